@@ -168,7 +168,8 @@ S_search(IndexSearcher *searcher, const char *query) {
 
     // Execute search query.
     String *query_str = Str_new_from_utf8(query, strlen(query));
-    Hits   *hits      = IxSearcher_Hits(searcher, (Obj*)query_str, 0, 10, NULL);
+    Hits   *hits      = IxSearcher_Hits(searcher, (Obj*)query_str, 0, 10, NULL,
+                                        NULL, NULL);
 
     String *field_str = Str_newf("title");
     HitDoc *hit;
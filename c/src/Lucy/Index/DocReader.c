@@ -26,35 +26,45 @@
 #include "Clownfish/Err.h"
 #include "Clownfish/Hash.h"
 #include "Clownfish/Num.h"
+#include "Clownfish/VArray.h"
 #include "Clownfish/Util/Memory.h"
 #include "Lucy/Document/HitDoc.h"
 #include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/Schema.h"
 #include "Lucy/Store/InStream.h"
 
-HitDoc*
-DefDocReader_Fetch_Doc_IMP(DefaultDocReader *self, int32_t doc_id) {
+// Return true if <code>fields</code> is NULL or contains the field name.
+static bool
+S_wanted(VArray *fields, const char *name, size_t name_len) {
+    if (!fields) { return true; }
+    for (uint32_t i = 0, max = VA_Get_Size(fields); i < max; i++) {
+        String *field = (String*)VA_Fetch(fields, i);
+        if (field && Str_Equals_Utf8(field, name, name_len)) { return true; }
+    }
+    return false;
+}
+
+static HitDoc*
+S_fetch_doc(DefaultDocReader *self, int32_t doc_id, VArray *fields) {
     DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
     Schema   *const schema = ivars->schema;
-    InStream *const dat_in = ivars->dat_in;
-    InStream *const ix_in  = ivars->ix_in;
-    Hash     *const fields = Hash_new(1);
-    int64_t   start;
+    InStream *const dat_in = DefDocReader_Seek_Record(self, doc_id);
+    Hash     *const doc_fields = Hash_new(1);
     uint32_t  num_fields;
+    uint32_t  num_wanted = fields ? VA_Get_Size(fields) : UINT32_MAX;
     uint32_t  field_name_cap = 31;
     char     *field_name = (char*)MALLOCATE(field_name_cap + 1);
 
-    // Get data file pointer from index, read number of fields.
-    InStream_Seek(ix_in, (int64_t)doc_id * 8);
-    start = InStream_Read_U64(ix_in);
-    InStream_Seek(dat_in, start);
+    // Read number of fields.
     num_fields = InStream_Read_C32(dat_in);
 
-    // Decode stored data and build up the doc field by field.
-    while (num_fields--) {
+    // Decode stored data and build up the doc field by field, stopping once
+    // every requested field has been found.
+    while (num_fields-- && num_wanted) {
         uint32_t        field_name_len;
         Obj       *value;
         FieldType *type;
+        InStream  *value_in;
 
         // Read field name.
         field_name_len = InStream_Read_C32(dat_in);
@@ -70,39 +80,45 @@ DefDocReader_Fetch_Doc_IMP(DefaultDocReader *self, int32_t doc_id) {
             = SSTR_WRAP_UTF8(field_name, field_name_len);
         type = Schema_Fetch_Type(schema, (String*)field_name_str);
 
+        // Skip over the value unless it was asked for.
+        bool wanted = S_wanted(fields, field_name, field_name_len);
+        value_in = DefDocReader_Seek_Value(self, dat_in, type, wanted);
+        if (!value_in) { continue; }
+        if (fields) { num_wanted--; }
+
         // Read the field value.
         switch (FType_Primitive_ID(type) & FType_PRIMITIVE_ID_MASK) {
             case FType_TEXT: {
-                    uint32_t value_len = InStream_Read_C32(dat_in);
+                    uint32_t value_len = InStream_Read_C32(value_in);
                     char *buf = (char*)MALLOCATE(value_len + 1);
-                    InStream_Read_Bytes(dat_in, buf, value_len);
+                    InStream_Read_Bytes(value_in, buf, value_len);
                     buf[value_len] = '\0'; 
                     value = (Obj*)Str_new_steal_utf8(buf, value_len);
                     break;
                 }
             case FType_BLOB: {
-                    uint32_t value_len = InStream_Read_C32(dat_in);
+                    uint32_t value_len = InStream_Read_C32(value_in);
                     char *buf = (char*)MALLOCATE(value_len);
-                    InStream_Read_Bytes(dat_in, buf, value_len);
+                    InStream_Read_Bytes(value_in, buf, value_len);
                     value = (Obj*)BB_new_steal_bytes(
                                 buf, value_len, value_len);
                     break;
                 }
             case FType_FLOAT32:
                 value = (Obj*)Float32_new(
-                                InStream_Read_F32(dat_in));
+                                InStream_Read_F32(value_in));
                 break;
             case FType_FLOAT64:
                 value = (Obj*)Float64_new(
-                                InStream_Read_F64(dat_in));
+                                InStream_Read_F64(value_in));
                 break;
             case FType_INT32:
                 value = (Obj*)Int32_new(
-                                (int32_t)InStream_Read_C32(dat_in));
+                                (int32_t)InStream_Read_C32(value_in));
                 break;
             case FType_INT64:
                 value = (Obj*)Int64_new(
-                                (int64_t)InStream_Read_C64(dat_in));
+                                (int64_t)InStream_Read_C64(value_in));
                 break;
             default:
                 value = NULL;
@@ -110,12 +126,23 @@ DefDocReader_Fetch_Doc_IMP(DefaultDocReader *self, int32_t doc_id) {
         }
 
         // Store the value.
-        Hash_Store_Utf8(fields, field_name, field_name_len, value);
+        Hash_Store_Utf8(doc_fields, field_name, field_name_len, value);
     }
     FREEMEM(field_name);
 
-    HitDoc *retval = HitDoc_new(fields, doc_id, 0.0);
-    DECREF(fields);
+    HitDoc *retval = HitDoc_new(doc_fields, doc_id, 0.0);
+    DECREF(doc_fields);
     return retval;
 }
 
+HitDoc*
+DefDocReader_Fetch_Doc_IMP(DefaultDocReader *self, int32_t doc_id) {
+    return S_fetch_doc(self, doc_id, NULL);
+}
+
+HitDoc*
+DefDocReader_Fetch_Doc_Fields_IMP(DefaultDocReader *self, int32_t doc_id,
+                                  VArray *fields) {
+    return S_fetch_doc(self, doc_id, fields);
+}
+
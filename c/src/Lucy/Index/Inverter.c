@@ -32,36 +32,8 @@
 #include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/Schema.h"
 
-static InverterEntry*
-S_fetch_entry(InverterIVARS *ivars, String *field) {
-    Schema *const schema = ivars->schema;
-    int32_t field_num = Seg_Field_Num(ivars->segment, field);
-    if (!field_num) {
-        // This field seems not to be in the segment yet.  Try to find it in
-        // the Schema.
-        if (Schema_Fetch_Type(schema, field)) {
-            // The field is in the Schema.  Get a field num from the Segment.
-            field_num = Seg_Add_Field(ivars->segment, field);
-        }
-        else {
-            // We've truly failed to find the field.  The user must
-            // not have spec'd it.
-            THROW(ERR, "Unknown field name: '%o'", field);
-        }
-    }
-
-    InverterEntry *entry
-        = (InverterEntry*)VA_Fetch(ivars->entry_pool, field_num);
-    if (!entry) {
-        entry = InvEntry_new(schema, (String*)field, field_num);
-        VA_Store(ivars->entry_pool, field_num, (Obj*)entry);
-    }
-    return entry;
-}
-
 void
 Inverter_Invert_Doc_IMP(Inverter *self, Doc *doc) {
-    InverterIVARS *const ivars = Inverter_IVARS(self);
     Hash *const fields = (Hash*)Doc_Get_Fields(doc);
     uint32_t   num_keys     = Hash_Iterate(fields);
 
@@ -73,7 +45,7 @@ Inverter_Invert_Doc_IMP(Inverter *self, Doc *doc) {
         Obj *key, *obj;
         Hash_Next(fields, &key, &obj);
         String *field = (String*)CERTIFY(key, STRING);
-        InverterEntry *inventry = S_fetch_entry(ivars, field);
+        InverterEntry *inventry = Inverter_Fetch_Entry(self, field);
         InverterEntryIVARS *inventry_ivars = InvEntry_IVARS(inventry);
         FieldType *type = inventry_ivars->type;
 
@@ -33,6 +33,8 @@
 #include "Lucy/Store/Folder.h"
 #include "Lucy/Store/FSFolder.h"
 #include "Lucy/Store/Lock.h"
+#include "Lucy/Store/RateLimiter.h"
+#include "Lucy/Util/Clock.h"
 #include "Lucy/Util/Freezer.h"
 #include "Lucy/Util/IndexFileNames.h"
 #include "Lucy/Util/Json.h"
@@ -57,6 +59,11 @@ S_release_write_lock(BackgroundMerger *self);
 static void
 S_release_merge_lock(BackgroundMerger *self);
 
+// If we borrowed the caller's Folder, give it back the RateLimiter it had
+// before we installed ours.
+static void
+S_restore_rate_limiter(BackgroundMerger *self);
+
 BackgroundMerger*
 BGMerger_new(Obj *index, IndexManager *manager) {
     BackgroundMerger *self
@@ -70,14 +77,39 @@ BGMerger_init(BackgroundMerger *self, Obj *index, IndexManager *manager) {
     Folder *folder = S_init_folder(index);
 
     // Init.
-    ivars->optimize      = false;
-    ivars->prepared      = false;
-    ivars->needs_commit  = false;
-    ivars->snapfile      = NULL;
-    ivars->doc_maps      = Hash_new(0);
+    ivars->optimize        = false;
+    ivars->prepared        = false;
+    ivars->needs_commit    = false;
+    ivars->snapfile        = NULL;
+    ivars->doc_maps        = Hash_new(0);
+    ivars->bytes_total     = 0;
+    ivars->bytes_done      = 0;
+    ivars->time_budget     = 0;
+    ivars->start_time      = Clock_microtime();
+    ivars->merge_start     = 0;
+    ivars->borrowed_folder = false;
+
+    // Route all I/O performed on our behalf through a RateLimiter.  It must
+    // be installed before the PolyReader opens its streams.  The budget
+    // starts out unlimited.  Work through a twin of the Folder where
+    // possible, so that the budget doesn't throttle anyone else using it;
+    // otherwise borrow the Folder and give its RateLimiter back afterwards.
+    ivars->rate_limiter = RateLimiter_new(0);
+    Folder *twin = Folder_Twin(folder);
+    if (twin) {
+        DECREF(folder);
+        folder = twin;
+    }
+    else {
+        ivars->borrowed_folder = true;
+        ivars->orig_limiter
+            = (RateLimiter*)INCREF(Folder_Get_Rate_Limiter(folder));
+    }
+    Folder_Set_Rate_Limiter(folder, ivars->rate_limiter);
 
     // Assign.
     ivars->folder = folder;
+
     if (manager) {
         ivars->manager = (IndexManager*)INCREF(manager);
     }
@@ -159,6 +191,7 @@ BGMerger_Destroy_IMP(BackgroundMerger *self) {
     BackgroundMergerIVARS *const ivars = BGMerger_IVARS(self);
     S_release_merge_lock(self);
     S_release_write_lock(self);
+    S_restore_rate_limiter(self);
     DECREF(ivars->schema);
     DECREF(ivars->folder);
     DECREF(ivars->segment);
@@ -171,6 +204,8 @@ BGMerger_Destroy_IMP(BackgroundMerger *self) {
     DECREF(ivars->write_lock);
     DECREF(ivars->snapfile);
     DECREF(ivars->doc_maps);
+    DECREF(ivars->rate_limiter);
+    DECREF(ivars->patch_seg_name);
     SUPER_DESTROY(self, BACKGROUNDMERGER);
 }
 
@@ -202,6 +237,56 @@ BGMerger_Optimize_IMP(BackgroundMerger *self) {
     BGMerger_IVARS(self)->optimize = true;
 }
 
+void
+BGMerger_Set_IO_Budget_IMP(BackgroundMerger *self, int64_t bytes_per_sec) {
+    RateLimiter_Set_Bytes_Per_Sec(BGMerger_IVARS(self)->rate_limiter,
+                                  bytes_per_sec);
+}
+
+int64_t
+BGMerger_Get_IO_Budget_IMP(BackgroundMerger *self) {
+    return RateLimiter_Get_Bytes_Per_Sec(BGMerger_IVARS(self)->rate_limiter);
+}
+
+void
+BGMerger_Set_Time_Budget_IMP(BackgroundMerger *self, uint32_t milliseconds) {
+    BGMerger_IVARS(self)->time_budget = milliseconds;
+}
+
+uint32_t
+BGMerger_Get_Time_Budget_IMP(BackgroundMerger *self) {
+    return BGMerger_IVARS(self)->time_budget;
+}
+
+bool
+BGMerger_Checkpoint_IMP(BackgroundMerger *self) {
+    BackgroundMergerIVARS *const ivars = BGMerger_IVARS(self);
+    if (!ivars->time_budget) { return true; }
+    uint64_t elapsed = Clock_microtime() - ivars->start_time;
+    return elapsed < (uint64_t)ivars->time_budget * 1000;
+}
+
+int64_t
+BGMerger_Bytes_Total_IMP(BackgroundMerger *self) {
+    return BGMerger_IVARS(self)->bytes_total;
+}
+
+int64_t
+BGMerger_Bytes_Done_IMP(BackgroundMerger *self) {
+    return BGMerger_IVARS(self)->bytes_done;
+}
+
+double
+BGMerger_ETA_IMP(BackgroundMerger *self) {
+    BackgroundMergerIVARS *const ivars = BGMerger_IVARS(self);
+    if (!ivars->bytes_done) { return -1.0; }
+    int64_t remaining = ivars->bytes_total - ivars->bytes_done;
+    if (remaining <= 0) { return 0.0; }
+    double elapsed = (double)(Clock_microtime() - ivars->merge_start)
+                     / 1000000.0;
+    return elapsed * (double)remaining / (double)ivars->bytes_done;
+}
+
 static uint32_t
 S_maybe_merge(BackgroundMerger *self) {
     BackgroundMergerIVARS *const ivars = BGMerger_IVARS(self);
@@ -226,9 +311,22 @@ S_maybe_merge(BackgroundMerger *self) {
     // Now that we're sure we're writing a new segment, prep the seg dir.
     SegWriter_Prep_Seg_Dir(ivars->seg_writer);
 
-    // Consolidate segments.
-    for (uint32_t i = 0, max = num_to_merge; i < max; i++) {
+    // Tally up the work, for progress reporting.
+    int64_t *seg_sizes
+        = (int64_t*)MALLOCATE(num_to_merge * sizeof(int64_t));
+    for (int32_t i = 0; i < num_to_merge; i++) {
         SegReader *seg_reader = (SegReader*)VA_Fetch(to_merge, i);
+        seg_sizes[i] = IxManager_seg_size(ivars->folder,
+                                          SegReader_Get_Seg_Name(seg_reader));
+        ivars->bytes_total += seg_sizes[i];
+    }
+    ivars->merge_start = Clock_microtime();
+
+    // Consolidate segments, stopping early if Checkpoint() says so.  Any
+    // segments we don't get to stay in the snapshot.
+    int32_t num_merged = 0;
+    while (num_merged < num_to_merge) {
+        SegReader *seg_reader = (SegReader*)VA_Fetch(to_merge, num_merged);
         String    *seg_name   = SegReader_Get_Seg_Name(seg_reader);
         int64_t    doc_count  = Seg_Get_Count(ivars->segment);
         Matcher *deletions
@@ -241,10 +339,15 @@ S_maybe_merge(BackgroundMerger *self) {
         Hash_Store(ivars->doc_maps, (Obj*)seg_name, (Obj*)doc_map);
         SegWriter_Merge_Segment(ivars->seg_writer, seg_reader, doc_map);
         DECREF(deletions);
+
+        ivars->bytes_done += seg_sizes[num_merged];
+        num_merged++;
+        if (!BGMerger_Checkpoint(self)) { break; }
     }
 
+    FREEMEM(seg_sizes);
     DECREF(to_merge);
-    return num_to_merge;
+    return (uint32_t)num_merged;
 }
 
 static bool
@@ -319,6 +422,8 @@ S_merge_updated_deletions(BackgroundMerger *self) {
         Matcher *deletions     = NULL;
 
         SegWriter_Prep_Seg_Dir(seg_writer);
+        DECREF(ivars->patch_seg_name);
+        ivars->patch_seg_name = Str_Clone(Seg_Get_Name(new_segment));
 
         for (uint32_t i = 0, max = VA_Get_Size(merge_seg_readers); i < max; i++) {
             SegReader *seg_reader
@@ -460,6 +565,10 @@ BGMerger_Prepare_Commit_IMP(BackgroundMerger *self) {
 
         DECREF(latest_snapshot);
 
+        // Make the new files durable before Commit() links the snapshot
+        // into place.
+        if (!Folder_Sync(folder)) { RETHROW(INCREF(Err_get_error())); }
+
         ivars->needs_commit = true;
     }
 
@@ -509,6 +618,9 @@ BGMerger_Commit_IMP(BackgroundMerger *self) {
             Err_throw_mess(ERR, mess);
         }
         DECREF(temp_snapfile);
+        if (!Folder_Sync(ivars->folder)) {
+            RETHROW(INCREF(Err_get_error()));
+        }
     }
 
     // Release the merge lock and remove the merge data file.
@@ -522,6 +634,52 @@ BGMerger_Commit_IMP(BackgroundMerger *self) {
 
     // Release the write lock.
     S_release_write_lock(self);
+    S_restore_rate_limiter(self);
+}
+
+void
+BGMerger_Abandon_IMP(BackgroundMerger *self) {
+    BackgroundMergerIVARS *const ivars = BGMerger_IVARS(self);
+    Folder *folder = ivars->folder;
+
+    // Safety check.
+    if (!ivars->merge_lock) {
+        THROW(ERR, "Can't call Abandon() after Commit() or Abandon()");
+    }
+
+    // Close reader, so that nothing holds on to the files we're zapping.
+    if (ivars->polyreader) {
+        PolyReader_Close(ivars->polyreader);
+    }
+
+    // Delete the temporary snapshot file and any segments we've written.
+    // Nothing else refers to them, since we haven't committed.
+    if (ivars->snapfile) {
+        Folder_Delete(folder, ivars->snapfile);
+        DECREF(ivars->snapfile);
+        ivars->snapfile = NULL;
+    }
+    if (ivars->segment) {
+        String *seg_name = Seg_Get_Name(ivars->segment);
+        if (Folder_Exists(folder, seg_name)) {
+            Folder_Delete_Tree(folder, seg_name);
+        }
+    }
+    if (ivars->patch_seg_name
+        && Folder_Exists(folder, ivars->patch_seg_name)
+       ) {
+        Folder_Delete_Tree(folder, ivars->patch_seg_name);
+    }
+    ivars->needs_commit = false;
+    ivars->prepared     = true;
+
+    // Release the merge lock and remove the merge data file.
+    S_release_merge_lock(self);
+    IxManager_Remove_Merge_Data(ivars->manager);
+
+    // Release the write lock if Prepare_Commit() acquired it.
+    S_release_write_lock(self);
+    S_restore_rate_limiter(self);
 }
 
 static void
@@ -574,4 +732,17 @@ S_release_merge_lock(BackgroundMerger *self) {
     }
 }
 
+static void
+S_restore_rate_limiter(BackgroundMerger *self) {
+    BackgroundMergerIVARS *const ivars = BGMerger_IVARS(self);
+    if (ivars->borrowed_folder
+        && ivars->folder
+        && Folder_Get_Rate_Limiter(ivars->folder) == ivars->rate_limiter
+       ) {
+        Folder_Set_Rate_Limiter(ivars->folder, ivars->orig_limiter);
+    }
+    DECREF(ivars->orig_limiter);
+    ivars->orig_limiter = NULL;
+}
+
 
@@ -47,6 +47,14 @@ DelReader_Aggregator_IMP(DeletionsReader *self, VArray *readers,
     return (DeletionsReader*)PolyDelReader_new(readers, offsets);
 }
 
+bool
+DelReader_Is_Deleted_IMP(DeletionsReader *self, int32_t doc_id) {
+    Matcher *iterator = DelReader_Iterator(self);
+    bool deleted = Matcher_Advance(iterator, doc_id) == doc_id;
+    DECREF(iterator);
+    return deleted;
+}
+
 PolyDeletionsReader*
 PolyDelReader_new(VArray *readers, I32Array *offsets) {
     PolyDeletionsReader *self
@@ -211,4 +219,12 @@ DefDelReader_Del_Count_IMP(DefaultDeletionsReader *self) {
     return DefDelReader_IVARS(self)->del_count;
 }
 
+bool
+DefDelReader_Is_Deleted_IMP(DefaultDeletionsReader *self, int32_t doc_id) {
+    DefaultDeletionsReaderIVARS *const ivars = DefDelReader_IVARS(self);
+    return ivars->deldocs && doc_id > 0
+           ? BitVec_Get(ivars->deldocs, (uint32_t)doc_id)
+           : false;
+}
+
 
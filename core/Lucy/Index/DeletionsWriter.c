@@ -23,12 +23,15 @@
 #include "Lucy/Index/DeletionsWriter.h"
 #include "Lucy/Index/DeletionsReader.h"
 #include "Lucy/Index/IndexReader.h"
+#include "Lucy/Index/LexiconReader.h"
 #include "Lucy/Index/PolyReader.h"
 #include "Lucy/Index/PostingList.h"
 #include "Lucy/Index/PostingListReader.h"
+#include "Lucy/Index/SegPostingList.h"
 #include "Lucy/Index/Segment.h"
 #include "Lucy/Index/SegReader.h"
 #include "Lucy/Index/Snapshot.h"
+#include "Lucy/Index/TermInfo.h"
 #include "Lucy/Plan/Schema.h"
 #include "Lucy/Search/BitVecMatcher.h"
 #include "Lucy/Search/Compiler.h"
@@ -247,18 +250,60 @@ DefDelWriter_Seg_Del_Count_IMP(DefaultDeletionsWriter *self,
     return deldocs ? BitVec_Count(deldocs) : 0;
 }
 
+// Look up the term before creating a PostingList, so that segments which
+// don't contain it -- the common case for unique identifiers -- cost only a
+// lexicon probe.
+static PostingList*
+S_term_posting_list(PostingListReader *plist_reader, String *field,
+                    Obj *term) {
+    LexiconReader *lex_reader = PListReader_Get_Lex_Reader(plist_reader);
+    if (!lex_reader) {
+        return PListReader_Posting_List(plist_reader, field, term);
+    }
+    TermInfo *tinfo = LexReader_Fetch_Term_Info(lex_reader, field, term);
+    if (!tinfo) { return NULL; }
+    PostingList *plist = PListReader_Posting_List(plist_reader, field, NULL);
+    if (plist && Obj_Is_A((Obj*)plist, SEGPOSTINGLIST)) {
+        SegPList_Seek_Term_Info((SegPostingList*)plist, tinfo);
+    }
+    else if (plist) {
+        PList_Seek(plist, term);
+    }
+    DECREF(tinfo);
+    return plist;
+}
+
+// Consult a unique field's key map.  Return 0 if the segment doesn't hold
+// the term, or -1 if it may.
+static int32_t
+S_lookup_key(SegReader *seg_reader, String *field, Obj *term) {
+    LexiconReader *lex_reader = (LexiconReader*)SegReader_Fetch(
+                                    seg_reader, VTable_Get_Name(LEXICONREADER));
+    int32_t doc_id = lex_reader
+                     ? LexReader_Lookup_Key(lex_reader, field, term)
+                     : -1;
+    return doc_id == 0 ? 0 : -1;
+}
+
 void
 DefDelWriter_Delete_By_Term_IMP(DefaultDeletionsWriter *self,
                                 String *field, Obj *term) {
     DefaultDeletionsWriterIVARS *const ivars = DefDelWriter_IVARS(self);
     for (uint32_t i = 0, max = VA_Get_Size(ivars->seg_readers); i < max; i++) {
         SegReader *seg_reader = (SegReader*)VA_Fetch(ivars->seg_readers, i);
+
+        // Updating a unique key usually finds it in one segment at most.  The
+        // key map rules the others out without a lexicon probe.  It only
+        // knows the newest doc holding a key, though, so duplicates within a
+        // segment are still found through the postings.
+        if (S_lookup_key(seg_reader, field, term) == 0) { continue; }
+
         PostingListReader *plist_reader
             = (PostingListReader*)SegReader_Fetch(
                   seg_reader, VTable_Get_Name(POSTINGLISTREADER));
         BitVector *bit_vec = (BitVector*)VA_Fetch(ivars->bit_vecs, i);
         PostingList *plist = plist_reader
-                             ? PListReader_Posting_List(plist_reader, field, term)
+                             ? S_term_posting_list(plist_reader, field, term)
                              : NULL;
         int32_t doc_id;
         int32_t num_zapped = 0;
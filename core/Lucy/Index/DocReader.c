@@ -25,9 +25,52 @@
 #include "Lucy/Index/PolyReader.h"
 #include "Lucy/Index/Segment.h"
 #include "Lucy/Index/Snapshot.h"
+#include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/Schema.h"
+#include "Lucy/Store/FileHandle.h"
 #include "Lucy/Store/Folder.h"
 #include "Lucy/Store/InStream.h"
+#include "Lucy/Store/RAMFile.h"
+#include "Lucy/Util/LZBlock.h"
+#include "Clownfish/Util/SortUtils.h"
+
+// Sort doc ids packed together with their position in the request:
+// (doc_id << 32) | position.
+static int
+S_compare_packed(void *context, const void *va, const void *vb);
+
+// Pack the requested doc ids with their positions and sort them.
+static uint64_t*
+S_sorted_requests(I32Array *doc_ids);
+
+// Load the chunk table from documents.ix.
+static void
+S_read_chunk_table(DefaultDocReader *self);
+
+// Return the tick of the chunk which holds the doc.
+static uint32_t
+S_find_chunk(DefaultDocReader *self, int32_t doc_id);
+
+// Decompress the specified chunk and make it the current one.
+static void
+S_load_chunk(DefaultDocReader *self, uint32_t tick);
+
+// Read a block starting at the current position of dat_in and return its
+// decompressed contents.
+static ByteBuf*
+S_read_block(DefaultDocReader *self, uint32_t expected_len);
+
+// Decompress a large value and return a stream positioned at its start.
+static InStream*
+S_load_value(DefaultDocReader *self, uint32_t offset, uint32_t len);
+
+// Skip over a value in the layout used before format 4.
+static void
+S_skip_value(InStream *instream, FieldType *type);
+
+// Append a C32 to a ByteBuf.
+static void
+S_cat_c32(ByteBuf *buffer, uint32_t value);
 
 DocReader*
 DocReader_init(DocReader *self, Schema *schema, Folder *folder,
@@ -36,6 +79,21 @@ DocReader_init(DocReader *self, Schema *schema, Folder *folder,
                                        snapshot, segments, seg_tick);
 }
 
+VArray*
+DocReader_Fetch_Docs_IMP(DocReader *self, I32Array *doc_ids,
+                         VArray *fields) {
+    const uint32_t num_docs = I32Arr_Get_Size(doc_ids);
+    VArray *hit_docs = VA_new(num_docs);
+    for (uint32_t i = 0; i < num_docs; i++) {
+        int32_t doc_id = I32Arr_Get(doc_ids, i);
+        HitDoc *hit_doc = fields
+                          ? DocReader_Fetch_Doc_Fields(self, doc_id, fields)
+                          : DocReader_Fetch_Doc(self, doc_id);
+        VA_Push(hit_docs, (Obj*)hit_doc);
+    }
+    return hit_docs;
+}
+
 DocReader*
 DocReader_Aggregator_IMP(DocReader *self, VArray *readers,
                          I32Array *offsets) {
@@ -81,6 +139,27 @@ PolyDocReader_Destroy_IMP(PolyDocReader *self) {
     SUPER_DESTROY(self, POLYDOCREADER);
 }
 
+HitDoc*
+DocReader_Fetch_Doc_Fields_IMP(DocReader *self, int32_t doc_id,
+                               VArray *fields) {
+    UNUSED_VAR(fields);
+    return DocReader_Fetch_Doc(self, doc_id);
+}
+
+HitDoc*
+PolyDocReader_Fetch_Doc_Fields_IMP(PolyDocReader *self, int32_t doc_id,
+                                   VArray *fields) {
+    PolyDocReaderIVARS *const ivars = PolyDocReader_IVARS(self);
+    uint32_t seg_tick = PolyReader_sub_tick(ivars->offsets, doc_id);
+    int32_t  offset   = I32Arr_Get(ivars->offsets, seg_tick);
+    DocReader *doc_reader = (DocReader*)VA_Fetch(ivars->readers, seg_tick);
+    if (!doc_reader) { THROW(ERR, "Invalid doc_id: %i32", doc_id); }
+    HitDoc *hit_doc
+        = DocReader_Fetch_Doc_Fields(doc_reader, doc_id - offset, fields);
+    HitDoc_Set_Doc_ID(hit_doc, doc_id);
+    return hit_doc;
+}
+
 HitDoc*
 PolyDocReader_Fetch_Doc_IMP(PolyDocReader *self, int32_t doc_id) {
     PolyDocReaderIVARS *const ivars = PolyDocReader_IVARS(self);
@@ -98,6 +177,19 @@ PolyDocReader_Fetch_Doc_IMP(PolyDocReader *self, int32_t doc_id) {
     return hit_doc;
 }
 
+static VArray*
+S_fetch_sub_docs(Obj *doc_reader, I32Array *doc_ids, VArray *fields) {
+    return DocReader_Fetch_Docs((DocReader*)doc_reader, doc_ids, fields);
+}
+
+VArray*
+PolyDocReader_Fetch_Docs_IMP(PolyDocReader *self, I32Array *doc_ids,
+                             VArray *fields) {
+    PolyDocReaderIVARS *const ivars = PolyDocReader_IVARS(self);
+    return PolyReader_fetch_docs(ivars->offsets, ivars->readers, doc_ids,
+                                 fields, S_fetch_sub_docs);
+}
+
 DefaultDocReader*
 DefDocReader_new(Schema *schema, Folder *folder, Snapshot *snapshot,
                  VArray *segments, int32_t seg_tick) {
@@ -120,6 +212,15 @@ DefDocReader_Close_IMP(DefaultDocReader *self) {
         DECREF(ivars->ix_in);
         ivars->ix_in = NULL;
     }
+    if (ivars->chunk_in != NULL) {
+        DECREF(ivars->chunk_in);
+        ivars->chunk_in = NULL;
+    }
+    if (ivars->value_in != NULL) {
+        DECREF(ivars->value_in);
+        ivars->value_in = NULL;
+    }
+    ivars->cached_chunk = -1;
 }
 
 void
@@ -127,6 +228,12 @@ DefDocReader_Destroy_IMP(DefaultDocReader *self) {
     DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
     DECREF(ivars->ix_in);
     DECREF(ivars->dat_in);
+    DECREF(ivars->chunk_in);
+    DECREF(ivars->value_in);
+    DECREF(ivars->scratch);
+    FREEMEM(ivars->chunk_bases);
+    FREEMEM(ivars->chunk_starts);
+    FREEMEM(ivars->record_starts);
     SUPER_DESTROY(self, DEFAULTDOCREADER);
 }
 
@@ -138,6 +245,8 @@ DefDocReader_init(DefaultDocReader *self, Schema *schema, Folder *folder,
     DocReader_init((DocReader*)self, schema, folder, snapshot, segments,
                    seg_tick);
     DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+    ivars->cached_chunk = -1;
+    ivars->scratch      = BB_new(0);
     segment = DefDocReader_Get_Segment(self);
     metadata = (Hash*)Seg_Fetch_Metadata_Utf8(segment, "documents", 9);
 
@@ -151,13 +260,14 @@ DefDocReader_init(DefaultDocReader *self, Schema *schema, Folder *folder,
         if (!format) { THROW(ERR, "Missing 'format' var"); }
         else {
             int64_t format_val = Obj_To_I64(format);
-            if (format_val < DocWriter_current_file_format) {
+            if (format_val < 2) {
                 THROW(ERR, "Obsolete doc storage format %i64; "
                       "Index regeneration is required", format_val);
             }
-            else if (format_val != DocWriter_current_file_format) {
+            else if (format_val > DocWriter_current_file_format) {
                 THROW(ERR, "Unsupported doc storage format: %i64", format_val);
             }
+            ivars->format = (int32_t)format_val;
         }
 
         // Get streams.
@@ -178,6 +288,13 @@ DefDocReader_init(DefaultDocReader *self, Schema *schema, Folder *folder,
                 DECREF(self);
                 RETHROW(error);
             }
+
+            // Lookups are random and mostly cold, so don't read ahead.  Advising
+            // through the Folder lets a compound file keep the hint standing.
+            Folder_Advise(folder, ix_file, FH_ADVICE_RANDOM);
+            Folder_Advise(folder, dat_file, FH_ADVICE_RANDOM);
+
+            if (ivars->format >= 3) { S_read_chunk_table(self); }
         }
         DECREF(ix_file);
         DECREF(dat_file);
@@ -186,22 +303,393 @@ DefDocReader_init(DefaultDocReader *self, Schema *schema, Folder *folder,
     return self;
 }
 
+static void
+S_read_chunk_table(DefaultDocReader *self) {
+    DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+    InStream *ix_in       = ivars->ix_in;
+    int64_t   num_entries = InStream_Length(ix_in) / 12;
+    if (num_entries < 1 || num_entries * 12 != InStream_Length(ix_in)) {
+        THROW(ERR, "Corrupt documents.ix: %o", InStream_Get_Filename(ix_in));
+    }
+
+    size_t size = (size_t)num_entries;
+    ivars->num_chunks   = (uint32_t)(num_entries - 1);
+    ivars->chunk_bases  = (int32_t*)MALLOCATE(size * sizeof(int32_t));
+    ivars->chunk_starts = (int64_t*)MALLOCATE(size * sizeof(int64_t));
+    InStream_Seek(ix_in, 0);
+    for (size_t i = 0; i < size; i++) {
+        ivars->chunk_bases[i]  = InStream_Read_I32(ix_in);
+        ivars->chunk_starts[i] = InStream_Read_I64(ix_in);
+    }
+}
+
+static uint32_t
+S_find_chunk(DefaultDocReader *self, int32_t doc_id) {
+    DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+    const int32_t *bases = ivars->chunk_bases;
+    if (!bases
+        || doc_id < bases[0]
+        || doc_id >= bases[ivars->num_chunks]
+       ) {
+        THROW(ERR, "Invalid doc_id: %i32", doc_id);
+    }
+
+    // Find the last chunk whose first doc id is no greater than doc_id.
+    uint32_t lo = 0;
+    uint32_t hi = ivars->num_chunks - 1;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo + 1) / 2;
+        if (bases[mid] <= doc_id) { lo = mid; }
+        else                      { hi = mid - 1; }
+    }
+    return lo;
+}
+
+static ByteBuf*
+S_read_block(DefaultDocReader *self, uint32_t expected_len) {
+    DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+    InStream *dat_in     = ivars->dat_in;
+    uint8_t   codec      = InStream_Read_U8(dat_in);
+    uint32_t  raw_len    = InStream_Read_C32(dat_in);
+    uint32_t  stored_len = InStream_Read_C32(dat_in);
+    if (expected_len != UINT32_MAX && raw_len != expected_len) {
+        THROW(ERR, "Corrupt block in %o", InStream_Get_Filename(dat_in));
+    }
+
+    ByteBuf *contents = BB_new(raw_len);
+    char    *raw      = BB_Get_Buf(contents);
+    if (codec == DocWriter_CODEC_NONE && stored_len == raw_len) {
+        InStream_Read_Bytes(dat_in, raw, raw_len);
+    }
+    else if (codec == DocWriter_CODEC_LZ4) {
+        char *stored = BB_Grow(ivars->scratch, stored_len);
+        InStream_Read_Bytes(dat_in, stored, stored_len);
+        if (!LZBlock_decompress(stored, stored_len, raw, raw_len)) {
+            DECREF(contents);
+            THROW(ERR, "Corrupt block in %o", InStream_Get_Filename(dat_in));
+        }
+    }
+    else {
+        DECREF(contents);
+        THROW(ERR, "Unsupported doc codec %u32 in %o", (uint32_t)codec,
+              InStream_Get_Filename(dat_in));
+    }
+    BB_Set_Size(contents, raw_len);
+    return contents;
+}
+
+static void
+S_load_chunk(DefaultDocReader *self, uint32_t tick) {
+    DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+    InStream *dat_in   = ivars->dat_in;
+    uint32_t  num_docs = (uint32_t)(ivars->chunk_bases[tick + 1]
+                                    - ivars->chunk_bases[tick]);
+
+    // Read the records, and note where the large values begin.
+    InStream_Seek(dat_in, ivars->chunk_starts[tick]);
+    ByteBuf  *contents = S_read_block(self, UINT32_MAX);
+    uint32_t  raw_len  = (uint32_t)BB_Get_Size(contents);
+    if (ivars->format >= 4) {
+        InStream_Read_C32(dat_in);
+        ivars->ext_start = InStream_Tell(dat_in);
+    }
+
+    // Wrap the payload in a stream and decode the record lengths.
+    RAMFile *file = RAMFile_new(contents, true);
+    DECREF(ivars->chunk_in);
+    ivars->chunk_in     = InStream_open((Obj*)file);
+    ivars->cached_chunk = -1;
+    DECREF(file);
+    DECREF(contents);
+    if (num_docs + 1 > ivars->record_cap) {
+        ivars->record_cap    = num_docs + 1;
+        ivars->record_starts
+            = (uint32_t*)REALLOCATE(ivars->record_starts,
+                                    ivars->record_cap * sizeof(uint32_t));
+    }
+    uint32_t *starts = ivars->record_starts;
+    for (uint32_t i = 0; i < num_docs; i++) {
+        starts[i + 1] = InStream_Read_C32(ivars->chunk_in);
+    }
+    starts[0] = (uint32_t)InStream_Tell(ivars->chunk_in);
+    for (uint32_t i = 0; i < num_docs; i++) {
+        starts[i + 1] += starts[i];
+    }
+    if (starts[num_docs] != raw_len) {
+        THROW(ERR, "Corrupt chunk %u32 in %o", tick,
+              InStream_Get_Filename(dat_in));
+    }
+    ivars->cached_chunk = tick;
+}
+
+InStream*
+DefDocReader_Seek_Record_IMP(DefaultDocReader *self, int32_t doc_id) {
+    DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+
+    if (ivars->format < 3) {
+        // Get data file pointer from index.
+        InStream_Seek(ivars->ix_in, (int64_t)doc_id * 8);
+        int64_t start = InStream_Read_I64(ivars->ix_in);
+        InStream_Seek(ivars->dat_in, start);
+        return ivars->dat_in;
+    }
+
+    uint32_t tick = S_find_chunk(self, doc_id);
+    if (ivars->cached_chunk != (int64_t)tick) { S_load_chunk(self, tick); }
+    uint32_t slot = (uint32_t)(doc_id - ivars->chunk_bases[tick]);
+    InStream_Seek(ivars->chunk_in, ivars->record_starts[slot]);
+    return ivars->chunk_in;
+}
+
+InStream*
+DefDocReader_Seek_Value_IMP(DefaultDocReader *self, InStream *record,
+                            FieldType *type, bool wanted) {
+    DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+
+    if (ivars->format < 4) {
+        if (wanted) { return record; }
+        S_skip_value(record, type);
+        return NULL;
+    }
+
+    uint32_t tag = InStream_Read_C32(record);
+    uint32_t len = tag >> 1;
+    if (!(tag & 1)) {
+        if (wanted) { return record; }
+        InStream_Seek(record, InStream_Tell(record) + len);
+        return NULL;
+    }
+
+    // Large values are only read and decompressed on request.
+    uint32_t offset = InStream_Read_C32(record);
+    return wanted ? S_load_value(self, offset, len) : NULL;
+}
+
+static InStream*
+S_load_value(DefaultDocReader *self, uint32_t offset, uint32_t len) {
+    DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+    InStream_Seek(ivars->dat_in, ivars->ext_start + offset);
+    ByteBuf *contents = S_read_block(self, len);
+    RAMFile *file     = RAMFile_new(contents, true);
+    DECREF(ivars->value_in);
+    ivars->value_in = InStream_open((Obj*)file);
+    DECREF(file);
+    DECREF(contents);
+    return ivars->value_in;
+}
+
+static void
+S_skip_value(InStream *instream, FieldType *type) {
+    switch (FType_Primitive_ID(type) & FType_PRIMITIVE_ID_MASK) {
+        case FType_TEXT:
+        case FType_BLOB: {
+                uint32_t len = InStream_Read_C32(instream);
+                InStream_Seek(instream, InStream_Tell(instream) + len);
+                break;
+            }
+        case FType_FLOAT32:
+            InStream_Seek(instream, InStream_Tell(instream) + 4);
+            break;
+        case FType_FLOAT64:
+            InStream_Seek(instream, InStream_Tell(instream) + 8);
+            break;
+        case FType_INT32:
+            InStream_Read_C32(instream);
+            break;
+        case FType_INT64:
+            InStream_Read_C64(instream);
+            break;
+        default:
+            THROW(ERR, "Unrecognized type: %o", type);
+    }
+}
+
+static void
+S_cat_c32(ByteBuf *buffer, uint32_t value) {
+    char  buf[5];
+    char *end = buf;
+    NumUtil_encode_c32(value, &end);
+    BB_Cat_Bytes(buffer, buf, (size_t)(end - buf));
+}
+
 void
 DefDocReader_Read_Record_IMP(DefaultDocReader *self, ByteBuf *buffer,
                              int32_t doc_id) {
     DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+    InStream *record     = DefDocReader_Seek_Record(self, doc_id);
+    uint32_t  num_fields = InStream_Read_C32(record);
+
+    // Rebuild the record in the current layout, with every value inline.
+    BB_Set_Size(buffer, 0);
+    S_cat_c32(buffer, num_fields);
+    while (num_fields--) {
+        uint32_t name_len = InStream_Read_C32(record);
+        S_cat_c32(buffer, name_len);
+        size_t   size     = BB_Get_Size(buffer);
+        char    *name     = BB_Grow(buffer, size + name_len) + size;
+        InStream_Read_Bytes(record, name, name_len);
+        BB_Set_Size(buffer, size + name_len);
+
+        // Work out how long the value is and where to copy it from.
+        InStream *value_in = record;
+        uint32_t  len;
+        if (ivars->format >= 4) {
+            uint32_t tag = InStream_Read_C32(record);
+            len = tag >> 1;
+            if (tag & 1) {
+                value_in = S_load_value(self, InStream_Read_C32(record), len);
+            }
+        }
+        else {
+            StackString *field = SSTR_WRAP_UTF8(name, name_len);
+            FieldType *type = Schema_Fetch_Type(ivars->schema,
+                                                (String*)field);
+            int64_t start = InStream_Tell(record);
+            S_skip_value(record, type);
+            len = (uint32_t)(InStream_Tell(record) - start);
+            InStream_Seek(record, start);
+        }
+        S_cat_c32(buffer, len << 1);
+        size = BB_Get_Size(buffer);
+        char *dest = BB_Grow(buffer, size + len) + size;
+        InStream_Read_Bytes(value_in, dest, len);
+        BB_Set_Size(buffer, size + len);
+    }
+}
+
+int32_t
+DefDocReader_Format_IMP(DefaultDocReader *self) {
+    return DefDocReader_IVARS(self)->format;
+}
+
+uint32_t
+DefDocReader_Chunk_Count_IMP(DefaultDocReader *self) {
+    return DefDocReader_IVARS(self)->num_chunks;
+}
 
-    // Find start and length of variable length record.
-    InStream_Seek(ivars->ix_in, (int64_t)doc_id * 8);
-    int64_t start = InStream_Read_I64(ivars->ix_in);
-    int64_t end   = InStream_Read_I64(ivars->ix_in);
-    size_t size  = (size_t)(end - start);
+int32_t
+DefDocReader_Chunk_Base_IMP(DefaultDocReader *self, uint32_t tick) {
+    DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+    if (!ivars->chunk_bases || tick > ivars->num_chunks) {
+        THROW(ERR, "Chunk tick out of range: %u32", tick);
+    }
+    return ivars->chunk_bases[tick];
+}
 
-    // Read in the record.
-    char *buf = BB_Grow(buffer, size);
+void
+DefDocReader_Read_Raw_Chunk_IMP(DefaultDocReader *self, ByteBuf *buffer,
+                                uint32_t tick) {
+    DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+    if (!ivars->chunk_bases || tick >= ivars->num_chunks) {
+        THROW(ERR, "Chunk tick out of range: %u32", tick);
+    }
+    int64_t start = ivars->chunk_starts[tick];
+    size_t  size  = (size_t)(ivars->chunk_starts[tick + 1] - start);
+    char   *buf   = BB_Grow(buffer, size);
     InStream_Seek(ivars->dat_in, start);
     InStream_Read_Bytes(ivars->dat_in, buf, size);
     BB_Set_Size(buffer, size);
 }
 
+VArray*
+DefDocReader_Fetch_Docs_IMP(DefaultDocReader *self, I32Array *doc_ids,
+                            VArray *fields) {
+    DefaultDocReaderIVARS *const ivars = DefDocReader_IVARS(self);
+    const uint32_t num_docs = I32Arr_Get_Size(doc_ids);
+    VArray   *hit_docs = VA_new(num_docs);
+    uint64_t *requests = S_sorted_requests(doc_ids);
 
+    // Both documents.ix and documents.dat are in doc id order, so visiting
+    // the docs sorted by id reads each file front to back.  Prefetch the
+    // chunks (or, for older segments, the index entries and then the
+    // records they point to), so that the reads for the whole batch are
+    // submitted up front rather than one at a time.  Visiting in order
+    // also means that each chunk is decompressed only once.
+    if (ivars->chunk_bases && num_docs) {
+        int64_t *offsets
+            = (int64_t*)MALLOCATE(num_docs * 2 * sizeof(int64_t));
+        int64_t *lengths    = offsets + num_docs;
+        uint32_t num_ranges = 0;
+        int64_t  last_tick  = -1;
+        int32_t  end_doc    = ivars->chunk_bases[ivars->num_chunks];
+        for (uint32_t i = 0; i < num_docs; i++) {
+            int32_t doc_id = (int32_t)(requests[i] >> 32);
+            if (doc_id < ivars->chunk_bases[0] || doc_id >= end_doc) {
+                // Leave the error for Fetch_Doc() to report.
+                continue;
+            }
+            uint32_t tick = S_find_chunk(self, doc_id);
+            if ((int64_t)tick == last_tick) { continue; }
+            offsets[num_ranges] = ivars->chunk_starts[tick];
+            lengths[num_ranges] = ivars->chunk_starts[tick + 1]
+                                  - ivars->chunk_starts[tick];
+            num_ranges++;
+            last_tick = tick;
+        }
+        InStream_Prefetch(ivars->dat_in, offsets, lengths, num_ranges);
+        FREEMEM(offsets);
+    }
+    else if (ivars->ix_in && num_docs) {
+        const int64_t ix_len = InStream_Length(ivars->ix_in);
+        int64_t *offsets
+            = (int64_t*)MALLOCATE(num_docs * 2 * sizeof(int64_t));
+        int64_t *lengths = offsets + num_docs;
+        for (uint32_t i = 0; i < num_docs; i++) {
+            offsets[i] = (int64_t)(requests[i] >> 32) * 8;
+            lengths[i] = 16;
+        }
+        InStream_Prefetch(ivars->ix_in, offsets, lengths, num_docs);
+        for (uint32_t i = 0; i < num_docs; i++) {
+            int64_t ix_pos = (int64_t)(requests[i] >> 32) * 8;
+            if (ix_pos + 16 > ix_len) {
+                // Leave the error for Fetch_Doc() to report.
+                lengths[i] = 0;
+                continue;
+            }
+            InStream_Seek(ivars->ix_in, ix_pos);
+            offsets[i] = InStream_Read_I64(ivars->ix_in);
+            lengths[i] = InStream_Read_I64(ivars->ix_in) - offsets[i];
+        }
+        InStream_Prefetch(ivars->dat_in, offsets, lengths, num_docs);
+        FREEMEM(offsets);
+    }
+
+    for (uint32_t i = 0; i < num_docs; i++) {
+        int32_t  doc_id   = (int32_t)(requests[i] >> 32);
+        uint32_t position = (uint32_t)(requests[i] & 0xFFFFFFFF);
+        HitDoc  *hit_doc
+            = fields
+              ? DefDocReader_Fetch_Doc_Fields(self, doc_id, fields)
+              : DefDocReader_Fetch_Doc(self, doc_id);
+        VA_Store(hit_docs, position, (Obj*)hit_doc);
+    }
+
+    FREEMEM(requests);
+    return hit_docs;
+}
+
+static int
+S_compare_packed(void *context, const void *va, const void *vb) {
+    UNUSED_VAR(context);
+    const uint64_t a = *(uint64_t*)va;
+    const uint64_t b = *(uint64_t*)vb;
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+
+static uint64_t*
+S_sorted_requests(I32Array *doc_ids) {
+    const uint32_t num_docs = I32Arr_Get_Size(doc_ids);
+    uint64_t *requests
+        = (uint64_t*)MALLOCATE((num_docs + 1) * sizeof(uint64_t));
+    for (uint32_t i = 0; i < num_docs; i++) {
+        int32_t doc_id = I32Arr_Get(doc_ids, i);
+        if (doc_id < 0) {
+            FREEMEM(requests);
+            THROW(ERR, "Invalid doc_id: %i32", doc_id);
+        }
+        requests[i] = ((uint64_t)doc_id << 32) | i;
+    }
+    Sort_quicksort(requests, num_docs, sizeof(uint64_t), S_compare_packed,
+                   NULL);
+    return requests;
+}
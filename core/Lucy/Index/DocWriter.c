@@ -25,16 +25,53 @@
 #include "Lucy/Index/Segment.h"
 #include "Lucy/Index/SegReader.h"
 #include "Lucy/Index/Snapshot.h"
+#include "Lucy/Plan/Architecture.h"
 #include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/Schema.h"
 #include "Lucy/Store/Folder.h"
 #include "Lucy/Store/OutStream.h"
+#include "Lucy/Store/RAMFile.h"
 #include "Lucy/Util/Freezer.h"
+#include "Lucy/Util/LZBlock.h"
 
 static OutStream*
 S_lazy_init(DocWriter *self);
 
-int32_t DocWriter_current_file_format = 2;
+// Finish off the record written to recs_out since <code>start</code>.
+static void
+S_end_record(DocWriter *self, int64_t start);
+
+// Compress the pending chunk and write it out.
+static void
+S_flush_chunk(DocWriter *self);
+
+// Start a new chunk, which will begin with doc id doc_max + 1.
+static void
+S_open_chunk(DocWriter *self);
+
+// Discard the buffers for the pending chunk.
+static void
+S_close_chunk(DocWriter *self);
+
+// Write a block, compressing it if that makes it smaller.
+static void
+S_write_block(DocWriter *self, OutStream *outstream, const char *raw,
+              size_t raw_len);
+
+// Write a field whose encoded value consists of <code>prefix</code>
+// followed by <code>body</code>.
+static void
+S_write_field(DocWriter *self, const char *name, size_t name_len,
+              const char *prefix, size_t prefix_len, const char *body,
+              size_t body_len);
+
+// Add a record in the form produced by DefDocReader_Read_Record().
+static void
+S_add_record(DocWriter *self, ByteBuf *record);
+
+int32_t DocWriter_current_file_format = 4;
+int32_t DocWriter_CODEC_NONE          = 0;
+int32_t DocWriter_CODEC_LZ4           = 1;
 
 DocWriter*
 DocWriter_new(Schema *schema, Snapshot *snapshot, Segment *segment,
@@ -47,12 +84,30 @@ DocWriter*
 DocWriter_init(DocWriter *self, Schema *schema, Snapshot *snapshot,
                Segment *segment, PolyReader *polyreader) {
     DataWriter_init((DataWriter*)self, schema, snapshot, segment, polyreader);
+    DocWriterIVARS *const ivars = DocWriter_IVARS(self);
+    Architecture *arch = Schema_Get_Architecture(schema);
+    ivars->codec      = Arch_Doc_Codec(arch);
+    ivars->chunk_size = Arch_Doc_Chunk_Size(arch);
+    ivars->large_size = ivars->chunk_size / 4 > 1 ? ivars->chunk_size / 4 : 1;
+    ivars->scratch    = BB_new(0);
+    ivars->value_buf  = BB_new(0);
+    ivars->doc_max    = 0;
+    if (ivars->codec != DocWriter_CODEC_NONE
+        && ivars->codec != DocWriter_CODEC_LZ4
+       ) {
+        int32_t codec = ivars->codec;
+        DECREF(self);
+        THROW(ERR, "Unsupported doc codec: %i32", codec);
+    }
     return self;
 }
 
 void
 DocWriter_Destroy_IMP(DocWriter *self) {
     DocWriterIVARS *const ivars = DocWriter_IVARS(self);
+    S_close_chunk(self);
+    DECREF(ivars->scratch);
+    DECREF(ivars->value_buf);
     DECREF(ivars->dat_out);
     DECREF(ivars->ix_out);
     SUPER_DESTROY(self, DOCWRITER);
@@ -74,12 +129,130 @@ S_lazy_init(DocWriter *self) {
         ivars->dat_out = Folder_Open_Out(folder, dat_file);
         DECREF(dat_file);
         if (!ivars->dat_out) { RETHROW(INCREF(Err_get_error())); }
+    }
+    if (!ivars->recs_out) { S_open_chunk(self); }
+
+    return ivars->recs_out;
+}
+
+static void
+S_open_chunk(DocWriter *self) {
+    DocWriterIVARS *const ivars = DocWriter_IVARS(self);
+    ivars->lens_file  = RAMFile_new(NULL, false);
+    ivars->recs_file  = RAMFile_new(NULL, false);
+    ivars->ext_file   = RAMFile_new(NULL, false);
+    ivars->lens_out   = OutStream_open((Obj*)ivars->lens_file);
+    ivars->recs_out   = OutStream_open((Obj*)ivars->recs_file);
+    ivars->ext_out    = OutStream_open((Obj*)ivars->ext_file);
+    ivars->chunk_base = ivars->doc_max + 1;
+}
+
+static void
+S_close_chunk(DocWriter *self) {
+    DocWriterIVARS *const ivars = DocWriter_IVARS(self);
+    DECREF(ivars->lens_out);
+    DECREF(ivars->recs_out);
+    DECREF(ivars->ext_out);
+    DECREF(ivars->lens_file);
+    DECREF(ivars->recs_file);
+    DECREF(ivars->ext_file);
+    ivars->lens_out  = NULL;
+    ivars->recs_out  = NULL;
+    ivars->ext_out   = NULL;
+    ivars->lens_file = NULL;
+    ivars->recs_file = NULL;
+    ivars->ext_file  = NULL;
+}
+
+static void
+S_end_record(DocWriter *self, int64_t start) {
+    DocWriterIVARS *const ivars = DocWriter_IVARS(self);
+    int64_t end = OutStream_Tell(ivars->recs_out);
+    OutStream_Write_C32(ivars->lens_out, (uint32_t)(end - start));
+    ivars->doc_max++;
+    if (end >= ivars->chunk_size) { S_flush_chunk(self); }
+}
+
+static void
+S_flush_chunk(DocWriter *self) {
+    DocWriterIVARS *const ivars = DocWriter_IVARS(self);
+    if (!ivars->recs_out) { return; }
+    if (ivars->doc_max < ivars->chunk_base) {
+        // Nothing pending.
+        S_close_chunk(self);
+        return;
+    }
+
+    // Assemble the raw payload: record lengths, then records.
+    OutStream_Close(ivars->lens_out);
+    OutStream_Close(ivars->recs_out);
+    OutStream_Close(ivars->ext_out);
+    ByteBuf *lens = RAMFile_Get_Contents(ivars->lens_file);
+    ByteBuf *recs = RAMFile_Get_Contents(ivars->recs_file);
+    ByteBuf *ext  = RAMFile_Get_Contents(ivars->ext_file);
+    BB_Cat(lens, recs);
+
+    OutStream_Write_I32(ivars->ix_out, ivars->chunk_base);
+    OutStream_Write_I64(ivars->ix_out, OutStream_Tell(ivars->dat_out));
+    S_write_block(self, ivars->dat_out, BB_Get_Buf(lens), BB_Get_Size(lens));
+    OutStream_Write_C32(ivars->dat_out, (uint32_t)BB_Get_Size(ext));
+    OutStream_Write_Bytes(ivars->dat_out, BB_Get_Buf(ext), BB_Get_Size(ext));
 
-        // Go past non-doc #0.
-        OutStream_Write_I64(ivars->ix_out, 0);
+    S_close_chunk(self);
+}
+
+static void
+S_write_block(DocWriter *self, OutStream *outstream, const char *raw,
+              size_t raw_len) {
+    DocWriterIVARS *const ivars = DocWriter_IVARS(self);
+
+    // Fall back to storing the block as-is if compression doesn't help.
+    const char *stored     = raw;
+    size_t      stored_len = raw_len;
+    int32_t     codec      = DocWriter_CODEC_NONE;
+    if (ivars->codec == DocWriter_CODEC_LZ4) {
+        char   *dest     = BB_Grow(ivars->scratch,
+                                   LZBlock_compress_bound(raw_len));
+        size_t  comp_len = LZBlock_compress(raw, raw_len, dest);
+        if (comp_len < raw_len) {
+            stored     = dest;
+            stored_len = comp_len;
+            codec      = DocWriter_CODEC_LZ4;
+        }
     }
 
-    return ivars->dat_out;
+    OutStream_Write_U8(outstream, (uint8_t)codec);
+    OutStream_Write_C32(outstream, (uint32_t)raw_len);
+    OutStream_Write_C32(outstream, (uint32_t)stored_len);
+    OutStream_Write_Bytes(outstream, stored, stored_len);
+}
+
+static void
+S_write_field(DocWriter *self, const char *name, size_t name_len,
+              const char *prefix, size_t prefix_len, const char *body,
+              size_t body_len) {
+    DocWriterIVARS *const ivars = DocWriter_IVARS(self);
+    OutStream *recs_out  = ivars->recs_out;
+    size_t     value_len = prefix_len + body_len;
+
+    OutStream_Write_C32(recs_out, (uint32_t)name_len);
+    OutStream_Write_Bytes(recs_out, name, name_len);
+    if (value_len >= (size_t)ivars->large_size) {
+        ByteBuf *value_buf = ivars->value_buf;
+        BB_Set_Size(value_buf, 0);
+        BB_Cat_Bytes(value_buf, prefix, prefix_len);
+        if (body_len) { BB_Cat_Bytes(value_buf, body, body_len); }
+        int64_t offset = OutStream_Tell(ivars->ext_out);
+        OutStream_Write_C32(recs_out, (uint32_t)((value_len << 1) | 1));
+        OutStream_Write_C32(recs_out, (uint32_t)offset);
+        S_write_block(self, ivars->ext_out, BB_Get_Buf(value_buf),
+                      value_len);
+    }
+    else {
+        OutStream_Write_C32(recs_out, (uint32_t)(value_len << 1));
+        OutStream_Write_Bytes(recs_out, prefix, prefix_len);
+        if (body_len) { OutStream_Write_Bytes(recs_out, body, body_len); }
+    }
 }
 
 void
@@ -87,14 +260,13 @@ DocWriter_Add_Inverted_Doc_IMP(DocWriter *self, Inverter *inverter,
                                int32_t doc_id) {
     DocWriterIVARS *const ivars = DocWriter_IVARS(self);
     OutStream *dat_out    = S_lazy_init(self);
-    OutStream *ix_out     = ivars->ix_out;
     uint32_t   num_stored = 0;
     int64_t    start      = OutStream_Tell(dat_out);
-    int64_t    expected   = OutStream_Tell(ix_out) / 8;
+    int32_t    expected   = ivars->doc_max + 1;
 
     // Verify doc id.
     if (doc_id != expected) {
-        THROW(ERR, "Expected doc id %i64 but got %i32", expected, doc_id);
+        THROW(ERR, "Expected doc id %i32 but got %i32", expected, doc_id);
     }
 
     // Write the number of stored fields.
@@ -110,52 +282,96 @@ DocWriter_Add_Inverted_Doc_IMP(DocWriter *self, Inverter *inverter,
         // Only store fields marked as "stored".
         FieldType *type = Inverter_Get_Type(inverter);
         if (FType_Stored(type)) {
-            String *field = Inverter_Get_Field_Name(inverter);
-            Obj *value = Inverter_Get_Value(inverter);
-            Freezer_serialize_string(field, dat_out);
+            String *field  = Inverter_Get_Field_Name(inverter);
+            Obj    *value  = Inverter_Get_Value(inverter);
+            char    prefix[10];
+            char   *end    = prefix;
+            char   *body   = NULL;
+            size_t  size   = 0;
             switch (FType_Primitive_ID(type) & FType_PRIMITIVE_ID_MASK) {
                 case FType_TEXT: {
-                    const char *buf  = Str_Get_Ptr8((String*)value);
-                    size_t      size = Str_Get_Size((String*)value);
-                    OutStream_Write_C32(dat_out, size);
-                    OutStream_Write_Bytes(dat_out, buf, size);
+                    body = (char*)Str_Get_Ptr8((String*)value);
+                    size = Str_Get_Size((String*)value);
+                    NumUtil_encode_c32((uint32_t)size, &end);
                     break;
                 }
                 case FType_BLOB: {
-                    char   *buf  = BB_Get_Buf((ByteBuf*)value);
-                    size_t  size = BB_Get_Size((ByteBuf*)value);
-                    OutStream_Write_C32(dat_out, size);
-                    OutStream_Write_Bytes(dat_out, buf, size);
+                    body = BB_Get_Buf((ByteBuf*)value);
+                    size = BB_Get_Size((ByteBuf*)value);
+                    NumUtil_encode_c32((uint32_t)size, &end);
                     break;
                 }
                 case FType_INT32: {
                     int32_t val = Int32_Get_Value((Integer32*)value);
-                    OutStream_Write_C32(dat_out, val);
+                    NumUtil_encode_c32((uint32_t)val, &end);
                     break;
                 }
                 case FType_INT64: {
                     int64_t val = Int64_Get_Value((Integer64*)value);
-                    OutStream_Write_C64(dat_out, val);
+                    NumUtil_encode_c64((uint64_t)val, &end);
                     break;
                 }
                 case FType_FLOAT32: {
                     float val = Float32_Get_Value((Float32*)value);
-                    OutStream_Write_F32(dat_out, val);
+                    NumUtil_encode_bigend_f32(val, &end);
+                    end += sizeof(float);
                     break;
                 }
                 case FType_FLOAT64: {
                     double val = Float64_Get_Value((Float64*)value);
-                    OutStream_Write_F64(dat_out, val);
+                    NumUtil_encode_bigend_f64(val, &end);
+                    end += sizeof(double);
                     break;
                 }
                 default:
                     THROW(ERR, "Unrecognized type: %o", type);
             }
+            S_write_field(self, Str_Get_Ptr8(field), Str_Get_Size(field),
+                          prefix, (size_t)(end - prefix), body, size);
         }
     }
 
-    // Write file pointer.
-    OutStream_Write_I64(ix_out, start);
+    S_end_record(self, start);
+}
+
+// Return true if every doc in the source range [first, last] survives
+// the merge and lands directly after the docs written so far.
+static bool
+S_range_is_live(DocWriter *self, I32Array *doc_map, int32_t first,
+                int32_t last) {
+    DocWriterIVARS *const ivars = DocWriter_IVARS(self);
+    int32_t offset = ivars->doc_max + 1 - first;
+    for (int32_t i = first; i <= last; i++) {
+        int32_t new_doc_id = doc_map ? I32Arr_Get(doc_map, i) : i;
+        if (new_doc_id != i + offset) { return false; }
+    }
+    return true;
+}
+
+static void
+S_add_record(DocWriter *self, ByteBuf *record) {
+    OutStream *recs_out = S_lazy_init(self);
+    int64_t    start    = OutStream_Tell(recs_out);
+    char      *buf      = BB_Get_Buf(record);
+    char      *limit    = buf + BB_Get_Size(record);
+
+    // Values arrive inline, but may need to be split out again.
+    uint32_t num_fields = NumUtil_decode_c32(&buf);
+    OutStream_Write_C32(recs_out, num_fields);
+    while (num_fields--) {
+        uint32_t name_len = NumUtil_decode_c32(&buf);
+        char    *name     = buf;
+        buf += name_len;
+        uint32_t tag = buf < limit ? NumUtil_decode_c32(&buf) : 1;
+        size_t   len = tag >> 1;
+        if ((tag & 1) || buf > limit || len > (size_t)(limit - buf)) {
+            THROW(ERR, "Malformed doc record");
+        }
+        S_write_field(self, name, name_len, buf, len, NULL, 0);
+        buf += len;
+    }
+
+    S_end_record(self, start);
 }
 
 void
@@ -169,27 +385,53 @@ DocWriter_Add_Segment_IMP(DocWriter *self, SegReader *reader,
         return;
     }
     else {
-        OutStream *const dat_out = S_lazy_init(self);
-        OutStream *const ix_out  = ivars->ix_out;
-        ByteBuf   *const buffer  = BB_new(0);
+        ByteBuf *const buffer = BB_new(0);
         DefaultDocReader *const doc_reader
             = (DefaultDocReader*)CERTIFY(
                   SegReader_Obtain(reader, VTable_Get_Name(DOCREADER)),
                   DEFAULTDOCREADER);
+        // Raw chunks can only be reused if their layout is current.  Older
+        // segments are rebuilt record by record.
+        uint32_t num_chunks
+            = DefDocReader_Format(doc_reader) == DocWriter_current_file_format
+              ? DefDocReader_Chunk_Count(doc_reader)
+              : 0;
+        uint32_t tick       = 0;
 
-        for (int32_t i = 1, max = SegReader_Doc_Max(reader); i <= max; i++) {
-            if (I32Arr_Get(doc_map, i)) {
-                int64_t  start = OutStream_Tell(dat_out);
+        for (int32_t i = 1; i <= doc_max;) {
+            // Copy whole chunks verbatim when none of their docs have been
+            // deleted, saving the cost of decompressing and recompressing.
+            while (tick < num_chunks
+                   && DefDocReader_Chunk_Base(doc_reader, tick + 1) <= i
+                  ) {
+                tick++;
+            }
+            if (tick < num_chunks
+                && DefDocReader_Chunk_Base(doc_reader, tick) == i
+               ) {
+                int32_t last = DefDocReader_Chunk_Base(doc_reader, tick + 1)
+                               - 1;
+                S_lazy_init(self);
+                if (S_range_is_live(self, doc_map, i, last)) {
+                    S_flush_chunk(self);
+                    DefDocReader_Read_Raw_Chunk(doc_reader, buffer, tick);
+                    OutStream_Write_I32(ivars->ix_out, ivars->doc_max + 1);
+                    OutStream_Write_I64(ivars->ix_out,
+                                        OutStream_Tell(ivars->dat_out));
+                    OutStream_Write_Bytes(ivars->dat_out, BB_Get_Buf(buffer),
+                                          BB_Get_Size(buffer));
+                    ivars->doc_max += last - i + 1;
+                    i = last + 1;
+                    continue;
+                }
+            }
 
+            if (!doc_map || I32Arr_Get(doc_map, i)) {
                 // Copy record over.
                 DefDocReader_Read_Record(doc_reader, buffer, i);
-                char *buf   = BB_Get_Buf(buffer);
-                size_t size = BB_Get_Size(buffer);
-                OutStream_Write_Bytes(dat_out, buf, size);
-
-                // Write file pointer.
-                OutStream_Write_I64(ix_out, start);
+                S_add_record(self, buffer);
             }
+            i++;
         }
 
         DECREF(buffer);
@@ -200,10 +442,12 @@ void
 DocWriter_Finish_IMP(DocWriter *self) {
     DocWriterIVARS *const ivars = DocWriter_IVARS(self);
     if (ivars->dat_out) {
-        // Write one final file pointer, so that we can derive the length of
-        // the last record.
-        int64_t end = OutStream_Tell(ivars->dat_out);
-        OutStream_Write_I64(ivars->ix_out, end);
+        S_flush_chunk(self);
+
+        // Write one final chunk entry, so that we can derive the extent of
+        // the last chunk.
+        OutStream_Write_I32(ivars->ix_out, ivars->doc_max + 1);
+        OutStream_Write_I64(ivars->ix_out, OutStream_Tell(ivars->dat_out));
 
         // Close down output streams.
         OutStream_Close(ivars->dat_out);
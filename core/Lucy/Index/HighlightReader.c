@@ -26,6 +26,7 @@
 #include "Lucy/Index/Segment.h"
 #include "Lucy/Index/Snapshot.h"
 #include "Lucy/Plan/Schema.h"
+#include "Lucy/Store/FileHandle.h"
 #include "Lucy/Store/InStream.h"
 #include "Lucy/Store/OutStream.h"
 #include "Lucy/Store/Folder.h"
@@ -157,6 +158,11 @@ DefHLReader_init(DefaultHighlightReader *self, Schema *schema,
             DECREF(self);
             RETHROW(error);
         }
+
+        // Lookups are random and mostly cold, so don't read ahead.  Advising
+        // through the Folder lets a compound file keep the hint standing.
+        Folder_Advise(folder, ix_file, FH_ADVICE_RANDOM);
+        Folder_Advise(folder, dat_file, FH_ADVICE_RANDOM);
     }
     DECREF(ix_file);
     DECREF(dat_file);
@@ -19,11 +19,14 @@
 
 #include "Lucy/Index/IndexManager.h"
 #include "Lucy/Index/DeletionsWriter.h"
+#include "Lucy/Index/MergePolicy.h"
 #include "Lucy/Index/PolyReader.h"
 #include "Lucy/Index/SegReader.h"
 #include "Lucy/Index/Segment.h"
 #include "Lucy/Index/Snapshot.h"
+#include "Lucy/Store/CompoundFileReader.h"
 #include "Lucy/Store/DirHandle.h"
+#include "Lucy/Store/FileHandle.h"
 #include "Lucy/Store/Folder.h"
 #include "Lucy/Store/Lock.h"
 #include "Lucy/Store/LockFactory.h"
@@ -46,6 +49,7 @@ IxManager_init(IndexManager *self, String *host,
                                 : Str_new_from_trusted_utf8("", 0);
     ivars->lock_factory        = (LockFactory*)INCREF(lock_factory);
     ivars->folder              = NULL;
+    ivars->merge_policy        = NULL;
     ivars->write_lock_timeout  = 1000;
     ivars->write_lock_interval = 100;
     ivars->merge_lock_timeout  = 0;
@@ -62,6 +66,7 @@ IxManager_Destroy_IMP(IndexManager *self) {
     DECREF(ivars->host);
     DECREF(ivars->folder);
     DECREF(ivars->lock_factory);
+    DECREF(ivars->merge_policy);
     SUPER_DESTROY(self, INDEXMANAGER);
 }
 
@@ -137,6 +142,78 @@ S_fibonacci(uint32_t n) {
     return result;
 }
 
+int64_t
+IxManager_seg_size(Folder *folder, String *seg_name) {
+    Folder *seg_folder = Folder_Find_Folder(folder, seg_name);
+    int64_t size = 0;
+
+    if (!seg_folder) {
+        THROW(ERR, "Can't find segment directory '%o'", seg_name);
+    }
+
+    // Measure the compound file itself rather than its virtual files.
+    if (Folder_Is_A(seg_folder, COMPOUNDFILEREADER)) {
+        seg_folder = CFReader_Get_Real_Folder((CompoundFileReader*)seg_folder);
+    }
+
+    DirHandle *dh = Folder_Local_Open_Dir(seg_folder);
+    if (!dh) { RETHROW(INCREF(Err_get_error())); }
+    while (DH_Next(dh)) {
+        if (DH_Entry_Is_Dir(dh)) { continue; }
+        String *entry = DH_Get_Entry(dh);
+        FileHandle *fh
+            = Folder_Local_Open_FileHandle(seg_folder, entry, FH_READ_ONLY);
+        if (fh) {
+            size += FH_Length(fh);
+            DECREF(fh);
+        }
+        DECREF(entry);
+    }
+    DECREF(dh);
+
+    return size;
+}
+
+// Summarize candidate segments and let the MergePolicy choose among them.
+static VArray*
+S_recycle_by_policy(IndexManager *self, VArray *candidates,
+                    DeletionsWriter *del_writer) {
+    MergePolicy *policy = IxManager_IVARS(self)->merge_policy;
+    const uint32_t num_candidates = VA_Get_Size(candidates);
+    VArray *merge_cands = VA_new(num_candidates);
+
+    for (uint32_t i = 0; i < num_candidates; i++) {
+        SegReader *seg_reader
+            = (SegReader*)CERTIFY(VA_Fetch(candidates, i), SEGREADER);
+        String *seg_name  = SegReader_Get_Seg_Name(seg_reader);
+        Folder *folder    = SegReader_Get_Folder(seg_reader);
+        int32_t del_count = DelWriter_Seg_Del_Count(del_writer, seg_name);
+        MergeCandidate *cand
+            = MergeCand_new(SegReader_Get_Seg_Num(seg_reader),
+                            IxManager_seg_size(folder, seg_name),
+                            SegReader_Doc_Max(seg_reader), del_count);
+        VA_Push(merge_cands, (Obj*)cand);
+    }
+
+    I32Array *ticks = MergePolicy_Select(policy, merge_cands);
+    uint32_t num_ticks = I32Arr_Get_Size(ticks);
+    VArray *recyclables = VA_new(num_ticks);
+    for (uint32_t i = 0; i < num_ticks; i++) {
+        int32_t tick = I32Arr_Get(ticks, i);
+        if (tick < 0 || (uint32_t)tick >= num_candidates) {
+            DECREF(recyclables);
+            DECREF(ticks);
+            DECREF(merge_cands);
+            THROW(ERR, "MergePolicy returned invalid tick %i32", tick);
+        }
+        VA_Push(recyclables, INCREF(VA_Fetch(candidates, tick)));
+    }
+
+    DECREF(ticks);
+    DECREF(merge_cands);
+    return recyclables;
+}
+
 VArray*
 IxManager_Recycle_IMP(IndexManager *self, PolyReader *reader,
                       DeletionsWriter *del_writer, int64_t cutoff,
@@ -150,6 +227,12 @@ IxManager_Recycle_IMP(IndexManager *self, PolyReader *reader,
         DECREF(recyclables);
         return candidates;
     }
+    else if (IxManager_IVARS(self)->merge_policy) {
+        DECREF(recyclables);
+        recyclables = S_recycle_by_policy(self, candidates, del_writer);
+        DECREF(candidates);
+        return recyclables;
+    }
 
     // Sort by ascending size in docs, choose sparsely populated segments.
     VA_Sort(candidates, S_compare_doc_count, NULL);
@@ -329,6 +412,18 @@ IxManager_Set_Folder_IMP(IndexManager *self, Folder *folder) {
     ivars->folder = (Folder*)INCREF(folder);
 }
 
+void
+IxManager_Set_Merge_Policy_IMP(IndexManager *self, MergePolicy *policy) {
+    IndexManagerIVARS *const ivars = IxManager_IVARS(self);
+    DECREF(ivars->merge_policy);
+    ivars->merge_policy = (MergePolicy*)INCREF(policy);
+}
+
+MergePolicy*
+IxManager_Get_Merge_Policy_IMP(IndexManager *self) {
+    return IxManager_IVARS(self)->merge_policy;
+}
+
 Folder*
 IxManager_Get_Folder_IMP(IndexManager *self) {
     return IxManager_IVARS(self)->folder;
@@ -18,16 +18,28 @@
 #include "Lucy/Util/ToolSet.h"
 
 #include "Lucy/Index/IndexReader.h"
+#include "Lucy/Index/DeletionsReader.h"
 #include "Lucy/Index/DocVector.h"
 #include "Lucy/Index/IndexManager.h"
+#include "Lucy/Index/LexiconReader.h"
+#include "Lucy/Index/PostingList.h"
+#include "Lucy/Index/PostingListReader.h"
 #include "Lucy/Index/PolyReader.h"
+#include "Lucy/Index/SegReader.h"
 #include "Lucy/Index/Snapshot.h"
 #include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/Schema.h"
 #include "Lucy/Search/Matcher.h"
+#include "Lucy/Store/CompoundFileReader.h"
+#include "Lucy/Store/FileHandle.h"
 #include "Lucy/Store/Folder.h"
 #include "Lucy/Store/Lock.h"
 
+int32_t IxReader_WARM_LEXICON = 0x00000001;
+int32_t IxReader_WARM_SORT    = 0x00000002;
+int32_t IxReader_WARM_SKIP    = 0x00000004;
+int32_t IxReader_WARM_ALL     = 0x7FFFFFFF;
+
 IndexReader*
 IxReader_open(Obj *index, Snapshot *snapshot, IndexManager *manager) {
     return IxReader_do_open(NULL, index, snapshot, manager);
@@ -125,3 +137,185 @@ IxReader_Fetch_IMP(IndexReader *self, String *api) {
 }
 
 
+
+static bool
+S_warm_policy_selects(String *name, int32_t policy) {
+    if (policy == IxReader_WARM_ALL) {
+        return true;
+    }
+    if (policy & IxReader_WARM_LEXICON) {
+        if (Str_Starts_With_Utf8(name, "lexicon-", 8)
+            && (Str_Ends_With_Utf8(name, ".ix", 3)
+                || Str_Ends_With_Utf8(name, ".ixix", 5)
+                || Str_Ends_With_Utf8(name, ".fst", 4)
+                || Str_Ends_With_Utf8(name, ".bloom", 6)
+                || Str_Ends_With_Utf8(name, ".keys", 5)
+                || Str_Ends_With_Utf8(name, ".docs", 5))
+           ) {
+            return true;
+        }
+    }
+    if (policy & IxReader_WARM_SORT) {
+        if (Str_Starts_With_Utf8(name, "sort-", 5)) { return true; }
+    }
+    if (policy & IxReader_WARM_SKIP) {
+        if (Str_Equals_Utf8(name, "postings.skip", 13)) { return true; }
+    }
+    return false;
+}
+
+// Return the entries in each segment directory as a flat array of
+// triplets: the Folder to open the entry from, its path, and its bare name.
+static VArray*
+S_segment_files(IndexReader *self) {
+    VArray *seg_readers = IxReader_Seg_Readers(self);
+    VArray *files       = VA_new(0);
+    for (uint32_t i = 0, max = VA_Get_Size(seg_readers); i < max; i++) {
+        SegReader *seg_reader = (SegReader*)VA_Fetch(seg_readers, i);
+        Folder    *folder     = SegReader_Get_Folder(seg_reader);
+        String    *seg_name   = SegReader_Get_Seg_Name(seg_reader);
+        VArray    *entries    = Folder_List(folder, seg_name);
+        if (!entries) { continue; }
+        for (uint32_t j = 0, limit = VA_Get_Size(entries); j < limit; j++) {
+            String *entry = (String*)VA_Fetch(entries, j);
+            VA_Push(files, INCREF(folder));
+            VA_Push(files, (Obj*)Str_newf("%o/%o", seg_name, entry));
+            VA_Push(files, INCREF(entry));
+        }
+        DECREF(entries);
+    }
+    DECREF(seg_readers);
+    return files;
+}
+
+void
+IxReader_Warm_IMP(IndexReader *self, int32_t policy) {
+    VArray *files = S_segment_files(self);
+    for (uint32_t i = 0, max = VA_Get_Size(files); i < max; i += 3) {
+        Folder *folder = (Folder*)VA_Fetch(files, i);
+        String *path   = (String*)VA_Fetch(files, i + 1);
+        String *name   = (String*)VA_Fetch(files, i + 2);
+        if (S_warm_policy_selects(name, policy)
+            && !Folder_Is_Directory(folder, path)
+           ) {
+            // WILLNEED starts asynchronous readahead; failures are ignored
+            // since warming is only an optimization.
+            Folder_Advise(folder, path, FH_ADVICE_WILLNEED);
+        }
+    }
+    DECREF(files);
+}
+
+Hash*
+IxReader_Residency_IMP(IndexReader *self) {
+    VArray *files  = S_segment_files(self);
+    Hash   *report = Hash_new(0);
+    for (uint32_t i = 0, max = VA_Get_Size(files); i < max; i += 3) {
+        Folder *folder = (Folder*)VA_Fetch(files, i);
+        String *path   = (String*)VA_Fetch(files, i + 1);
+        if (Folder_Is_Directory(folder, path)) { continue; }
+        double fraction = Folder_Residency(folder, path);
+        if (fraction >= 0.0) {
+            Hash_Store(report, (Obj*)path, (Obj*)Float64_new(fraction));
+        }
+    }
+    DECREF(files);
+    return report;
+}
+
+VArray*
+IxReader_Verify_IMP(IndexReader *self) {
+    VArray *seg_readers = IxReader_Seg_Readers(self);
+    VArray *failed      = VA_new(0);
+    String *cf_file     = (String*)SSTR_WRAP_UTF8("cf.dat", 6);
+    for (uint32_t i = 0, max = VA_Get_Size(seg_readers); i < max; i++) {
+        SegReader *seg_reader = (SegReader*)VA_Fetch(seg_readers, i);
+        Folder    *folder     = SegReader_Get_Folder(seg_reader);
+        String    *seg_name   = SegReader_Get_Seg_Name(seg_reader);
+        Folder    *seg_folder = Folder_Find_Folder(folder, seg_name);
+        if (!seg_folder || !Folder_Is_A(seg_folder, COMPOUNDFILEREADER)) {
+            continue;
+        }
+
+        // Start reading the next segment in the background, so that disk
+        // and checksumming overlap.
+        if (i + 1 < max) {
+            SegReader *next = (SegReader*)VA_Fetch(seg_readers, i + 1);
+            String *path = Str_newf("%o/%o", SegReader_Get_Seg_Name(next),
+                                    cf_file);
+            if (Folder_Exists(SegReader_Get_Folder(next), path)) {
+                Folder_Advise(SegReader_Get_Folder(next), path,
+                              FH_ADVICE_WILLNEED);
+            }
+            DECREF(path);
+        }
+
+        VArray *bad = CFReader_Verify((CompoundFileReader*)seg_folder);
+        for (uint32_t j = 0, limit = VA_Get_Size(bad); j < limit; j++) {
+            String *name = (String*)VA_Fetch(bad, j);
+            VA_Push(failed, (Obj*)Str_newf("%o/%o", seg_name, name));
+        }
+        DECREF(bad);
+    }
+    DECREF(seg_readers);
+    return failed;
+}
+
+// Return the highest live doc id in the segment which contains the term, or
+// 0 if there is none.
+static int32_t
+S_lookup_in_segment(SegReader *seg_reader, String *field, Obj *value) {
+    LexiconReader *lex_reader = (LexiconReader*)SegReader_Fetch(
+                                    seg_reader, VTable_Get_Name(LEXICONREADER));
+    DeletionsReader *del_reader = (DeletionsReader*)SegReader_Fetch(
+                                      seg_reader,
+                                      VTable_Get_Name(DELETIONSREADER));
+    if (!lex_reader) { return 0; }
+
+    // Try the key map first; it knows the newest doc holding the key.
+    int32_t doc_id = LexReader_Lookup_Key(lex_reader, field, value);
+    if (doc_id == 0) { return 0; }
+    if (doc_id > 0
+        && !(del_reader && DelReader_Is_Deleted(del_reader, doc_id))
+       ) {
+        return doc_id;
+    }
+
+    // No key map, or the newest doc is deleted: walk the postings.
+    PostingListReader *plist_reader = (PostingListReader*)SegReader_Fetch(
+                                          seg_reader,
+                                          VTable_Get_Name(POSTINGLISTREADER));
+    PostingList *plist = plist_reader
+                         ? PListReader_Posting_List(plist_reader, field, value)
+                         : NULL;
+    int32_t live = 0;
+    if (plist) {
+        int32_t candidate;
+        while (0 != (candidate = PList_Next(plist))) {
+            if (!(del_reader && DelReader_Is_Deleted(del_reader, candidate))) {
+                live = candidate;
+            }
+        }
+        DECREF(plist);
+    }
+    return live;
+}
+
+int32_t
+IxReader_Lookup_IMP(IndexReader *self, String *field, Obj *value) {
+    VArray   *seg_readers = IxReader_Seg_Readers(self);
+    I32Array *offsets     = IxReader_Offsets(self);
+    int32_t   found       = 0;
+    for (uint32_t i = VA_Get_Size(seg_readers); i-- > 0;) {
+        SegReader *seg_reader = (SegReader*)VA_Fetch(seg_readers, i);
+        int32_t doc_id = S_lookup_in_segment(seg_reader, field, value);
+        if (doc_id) {
+            found = I32Arr_Get(offsets, i) + doc_id;
+            break;
+        }
+    }
+    DECREF(offsets);
+    DECREF(seg_readers);
+    return found;
+}
+
@@ -62,6 +62,10 @@ S_init_folder(Obj *index, bool create);
 static String*
 S_find_schema_file(Snapshot *snapshot);
 
+// Create the Segment and SegWriter which will receive new content.
+static void
+S_start_segment(Indexer *self, int64_t seg_num);
+
 Indexer*
 Indexer_new(Schema *schema, Obj *index, IndexManager *manager, int32_t flags) {
     Indexer *self = (Indexer*)VTable_Make_Obj(INDEXER);
@@ -85,6 +89,8 @@ Indexer_init(Indexer *self, Schema *schema, Obj *index,
     ivars->needs_commit  = false;
     ivars->snapfile      = NULL;
     ivars->merge_lock    = NULL;
+    ivars->flushed       = false;
+    ivars->nrt_reader    = NULL;
 
     // Assign.
     ivars->folder       = folder;
@@ -191,32 +197,38 @@ Indexer_init(Indexer *self, Schema *schema, Obj *index,
         }
         DECREF(merge_data);
     }
-    ivars->segment = Seg_new(new_seg_num);
+    DECREF(merge_lock);
+
+    // Create new SegWriter and FilePurger.
+    ivars->file_purger
+        = FilePurger_new(folder, ivars->snapshot, ivars->manager);
+    S_start_segment(self, new_seg_num);
+
+    DECREF(latest_snapfile);
+    DECREF(latest_snapshot);
+
+    return self;
+}
+
+static void
+S_start_segment(Indexer *self, int64_t seg_num) {
+    IndexerIVARS *const ivars = Indexer_IVARS(self);
+    ivars->segment = Seg_new(seg_num);
 
     // Add all known fields to Segment.
-    VArray *fields = Schema_All_Fields(schema);
+    VArray *fields = Schema_All_Fields(ivars->schema);
     for (uint32_t i = 0, max = VA_Get_Size(fields); i < max; i++) {
         Seg_Add_Field(ivars->segment, (String*)VA_Fetch(fields, i));
     }
     DECREF(fields);
 
-    DECREF(merge_lock);
-
-    // Create new SegWriter and FilePurger.
-    ivars->file_purger
-        = FilePurger_new(folder, ivars->snapshot, ivars->manager);
     ivars->seg_writer = SegWriter_new(ivars->schema, ivars->snapshot,
-                                     ivars->segment, ivars->polyreader);
+                                      ivars->segment, ivars->polyreader);
     SegWriter_Prep_Seg_Dir(ivars->seg_writer);
 
     // Grab a local ref to the DeletionsWriter.
     ivars->del_writer = (DeletionsWriter*)INCREF(
-                           SegWriter_Get_Del_Writer(ivars->seg_writer));
-
-    DECREF(latest_snapfile);
-    DECREF(latest_snapshot);
-
-    return self;
+                            SegWriter_Get_Del_Writer(ivars->seg_writer));
 }
 
 void
@@ -230,6 +242,7 @@ Indexer_Destroy_IMP(Indexer *self) {
     DECREF(ivars->manager);
     DECREF(ivars->stock_doc);
     DECREF(ivars->polyreader);
+    DECREF(ivars->nrt_reader);
     DECREF(ivars->del_writer);
     DECREF(ivars->snapshot);
     DECREF(ivars->seg_writer);
@@ -273,6 +286,14 @@ Indexer_Add_Doc_IMP(Indexer *self, Doc *doc, float boost) {
     SegWriter_Add_Doc(ivars->seg_writer, doc, boost);
 }
 
+void
+Indexer_Add_Batch_IMP(Indexer *self, VArray *fields, uint32_t num_docs,
+                      const char **values, size_t *sizes, float boost) {
+    IndexerIVARS *const ivars = Indexer_IVARS(self);
+    SegWriter_Add_Batch(ivars->seg_writer, fields, num_docs, values, sizes,
+                        boost);
+}
+
 void
 Indexer_Delete_By_Term_IMP(Indexer *self, String *field, Obj *term) {
     IndexerIVARS *const ivars = Indexer_IVARS(self);
@@ -496,11 +517,12 @@ Indexer_Prepare_Commit_IMP(Indexer *self) {
     }
 
     // Add a new segment and write a new snapshot file if...
-    if (Seg_Get_Count(ivars->segment)             // Docs/segs added.
-        || merge_happened                        // Some segs merged.
-        || !Snapshot_Num_Entries(ivars->snapshot) // Initializing index.
-        || DelWriter_Updated(ivars->del_writer)
-       ) {
+    bool finish_segment
+        = Seg_Get_Count(ivars->segment)             // Docs/segs added.
+          || merge_happened                        // Some segs merged.
+          || !Snapshot_Num_Entries(ivars->snapshot) // Initializing index.
+          || DelWriter_Updated(ivars->del_writer);
+    if (finish_segment || ivars->flushed) {
         Folder   *folder   = ivars->folder;
         Schema   *schema   = ivars->schema;
         Snapshot *snapshot = ivars->snapshot;
@@ -515,8 +537,14 @@ Indexer_Prepare_Commit_IMP(Indexer *self) {
         StrHelp_to_base36(schema_gen, &base36);
         String *new_schema_name = Str_newf("schema_%s.json", base36);
 
-        // Finish the segment, write schema file.
-        SegWriter_Finish(ivars->seg_writer);
+        // Finish the segment, write schema file.  If everything was
+        // flushed already, the segment is empty and can be discarded.
+        if (finish_segment) {
+            SegWriter_Finish(ivars->seg_writer);
+        }
+        else {
+            Folder_Delete_Tree(folder, Seg_Get_Name(ivars->segment));
+        }
         Schema_Write(schema, folder, new_schema_name);
         String *old_schema_name = S_find_schema_file(snapshot);
         if (old_schema_name) {
@@ -529,15 +557,84 @@ Indexer_Prepare_Commit_IMP(Indexer *self) {
         Folder_Delete(folder, ivars->snapfile);
         Snapshot_Write_File(snapshot, folder, ivars->snapfile);
 
+        // Make the new files durable -- in one batch -- before Commit()
+        // renames the snapshot into place.
+        if (!Folder_Sync(folder)) { RETHROW(INCREF(Err_get_error())); }
+
         ivars->needs_commit = true;
     }
 
-    // Close reader, so that we can delete its files if appropriate.
+    // Close reader, so that we can delete its files if appropriate.  Let
+    // go of the near-real-time reader too; whoever holds it keeps it alive.
     PolyReader_Close(ivars->polyreader);
+    DECREF(ivars->nrt_reader);
+    ivars->nrt_reader = NULL;
 
     ivars->prepared = true;
 }
 
+void
+Indexer_Flush_IMP(Indexer *self) {
+    IndexerIVARS *const ivars = Indexer_IVARS(self);
+
+    if (!ivars->write_lock || ivars->prepared) {
+        THROW(ERR, "Can't call Flush() after Prepare_Commit() or Commit()");
+    }
+    if (!Seg_Get_Count(ivars->segment)
+        && !DelWriter_Updated(ivars->del_writer)
+       ) {
+        return;
+    }
+
+    // Write out pending deletions, then finish the segment, which adds it
+    // to our Snapshot.
+    if (DelWriter_Updated(ivars->del_writer)) {
+        DelWriter_Finish(ivars->del_writer);
+    }
+    SegWriter_Finish(ivars->seg_writer);
+    ivars->flushed = true;
+
+    // The last near-real-time reader is now out of date.
+    DECREF(ivars->nrt_reader);
+    ivars->nrt_reader = NULL;
+
+    // Reopen our own reader so that subsequent deletions and merges see the
+    // flushed segment and deletions.
+    PolyReader_Close(ivars->polyreader);
+    DECREF(ivars->polyreader);
+    ivars->polyreader = PolyReader_open_uncommitted(ivars->schema,
+                                                    ivars->folder,
+                                                    ivars->snapshot);
+
+    // Carry on with a fresh segment.
+    int64_t new_seg_num = Seg_Get_Number(ivars->segment) + 1;
+    DECREF(ivars->segment);
+    DECREF(ivars->seg_writer);
+    DECREF(ivars->del_writer);
+    S_start_segment(self, new_seg_num);
+}
+
+PolyReader*
+Indexer_Open_Reader_IMP(Indexer *self) {
+    IndexerIVARS *const ivars = Indexer_IVARS(self);
+    Indexer_Flush(self);
+
+    // Reuse the previous reader unless someone has closed it, which empties
+    // its components.
+    if (ivars->nrt_reader
+        && !Hash_Get_Size(PolyReader_Get_Components(ivars->nrt_reader))
+       ) {
+        DECREF(ivars->nrt_reader);
+        ivars->nrt_reader = NULL;
+    }
+    if (!ivars->nrt_reader) {
+        ivars->nrt_reader = PolyReader_open_uncommitted(ivars->schema,
+                                                        ivars->folder,
+                                                        ivars->snapshot);
+    }
+    return (PolyReader*)INCREF(ivars->nrt_reader);
+}
+
 void
 Indexer_Commit_IMP(Indexer *self) {
     IndexerIVARS *const ivars = Indexer_IVARS(self);
@@ -567,6 +664,7 @@ Indexer_Commit_IMP(Indexer *self) {
         success = Folder_Rename(ivars->folder, temp_snapfile, ivars->snapfile);
         DECREF(temp_snapfile);
         if (!success) { RETHROW(INCREF(Err_get_error())); }
+        if (!Folder_Sync(ivars->folder)) { RETHROW(INCREF(Err_get_error())); }
 
         // Purge obsolete files.
         FilePurger_Purge(ivars->file_purger);
@@ -587,6 +685,16 @@ Indexer_Get_Seg_Writer_IMP(Indexer *self) {
     return Indexer_IVARS(self)->seg_writer;
 }
 
+Folder*
+Indexer_Get_Folder_IMP(Indexer *self) {
+    return Indexer_IVARS(self)->folder;
+}
+
+Snapshot*
+Indexer_Get_Snapshot_IMP(Indexer *self) {
+    return Indexer_IVARS(self)->snapshot;
+}
+
 Doc*
 Indexer_Get_Stock_Doc_IMP(Indexer *self) {
     return Indexer_IVARS(self)->stock_doc;
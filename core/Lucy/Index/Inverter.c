@@ -16,9 +16,12 @@
 
 #define C_LUCY_INVERTER
 #define C_LUCY_INVERTERENTRY
+#define C_LUCY_TOKEN
 #include "Lucy/Util/ToolSet.h"
 
 #include "Lucy/Index/Inverter.h"
+#include "Clownfish/Util/SortUtils.h"
+#include "Clownfish/Util/StringHelper.h"
 #include "Lucy/Analysis/Analyzer.h"
 #include "Lucy/Analysis/Token.h"
 #include "Lucy/Analysis/Inversion.h"
@@ -149,12 +152,93 @@ Inverter_Get_Inversion_IMP(Inverter *self) {
     return InvEntry_IVARS(current)->inversion;
 }
 
+uint32_t
+Inverter_Get_Length_IMP(Inverter *self) {
+    InverterEntry *current = Inverter_IVARS(self)->current;
+    return InvEntry_IVARS(current)->length;
+}
+
+static int
+S_compare_token_pos(void *context, const void *va, const void *vb) {
+    UNUSED_VAR(context);
+    TokenIVARS *const a = Token_IVARS(*(Token**)va);
+    TokenIVARS *const b = Token_IVARS(*(Token**)vb);
+    return a->pos < b->pos ? -1 : a->pos > b->pos ? 1 : 0;
+}
+
+// Build an Inversion for the shingle field out of the parent field's
+// Inversion, with one token for each pair of tokens at adjacent positions.
+// Each shingle takes the position of its first token, so a phrase of N
+// terms corresponds to N-1 shingles at consecutive positions.
+static void
+S_add_shingles(Inverter *self, InverterEntry *entry) {
+    InverterEntryIVARS *const entry_ivars = InvEntry_IVARS(entry);
+    InverterEntry *shingle_entry = entry_ivars->shingles;
+    InverterEntryIVARS *const shingle_ivars = InvEntry_IVARS(shingle_entry);
+    Inversion *source = entry_ivars->inversion;
+    uint32_t num_tokens = Inversion_Get_Size(source);
+
+    // Gather the tokens in position order.
+    Token **tokens = (Token**)MALLOCATE((num_tokens + 1) * sizeof(Token*));
+    Token *token;
+    uint32_t num_gathered = 0;
+    Inversion_Reset(source);
+    while (NULL != (token = Inversion_Next(source))) {
+        tokens[num_gathered++] = token;
+    }
+    Inversion_Reset(source);
+    Sort_quicksort(tokens, num_gathered, sizeof(Token*),
+                   S_compare_token_pos, NULL);
+
+    Inversion *inversion = Inversion_new(NULL);
+    TokenIVARS *prev_shingle = NULL;
+    for (uint32_t i = 0, next = 0; i < num_gathered; i++) {
+        TokenIVARS *const first = Token_IVARS(tokens[i]);
+        while (next < num_gathered
+               && Token_IVARS(tokens[next])->pos <= first->pos
+              ) {
+            next++;
+        }
+        for (uint32_t j = next; j < num_gathered; j++) {
+            TokenIVARS *const second = Token_IVARS(tokens[j]);
+            if (second->pos != first->pos + 1) { break; }
+            String *text
+                = FullTextType_shingle_text(first->text, first->len,
+                                            second->text, second->len);
+            Token *shingle
+                = Token_new(Str_Get_Ptr8(text), Str_Get_Size(text),
+                            first->start_offset, second->end_offset,
+                            first->boost, 0);
+            TokenIVARS *const current = Token_IVARS(shingle);
+            current->pos = first->pos;
+            if (prev_shingle) {
+                prev_shingle->pos_inc = first->pos - prev_shingle->pos;
+            }
+            prev_shingle = current;
+            Inversion_Append(inversion, shingle);
+            DECREF(text);
+        }
+    }
+    FREEMEM(tokens);
+    Inversion_Invert(inversion);
+
+    DECREF(shingle_ivars->inversion);
+    shingle_ivars->inversion = inversion;
+    shingle_ivars->length    = entry_ivars->length;
+    VA_Push(Inverter_IVARS(self)->entries, INCREF(shingle_entry));
+}
+
 
 void
 Inverter_Add_Field_IMP(Inverter *self, InverterEntry *entry) {
     InverterIVARS *const ivars = Inverter_IVARS(self);
     InverterEntryIVARS *const entry_ivars = InvEntry_IVARS(entry);
 
+    // Prime the iterator.  Do this first so that Clear() reaches the entry
+    // even if inversion fails.
+    VA_Push(ivars->entries, INCREF(entry));
+    ivars->sorted = false;
+
     // Get an Inversion, going through analyzer if appropriate.
     if (entry_ivars->analyzer) {
         DECREF(entry_ivars->inversion);
@@ -162,21 +246,84 @@ Inverter_Add_Field_IMP(Inverter *self, InverterEntry *entry) {
             = Analyzer_Transform_Text(entry_ivars->analyzer,
                                       (String*)entry_ivars->value);
         Inversion_Invert(entry_ivars->inversion);
+        entry_ivars->length = Inversion_Get_Size(entry_ivars->inversion);
+        if (entry_ivars->shingles) {
+            S_add_shingles(self, entry);
+        }
     }
     else if (entry_ivars->indexed || entry_ivars->highlightable) {
         String *value = (String*)entry_ivars->value;
         size_t token_len = Str_Get_Size(value);
-        Token *seed = Token_new(Str_Get_Ptr8(value),
-                                token_len, 0, token_len, 1.0f, 1);
-        DECREF(entry_ivars->inversion);
-        entry_ivars->inversion = Inversion_new(seed);
-        DECREF(seed);
-        Inversion_Invert(entry_ivars->inversion); // Nearly a no-op.
+        if (entry_ivars->inversion) {
+            // Recycle the single-token Inversion left over from the last
+            // doc rather than allocating a new one.
+            Inversion *inversion = entry_ivars->inversion;
+            Inversion_Reset(inversion);
+            Token *token = Inversion_Next(inversion);
+            Token_Set_Text(token, (char*)Str_Get_Ptr8(value), token_len);
+            Token_IVARS(token)->end_offset = (uint32_t)token_len;
+            Inversion_Reset(inversion);
+        }
+        else {
+            Token *seed = Token_new(Str_Get_Ptr8(value),
+                                    token_len, 0, token_len, 1.0f, 1);
+            entry_ivars->inversion = Inversion_new(seed);
+            DECREF(seed);
+            Inversion_Invert(entry_ivars->inversion); // Nearly a no-op.
+        }
+        entry_ivars->length = 1;
     }
+}
 
-    // Prime the iterator.
-    VA_Push(ivars->entries, INCREF(entry));
-    ivars->sorted = false;
+InverterEntry*
+Inverter_Fetch_Entry_IMP(Inverter *self, String *field) {
+    InverterIVARS *const ivars = Inverter_IVARS(self);
+    Schema *const schema = ivars->schema;
+    int32_t field_num = Seg_Field_Num(ivars->segment, field);
+    if (!field_num) {
+        // This field seems not to be in the segment yet.  Try to find it in
+        // the Schema.
+        if (Schema_Fetch_Type(schema, field)) {
+            // The field is in the Schema.  Get a field num from the Segment.
+            field_num = Seg_Add_Field(ivars->segment, field);
+        }
+        else {
+            // We've truly failed to find the field.  The user must
+            // not have spec'd it.
+            THROW(ERR, "Unknown field name: '%o'", field);
+        }
+    }
+
+    InverterEntry *entry
+        = (InverterEntry*)VA_Fetch(ivars->entry_pool, field_num);
+    if (!entry) {
+        entry = InvEntry_new(schema, field, field_num);
+        VA_Store(ivars->entry_pool, field_num, (Obj*)entry);
+
+        InverterEntryIVARS *const entry_ivars = InvEntry_IVARS(entry);
+        if (entry_ivars->analyzer
+            && FType_Is_A(entry_ivars->type, FULLTEXTTYPE)
+            && FullTextType_Shingles((FullTextType*)entry_ivars->type)
+           ) {
+            String *shingle_field = FullTextType_shingle_field(field);
+            entry_ivars->shingles = (InverterEntry*)INCREF(
+                Inverter_Fetch_Entry(self, shingle_field));
+            DECREF(shingle_field);
+        }
+    }
+    return entry;
+}
+
+void
+Inverter_Invert_Raw_IMP(Inverter *self, InverterEntry **entries,
+                        uint32_t num_fields, const char **values,
+                        size_t *sizes) {
+    Inverter_Set_Doc(self, NULL);
+    for (uint32_t i = 0; i < num_fields; i++) {
+        if (!values[i]) { continue; }
+        InvEntry_Set_Raw_Value(entries[i], values[i], sizes[i]);
+        Inverter_Add_Field(self, entries[i]);
+    }
 }
 
 void
@@ -204,6 +351,9 @@ InvEntry_init(InverterEntry *self, Schema *schema, String *field,
     ivars->field_num  = field_num;
     ivars->field      = field ? Str_Clone(field) : NULL;
     ivars->inversion  = NULL;
+    ivars->view       = NULL;
+    ivars->length     = 0;
+    ivars->shingles   = NULL;
 
     if (schema) {
         ivars->analyzer
@@ -253,19 +403,147 @@ void
 InvEntry_Destroy_IMP(InverterEntry *self) {
     InverterEntryIVARS *const ivars = InvEntry_IVARS(self);
     DECREF(ivars->field);
-    DECREF(ivars->value);
+    if (ivars->value != (Obj*)ivars->view) { DECREF(ivars->value); }
+    FREEMEM(ivars->view);
     DECREF(ivars->analyzer);
     DECREF(ivars->type);
     DECREF(ivars->sim);
     DECREF(ivars->inversion);
+    DECREF(ivars->shingles);
     SUPER_DESTROY(self, INVERTERENTRY);
 }
 
 void
 InvEntry_Clear_IMP(InverterEntry *self) {
     InverterEntryIVARS *const ivars = InvEntry_IVARS(self);
-    DECREF(ivars->inversion);
-    ivars->inversion = NULL;
+    // Single-token Inversions for unanalyzed fields get recycled.
+    if (ivars->analyzer) {
+        DECREF(ivars->inversion);
+        ivars->inversion = NULL;
+    }
+    // The view wraps memory owned by the caller of Invert_Raw(), so it must
+    // not outlive the doc.
+    if (ivars->value && ivars->value == (Obj*)ivars->view) {
+        ivars->value = NULL;
+    }
+}
+
+// Parse a decimal integer which spans the whole slice.
+static bool
+S_parse_i64(const char *ptr, size_t size, int64_t *result) {
+    const char *const end = ptr + size;
+    bool is_negative = false;
+    if (ptr < end && (*ptr == '-' || *ptr == '+')) {
+        is_negative = *ptr == '-';
+        ptr++;
+    }
+    if (ptr == end) { return false; }
+
+    const uint64_t limit = is_negative
+                           ? (uint64_t)INT64_MAX + 1
+                           : (uint64_t)INT64_MAX;
+    uint64_t magnitude = 0;
+    for (; ptr < end; ptr++) {
+        if (*ptr < '0' || *ptr > '9') { return false; }
+        uint64_t digit = (uint64_t)(*ptr - '0');
+        if (magnitude > (limit - digit) / 10) { return false; }
+        magnitude = magnitude * 10 + digit;
+    }
+    *result = is_negative && magnitude
+              ? -(int64_t)(magnitude - 1) - 1
+              : (int64_t)magnitude;
+    return true;
+}
+
+// Parse a floating point number which spans the whole slice.
+static bool
+S_parse_f64(const char *ptr, size_t size, double *result) {
+    // strtod() needs a NUL-terminated string, and would skip leading
+    // whitespace.
+    if (!size || ptr[0] == ' ' || (ptr[0] >= '\t' && ptr[0] <= '\r')) {
+        return false;
+    }
+    char  stack_buf[64];
+    char *buf = size < sizeof(stack_buf)
+                ? stack_buf
+                : (char*)MALLOCATE(size + 1);
+    memcpy(buf, ptr, size);
+    buf[size] = '\0';
+    char *terminus;
+    *result = strtod(buf, &terminus);
+    bool valid = terminus == buf + size;
+    if (buf != stack_buf) { FREEMEM(buf); }
+    return valid;
+}
+
+static void
+S_throw_bad_number(InverterEntryIVARS *ivars, const char *ptr, size_t size) {
+    if (StrHelp_utf8_valid(ptr, size)) {
+        THROW(ERR, "Invalid numeric value in field '%o': '%o'", ivars->field,
+              (String*)SSTR_WRAP_UTF8(ptr, size));
+    }
+    THROW(ERR, "Invalid numeric value in field '%o'", ivars->field);
+}
+
+void
+InvEntry_Set_Raw_Value_IMP(InverterEntry *self, const char *ptr,
+                           size_t size) {
+    InverterEntryIVARS *const ivars = InvEntry_IVARS(self);
+    switch (FType_Primitive_ID(ivars->type) & FType_PRIMITIVE_ID_MASK) {
+        case FType_TEXT: {
+                if (!StrHelp_utf8_valid(ptr, size)) {
+                    THROW(ERR, "Invalid UTF-8 in field '%o'", ivars->field);
+                }
+                if (!ivars->view) {
+                    ivars->view = (StackString*)MALLOCATE(SStr_size());
+                }
+                if (ivars->value != (Obj*)ivars->view) {
+                    DECREF(ivars->value);
+                }
+                ivars->value = (Obj*)SStr_wrap_str(ivars->view, ptr, size);
+                break;
+            }
+        case FType_BLOB:
+            ViewBB_Assign_Bytes((ViewByteBuf*)ivars->value, (char*)ptr,
+                                size);
+            break;
+        case FType_INT32: {
+                int64_t value = 0;
+                if (!S_parse_i64(ptr, size, &value)
+                    || value < INT32_MIN || value > INT32_MAX
+                   ) {
+                    S_throw_bad_number(ivars, ptr, size);
+                }
+                Int32_Set_Value((Integer32*)ivars->value, (int32_t)value);
+                break;
+            }
+        case FType_INT64: {
+                int64_t value = 0;
+                if (!S_parse_i64(ptr, size, &value)) {
+                    S_throw_bad_number(ivars, ptr, size);
+                }
+                Int64_Set_Value((Integer64*)ivars->value, value);
+                break;
+            }
+        case FType_FLOAT32: {
+                double value = 0.0;
+                if (!S_parse_f64(ptr, size, &value)) {
+                    S_throw_bad_number(ivars, ptr, size);
+                }
+                Float32_Set_Value((Float32*)ivars->value, (float)value);
+                break;
+            }
+        case FType_FLOAT64: {
+                double value = 0.0;
+                if (!S_parse_f64(ptr, size, &value)) {
+                    S_throw_bad_number(ivars, ptr, size);
+                }
+                Float64_Set_Value((Float64*)ivars->value, value);
+                break;
+            }
+        default:
+            THROW(ERR, "Unrecognized type: %o", ivars->type);
+    }
 }
 
 int32_t
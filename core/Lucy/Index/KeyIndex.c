@@ -0,0 +1,85 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_KEYINDEX
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Index/KeyIndex.h"
+#include "Lucy/Index/Segment.h"
+#include "Lucy/Store/Folder.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Util/Transducer.h"
+
+KeyIndex*
+KeyIndex_open(Folder *folder, Segment *segment, int32_t field_num) {
+    KeyIndex *self = (KeyIndex*)VTable_Make_Obj(KEYINDEX);
+    return KeyIndex_do_open(self, folder, segment, field_num);
+}
+
+KeyIndex*
+KeyIndex_do_open(KeyIndex *self, Folder *folder, Segment *segment,
+                 int32_t field_num) {
+    KeyIndexIVARS *const ivars = KeyIndex_IVARS(self);
+    String *seg_name  = Seg_Get_Name(segment);
+    String *keys_file = Str_newf("%o/lexicon-%i32.keys", seg_name, field_num);
+    String *docs_file = Str_newf("%o/lexicon-%i32.docs", seg_name, field_num);
+
+    if (Folder_Exists(folder, keys_file) && Folder_Exists(folder, docs_file)) {
+        InStream *keys_in = Folder_Open_In(folder, keys_file);
+        if (keys_in) {
+            ivars->keys = FST_open(keys_in);
+            DECREF(keys_in);
+        }
+        ivars->docs_in = Folder_Open_In(folder, docs_file);
+    }
+    DECREF(docs_file);
+    DECREF(keys_file);
+
+    if (!ivars->keys || !ivars->docs_in) {
+        DECREF(self);
+        return NULL;
+    }
+
+    // The two files must agree on the number of keys.
+    const int64_t len = InStream_Length(ivars->docs_in);
+    if (len != (int64_t)FST_Get_Num_Keys(ivars->keys) * 4) {
+        DECREF(self);
+        return NULL;
+    }
+    ivars->doc_ids = InStream_Buf(ivars->docs_in, (size_t)len);
+
+    return self;
+}
+
+void
+KeyIndex_Destroy_IMP(KeyIndex *self) {
+    KeyIndexIVARS *const ivars = KeyIndex_IVARS(self);
+    DECREF(ivars->keys);
+    DECREF(ivars->docs_in);
+    SUPER_DESTROY(self, KEYINDEX);
+}
+
+int32_t
+KeyIndex_Lookup_IMP(KeyIndex *self, const char *key, size_t size) {
+    KeyIndexIVARS *const ivars = KeyIndex_IVARS(self);
+    bool exact;
+    int32_t ordinal = FST_Rank(ivars->keys, key, size, &exact);
+    if (!exact) { return 0; }
+    return (int32_t)NumUtil_decode_bigend_u32(
+               (void*)(ivars->doc_ids + (size_t)ordinal * 4));
+}
+
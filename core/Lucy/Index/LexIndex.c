@@ -26,6 +26,7 @@
 #include "Lucy/Plan/Schema.h"
 #include "Lucy/Store/Folder.h"
 #include "Lucy/Store/InStream.h"
+#include "Lucy/Util/Transducer.h"
 
 // Read the data we've arrived at after a seek operation.
 static void
@@ -45,6 +46,7 @@ LexIndex_init(LexIndex *self, Schema *schema, Folder *folder,
     String  *seg_name  = Seg_Get_Name(segment);
     String  *ixix_file = Str_newf("%o/lexicon-%i32.ixix", seg_name, field_num);
     String  *ix_file   = Str_newf("%o/lexicon-%i32.ix", seg_name, field_num);
+    String  *fst_file  = Str_newf("%o/lexicon-%i32.fst", seg_name, field_num);
     Architecture *arch = Schema_Get_Architecture(schema);
 
     // Init.
@@ -59,6 +61,7 @@ LexIndex_init(LexIndex *self, Schema *schema, Folder *folder,
         String *mess = MAKE_MESS("Unknown field: '%o'", field);
         DECREF(ix_file);
         DECREF(ixix_file);
+        DECREF(fst_file);
         DECREF(self);
         Err_throw_mess(ERR, mess);
     }
@@ -69,6 +72,7 @@ LexIndex_init(LexIndex *self, Schema *schema, Folder *folder,
         Err *error = (Err*)INCREF(Err_get_error());
         DECREF(ix_file);
         DECREF(ixix_file);
+        DECREF(fst_file);
         DECREF(self);
         RETHROW(error);
     }
@@ -77,6 +81,7 @@ LexIndex_init(LexIndex *self, Schema *schema, Folder *folder,
         Err *error = (Err*)INCREF(Err_get_error());
         DECREF(ix_file);
         DECREF(ixix_file);
+        DECREF(fst_file);
         DECREF(self);
         RETHROW(error);
     }
@@ -86,6 +91,22 @@ LexIndex_init(LexIndex *self, Schema *schema, Folder *folder,
     ivars->offsets = (int64_t*)InStream_Buf(ivars->ixix_in,
                                            (size_t)InStream_Length(ivars->ixix_in));
 
+    // Use the transducer, if the segment has one, to locate entries in
+    // lexicon.ix without decoding and comparing keys along the way.
+    ivars->fst = NULL;
+    if (Folder_Exists(folder, fst_file)) {
+        InStream *fst_in = Folder_Open_In(folder, fst_file);
+        if (fst_in) {
+            ivars->fst = FST_open(fst_in);
+            DECREF(fst_in);
+        }
+        if (ivars->fst && FST_Get_Num_Keys(ivars->fst) != ivars->size) {
+            DECREF(ivars->fst);
+            ivars->fst = NULL;
+        }
+    }
+
+    DECREF(fst_file);
     DECREF(ixix_file);
     DECREF(ix_file);
 
@@ -98,6 +119,7 @@ LexIndex_Destroy_IMP(LexIndex *self) {
     DECREF(ivars->field_type);
     DECREF(ivars->ixix_in);
     DECREF(ivars->ix_in);
+    DECREF(ivars->fst);
     DECREF(ivars->term_stepper);
     DECREF(ivars->tinfo);
     SUPER_DESTROY(self, LEXINDEX);
@@ -166,6 +188,15 @@ LexIndex_Seek_IMP(LexIndex *self, Obj *target) {
         */
     }
 
+    if (ivars->fst) {
+        String *text = (String*)target;
+        int32_t floor = FST_Floor(ivars->fst, Str_Get_Ptr8(text),
+                                  Str_Get_Size(text));
+        ivars->tick = floor < 0 ? 0 : floor;
+        S_read_entry(self);
+        return;
+    }
+
     // Divide and conquer.
     while (hi >= lo) {
         const int32_t mid = lo + ((hi - lo) / 2);
@@ -20,6 +20,7 @@
 #include "Lucy/Util/ToolSet.h"
 
 #include "Lucy/Index/LexiconReader.h"
+#include "Lucy/Index/KeyIndex.h"
 #include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/Schema.h"
 #include "Lucy/Index/PolyLexicon.h"
@@ -27,7 +28,11 @@
 #include "Lucy/Index/Segment.h"
 #include "Lucy/Index/Snapshot.h"
 #include "Lucy/Index/TermInfo.h"
+#include "Lucy/Store/FileHandle.h"
 #include "Lucy/Store/Folder.h"
+#include "Lucy/Store/FSFolder.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Util/BloomFilter.h"
 
 LexiconReader*
 LexReader_init(LexiconReader *self, Schema *schema, Folder *folder,
@@ -45,6 +50,14 @@ LexReader_Aggregator_IMP(LexiconReader *self, VArray *readers,
     return (LexiconReader*)PolyLexReader_new(readers, offsets);
 }
 
+int32_t
+LexReader_Lookup_Key_IMP(LexiconReader *self, String *field, Obj *term) {
+    UNUSED_VAR(self);
+    UNUSED_VAR(field);
+    UNUSED_VAR(term);
+    return -1;
+}
+
 PolyLexiconReader*
 PolyLexReader_new(VArray *readers, I32Array *offsets) {
     PolyLexiconReader *self
@@ -156,6 +169,62 @@ S_has_data(Schema *schema, Folder *folder, Segment *segment, String *field) {
     }
 }
 
+// Open the field's Bloom filter, if the segment has one.  A filter which
+// can't be read is ignored: it only ever saves work.
+static BloomFilter*
+S_open_bloom_filter(Folder *folder, Segment *segment, int32_t field_num) {
+    String *seg_name = Seg_Get_Name(segment);
+    String *file = Str_newf("%o/lexicon-%i32.bloom", seg_name, field_num);
+    BloomFilter *filter = NULL;
+    if (Folder_Exists(folder, file)) {
+        InStream *instream = Folder_Open_In(folder, file);
+        if (instream) {
+            filter = BloomFilter_open(instream);
+            DECREF(instream);
+        }
+    }
+    DECREF(file);
+    return filter;
+}
+
+// Lexicon index files are small, hot, and accessed randomly, so ask for them
+// to be read in up front.  Only discrete files on disk are advised: within a
+// compound file the hint would land on the cf.dat handle shared by every
+// sub-file, and RAM-backed files have no page cache to warm.  Access pattern
+// hints aren't given, since they wouldn't outlive Folder_Advise()'s handle.
+static void
+S_advise(Folder *folder, Segment *segment, int32_t field_num,
+         bool has_bloom_filter, bool has_key_index) {
+    String *seg_name = Seg_Get_Name(segment);
+    String *ix_file   = Str_newf("%o/lexicon-%i32.ix", seg_name, field_num);
+    String *ixix_file = Str_newf("%o/lexicon-%i32.ixix", seg_name, field_num);
+    String *fst_file  = Str_newf("%o/lexicon-%i32.fst", seg_name, field_num);
+    Folder_Advise(folder, ix_file, FH_ADVICE_WILLNEED);
+    Folder_Advise(folder, ixix_file, FH_ADVICE_WILLNEED);
+    if (Folder_Exists(folder, fst_file)) {
+        Folder_Advise(folder, fst_file, FH_ADVICE_WILLNEED);
+    }
+    if (has_bloom_filter) {
+        String *bloom_file
+            = Str_newf("%o/lexicon-%i32.bloom", seg_name, field_num);
+        Folder_Advise(folder, bloom_file, FH_ADVICE_WILLNEED);
+        DECREF(bloom_file);
+    }
+    if (has_key_index) {
+        String *keys_file
+            = Str_newf("%o/lexicon-%i32.keys", seg_name, field_num);
+        String *docs_file
+            = Str_newf("%o/lexicon-%i32.docs", seg_name, field_num);
+        Folder_Advise(folder, keys_file, FH_ADVICE_WILLNEED);
+        Folder_Advise(folder, docs_file, FH_ADVICE_WILLNEED);
+        DECREF(docs_file);
+        DECREF(keys_file);
+    }
+    DECREF(fst_file);
+    DECREF(ixix_file);
+    DECREF(ix_file);
+}
+
 DefaultLexiconReader*
 DefLexReader_init(DefaultLexiconReader *self, Schema *schema, Folder *folder,
                   Snapshot *snapshot, VArray *segments, int32_t seg_tick) {
@@ -165,14 +234,28 @@ DefLexReader_init(DefaultLexiconReader *self, Schema *schema, Folder *folder,
                    seg_tick);
     DefaultLexiconReaderIVARS *const ivars = DefLexReader_IVARS(self);
     Segment *segment = DefLexReader_Get_Segment(self);
+    Folder  *seg_folder
+        = Folder_Find_Folder(folder, Seg_Get_Name(segment));
+    bool     advise   = seg_folder && Folder_Is_A(seg_folder, FSFOLDER);
 
     // Build an array of SegLexicon objects.
-    ivars->lexicons = VA_new(Schema_Num_Fields(schema));
+    ivars->lexicons      = VA_new(Schema_Num_Fields(schema));
+    ivars->bloom_filters = VA_new(Schema_Num_Fields(schema));
+    ivars->key_indexes   = VA_new(Schema_Num_Fields(schema));
     for (uint32_t i = 1, max = Schema_Num_Fields(schema) + 1; i < max; i++) {
         String *field = Seg_Field_Name(segment, i);
         if (field && S_has_data(schema, folder, segment, field)) {
             SegLexicon *lexicon = SegLex_new(schema, folder, segment, field);
+            BloomFilter *filter
+                = S_open_bloom_filter(folder, segment, (int32_t)i);
+            KeyIndex *key_index = KeyIndex_open(folder, segment, (int32_t)i);
             VA_Store(ivars->lexicons, i, (Obj*)lexicon);
+            VA_Store(ivars->bloom_filters, i, (Obj*)filter);
+            VA_Store(ivars->key_indexes, i, (Obj*)key_index);
+            if (advise) {
+                S_advise(folder, segment, (int32_t)i, filter != NULL,
+                         key_index != NULL);
+            }
         }
     }
 
@@ -183,13 +266,19 @@ void
 DefLexReader_Close_IMP(DefaultLexiconReader *self) {
     DefaultLexiconReaderIVARS *const ivars = DefLexReader_IVARS(self);
     DECREF(ivars->lexicons);
-    ivars->lexicons = NULL;
+    DECREF(ivars->bloom_filters);
+    DECREF(ivars->key_indexes);
+    ivars->lexicons      = NULL;
+    ivars->bloom_filters = NULL;
+    ivars->key_indexes   = NULL;
 }
 
 void
 DefLexReader_Destroy_IMP(DefaultLexiconReader *self) {
     DefaultLexiconReaderIVARS *const ivars = DefLexReader_IVARS(self);
     DECREF(ivars->lexicons);
+    DECREF(ivars->bloom_filters);
+    DECREF(ivars->key_indexes);
     SUPER_DESTROY(self, DEFAULTLEXICONREADER);
 }
 
@@ -219,6 +308,17 @@ S_find_tinfo(DefaultLexiconReader *self, String *field, Obj *target) {
             = (SegLexicon*)VA_Fetch(ivars->lexicons, field_num);
 
         if (lexicon) {
+            // Skip the seek if the term definitely isn't present.
+            BloomFilter *filter
+                = (BloomFilter*)VA_Fetch(ivars->bloom_filters, field_num);
+            if (filter && Obj_Is_A(target, STRING)
+                && !BloomFilter_Might_Contain(filter,
+                                              Str_Get_Ptr8((String*)target),
+                                              Str_Get_Size((String*)target))
+               ) {
+                return NULL;
+            }
+
             // Iterate until the result is ge the term.
             SegLex_Seek(lexicon, target);
 
@@ -246,4 +346,16 @@ DefLexReader_Doc_Freq_IMP(DefaultLexiconReader *self, String *field,
     return tinfo ? TInfo_Get_Doc_Freq(tinfo) : 0;
 }
 
+int32_t
+DefLexReader_Lookup_Key_IMP(DefaultLexiconReader *self, String *field,
+                            Obj *term) {
+    DefaultLexiconReaderIVARS *const ivars = DefLexReader_IVARS(self);
+    int32_t field_num = Seg_Field_Num(ivars->segment, field);
+    if (!VA_Fetch(ivars->lexicons, field_num)) { return 0; }
+    KeyIndex *key_index = (KeyIndex*)VA_Fetch(ivars->key_indexes, field_num);
+    if (!key_index || !Obj_Is_A(term, STRING)) { return -1; }
+    return KeyIndex_Lookup(key_index, Str_Get_Ptr8((String*)term),
+                           Str_Get_Size((String*)term));
+}
+
 
@@ -21,6 +21,7 @@
 #include "Clownfish/CharBuf.h"
 #include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/Schema.h"
+#include "Lucy/Plan/TextType.h"
 #include "Lucy/Index/PolyReader.h"
 #include "Lucy/Index/Posting/MatchPosting.h"
 #include "Lucy/Index/Segment.h"
@@ -31,6 +32,8 @@
 #include "Lucy/Plan/Architecture.h"
 #include "Lucy/Store/Folder.h"
 #include "Lucy/Store/OutStream.h"
+#include "Lucy/Util/BloomFilter.h"
+#include "Lucy/Util/Transducer.h"
 
 int32_t LexWriter_current_file_format = 3;
 
@@ -62,6 +65,14 @@ LexWriter_init(LexiconWriter *self, Schema *schema, Snapshot *snapshot,
     ivars->dat_file           = NULL;
     ivars->ix_file            = NULL;
     ivars->ixix_file          = NULL;
+    ivars->fst_file           = NULL;
+    ivars->fst_builder        = NULL;
+    ivars->bloom_file         = NULL;
+    ivars->bloom_writer       = NULL;
+    ivars->keys_file          = NULL;
+    ivars->docs_file          = NULL;
+    ivars->key_builder        = NULL;
+    ivars->key_docs           = NULL;
     ivars->counts             = Hash_new(0);
     ivars->ix_counts          = Hash_new(0);
     ivars->temp_mode          = false;
@@ -79,6 +90,14 @@ LexWriter_Destroy_IMP(LexiconWriter *self) {
     DECREF(ivars->dat_file);
     DECREF(ivars->ix_file);
     DECREF(ivars->ixix_file);
+    DECREF(ivars->fst_file);
+    DECREF(ivars->fst_builder);
+    DECREF(ivars->bloom_file);
+    DECREF(ivars->bloom_writer);
+    DECREF(ivars->keys_file);
+    DECREF(ivars->docs_file);
+    DECREF(ivars->key_builder);
+    DECREF(ivars->key_docs);
     DECREF(ivars->dat_out);
     DECREF(ivars->ix_out);
     DECREF(ivars->ixix_out);
@@ -102,10 +121,62 @@ S_add_last_term_to_ix(LexiconWriter *self) {
                                 ivars->ix_out, TermStepper_Get_Value(ivars->tinfo_stepper));
     OutStream_Write_C64(ivars->ix_out, OutStream_Tell(ivars->dat_out));
     ivars->ix_count++;
+
+    // Mirror the key into the transducer.  Abandon it if the field type
+    // turns out not to sort terms in byte order.
+    if (ivars->fst_builder) {
+        String *term = (String*)TermStepper_Get_Value(ivars->term_stepper);
+        if (!FSTBuilder_Add(ivars->fst_builder, Str_Get_Ptr8(term),
+                            Str_Get_Size(term))
+           ) {
+            DECREF(ivars->fst_builder);
+            ivars->fst_builder = NULL;
+        }
+    }
+}
+
+// Lexicon index entries may be located via a Transducer when terms are text
+// which sorts in plain byte order.
+static bool
+S_wants_transducer(FieldType *type, TermStepper *term_stepper) {
+    return Obj_Is_A((Obj*)term_stepper, TEXTTERMSTEPPER)
+           && METHOD_PTR(FType_Get_VTable(type), LUCY_FType_Compare_Values)
+              == METHOD_PTR(FIELDTYPE, LUCY_FType_Compare_Values);
+}
+
+// Unique fields get a key map from term to newest doc id.
+static bool
+S_wants_key_map(FieldType *type, TermStepper *term_stepper) {
+    return FType_Unique(type)
+           && S_wants_transducer(type, term_stepper);
+}
+
+static void
+S_add_key(LexiconWriter *self, Obj *term_text, int32_t last_doc_id) {
+    LexiconWriterIVARS *const ivars = LexWriter_IVARS(self);
+    const char *key = Obj_Is_A(term_text, STRING)
+                      ? Str_Get_Ptr8((String*)term_text)
+                      : CB_Get_Ptr8((CharBuf*)term_text);
+    size_t size = Obj_Is_A(term_text, STRING)
+                  ? Str_Get_Size((String*)term_text)
+                  : CB_Get_Size((CharBuf*)term_text);
+    if (!FSTBuilder_Add(ivars->key_builder, key, size)) {
+        // Out of byte order -- abandon the key map.
+        DECREF(ivars->key_builder);
+        DECREF(ivars->key_docs);
+        ivars->key_builder = NULL;
+        ivars->key_docs    = NULL;
+        return;
+    }
+    char buf[4];
+    char *ptr = buf;
+    NumUtil_encode_bigend_u32((uint32_t)last_doc_id, &ptr);
+    BB_Cat_Bytes(ivars->key_docs, buf, 4);
 }
 
 void
-LexWriter_Add_Term_IMP(LexiconWriter* self, Obj* term_text, TermInfo* tinfo) {
+LexWriter_Add_Term_IMP(LexiconWriter* self, Obj* term_text, TermInfo* tinfo,
+                       int32_t last_doc_id) {
     LexiconWriterIVARS *const ivars = LexWriter_IVARS(self);
     OutStream *dat_out = ivars->dat_out;
 
@@ -116,6 +187,23 @@ LexWriter_Add_Term_IMP(LexiconWriter* self, Obj* term_text, TermInfo* tinfo) {
         S_add_last_term_to_ix(self);
     }
 
+    if (ivars->bloom_writer) {
+        if (Obj_Is_A(term_text, STRING)) {
+            BloomWriter_Add(ivars->bloom_writer,
+                            Str_Get_Ptr8((String*)term_text),
+                            Str_Get_Size((String*)term_text));
+        }
+        else {
+            BloomWriter_Add(ivars->bloom_writer,
+                            CB_Get_Ptr8((CharBuf*)term_text),
+                            CB_Get_Size((CharBuf*)term_text));
+        }
+    }
+
+    if (ivars->key_builder && !ivars->temp_mode) {
+        S_add_key(self, term_text, last_doc_id);
+    }
+
     TermStepper_Write_Delta(ivars->term_stepper, dat_out, term_text);
     TermStepper_Write_Delta(ivars->tinfo_stepper, dat_out, (Obj*)tinfo);
 
@@ -137,9 +225,18 @@ LexWriter_Start_Field_IMP(LexiconWriter *self, int32_t field_num) {
     DECREF(ivars->dat_file);
     DECREF(ivars->ix_file);
     DECREF(ivars->ixix_file);
+    DECREF(ivars->fst_file);
+    DECREF(ivars->bloom_file);
     ivars->dat_file  = Str_newf("%o/lexicon-%i32.dat",  seg_name, field_num);
     ivars->ix_file   = Str_newf("%o/lexicon-%i32.ix",   seg_name, field_num);
     ivars->ixix_file = Str_newf("%o/lexicon-%i32.ixix", seg_name, field_num);
+    ivars->fst_file  = Str_newf("%o/lexicon-%i32.fst",  seg_name, field_num);
+    ivars->bloom_file
+        = Str_newf("%o/lexicon-%i32.bloom", seg_name, field_num);
+    DECREF(ivars->keys_file);
+    DECREF(ivars->docs_file);
+    ivars->keys_file = Str_newf("%o/lexicon-%i32.keys", seg_name, field_num);
+    ivars->docs_file = Str_newf("%o/lexicon-%i32.docs", seg_name, field_num);
     ivars->dat_out = Folder_Open_Out(folder, ivars->dat_file);
     if (!ivars->dat_out) { RETHROW(INCREF(Err_get_error())); }
     ivars->ix_out = Folder_Open_Out(folder, ivars->ix_file);
@@ -152,6 +249,26 @@ LexWriter_Start_Field_IMP(LexiconWriter *self, int32_t field_num) {
     ivars->ix_count = 0;
     ivars->term_stepper = FType_Make_Term_Stepper(type);
     TermStepper_Reset(ivars->tinfo_stepper);
+    DECREF(ivars->fst_builder);
+    ivars->fst_builder = S_wants_transducer(type, ivars->term_stepper)
+                         ? FSTBuilder_new()
+                         : NULL;
+    DECREF(ivars->bloom_writer);
+    ivars->bloom_writer
+        = FType_Get_Bloom_Bits(type)
+          && Obj_Is_A((Obj*)ivars->term_stepper, TEXTTERMSTEPPER)
+          ? BloomWriter_new(FType_Get_Bloom_Bits(type))
+          : NULL;
+    DECREF(ivars->key_builder);
+    DECREF(ivars->key_docs);
+    if (S_wants_key_map(type, ivars->term_stepper)) {
+        ivars->key_builder = FSTBuilder_new();
+        ivars->key_docs    = BB_new(0);
+    }
+    else {
+        ivars->key_builder = NULL;
+        ivars->key_docs    = NULL;
+    }
 }
 
 void
@@ -176,6 +293,50 @@ LexWriter_Finish_Field_IMP(LexiconWriter *self, int32_t field_num) {
     ivars->ix_out   = NULL;
     ivars->ixix_out = NULL;
 
+    // Write the transducer.
+    if (ivars->fst_builder) {
+        Folder *folder = LexWriter_Get_Folder(self);
+        OutStream *fst_out = Folder_Open_Out(folder, ivars->fst_file);
+        if (!fst_out) { RETHROW(INCREF(Err_get_error())); }
+        FSTBuilder_Finish(ivars->fst_builder, fst_out);
+        OutStream_Close(fst_out);
+        DECREF(fst_out);
+        DECREF(ivars->fst_builder);
+        ivars->fst_builder = NULL;
+    }
+
+    // Write the Bloom filter.
+    if (ivars->bloom_writer) {
+        Folder *folder = LexWriter_Get_Folder(self);
+        OutStream *bloom_out = Folder_Open_Out(folder, ivars->bloom_file);
+        if (!bloom_out) { RETHROW(INCREF(Err_get_error())); }
+        BloomWriter_Finish(ivars->bloom_writer, bloom_out);
+        OutStream_Close(bloom_out);
+        DECREF(bloom_out);
+        DECREF(ivars->bloom_writer);
+        ivars->bloom_writer = NULL;
+    }
+
+    // Write the key map.
+    if (ivars->key_builder) {
+        Folder *folder = LexWriter_Get_Folder(self);
+        OutStream *keys_out = Folder_Open_Out(folder, ivars->keys_file);
+        if (!keys_out) { RETHROW(INCREF(Err_get_error())); }
+        FSTBuilder_Finish(ivars->key_builder, keys_out);
+        OutStream_Close(keys_out);
+        DECREF(keys_out);
+        OutStream *docs_out = Folder_Open_Out(folder, ivars->docs_file);
+        if (!docs_out) { RETHROW(INCREF(Err_get_error())); }
+        OutStream_Write_Bytes(docs_out, BB_Get_Buf(ivars->key_docs),
+                              BB_Get_Size(ivars->key_docs));
+        OutStream_Close(docs_out);
+        DECREF(docs_out);
+        DECREF(ivars->key_builder);
+        DECREF(ivars->key_docs);
+        ivars->key_builder = NULL;
+        ivars->key_docs    = NULL;
+    }
+
     // Close term stepper.
     DECREF(ivars->term_stepper);
     ivars->term_stepper = NULL;
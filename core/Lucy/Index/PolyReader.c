@@ -21,6 +21,7 @@
 #include "Lucy/Document/HitDoc.h"
 #include "Lucy/Index/DeletionsReader.h"
 #include "Lucy/Index/IndexManager.h"
+#include "Lucy/Index/Indexer.h"
 #include "Lucy/Index/Segment.h"
 #include "Lucy/Index/SegReader.h"
 #include "Lucy/Index/Snapshot.h"
@@ -76,6 +77,12 @@ S_try_open_segreader(void *context);
 static Folder*
 S_derive_folder(Obj *index);
 
+// Open SegReaders for the segments listed in a Snapshot which hasn't been
+// written to a file yet.
+static PolyReader*
+S_init_uncommitted(PolyReader *self, Schema *schema, Folder *folder,
+                   Snapshot *snapshot);
+
 PolyReader*
 PolyReader_new(Schema *schema, Folder *folder, Snapshot *snapshot,
                IndexManager *manager, VArray *sub_readers) {
@@ -86,10 +93,65 @@ PolyReader_new(Schema *schema, Folder *folder, Snapshot *snapshot,
 
 PolyReader*
 PolyReader_open(Obj *index, Snapshot *snapshot, IndexManager *manager) {
+    // Let an Indexer hand back its previous near-real-time reader if
+    // nothing has changed since.
+    if (!snapshot && Obj_Is_A(index, INDEXER)) {
+        return Indexer_Open_Reader((Indexer*)index);
+    }
     PolyReader *self = (PolyReader*)VTable_Make_Obj(POLYREADER);
     return PolyReader_do_open(self, index, snapshot, manager);
 }
 
+PolyReader*
+PolyReader_open_uncommitted(Schema *schema, Folder *folder,
+                            Snapshot *snapshot) {
+    PolyReader *self = (PolyReader*)VTable_Make_Obj(POLYREADER);
+    return S_init_uncommitted(self, schema, folder, snapshot);
+}
+
+static PolyReader*
+S_init_uncommitted(PolyReader *self, Schema *schema, Folder *folder,
+                   Snapshot *snapshot) {
+    // Work from a copy, since the original may keep changing.
+    Snapshot *copy     = Snapshot_new();
+    VArray   *files    = Snapshot_List(snapshot);
+    VArray   *segments = VA_new(VA_Get_Size(files));
+    for (uint32_t i = 0, max = VA_Get_Size(files); i < max; i++) {
+        String *entry = (String*)VA_Fetch(files, i);
+        Snapshot_Add_Entry(copy, entry);
+        if (Seg_valid_seg_name(entry)) {
+            Segment *segment = Seg_new(IxFileNames_extract_gen(entry));
+            if (!Seg_Read_File(segment, folder)) {
+                String *mess = MAKE_MESS("Failed to read %o", entry);
+                DECREF(segment);
+                DECREF(segments);
+                DECREF(files);
+                DECREF(copy);
+                DECREF(self);
+                Err_throw_mess(ERR, mess);
+            }
+            VA_Push(segments, (Obj*)segment);
+        }
+    }
+    DECREF(files);
+
+    // Sort the segments by age, then open a SegReader for each.
+    VA_Sort(segments, NULL, NULL);
+    uint32_t num_segs = VA_Get_Size(segments);
+    VArray *seg_readers = VA_new(num_segs);
+    for (uint32_t seg_tick = 0; seg_tick < num_segs; seg_tick++) {
+        SegReader *seg_reader
+            = SegReader_new(schema, folder, copy, segments, seg_tick);
+        VA_Push(seg_readers, (Obj*)seg_reader);
+    }
+
+    PolyReader_init(self, schema, folder, copy, NULL, seg_readers);
+    DECREF(seg_readers);
+    DECREF(segments);
+    DECREF(copy);
+    return self;
+}
+
 static Obj*
 S_first_non_null(VArray *array) {
     for (uint32_t i = 0, max = VA_Get_Size(array); i < max; i++) {
@@ -332,6 +394,21 @@ PolyReader*
 PolyReader_do_open(PolyReader *self, Obj *index, Snapshot *snapshot,
                    IndexManager *manager) {
     PolyReaderIVARS *const ivars = PolyReader_IVARS(self);
+
+    // Near-real-time: read what an Indexer has added so far.  The Indexer
+    // holds the write lock, so there's no need for read locks.
+    if (Obj_Is_A(index, INDEXER)) {
+        Indexer *indexer = (Indexer*)index;
+        if (snapshot) {
+            DECREF(self);
+            THROW(ERR, "Can't supply a Snapshot when opening an Indexer");
+        }
+        Indexer_Flush(indexer);
+        return S_init_uncommitted(self, Indexer_Get_Schema(indexer),
+                                  Indexer_Get_Folder(indexer),
+                                  Indexer_Get_Snapshot(indexer));
+    }
+
     Folder   *folder   = S_derive_folder(index);
     uint64_t  last_gen = 0;
 
@@ -581,4 +658,58 @@ PolyReader_sub_tick(I32Array *offsets, int32_t doc_id) {
     return hi;
 }
 
+VArray*
+PolyReader_fetch_docs(I32Array *offsets, VArray *subs, I32Array *doc_ids,
+                      VArray *fields, PolyReader_Fetch_Docs_t fetch) {
+    const uint32_t num_docs = I32Arr_Get_Size(doc_ids);
+    const uint32_t num_subs = VA_Get_Size(subs);
+    VArray   *hit_docs  = VA_new(num_docs);
+    size_t    alloc_len = num_docs + 1;
+    uint32_t *ticks     = (uint32_t*)MALLOCATE(alloc_len * sizeof(uint32_t));
+    uint32_t *positions = (uint32_t*)MALLOCATE(alloc_len * sizeof(uint32_t));
+    int32_t  *local_ids = (int32_t*)MALLOCATE(alloc_len * sizeof(int32_t));
+
+    for (uint32_t i = 0; i < num_docs; i++) {
+        ticks[i] = PolyReader_sub_tick(offsets, I32Arr_Get(doc_ids, i));
+    }
+
+    // Hand each sub-object all of its requests at once.
+    for (uint32_t tick = 0; tick < num_subs; tick++) {
+        int32_t  offset    = I32Arr_Get(offsets, tick);
+        uint32_t num_local = 0;
+        for (uint32_t i = 0; i < num_docs; i++) {
+            if (ticks[i] == tick) {
+                local_ids[num_local] = I32Arr_Get(doc_ids, i) - offset;
+                positions[num_local] = i;
+                num_local++;
+            }
+        }
+        if (!num_local) { continue; }
+
+        Obj *sub = VA_Fetch(subs, tick);
+        if (!sub) {
+            int32_t doc_id = local_ids[0] + offset;
+            FREEMEM(local_ids);
+            FREEMEM(positions);
+            FREEMEM(ticks);
+            DECREF(hit_docs);
+            THROW(ERR, "Invalid doc_id: %i32", doc_id);
+        }
+        I32Array *local    = I32Arr_new(local_ids, num_local);
+        VArray   *sub_docs = fetch(sub, local, fields);
+        for (uint32_t j = 0; j < num_local; j++) {
+            HitDoc *hit_doc = (HitDoc*)VA_Fetch(sub_docs, j);
+            HitDoc_Set_Doc_ID(hit_doc, local_ids[j] + offset);
+            VA_Store(hit_docs, positions[j], INCREF(hit_doc));
+        }
+        DECREF(sub_docs);
+        DECREF(local);
+    }
+
+    FREEMEM(local_ids);
+    FREEMEM(positions);
+    FREEMEM(ticks);
+    return hit_docs;
+}
+
 
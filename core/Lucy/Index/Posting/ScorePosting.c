@@ -58,6 +58,7 @@ ScorePost_init(ScorePosting *self, Similarity *sim) {
     ivars->weight       = 0.0;
     ivars->prox         = NULL;
     ivars->prox_cap     = 0;
+    ivars->pending_prox = NULL;
     return self;
 }
 
@@ -70,7 +71,26 @@ ScorePost_Destroy_IMP(ScorePosting *self) {
 
 uint32_t*
 ScorePost_Get_Prox_IMP(ScorePosting *self) {
-    return ScorePost_IVARS(self)->prox;
+    ScorePostingIVARS *const ivars = ScorePost_IVARS(self);
+    if (ivars->pending_prox) {
+        // Decode the positions skipped over by Read_Record().  The buffer
+        // stays valid until the InStream is read from again.
+        uint32_t num_prox = ivars->freq;
+        if (num_prox > ivars->prox_cap) {
+            ivars->prox = (uint32_t*)REALLOCATE(
+                             ivars->prox, num_prox * sizeof(uint32_t));
+            ivars->prox_cap = num_prox;
+        }
+        uint32_t *positions = ivars->prox;
+        uint32_t  position  = 0;
+        char     *buf       = ivars->pending_prox;
+        while (num_prox--) {
+            position += NumUtil_decode_c32(&buf);
+            *positions++ = position;
+        }
+        ivars->pending_prox = NULL;
+    }
+    return ivars->prox;
 }
 
 void
@@ -124,15 +144,15 @@ ScorePost_Add_Inversion_To_Pool_IMP(ScorePosting *self,
 void
 ScorePost_Reset_IMP(ScorePosting *self) {
     ScorePostingIVARS *const ivars = ScorePost_IVARS(self);
-    ivars->doc_id = 0;
-    ivars->freq   = 0;
-    ivars->weight = 0.0;
+    ivars->doc_id       = 0;
+    ivars->freq         = 0;
+    ivars->weight       = 0.0;
+    ivars->pending_prox = NULL;
 }
 
 void
 ScorePost_Read_Record_IMP(ScorePosting *self, InStream *instream) {
     ScorePostingIVARS *const ivars = ScorePost_IVARS(self);
-    uint32_t  position = 0;
     const size_t max_start_bytes = (C32_MAX_BYTES * 2) + 1;
     char *buf = InStream_Buf(instream, max_start_bytes);
     const uint32_t doc_code = NumUtil_decode_c32(&buf);
@@ -151,20 +171,15 @@ ScorePost_Read_Record_IMP(ScorePosting *self, InStream *instream) {
     ivars->weight = ivars->norm_decoder[*(uint8_t*)buf];
     buf++;
 
-    // Read positions.
+    // Skip over the positions, remembering where they start.  Most records
+    // are read while intersecting or skipping and never need their
+    // positions, so Get_Prox() decodes them on demand.
     uint32_t num_prox = ivars->freq;
-    if (num_prox > ivars->prox_cap) {
-        ivars->prox = (uint32_t*)REALLOCATE(
-                         ivars->prox, num_prox * sizeof(uint32_t));
-        ivars->prox_cap = num_prox;
-    }
-    uint32_t *positions = ivars->prox;
-
     InStream_Advance_Buf(instream, buf);
     buf = InStream_Buf(instream, num_prox * C32_MAX_BYTES);
+    ivars->pending_prox = buf;
     while (num_prox--) {
-        position += NumUtil_decode_c32(&buf);
-        *positions++ = position;
+        NumUtil_skip_cint(&buf);
     }
 
     InStream_Advance_Buf(instream, buf);
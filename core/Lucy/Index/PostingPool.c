@@ -16,7 +16,6 @@
 
 #define C_LUCY_POSTINGPOOL
 #define C_LUCY_RAWPOSTING
-#define C_LUCY_MEMORYPOOL
 #define C_LUCY_TERMINFO
 #define C_LUCY_SKIPSTEPPER
 #include "Lucy/Util/ToolSet.h"
@@ -214,6 +213,11 @@ PostPool_Flip_IMP(PostingPool *self) {
     for (uint32_t i = 0; i < num_runs; i++) {
         PostingPool *run = (PostingPool*)VA_Fetch(ivars->runs, i);
         if (run != NULL) {
+            // Give each run a private MemoryPool whose arenas it can recycle
+            // from one Refill() to the next.
+            PostingPoolIVARS *const run_ivars = PostPool_IVARS(run);
+            DECREF(run_ivars->mem_pool);
+            run_ivars->mem_pool = MemPool_new(0);
             PostPool_Set_Mem_Thresh(run, sub_thresh);
             if (!PostPool_IVARS(run)->lexicon) {
                 S_fresh_flip(run, ivars->lex_temp_in, ivars->post_temp_in);
@@ -370,6 +374,7 @@ S_write_terms_and_postings(PostingPool *self, PostingWriter *post_writer,
         = SkipStepper_IVARS(skip_stepper);
     int32_t        last_skip_doc          = 0;
     int64_t        last_skip_filepos      = 0;
+    int32_t        last_doc_id            = 0;
     const int32_t  skip_interval
         = Arch_Skip_Interval(Schema_Get_Architecture(ivars->schema));
 
@@ -414,7 +419,8 @@ S_write_terms_and_postings(PostingPool *self, PostingWriter *post_writer,
         // If the term text changes, process the last term.
         if (!same_text_as_last) {
             // Hand off to LexiconWriter.
-            LexWriter_Add_Term(lex_writer, (Obj*)last_term_text, tinfo);
+            LexWriter_Add_Term(lex_writer, (Obj*)last_term_text, tinfo,
+                               last_doc_id);
 
             // Start each term afresh.
             TInfo_Reset(tinfo);
@@ -438,6 +444,7 @@ S_write_terms_and_postings(PostingPool *self, PostingWriter *post_writer,
 
         // Write posting data.
         PostWriter_Write_Posting(post_writer, posting);
+        last_doc_id = post_ivars->doc_id;
 
         // Doc freq lags by one iter.
         tinfo_ivars->doc_freq++;
@@ -500,12 +507,9 @@ PostPool_Refill_IMP(PostingPool *self) {
     ivars->cache_max  = 0;
     ivars->cache_tick = 0;
 
-    // Ditch old MemoryPool and get another.
-    DECREF(ivars->mem_pool);
-    ivars->mem_pool = MemPool_new(0);
+    // Recycle the MemoryPool, since everything in it has been consumed.
     MemoryPool *const mem_pool = ivars->mem_pool;
-    MemoryPoolIVARS *const mem_pool_ivars = MemPool_IVARS(mem_pool);
-
+    MemPool_Release_All(mem_pool);
 
     while (1) {
         if (ivars->post_count == 0) {
@@ -527,7 +531,7 @@ PostPool_Refill_IMP(PostingPool *self) {
         }
 
         // Bail if we've hit the ceiling for this run's cache.
-        if (mem_pool_ivars->consumed >= mem_thresh && num_elems > 0) {
+        if (MemPool_Get_Consumed(mem_pool) >= mem_thresh && num_elems > 0) {
             break;
         }
 
@@ -274,6 +274,11 @@ SegPList_Seek_Lex_IMP(SegPostingList *self, Lexicon *lexicon) {
     }
 }
 
+void
+SegPList_Seek_Term_Info_IMP(SegPostingList *self, TermInfo *tinfo) {
+    S_seek_tinfo(self, tinfo);
+}
+
 static void
 S_seek_tinfo(SegPostingList *self, TermInfo *tinfo) {
     SegPostingListIVARS *const ivars = SegPList_IVARS(self);
@@ -27,6 +27,7 @@
 #include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/Schema.h"
 #include "Lucy/Search/Matcher.h"
+#include "Lucy/Store/CompoundFileReader.h"
 #include "Lucy/Store/Folder.h"
 
 // Try to initialize all sub-readers.
@@ -73,6 +74,15 @@ S_try_init_components(void *context) {
     SegReader *self = (SegReader*)context;
     Schema *schema = SegReader_Get_Schema(self);
     Architecture *arch = Schema_Get_Architecture(schema);
+    int64_t verify_size = Arch_Verify_On_Open_Size(arch);
+    if (verify_size > 0) {
+        Folder *seg_folder = Folder_Find_Folder(SegReader_Get_Folder(self),
+                                                SegReader_Get_Seg_Name(self));
+        if (seg_folder && Folder_Is_A(seg_folder, COMPOUNDFILEREADER)) {
+            CFReader_Set_Verify_Threshold((CompoundFileReader*)seg_folder,
+                                          verify_size);
+        }
+    }
     Arch_Init_Seg_Reader(arch, self);
 }
 
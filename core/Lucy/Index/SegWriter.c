@@ -20,8 +20,11 @@
 #include "Lucy/Index/SegWriter.h"
 #include "Lucy/Document/Doc.h"
 #include "Lucy/Plan/Schema.h"
+#include "Lucy/Store/CompoundFileReader.h"
 #include "Lucy/Store/DirHandle.h"
+#include "Lucy/Store/FileHandle.h"
 #include "Lucy/Store/Folder.h"
+#include "Lucy/Store/InStream.h"
 #include "Lucy/Index/DeletionsWriter.h"
 #include "Lucy/Index/Inverter.h"
 #include "Lucy/Index/PolyReader.h"
@@ -111,6 +114,34 @@ SegWriter_Add_Doc_IMP(SegWriter *self, Doc *doc, float boost) {
     SegWriter_Add_Inverted_Doc(self, ivars->inverter, doc_id);
 }
 
+void
+SegWriter_Add_Batch_IMP(SegWriter *self, VArray *fields, uint32_t num_docs,
+                        const char **values, size_t *sizes, float boost) {
+    SegWriterIVARS *const ivars = SegWriter_IVARS(self);
+    Inverter *const inverter = ivars->inverter;
+    uint32_t num_fields = VA_Get_Size(fields);
+    size_t   alloc_size = (num_fields + 1) * sizeof(InverterEntry*);
+    InverterEntry **entries = (InverterEntry**)MALLOCATE(alloc_size);
+
+    for (uint32_t i = 0; i < num_fields; i++) {
+        String *field = (String*)CERTIFY(VA_Fetch(fields, i), STRING);
+        entries[i] = Inverter_Fetch_Entry(inverter, field);
+    }
+
+    for (uint32_t i = 0; i < num_docs; i++) {
+        size_t offset = (size_t)i * num_fields;
+        int32_t doc_id = (int32_t)Seg_Increment_Count(ivars->segment, 1);
+        Inverter_Invert_Raw(inverter, entries, num_fields, values + offset,
+                            sizes + offset);
+        Inverter_Set_Boost(inverter, boost);
+        SegWriter_Add_Inverted_Doc(self, inverter, doc_id);
+    }
+
+    // Don't let the Inverter hang on to views of the caller's buffers.
+    Inverter_Clear(inverter);
+    FREEMEM(entries);
+}
+
 void
 SegWriter_Add_Inverted_Doc_IMP(SegWriter *self, Inverter *inverter,
                                int32_t doc_id) {
@@ -134,16 +165,59 @@ S_adjust_doc_id(SegWriter *self, SegReader *reader, I32Array *doc_map) {
     Seg_Increment_Count(ivars->segment, doc_count);
 }
 
+// Merging streams through a segment's bulk data exactly once.  Say so with
+// FH_ADVICE_SEQUENTIAL, so that pages can be dropped behind the read rather
+// than pushing hot pages out of the cache, then put back each file's
+// standing advice -- e.g. the FH_ADVICE_RANDOM which DocReader places on
+// documents.dat -- once the merge is done.  The hint only sticks within a
+// compound file, where it lands on the cf.dat handle that searchers using
+// the same Folder share; advising the InStream directly keeps it from
+// replacing the standing advice.  Discrete files get a fresh handle per
+// InStream, so there is nothing to advise.
+static void
+S_advise_merge(SegReader *reader, bool merging) {
+    Folder  *folder     = SegReader_Get_Folder(reader);
+    Segment *segment    = SegReader_Get_Segment(reader);
+    String  *seg_name   = Seg_Get_Name(segment);
+    Folder  *seg_folder = Folder_Find_Folder(folder, seg_name);
+    if (!seg_folder || !Folder_Is_A(seg_folder, COMPOUNDFILEREADER)) {
+        return;
+    }
+    CompoundFileReader *cf_reader = (CompoundFileReader*)seg_folder;
+
+    VArray *files = VA_new(8);
+    VA_Push(files, (Obj*)Str_newf("documents.dat"));
+    VA_Push(files, (Obj*)Str_newf("highlight.dat"));
+    for (int32_t i = 1; Seg_Field_Name(segment, i) != NULL; i++) {
+        VA_Push(files, (Obj*)Str_newf("lexicon-%i32.dat", i));
+        VA_Push(files, (Obj*)Str_newf("postings-%i32.dat", i));
+    }
+    for (uint32_t i = 0, max = VA_Get_Size(files); i < max; i++) {
+        String *file = (String*)VA_Fetch(files, i);
+        if (!CFReader_Local_Exists(cf_reader, file)) { continue; }
+        InStream *instream = CFReader_Local_Open_In(cf_reader, file);
+        if (instream) {
+            InStream_Advise(instream, merging
+                                      ? FH_ADVICE_SEQUENTIAL
+                                      : CFReader_Get_Advice(cf_reader, file));
+            DECREF(instream);
+        }
+    }
+    DECREF(files);
+}
+
 void
 SegWriter_Add_Segment_IMP(SegWriter *self, SegReader *reader,
                           I32Array *doc_map) {
     SegWriterIVARS *const ivars = SegWriter_IVARS(self);
+    S_advise_merge(reader, true);
 
     // Bulk add the slab of documents to the various writers.
     for (uint32_t i = 0, max = VA_Get_Size(ivars->writers); i < max; i++) {
         DataWriter *writer = (DataWriter*)VA_Fetch(ivars->writers, i);
         DataWriter_Add_Segment(writer, reader, doc_map);
     }
+    S_advise_merge(reader, false);
 
     // Bulk add the segment to the DeletionsWriter, so that it can merge
     // previous segment files as necessary.
@@ -159,12 +233,14 @@ SegWriter_Merge_Segment_IMP(SegWriter *self, SegReader *reader,
     SegWriterIVARS *const ivars = SegWriter_IVARS(self);
     Snapshot *snapshot = SegWriter_Get_Snapshot(self);
     String   *seg_name = Seg_Get_Name(SegReader_Get_Segment(reader));
+    S_advise_merge(reader, true);
 
     // Have all the sub-writers merge the segment.
     for (uint32_t i = 0, max = VA_Get_Size(ivars->writers); i < max; i++) {
         DataWriter *writer = (DataWriter*)VA_Fetch(ivars->writers, i);
         DataWriter_Merge_Segment(writer, reader, doc_map);
     }
+    S_advise_merge(reader, false);
     DelWriter_Merge_Segment(ivars->del_writer, reader, doc_map);
 
     // Remove seg directory from snapshot.
@@ -210,7 +286,9 @@ SegWriter_Finish_IMP(SegWriter *self) {
     DECREF(segmeta_filename);
 
     // Collapse segment files into compound file.
-    Folder_Consolidate(ivars->folder, seg_name);
+    Architecture *arch = Schema_Get_Architecture(SegWriter_Get_Schema(self));
+    Folder_Consolidate(ivars->folder, seg_name,
+                       Arch_Compound_File_Alignment(arch));
 }
 
 void
@@ -26,6 +26,7 @@
 #include "Lucy/Index/SortWriter.h"
 #include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/Schema.h"
+#include "Lucy/Store/FileHandle.h"
 #include "Lucy/Store/Folder.h"
 #include "Lucy/Store/InStream.h"
 
@@ -154,6 +155,17 @@ S_calc_ord_width(int32_t cardinality) {
     else                                { return 32; }
 }
 
+// Advise through the Folder, which lets a compound file keep the access
+// pattern hint standing for the sub-file.
+static void
+S_advise(Folder *folder, String *seg_name, int32_t field_num,
+         const char *ext) {
+    String *path = Str_newf("%o/sort-%i32.%s", seg_name, field_num, ext);
+    Folder_Advise(folder, path, FH_ADVICE_RANDOM);
+    Folder_Advise(folder, path, FH_ADVICE_WILLNEED);
+    DECREF(path);
+}
+
 static SortCache*
 S_lazy_init_sort_cache(DefaultSortReader *self, String *field) {
     DefaultSortReaderIVARS *const ivars = DefSortReader_IVARS(self);
@@ -204,6 +216,11 @@ S_lazy_init_sort_cache(DefaultSortReader *self, String *field) {
               field, Err_get_error());
     }
 
+    // Sort caches are accessed randomly and heavily; pull them in now.
+    S_advise(folder, seg_name, field_num, "ord");
+    if (ix_in) { S_advise(folder, seg_name, field_num, "ix"); }
+    S_advise(folder, seg_name, field_num, "dat");
+
     Obj     *null_ord_obj = Hash_Fetch(ivars->null_ords, (Obj*)field);
     int32_t  null_ord = null_ord_obj ? (int32_t)Obj_To_I64(null_ord_obj) : -1;
     Obj     *ord_width_obj = Hash_Fetch(ivars->ord_widths, (Obj*)field);
@@ -0,0 +1,264 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_TIEREDMERGEPOLICY
+#include "Lucy/Util/ToolSet.h"
+#include <math.h>
+
+#include "Lucy/Index/TieredMergePolicy.h"
+#include "Clownfish/Util/SortUtils.h"
+
+typedef struct lucy_TieredCand {
+    int32_t  tick;
+    uint32_t tier;
+    int64_t  live_size;
+    double   del_proportion;
+} lucy_TieredCand;
+
+// Order by descending deletion proportion, then by ascending live size, then
+// by tick.
+static int
+S_compare_cands(void *context, const void *va, const void *vb);
+
+static int
+S_compare_i32(void *context, const void *va, const void *vb);
+
+// Add members of `cands` to `picked`, in order, until either
+// `max_merge_at_once` members have been added or no more will fit under the
+// size cap.  Return the number picked.
+static uint32_t
+S_pick(TieredMergePolicyIVARS *ivars, lucy_TieredCand **cands,
+       uint32_t num_cands, int32_t *picked);
+
+TieredMergePolicy*
+TieredMergePol_new() {
+    TieredMergePolicy *self
+        = (TieredMergePolicy*)VTable_Make_Obj(TIEREDMERGEPOLICY);
+    return TieredMergePol_init(self);
+}
+
+TieredMergePolicy*
+TieredMergePol_init(TieredMergePolicy *self) {
+    MergePolicy_init((MergePolicy*)self);
+    TieredMergePolicyIVARS *const ivars = TieredMergePol_IVARS(self);
+    ivars->max_merge_at_once = 10;
+    ivars->segs_per_tier     = 10;
+    ivars->floor_size        = INT64_C(2) * 1024 * 1024;
+    ivars->max_merged_size   = INT64_C(5) * 1024 * 1024 * 1024;
+    ivars->deletes_threshold = 0.2;
+    return self;
+}
+
+uint32_t
+TieredMergePol_Tier_IMP(TieredMergePolicy *self, int64_t size) {
+    TieredMergePolicyIVARS *const ivars = TieredMergePol_IVARS(self);
+    if (size <= ivars->floor_size) { return 0; }
+    double ratio = (double)size / (double)ivars->floor_size;
+    return (uint32_t)(log(ratio) / log((double)ivars->segs_per_tier)) + 1;
+}
+
+I32Array*
+TieredMergePol_Select_IMP(TieredMergePolicy *self, VArray *candidates) {
+    TieredMergePolicyIVARS *const ivars = TieredMergePol_IVARS(self);
+    const uint32_t num_candidates = VA_Get_Size(candidates);
+    const int64_t  too_big        = ivars->max_merged_size / 2;
+    lucy_TieredCand *cands
+        = (lucy_TieredCand*)MALLOCATE(
+              (num_candidates + 1) * sizeof(lucy_TieredCand));
+    lucy_TieredCand **sorted
+        = (lucy_TieredCand**)MALLOCATE(
+              (num_candidates + 1) * sizeof(lucy_TieredCand*));
+    lucy_TieredCand **bucket
+        = (lucy_TieredCand**)MALLOCATE(
+              (num_candidates + 1) * sizeof(lucy_TieredCand*));
+    int32_t *picked
+        = (int32_t*)MALLOCATE((num_candidates + 1) * sizeof(int32_t));
+    uint32_t num_eligible = 0;
+    uint32_t num_picked   = 0;
+    uint32_t max_tier     = 0;
+
+    // Summarize eligible candidates.  Segments which are too big to merge
+    // with anything else are skipped unless they need reclamation.
+    for (uint32_t i = 0; i < num_candidates; i++) {
+        MergeCandidate *candidate
+            = (MergeCandidate*)CERTIFY(VA_Fetch(candidates, i),
+                                       MERGECANDIDATE);
+        lucy_TieredCand *cand = cands + num_eligible;
+        cand->tick           = (int32_t)i;
+        cand->live_size      = MergeCand_Live_Size(candidate);
+        cand->del_proportion = MergeCand_Del_Proportion(candidate);
+        cand->tier = TieredMergePol_Tier(self, cand->live_size);
+        if (cand->live_size > too_big
+            && cand->del_proportion < ivars->deletes_threshold
+           ) {
+            continue;
+        }
+        if (cand->tier > max_tier) { max_tier = cand->tier; }
+        sorted[num_eligible] = cand;
+        num_eligible++;
+    }
+    Sort_quicksort(sorted, num_eligible, sizeof(lucy_TieredCand*),
+                   S_compare_cands, NULL);
+
+    // Service the lowest tier which has filled up.
+    for (uint32_t tier = 0; tier <= max_tier && num_eligible; tier++) {
+        uint32_t bucket_size = 0;
+        for (uint32_t i = 0; i < num_eligible; i++) {
+            if (sorted[i]->tier == tier) { bucket[bucket_size++] = sorted[i]; }
+        }
+        if (bucket_size >= ivars->segs_per_tier) {
+            num_picked = S_pick(ivars, bucket, bucket_size, picked);
+            // Merging a lone segment rewrites it without gaining anything,
+            // unless that reclaims deleted docs.
+            if (num_picked == 1
+                && bucket[0]->del_proportion < ivars->deletes_threshold
+               ) {
+                num_picked = 0;
+            }
+            if (num_picked) { break; }
+        }
+    }
+
+    // If no tier needed servicing, reclaim space held by deleted docs.
+    if (!num_picked) {
+        uint32_t num_reclaimable = 0;
+        for (uint32_t i = 0; i < num_eligible; i++) {
+            if (sorted[i]->del_proportion >= ivars->deletes_threshold
+                && sorted[i]->del_proportion > 0.0
+               ) {
+                bucket[num_reclaimable++] = sorted[i];
+            }
+        }
+        num_picked = S_pick(ivars, bucket, num_reclaimable, picked);
+    }
+
+    // Preserve the original segment order.
+    Sort_quicksort(picked, num_picked, sizeof(int32_t), S_compare_i32, NULL);
+
+    FREEMEM(bucket);
+    FREEMEM(sorted);
+    FREEMEM(cands);
+    return I32Arr_new_steal(picked, num_picked);
+}
+
+static uint32_t
+S_pick(TieredMergePolicyIVARS *ivars, lucy_TieredCand **cands,
+       uint32_t num_cands, int32_t *picked) {
+    uint32_t num_picked = 0;
+    int64_t  total_size = 0;
+    for (uint32_t i = 0; i < num_cands; i++) {
+        if (num_picked >= ivars->max_merge_at_once) { break; }
+        if (num_picked && total_size + cands[i]->live_size
+                          > ivars->max_merged_size
+           ) {
+            continue;
+        }
+        total_size += cands[i]->live_size;
+        picked[num_picked++] = cands[i]->tick;
+    }
+    return num_picked;
+}
+
+static int
+S_compare_cands(void *context, const void *va, const void *vb) {
+    lucy_TieredCand *a = *(lucy_TieredCand**)va;
+    lucy_TieredCand *b = *(lucy_TieredCand**)vb;
+    UNUSED_VAR(context);
+    if (a->del_proportion != b->del_proportion) {
+        return a->del_proportion > b->del_proportion ? -1 : 1;
+    }
+    if (a->live_size != b->live_size) {
+        return a->live_size < b->live_size ? -1 : 1;
+    }
+    return a->tick - b->tick;
+}
+
+static int
+S_compare_i32(void *context, const void *va, const void *vb) {
+    UNUSED_VAR(context);
+    return *(int32_t*)va - *(int32_t*)vb;
+}
+
+void
+TieredMergePol_Set_Max_Merge_At_Once_IMP(TieredMergePolicy *self,
+                                         uint32_t max_merge_at_once) {
+    if (max_merge_at_once < 2) {
+        THROW(ERR, "max_merge_at_once must be at least 2: %u32",
+              max_merge_at_once);
+    }
+    TieredMergePol_IVARS(self)->max_merge_at_once = max_merge_at_once;
+}
+
+uint32_t
+TieredMergePol_Get_Max_Merge_At_Once_IMP(TieredMergePolicy *self) {
+    return TieredMergePol_IVARS(self)->max_merge_at_once;
+}
+
+void
+TieredMergePol_Set_Segs_Per_Tier_IMP(TieredMergePolicy *self,
+                                     uint32_t segs_per_tier) {
+    if (segs_per_tier < 2) {
+        THROW(ERR, "segs_per_tier must be at least 2: %u32", segs_per_tier);
+    }
+    TieredMergePol_IVARS(self)->segs_per_tier = segs_per_tier;
+}
+
+uint32_t
+TieredMergePol_Get_Segs_Per_Tier_IMP(TieredMergePolicy *self) {
+    return TieredMergePol_IVARS(self)->segs_per_tier;
+}
+
+void
+TieredMergePol_Set_Floor_Size_IMP(TieredMergePolicy *self,
+                                  int64_t floor_size) {
+    if (floor_size < 1) {
+        THROW(ERR, "floor_size must be positive: %i64", floor_size);
+    }
+    TieredMergePol_IVARS(self)->floor_size = floor_size;
+}
+
+int64_t
+TieredMergePol_Get_Floor_Size_IMP(TieredMergePolicy *self) {
+    return TieredMergePol_IVARS(self)->floor_size;
+}
+
+void
+TieredMergePol_Set_Max_Merged_Size_IMP(TieredMergePolicy *self,
+                                       int64_t max_merged_size) {
+    if (max_merged_size < 1) {
+        THROW(ERR, "max_merged_size must be positive: %i64",
+              max_merged_size);
+    }
+    TieredMergePol_IVARS(self)->max_merged_size = max_merged_size;
+}
+
+int64_t
+TieredMergePol_Get_Max_Merged_Size_IMP(TieredMergePolicy *self) {
+    return TieredMergePol_IVARS(self)->max_merged_size;
+}
+
+void
+TieredMergePol_Set_Deletes_Threshold_IMP(TieredMergePolicy *self,
+                                         double threshold) {
+    TieredMergePol_IVARS(self)->deletes_threshold = threshold;
+}
+
+double
+TieredMergePol_Get_Deletes_Threshold_IMP(TieredMergePolicy *self) {
+    return TieredMergePol_IVARS(self)->deletes_threshold;
+}
+
@@ -37,6 +37,7 @@
 #include "Lucy/Index/SortReader.h"
 #include "Lucy/Index/SortWriter.h"
 #include "Lucy/Plan/Schema.h"
+#include "Lucy/Store/CompoundFileWriter.h"
 #include "Lucy/Store/Folder.h"
 
 Architecture*
@@ -274,4 +275,28 @@ Arch_Skip_Interval_IMP(Architecture *self) {
     return 16;
 }
 
+int32_t
+Arch_Doc_Codec_IMP(Architecture *self) {
+    UNUSED_VAR(self);
+    return DocWriter_CODEC_LZ4;
+}
+
+int32_t
+Arch_Doc_Chunk_Size_IMP(Architecture *self) {
+    UNUSED_VAR(self);
+    return 16384;
+}
+
+int32_t
+Arch_Compound_File_Alignment_IMP(Architecture *self) {
+    UNUSED_VAR(self);
+    return CFWriter_default_alignment;
+}
+
+int64_t
+Arch_Verify_On_Open_Size_IMP(Architecture *self) {
+    UNUSED_VAR(self);
+    return 0;
+}
+
 
@@ -35,6 +35,8 @@ FType_init2(FieldType *self, float boost, bool indexed, bool stored,
     ivars->indexed           = indexed;
     ivars->stored            = stored;
     ivars->sortable          = sortable;
+    ivars->bloom_bits        = 0;
+    ivars->unique            = false;
     ABSTRACT_CLASS_CHECK(self, FIELDTYPE);
     return self;
 }
@@ -59,6 +61,20 @@ FType_Set_Sortable_IMP(FieldType *self, bool sortable) {
     FType_IVARS(self)->sortable = !!sortable;
 }
 
+void
+FType_Set_Bloom_Bits_IMP(FieldType *self, int32_t bloom_bits) {
+    if (bloom_bits != 0 && (bloom_bits < 4 || bloom_bits > 32)) {
+        THROW(ERR, "bloom_bits must be 0 or between 4 and 32: %i32",
+              bloom_bits);
+    }
+    FType_IVARS(self)->bloom_bits = bloom_bits;
+}
+
+void
+FType_Set_Unique_IMP(FieldType *self, bool unique) {
+    FType_IVARS(self)->unique = !!unique;
+}
+
 float
 FType_Get_Boost_IMP(FieldType *self) {
     return FType_IVARS(self)->boost;
@@ -79,6 +95,16 @@ FType_Sortable_IMP(FieldType *self) {
     return FType_IVARS(self)->sortable;
 }
 
+int32_t
+FType_Get_Bloom_Bits_IMP(FieldType *self) {
+    return FType_IVARS(self)->bloom_bits;
+}
+
+bool
+FType_Unique_IMP(FieldType *self) {
+    return FType_IVARS(self)->unique;
+}
+
 bool
 FType_Binary_IMP(FieldType *self) {
     UNUSED_VAR(self);
@@ -107,6 +133,8 @@ FType_Equals_IMP(FieldType *self, Obj *other) {
     if (!!ivars->indexed    != !!ovars->indexed)         { return false; }
     if (!!ivars->stored     != !!ovars->stored)          { return false; }
     if (!!ivars->sortable   != !!ovars->sortable)        { return false; }
+    if (ivars->bloom_bits   != ovars->bloom_bits)        { return false; }
+    if (!!ivars->unique     != !!ovars->unique)          { return false; }
     if (!!FType_Binary(self) != !!FType_Binary((FieldType*)other)) {
         return false;
     }
@@ -47,6 +47,7 @@ FullTextType_init2(FullTextType *self, Analyzer *analyzer, float boost,
     ivars->stored        = stored;
     ivars->sortable      = sortable;
     ivars->highlightable = highlightable;
+    ivars->shingles      = false;
     ivars->analyzer      = (Analyzer*)INCREF(analyzer);
 
     return self;
@@ -71,6 +72,7 @@ FullTextType_Equals_IMP(FullTextType *self, Obj *other) {
     if (!super_equals(self, other))                       { return false; }
     if (!!ivars->sortable      != !!ovars->sortable)      { return false; }
     if (!!ivars->highlightable != !!ovars->highlightable) { return false; }
+    if (!!ivars->shingles      != !!ovars->shingles)      { return false; }
     if (!Analyzer_Equals(ivars->analyzer, (Obj*)ovars->analyzer)) {
         return false;
     }
@@ -96,9 +98,19 @@ FullTextType_Dump_For_Schema_IMP(FullTextType *self) {
     if (ivars->sortable) {
         Hash_Store_Utf8(dump, "sortable", 8, (Obj*)CFISH_TRUE);
     }
+    if (ivars->bloom_bits) {
+        Hash_Store_Utf8(dump, "bloom_bits", 10,
+                        (Obj*)Str_newf("%i32", ivars->bloom_bits));
+    }
+    if (ivars->unique) {
+        Hash_Store_Utf8(dump, "unique", 6, (Obj*)CFISH_TRUE);
+    }
     if (ivars->highlightable) {
         Hash_Store_Utf8(dump, "highlightable", 13, (Obj*)CFISH_TRUE);
     }
+    if (ivars->shingles) {
+        Hash_Store_Utf8(dump, "shingles", 8, (Obj*)CFISH_TRUE);
+    }
 
     return dump;
 }
@@ -158,6 +170,20 @@ FullTextType_Load_IMP(FullTextType *self, Obj *dump) {
     FullTextType_init2(loaded, analyzer, boost, indexed, stored,
                        sortable, hl);
     DECREF(analyzer);
+
+    Obj *bloom_dump = Hash_Fetch_Utf8(source, "bloom_bits", 10);
+    if (bloom_dump) {
+        FullTextType_Set_Bloom_Bits(loaded, (int32_t)Obj_To_I64(bloom_dump));
+    }
+    Obj *unique_dump = Hash_Fetch_Utf8(source, "unique", 6);
+    if (unique_dump) {
+        FullTextType_Set_Unique(loaded, Obj_To_Bool(unique_dump));
+    }
+    Obj *shingles_dump = Hash_Fetch_Utf8(source, "shingles", 8);
+    if (shingles_dump) {
+        FullTextType_Set_Shingles(loaded, Obj_To_Bool(shingles_dump));
+    }
+
     return loaded;
 }
 
@@ -166,6 +192,49 @@ FullTextType_Set_Highlightable_IMP(FullTextType *self, bool highlightable) {
     FullTextType_IVARS(self)->highlightable = highlightable;
 }
 
+void
+FullTextType_Set_Shingles_IMP(FullTextType *self, bool shingles) {
+    FullTextType_IVARS(self)->shingles = shingles;
+}
+
+bool
+FullTextType_Shingles_IMP(FullTextType *self) {
+    return FullTextType_IVARS(self)->shingles;
+}
+
+// U+001F (UNIT SEPARATOR) never appears in field names or tokens produced by
+// Lucy's analyzers.
+#define SHINGLE_SEP '\x1F'
+
+String*
+FullTextType_shingle_field(String *field) {
+    return Str_newf("%o" "\x1F" "shingles", field);
+}
+
+String*
+FullTextType_shingle_text(const char *first, size_t first_len,
+                          const char *second, size_t second_len) {
+    size_t  size = first_len + 1 + second_len;
+    char   *text = (char*)MALLOCATE(size + 1);
+    memcpy(text, first, first_len);
+    text[first_len] = SHINGLE_SEP;
+    memcpy(text + first_len + 1, second, second_len);
+    text[size] = '\0';
+    return Str_new_steal_trusted_utf8(text, size);
+}
+
+FullTextType*
+FullTextType_Make_Shingle_Type_IMP(FullTextType *self) {
+    FullTextTypeIVARS *const ivars = FullTextType_IVARS(self);
+    // Same class as the parent, so that overrides such as Make_Similarity()
+    // carry over.  Indexed only: the shingles are derived from the parent
+    // field's value at index time and never stored, sorted, or highlighted.
+    VTable *vtable = FullTextType_Get_VTable(self);
+    return FullTextType_init2((FullTextType*)VTable_Make_Obj(vtable),
+                              ivars->analyzer, ivars->boost, true, false,
+                              false, false);
+}
+
 Analyzer*
 FullTextType_Get_Analyzer_IMP(FullTextType *self) {
     return FullTextType_IVARS(self)->analyzer;
@@ -154,6 +154,17 @@ S_add_text_field(Schema *self, String *field, FieldType *type) {
 
     // Store FieldType.
     Hash_Store(ivars->types, (Obj*)field, INCREF(type));
+
+    // Add the hidden field which holds the shingles.
+    if (FullTextType_Shingles(fttype)) {
+        String *shingle_field = FullTextType_shingle_field(field);
+        FullTextType *shingle_type = FullTextType_Make_Shingle_Type(fttype);
+        Schema_Spec_Field(self, shingle_field, (FieldType*)shingle_type);
+        // Score shingles with the parent field's Similarity.
+        Hash_Store(ivars->sims, (Obj*)shingle_field, INCREF(sim));
+        DECREF(shingle_type);
+        DECREF(shingle_field);
+    }
 }
 
 static void
@@ -228,6 +239,24 @@ Schema_All_Fields_IMP(Schema *self) {
     return Hash_Keys(Schema_IVARS(self)->types);
 }
 
+bool
+Schema_Hidden_Field_IMP(Schema *self, String *field) {
+    SchemaIVARS *const ivars = Schema_IVARS(self);
+    static const char suffix[] = "\x1F" "shingles";
+    const size_t suffix_len = sizeof(suffix) - 1;
+    size_t size = Str_Get_Size(field);
+    if (size <= suffix_len) { return false; }
+    const char *ptr = Str_Get_Ptr8(field);
+    if (memcmp(ptr + size - suffix_len, suffix, suffix_len) != 0) {
+        return false;
+    }
+    String *base = (String*)SSTR_WRAP_UTF8(ptr, size - suffix_len);
+    FieldType *type = (FieldType*)Hash_Fetch(ivars->types, (Obj*)base);
+    return type != NULL
+           && FType_Is_A(type, FULLTEXTTYPE)
+           && FullTextType_Shingles((FullTextType*)type);
+}
+
 uint32_t
 S_find_in_array(VArray *array, Obj *obj) {
     for (uint32_t i = 0, max = VA_Get_Size(array); i < max; i++) {
@@ -267,6 +296,9 @@ Schema_Dump_IMP(Schema *self) {
     while (Hash_Next(ivars->types, (Obj**)&field, (Obj**)&type)) {
         VTable *type_vtable = FType_Get_VTable(type);
 
+        // Hidden fields are recreated when their parent field is loaded.
+        if (Schema_Hidden_Field(self, field)) { continue; }
+
         // Dump known types to simplified format.
         if (type_vtable == FULLTEXTTYPE) {
             FullTextType *fttype = (FullTextType*)type;
@@ -73,6 +73,13 @@ StringType_Dump_For_Schema_IMP(StringType *self) {
     if (ivars->sortable) {
         Hash_Store_Utf8(dump, "sortable", 8, (Obj*)CFISH_TRUE);
     }
+    if (ivars->bloom_bits) {
+        Hash_Store_Utf8(dump, "bloom_bits", 10,
+                        (Obj*)Str_newf("%i32", ivars->bloom_bits));
+    }
+    if (ivars->unique) {
+        Hash_Store_Utf8(dump, "unique", 6, (Obj*)CFISH_TRUE);
+    }
 
     return dump;
 }
@@ -99,6 +106,8 @@ StringType_Load_IMP(StringType *self, Obj *dump) {
     Obj *indexed_dump    = Hash_Fetch_Utf8(source, "indexed", 7);
     Obj *stored_dump     = Hash_Fetch_Utf8(source, "stored", 6);
     Obj *sortable_dump   = Hash_Fetch_Utf8(source, "sortable", 8);
+    Obj *bloom_dump      = Hash_Fetch_Utf8(source, "bloom_bits", 10);
+    Obj *unique_dump     = Hash_Fetch_Utf8(source, "unique", 6);
     UNUSED_VAR(self);
 
     float boost    = boost_dump    ? (float)Obj_To_F64(boost_dump) : 1.0f;
@@ -106,7 +115,14 @@ StringType_Load_IMP(StringType *self, Obj *dump) {
     bool  stored   = stored_dump   ? Obj_To_Bool(stored_dump)      : true;
     bool  sortable = sortable_dump ? Obj_To_Bool(sortable_dump)    : false;
 
-    return StringType_init2(loaded, boost, indexed, stored, sortable);
+    StringType_init2(loaded, boost, indexed, stored, sortable);
+    if (bloom_dump) {
+        StringType_Set_Bloom_Bits(loaded, (int32_t)Obj_To_I64(bloom_dump));
+    }
+    if (unique_dump) {
+        StringType_Set_Unique(loaded, Obj_To_Bool(unique_dump));
+    }
+    return loaded;
 }
 
 Similarity*
@@ -18,6 +18,7 @@
 #include "Lucy/Util/ToolSet.h"
 
 #include "Lucy/Search/ANDMatcher.h"
+#include "Clownfish/CharBuf.h"
 #include "Lucy/Index/Similarity.h"
 
 ANDMatcher*
@@ -37,11 +38,24 @@ ANDMatcher_init(ANDMatcher *self, VArray *children, Similarity *sim) {
     // Assign.
     ivars->more         = ivars->num_kids ? true : false;
     ivars->kids         = (Matcher**)MALLOCATE(ivars->num_kids * sizeof(Matcher*));
+    int32_t *costs = (int32_t*)MALLOCATE(ivars->num_kids * sizeof(int32_t));
     for (uint32_t i = 0; i < ivars->num_kids; i++) {
         Matcher *child = (Matcher*)VA_Fetch(children, i);
-        ivars->kids[i] = child;
+        int32_t  cost  = Matcher_Cost(child);
+
+        // Insertion sort by ascending cost, keeping ties in query order.
+        uint32_t j = i;
+        while (j > 0 && costs[j - 1] > cost) {
+            ivars->kids[j] = ivars->kids[j - 1];
+            costs[j]       = costs[j - 1];
+            j--;
+        }
+        ivars->kids[j] = child;
+        costs[j]       = cost;
+
         if (!Matcher_Next(child)) { ivars->more = false; }
     }
+    FREEMEM(costs);
 
     // Derive.
     ivars->matching_kids = ivars->num_kids;
@@ -76,71 +90,53 @@ ANDMatcher_Advance_IMP(ANDMatcher *self, int32_t target) {
     ANDMatcherIVARS *const ivars = ANDMatcher_IVARS(self);
     Matcher **const kids     = ivars->kids;
     const uint32_t  num_kids = ivars->num_kids;
-    int32_t         highest  = 0;
+    Matcher  *const lead     = kids[0];
+    int32_t         candidate;
 
     if (!ivars->more) { return 0; }
 
-    // First step: Advance first child and use its doc as a starting point.
+    // First step: position the leader (the rarest child) at or past target.
+    // Children were primed with Next() by the constructor.
+    candidate = Matcher_Get_Doc_ID(lead);
     if (ivars->first_time) {
         ivars->first_time = false;
     }
-    else {
-        highest = Matcher_Advance(kids[0], target);
-        if (!highest) {
-            ivars->more = false;
-            return 0;
-        }
+    if (candidate < target) {
+        candidate = Matcher_Advance(lead, target);
     }
 
-    // Second step: reconcile.
-    while (1) {
-        bool agreement = true;
-
-        // Scoot all Matchers up.
-        for (uint32_t i = 0; i < num_kids; i++) {
+    // Second step: ask the others to confirm the leader's candidate.  A
+    // child which overshoots supplies the next target for the leader.
+    while (candidate) {
+        uint32_t i = 1;
+        for (; i < num_kids; i++) {
             Matcher *const child = kids[i];
-            int32_t candidate = Matcher_Get_Doc_ID(child);
-
-            // If this child is highest, others will need to catch up.
-            if (highest < candidate) {
-                highest = candidate;
-            }
-
-            // If least doc Matchers can agree on exceeds target, raise bar.
-            if (target < highest) {
-                target = highest;
-            }
-
-            // Scoot this Matcher up if not already at highest.
-            if (candidate < target) {
-                // This Matcher is definitely the highest right now.
-                highest = Matcher_Advance(child, target);
-                if (!highest) {
+            int32_t doc_id = Matcher_Get_Doc_ID(child);
+            if (doc_id < candidate) {
+                doc_id = Matcher_Advance(child, candidate);
+                if (!doc_id) {
                     ivars->more = false;
                     return 0;
                 }
             }
-        }
-
-        // If Matchers don't agree, send back through the loop.
-        for (uint32_t i = 0; i < num_kids; i++) {
-            Matcher *const child = kids[i];
-            const int32_t candidate = Matcher_Get_Doc_ID(child);
-            if (candidate != highest) {
-                agreement = false;
+            if (doc_id > candidate) {
+                candidate = Matcher_Advance(lead, doc_id);
                 break;
             }
         }
-
-        if (!agreement) {
-            continue;
-        }
-        if (highest >= target) {
-            break;
+        if (i == num_kids) {
+            return candidate;
         }
     }
 
-    return highest;
+    ivars->more = false;
+    return 0;
+}
+
+int32_t
+ANDMatcher_Cost_IMP(ANDMatcher *self) {
+    ANDMatcherIVARS *const ivars = ANDMatcher_IVARS(self);
+    return ivars->num_kids ? Matcher_Cost(ivars->kids[0]) : 0;
 }
 
 int32_t
@@ -163,3 +159,16 @@ ANDMatcher_Score_IMP(ANDMatcher *self) {
     return score;
 }
 
+void
+ANDMatcher_Describe_IMP(ANDMatcher *self, CharBuf *buf, int32_t depth) {
+    ANDMatcherIVARS *const ivars = ANDMatcher_IVARS(self);
+    // Bypass PolyMatcher's implementation, which would list the children in
+    // their original order.
+    Matcher_Describe_t describe
+        = METHOD_PTR(MATCHER, LUCY_Matcher_Describe);
+    describe((Matcher*)self, buf, depth);
+    for (uint32_t i = 0; i < ivars->num_kids; i++) {
+        Matcher_Describe(ivars->kids[i], buf, depth + 1);
+    }
+}
+
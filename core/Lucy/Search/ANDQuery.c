@@ -26,6 +26,8 @@
 #include "Lucy/Index/Similarity.h"
 #include "Lucy/Plan/Schema.h"
 #include "Lucy/Search/ANDMatcher.h"
+#include "Lucy/Search/MatchAllMatcher.h"
+#include "Lucy/Search/NoMatchMatcher.h"
 #include "Lucy/Search/Searcher.h"
 #include "Lucy/Search/Span.h"
 #include "Lucy/Store/InStream.h"
@@ -103,6 +105,27 @@ ANDCompiler_init(ANDCompiler *self, ANDQuery *parent, Searcher *searcher,
     return self;
 }
 
+// Gather the compilers for a conjunction, splicing in the children of any
+// nested ANDCompilers.  Nesting only affects scoring through the coordination
+// factor, so nested clauses are only flattened when it cannot change scores.
+static void
+S_flatten_and(ANDCompiler *self, VArray *compilers, Similarity *sim,
+              bool need_score) {
+    VArray *children = ANDCompiler_IVARS(self)->children;
+    for (uint32_t i = 0, max = VA_Get_Size(children); i < max; i++) {
+        Compiler *child = (Compiler*)VA_Fetch(children, i);
+        if (Compiler_Get_VTable(child) == ANDCOMPILER) {
+            ANDCompiler *nested = (ANDCompiler*)child;
+            uint32_t size = VA_Get_Size(ANDCompiler_IVARS(nested)->children);
+            if (!need_score || Sim_Coord(sim, size, size) == 1.0f) {
+                S_flatten_and(nested, compilers, sim, need_score);
+                continue;
+            }
+        }
+        VA_Push(compilers, INCREF(child));
+    }
+}
+
 Matcher*
 ANDCompiler_Make_Matcher_IMP(ANDCompiler *self, SegReader *reader,
                              bool need_score) {
@@ -114,30 +137,68 @@ ANDCompiler_Make_Matcher_IMP(ANDCompiler *self, SegReader *reader,
         return Compiler_Make_Matcher(only_child, reader, need_score);
     }
     else {
+        Similarity *sim = ANDCompiler_Get_Similarity(self);
+        VArray *compilers = VA_new(num_kids);
+        S_flatten_and(self, compilers, sim, need_score);
+        num_kids = VA_Get_Size(compilers);
+        if (need_score && Sim_Coord(sim, num_kids, num_kids) != 1.0f) {
+            // Flattening would change the coordination factor.
+            DECREF(compilers);
+            compilers = (VArray*)INCREF(ivars->children);
+            num_kids  = VA_Get_Size(compilers);
+        }
         VArray *child_matchers = VA_new(num_kids);
+        Matcher *match_all     = NULL;
 
         // Add child matchers one by one.
         for (uint32_t i = 0; i < num_kids; i++) {
-            Compiler *child = (Compiler*)VA_Fetch(ivars->children, i);
+            Compiler *child = (Compiler*)VA_Fetch(compilers, i);
             Matcher *child_matcher
                 = Compiler_Make_Matcher(child, reader, need_score);
 
-            // If any required clause fails, the whole thing fails.
-            if (child_matcher == NULL) {
+            // If any required clause fails, the whole thing fails.  The same
+            // goes for a clause which cannot match anything in this segment.
+            // Cost() is only an estimate, so don't prune on it.
+            if (child_matcher == NULL
+                || Matcher_Get_VTable(child_matcher) == NOMATCHMATCHER
+               ) {
+                DECREF(child_matcher);
+                DECREF(match_all);
                 DECREF(child_matchers);
+                DECREF(compilers);
                 return NULL;
             }
+            else if (!need_score
+                     && Matcher_Get_VTable(child_matcher) == MATCHALLMATCHER
+                    ) {
+                // A match-all clause filters nothing, so drop it unless
+                // it's the only one.
+                if (match_all) { DECREF(child_matcher); }
+                else           { match_all = child_matcher; }
+            }
             else {
                 VA_Push(child_matchers, (Obj*)child_matcher);
             }
         }
+        DECREF(compilers);
 
-        Matcher *retval
-            = (Matcher*)ANDMatcher_new(child_matchers,
-                                       ANDCompiler_Get_Similarity(self));
+        Matcher *retval;
+        uint32_t num_matchers = VA_Get_Size(child_matchers);
+        if (num_matchers == 0) {
+            retval = match_all;
+            match_all = NULL;
+        }
+        else if (num_matchers == 1
+                 && (!need_score || Sim_Coord(sim, 1, 1) == 1.0f)
+                ) {
+            retval = (Matcher*)INCREF(VA_Fetch(child_matchers, 0));
+        }
+        else {
+            retval = (Matcher*)ANDMatcher_new(child_matchers, sim);
+        }
+        DECREF(match_all);
         DECREF(child_matchers);
         return retval;
-
     }
 }
 
@@ -60,4 +60,9 @@ BitVecMatcher_Get_Doc_ID_IMP(BitVecMatcher *self) {
     return BitVecMatcher_IVARS(self)->doc_id;
 }
 
+int32_t
+BitVecMatcher_Cost_IMP(BitVecMatcher *self) {
+    uint32_t count = BitVec_Count(BitVecMatcher_IVARS(self)->bit_vec);
+    return count > INT32_MAX ? INT32_MAX : (int32_t)count;
+}
 
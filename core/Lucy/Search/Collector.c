@@ -22,6 +22,7 @@
 #include "Lucy/Search/Collector.h"
 #include "Lucy/Index/SegReader.h"
 #include "Lucy/Search/Matcher.h"
+#include "Lucy/Search/SearchBudget.h"
 
 Collector*
 Coll_init(Collector *self) {
@@ -29,6 +30,7 @@ Coll_init(Collector *self) {
     ABSTRACT_CLASS_CHECK(self, COLLECTOR);
     ivars->reader  = NULL;
     ivars->matcher = NULL;
+    ivars->budget  = NULL;
     ivars->base    = 0;
     return self;
 }
@@ -38,6 +40,7 @@ Coll_Destroy_IMP(Collector *self) {
     CollectorIVARS *const ivars = Coll_IVARS(self);
     DECREF(ivars->reader);
     DECREF(ivars->matcher);
+    DECREF(ivars->budget);
     SUPER_DESTROY(self, COLLECTOR);
 }
 
@@ -60,6 +63,19 @@ Coll_Set_Base_IMP(Collector *self, int32_t base) {
     Coll_IVARS(self)->base = base;
 }
 
+void
+Coll_Set_Budget_IMP(Collector *self, SearchBudget *budget) {
+    CollectorIVARS *const ivars = Coll_IVARS(self);
+    SearchBudget *temp = ivars->budget;
+    ivars->budget = (SearchBudget*)INCREF(budget);
+    DECREF(temp);
+}
+
+SearchBudget*
+Coll_Get_Budget_IMP(Collector *self) {
+    return Coll_IVARS(self)->budget;
+}
+
 BitCollector*
 BitColl_new(BitVector *bit_vec) {
     BitCollector *self = (BitCollector*)VTable_Make_Obj(BITCOLLECTOR);
@@ -136,6 +152,18 @@ OffsetColl_Set_Matcher_IMP(OffsetCollector *self, Matcher *matcher) {
     Coll_Set_Matcher(ivars->inner_coll, matcher);
 }
 
+void
+OffsetColl_Set_Budget_IMP(OffsetCollector *self, SearchBudget *budget) {
+    OffsetCollectorIVARS *const ivars = OffsetColl_IVARS(self);
+    Coll_Set_Budget(ivars->inner_coll, budget);
+}
+
+SearchBudget*
+OffsetColl_Get_Budget_IMP(OffsetCollector *self) {
+    OffsetCollectorIVARS *const ivars = OffsetColl_IVARS(self);
+    return Coll_Get_Budget(ivars->inner_coll);
+}
+
 void
 OffsetColl_Collect_IMP(OffsetCollector *self, int32_t doc_id) {
     OffsetCollectorIVARS *const ivars = OffsetColl_IVARS(self);
@@ -130,6 +130,18 @@ Compiler_Equals_IMP(Compiler *self, Obj *other) {
     return true;
 }
 
+String*
+Compiler_Explain_Plan_IMP(Compiler *self, SegReader *reader,
+                          bool need_score) {
+    Matcher *matcher = Compiler_Make_Matcher(self, reader, need_score);
+    if (matcher == NULL) {
+        return Str_newf("(no match)\n");
+    }
+    String *retval = Matcher_Explain(matcher);
+    DECREF(matcher);
+    return retval;
+}
+
 void
 Compiler_Serialize_IMP(Compiler *self, OutStream *outstream) {
     CompilerIVARS *const ivars = Compiler_IVARS(self);
@@ -0,0 +1,296 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_FUZZYQUERY
+#define C_LUCY_FUZZYACCEPTOR
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Search/FuzzyQuery.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/OutStream.h"
+
+// Decode the target term into code points.
+static void
+S_prepare(FuzzyQuery *self);
+
+// Make room for `len` characters and the automaton rows which go with them.
+static void
+S_grow(FuzzyAcceptorIVARS *ivars, int32_t width, int32_t len);
+
+FuzzyQuery*
+FuzzyQuery_new(String *field, String *term, int32_t max_edits,
+               int32_t prefix_length) {
+    FuzzyQuery *self = (FuzzyQuery*)VTable_Make_Obj(FUZZYQUERY);
+    return FuzzyQuery_init(self, field, term, max_edits, prefix_length);
+}
+
+FuzzyQuery*
+FuzzyQuery_init(FuzzyQuery *self, String *field, String *term,
+                int32_t max_edits, int32_t prefix_length) {
+    MultiTermQuery_init((MultiTermQuery*)self, field, term);
+    FuzzyQueryIVARS *const ivars = FuzzyQuery_IVARS(self);
+    if (max_edits < 0 || prefix_length < 0) {
+        DECREF(self);
+        THROW(ERR, "max_edits and prefix_length can't be negative");
+    }
+    ivars->max_edits      = max_edits;
+    ivars->prefix_length  = prefix_length;
+    ivars->max_expansions = 50;
+    S_prepare(self);
+    return self;
+}
+
+void
+FuzzyQuery_Destroy_IMP(FuzzyQuery *self) {
+    FuzzyQueryIVARS *const ivars = FuzzyQuery_IVARS(self);
+    FREEMEM(ivars->target);
+    SUPER_DESTROY(self, FUZZYQUERY);
+}
+
+static void
+S_prepare(FuzzyQuery *self) {
+    FuzzyQueryIVARS *const ivars = FuzzyQuery_IVARS(self);
+    const char *ptr = Str_Get_Ptr8(ivars->term);
+    const char *end = ptr + Str_Get_Size(ivars->term);
+
+    FREEMEM(ivars->target);
+    ivars->target     = (int32_t*)MALLOCATE(
+                            (Str_Length(ivars->term) + 1) * sizeof(int32_t));
+    ivars->target_len = 0;
+    while (ptr < end) {
+        ivars->target[ivars->target_len++] = StrHelp_decode_utf8_char(ptr);
+        ptr += StrHelp_UTF8_COUNT[*(const uint8_t*)ptr];
+    }
+}
+
+int32_t
+FuzzyQuery_Get_Max_Edits_IMP(FuzzyQuery *self) {
+    return FuzzyQuery_IVARS(self)->max_edits;
+}
+
+int32_t
+FuzzyQuery_Get_Prefix_Length_IMP(FuzzyQuery *self) {
+    return FuzzyQuery_IVARS(self)->prefix_length;
+}
+
+String*
+FuzzyQuery_Literal_Prefix_IMP(FuzzyQuery *self) {
+    FuzzyQueryIVARS *const ivars = FuzzyQuery_IVARS(self);
+    const char *ptr = Str_Get_Ptr8(ivars->term);
+    const char *end = ptr + Str_Get_Size(ivars->term);
+    const char *cur = ptr;
+    for (int32_t i = 0; i < ivars->prefix_length && cur < end; i++) {
+        cur += StrHelp_UTF8_COUNT[*(const uint8_t*)cur];
+    }
+    return Str_new_from_trusted_utf8(ptr, (size_t)(cur - ptr));
+}
+
+bool
+FuzzyQuery_Accept_Term_IMP(FuzzyQuery *self, String *term) {
+    FuzzyAcceptor *acceptor = FuzzyAcceptor_new(self);
+    int32_t rank = FuzzyAcceptor_Rank(acceptor, term);
+    DECREF(acceptor);
+    return rank >= 0;
+}
+
+TermAcceptor*
+FuzzyQuery_Make_Acceptor_IMP(FuzzyQuery *self) {
+    return (TermAcceptor*)FuzzyAcceptor_new(self);
+}
+
+bool
+FuzzyQuery_Equals_IMP(FuzzyQuery *self, Obj *other) {
+    FuzzyQuery_Equals_t super_equals
+        = SUPER_METHOD_PTR(FUZZYQUERY, LUCY_FuzzyQuery_Equals);
+    if (!super_equals(self, other)) { return false; }
+    FuzzyQueryIVARS *const ivars = FuzzyQuery_IVARS(self);
+    FuzzyQueryIVARS *const ovars = FuzzyQuery_IVARS((FuzzyQuery*)other);
+    if (ivars->max_edits != ovars->max_edits)         { return false; }
+    if (ivars->prefix_length != ovars->prefix_length) { return false; }
+    return true;
+}
+
+String*
+FuzzyQuery_To_String_IMP(FuzzyQuery *self) {
+    FuzzyQueryIVARS *const ivars = FuzzyQuery_IVARS(self);
+    return Str_newf("%o:%o~%i32", ivars->field, ivars->term,
+                    ivars->max_edits);
+}
+
+void
+FuzzyQuery_Serialize_IMP(FuzzyQuery *self, OutStream *outstream) {
+    FuzzyQueryIVARS *const ivars = FuzzyQuery_IVARS(self);
+    FuzzyQuery_Serialize_t super_serialize
+        = SUPER_METHOD_PTR(FUZZYQUERY, LUCY_FuzzyQuery_Serialize);
+    super_serialize(self, outstream);
+    OutStream_Write_C32(outstream, ivars->max_edits);
+    OutStream_Write_C32(outstream, ivars->prefix_length);
+}
+
+FuzzyQuery*
+FuzzyQuery_Deserialize_IMP(FuzzyQuery *self, InStream *instream) {
+    FuzzyQuery_Deserialize_t super_deserialize
+        = SUPER_METHOD_PTR(FUZZYQUERY, LUCY_FuzzyQuery_Deserialize);
+    self = super_deserialize(self, instream);
+    FuzzyQueryIVARS *const ivars = FuzzyQuery_IVARS(self);
+    ivars->max_edits     = (int32_t)InStream_Read_C32(instream);
+    ivars->prefix_length = (int32_t)InStream_Read_C32(instream);
+    S_prepare(self);
+    return self;
+}
+
+Obj*
+FuzzyQuery_Dump_IMP(FuzzyQuery *self) {
+    FuzzyQueryIVARS *const ivars = FuzzyQuery_IVARS(self);
+    FuzzyQuery_Dump_t super_dump
+        = SUPER_METHOD_PTR(FUZZYQUERY, LUCY_FuzzyQuery_Dump);
+    Hash *dump = (Hash*)CERTIFY(super_dump(self), HASH);
+    Hash_Store_Utf8(dump, "max_edits", 9,
+                    (Obj*)Str_newf("%i32", ivars->max_edits));
+    Hash_Store_Utf8(dump, "prefix_length", 13,
+                    (Obj*)Str_newf("%i32", ivars->prefix_length));
+    return (Obj*)dump;
+}
+
+Obj*
+FuzzyQuery_Load_IMP(FuzzyQuery *self, Obj *dump) {
+    Hash *source = (Hash*)CERTIFY(dump, HASH);
+    FuzzyQuery_Load_t super_load
+        = SUPER_METHOD_PTR(FUZZYQUERY, LUCY_FuzzyQuery_Load);
+    FuzzyQuery *loaded = (FuzzyQuery*)super_load(self, dump);
+    FuzzyQueryIVARS *const loaded_ivars = FuzzyQuery_IVARS(loaded);
+    Obj *max_edits = CERTIFY(Hash_Fetch_Utf8(source, "max_edits", 9), OBJ);
+    loaded_ivars->max_edits = (int32_t)Obj_To_I64(max_edits);
+    Obj *prefix_length
+        = CERTIFY(Hash_Fetch_Utf8(source, "prefix_length", 13), OBJ);
+    loaded_ivars->prefix_length = (int32_t)Obj_To_I64(prefix_length);
+    S_prepare(loaded);
+    return (Obj*)loaded;
+}
+
+/**********************************************************************/
+
+FuzzyAcceptor*
+FuzzyAcceptor_new(FuzzyQuery *query) {
+    FuzzyAcceptor *self = (FuzzyAcceptor*)VTable_Make_Obj(FUZZYACCEPTOR);
+    return FuzzyAcceptor_init(self, query);
+}
+
+FuzzyAcceptor*
+FuzzyAcceptor_init(FuzzyAcceptor *self, FuzzyQuery *query) {
+    TermAcceptor_init((TermAcceptor*)self, (MultiTermQuery*)query);
+    FuzzyAcceptorIVARS *const ivars = FuzzyAcceptor_IVARS(self);
+    const int32_t target_len = FuzzyQuery_IVARS(query)->target_len;
+
+    // Row 0 of the automaton: reaching the i-th target character from an
+    // empty term takes i insertions.
+    S_grow(ivars, target_len + 1, 16);
+    for (int32_t j = 0; j <= target_len; j++) {
+        ivars->rows[j] = j;
+    }
+    ivars->valid_depth = 0;
+    ivars->dead_depth  = INT32_MAX;
+    return self;
+}
+
+void
+FuzzyAcceptor_Destroy_IMP(FuzzyAcceptor *self) {
+    FuzzyAcceptorIVARS *const ivars = FuzzyAcceptor_IVARS(self);
+    FREEMEM(ivars->chars);
+    FREEMEM(ivars->rows);
+    SUPER_DESTROY(self, FUZZYACCEPTOR);
+}
+
+static void
+S_grow(FuzzyAcceptorIVARS *ivars, int32_t width, int32_t len) {
+    if (len < ivars->chars_cap) { return; }
+    int32_t cap = ivars->chars_cap ? ivars->chars_cap : 16;
+    while (cap <= len) { cap *= 2; }
+    ivars->chars = (int32_t*)REALLOCATE(ivars->chars,
+                                        (size_t)cap * sizeof(int32_t));
+    ivars->rows  = (int32_t*)REALLOCATE(ivars->rows,
+                                        (size_t)(cap + 1) * (size_t)width
+                                        * sizeof(int32_t));
+    ivars->chars_cap = cap;
+}
+
+int32_t
+FuzzyAcceptor_Rank_IMP(FuzzyAcceptor *self, String *term) {
+    FuzzyAcceptorIVARS *const ivars = FuzzyAcceptor_IVARS(self);
+    FuzzyQueryIVARS *const qvars
+        = FuzzyQuery_IVARS((FuzzyQuery*)ivars->query);
+    const int32_t  max_edits = qvars->max_edits;
+    const int32_t  width     = qvars->target_len + 1;
+    const int32_t *target    = qvars->target;
+    const char    *ptr       = Str_Get_Ptr8(term);
+    const char    *end       = ptr + Str_Get_Size(term);
+
+    // Decode the term over the previous one, noting how many leading
+    // characters they share.  Automaton rows for the shared part still hold.
+    int32_t len    = 0;
+    int32_t shared = 0;
+    bool    same   = true;
+    while (ptr < end) {
+        int32_t code_point = StrHelp_decode_utf8_char(ptr);
+        ptr += StrHelp_UTF8_COUNT[*(const uint8_t*)ptr];
+        S_grow(ivars, width, len + 1);
+        if (same && len < ivars->valid_depth
+            && ivars->chars[len] == code_point
+           ) {
+            shared++;
+        }
+        else {
+            same = false;
+        }
+        ivars->chars[len++] = code_point;
+    }
+
+    // A shared prefix which already needs too many edits rules this term
+    // out too.
+    if (ivars->dead_depth <= shared) {
+        ivars->valid_depth = shared;
+        return -1;
+    }
+    ivars->dead_depth = INT32_MAX;
+
+    // Step the automaton over the rest of the term.
+    int32_t *const rows = ivars->rows;
+    int32_t depth = shared;
+    while (depth < len) {
+        const int32_t  c    = ivars->chars[depth];
+        const int32_t *prev = rows + (size_t)depth * width;
+        int32_t       *row  = rows + (size_t)(depth + 1) * width;
+        int32_t        best = row[0] = depth + 1;
+        for (int32_t j = 1; j < width; j++) {
+            int32_t cost = prev[j - 1] + (target[j - 1] == c ? 0 : 1);
+            if (prev[j] + 1 < cost)    { cost = prev[j] + 1; }
+            if (row[j - 1] + 1 < cost) { cost = row[j - 1] + 1; }
+            row[j] = cost;
+            if (cost < best) { best = cost; }
+        }
+        depth++;
+        if (best > max_edits) {
+            ivars->dead_depth = depth;
+            break;
+        }
+    }
+    ivars->valid_depth = depth;
+
+    if (depth < len) { return -1; }
+    const int32_t distance = rows[(size_t)len * width + width - 1];
+    return distance <= max_edits ? distance : -1;
+}
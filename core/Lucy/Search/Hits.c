@@ -26,17 +26,21 @@
 #include "Lucy/Search/TopDocs.h"
 
 Hits*
-Hits_new(Searcher *searcher, TopDocs *top_docs, uint32_t offset) {
+Hits_new(Searcher *searcher, TopDocs *top_docs, uint32_t offset,
+         VArray *fields) {
     Hits *self = (Hits*)VTable_Make_Obj(HITS);
-    return Hits_init(self, searcher, top_docs, offset);
+    return Hits_init(self, searcher, top_docs, offset, fields);
 }
 
 Hits*
-Hits_init(Hits *self, Searcher *searcher, TopDocs *top_docs, uint32_t offset) {
+Hits_init(Hits *self, Searcher *searcher, TopDocs *top_docs, uint32_t offset,
+          VArray *fields) {
     HitsIVARS *const ivars = Hits_IVARS(self);
     ivars->searcher   = (Searcher*)INCREF(searcher);
     ivars->top_docs   = (TopDocs*)INCREF(top_docs);
     ivars->match_docs = (VArray*)INCREF(TopDocs_Get_Match_Docs(top_docs));
+    ivars->hit_docs   = NULL;
+    ivars->fields     = (VArray*)INCREF(fields);
     ivars->offset     = offset;
     return self;
 }
@@ -47,26 +51,58 @@ Hits_Destroy_IMP(Hits *self) {
     DECREF(ivars->searcher);
     DECREF(ivars->top_docs);
     DECREF(ivars->match_docs);
+    DECREF(ivars->hit_docs);
+    DECREF(ivars->fields);
     SUPER_DESTROY(self, HITS);
 }
 
+// Fetch the stored documents for all remaining hits in one batch, so that
+// the Searcher can order the reads to suit the index.
+static void
+S_fetch_hit_docs(HitsIVARS *ivars) {
+    uint32_t num_match_docs = VA_Get_Size(ivars->match_docs);
+    uint32_t num_remaining  = ivars->offset < num_match_docs
+                              ? num_match_docs - ivars->offset
+                              : 0;
+    int32_t *doc_ids
+        = (int32_t*)MALLOCATE((num_remaining + 1) * sizeof(int32_t));
+    for (uint32_t i = 0; i < num_remaining; i++) {
+        MatchDoc *match_doc
+            = (MatchDoc*)VA_Fetch(ivars->match_docs, ivars->offset + i);
+        doc_ids[i] = MatchDoc_IVARS(match_doc)->doc_id;
+    }
+    I32Array *doc_id_array = I32Arr_new_steal(doc_ids, num_remaining);
+    VArray *hit_docs = Searcher_Fetch_Docs(ivars->searcher, doc_id_array,
+                                           ivars->fields);
+    DECREF(doc_id_array);
+
+    // Index the fetched docs the same way as match_docs.
+    ivars->hit_docs = VA_new(num_match_docs);
+    for (uint32_t i = 0; i < num_remaining; i++) {
+        VA_Store(ivars->hit_docs, ivars->offset + i,
+                 INCREF(VA_Fetch(hit_docs, i)));
+    }
+    DECREF(hit_docs);
+}
+
 HitDoc*
 Hits_Next_IMP(Hits *self) {
     HitsIVARS *const ivars = Hits_IVARS(self);
     MatchDoc *match_doc = (MatchDoc*)VA_Fetch(ivars->match_docs, ivars->offset);
-    ivars->offset++;
 
     if (!match_doc) {
         /** Bail if there aren't any more *captured* hits. (There may be more
          * total hits.) */
+        ivars->offset++;
         return NULL;
     }
     else {
-        // Lazily fetch HitDoc, set score.
+        // Lazily fetch the HitDocs on the first call, set score.
         MatchDocIVARS *match_doc_ivars = MatchDoc_IVARS(match_doc);
-        HitDoc *hit_doc = Searcher_Fetch_Doc(ivars->searcher,
-                                             match_doc_ivars->doc_id);
+        if (!ivars->hit_docs) { S_fetch_hit_docs(ivars); }
+        HitDoc *hit_doc = (HitDoc*)VA_Delete(ivars->hit_docs, ivars->offset);
         HitDoc_Set_Score(hit_doc, match_doc_ivars->score);
+        ivars->offset++;
         return hit_doc;
     }
 }
@@ -77,4 +113,10 @@ Hits_Total_Hits_IMP(Hits *self) {
     return TopDocs_Get_Total_Hits(ivars->top_docs);
 }
 
+bool
+Hits_Partial_IMP(Hits *self) {
+    HitsIVARS *const ivars = Hits_IVARS(self);
+    return TopDocs_Partial(ivars->top_docs);
+}
+
 
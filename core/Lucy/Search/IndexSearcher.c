@@ -36,6 +36,7 @@
 #include "Lucy/Search/MatchDoc.h"
 #include "Lucy/Search/Matcher.h"
 #include "Lucy/Search/Query.h"
+#include "Lucy/Search/SearchBudget.h"
 #include "Lucy/Search/SortRule.h"
 #include "Lucy/Search/SortSpec.h"
 #include "Lucy/Search/TopDocs.h"
@@ -89,6 +90,22 @@ IxSearcher_Fetch_Doc_IMP(IndexSearcher *self, int32_t doc_id) {
     return DocReader_Fetch_Doc(ivars->doc_reader, doc_id);
 }
 
+VArray*
+IxSearcher_Fetch_Docs_IMP(IndexSearcher *self, I32Array *doc_ids,
+                          VArray *fields) {
+    IndexSearcherIVARS *const ivars = IxSearcher_IVARS(self);
+    if (!ivars->doc_reader) { THROW(ERR, "No DocReader"); }
+    return DocReader_Fetch_Docs(ivars->doc_reader, doc_ids, fields);
+}
+
+HitDoc*
+IxSearcher_Fetch_Doc_Fields_IMP(IndexSearcher *self, int32_t doc_id,
+                                VArray *fields) {
+    IndexSearcherIVARS *const ivars = IxSearcher_IVARS(self);
+    if (!ivars->doc_reader) { THROW(ERR, "No DocReader"); }
+    return DocReader_Fetch_Doc_Fields(ivars->doc_reader, doc_id, fields);
+}
+
 DocVector*
 IxSearcher_Fetch_Doc_Vec_IMP(IndexSearcher *self, int32_t doc_id) {
     IndexSearcherIVARS *const ivars = IxSearcher_IVARS(self);
@@ -113,15 +130,21 @@ IxSearcher_Doc_Freq_IMP(IndexSearcher *self, String *field, Obj *term) {
 
 TopDocs*
 IxSearcher_Top_Docs_IMP(IndexSearcher *self, Query *query, uint32_t num_wanted,
-                        SortSpec *sort_spec) {
+                        SortSpec *sort_spec, SearchBudget *budget) {
     Schema        *schema    = IxSearcher_Get_Schema(self);
     uint32_t       doc_max   = IxSearcher_Doc_Max(self);
     uint32_t       wanted    = num_wanted > doc_max ? doc_max : num_wanted;
     SortCollector *collector = SortColl_new(schema, sort_spec, wanted);
+    SortColl_Set_Budget(collector, budget);
     IxSearcher_Collect(self, query, (Collector*)collector);
     VArray  *match_docs = SortColl_Pop_Match_Docs(collector);
     int32_t  total_hits = SortColl_Get_Total_Hits(collector);
     TopDocs *retval     = TopDocs_new(match_docs, total_hits);
+    if (budget) {
+        TopDocs_Set_Partial(retval, SearchBudget_Expired(budget));
+        TopDocs_Set_Segments_Completed(
+            retval, SearchBudget_Get_Segments_Completed(budget));
+    }
     DECREF(collector);
     DECREF(match_docs);
     return retval;
@@ -133,6 +156,7 @@ IxSearcher_Collect_IMP(IndexSearcher *self, Query *query, Collector *collector)
     VArray   *const seg_readers = ivars->seg_readers;
     I32Array *const seg_starts  = ivars->seg_starts;
     bool      need_score        = Coll_Need_Score(collector);
+    SearchBudget *budget        = Coll_Get_Budget(collector);
     Compiler *compiler = Query_Is_A(query, COMPILER)
                          ? (Compiler*)INCREF(query)
                          : Query_Make_Compiler(query, (Searcher*)self,
@@ -140,6 +164,7 @@ IxSearcher_Collect_IMP(IndexSearcher *self, Query *query, Collector *collector)
 
     // Accumulate hits into the Collector.
     for (uint32_t i = 0, max = VA_Get_Size(seg_readers); i < max; i++) {
+        if (budget && !SearchBudget_Check(budget)) { break; }
         SegReader *seg_reader = (SegReader*)VA_Fetch(seg_readers, i);
         DeletionsReader *del_reader = (DeletionsReader*)SegReader_Fetch(
                                           seg_reader,
@@ -156,6 +181,11 @@ IxSearcher_Collect_IMP(IndexSearcher *self, Query *query, Collector *collector)
             DECREF(deletions);
             DECREF(matcher);
         }
+        if (budget) {
+            // An expired budget means Collect() bailed out mid-segment.
+            if (SearchBudget_Expired(budget)) { break; }
+            SearchBudget_Complete_Segment(budget);
+        }
     }
 
     DECREF(compiler);
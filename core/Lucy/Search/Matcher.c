@@ -20,9 +20,18 @@
 #define CHY_USE_SHORT_NAMES
 
 #include "Lucy/Search/Matcher.h"
+#include "Clownfish/CharBuf.h"
 #include "Clownfish/Err.h"
+#include "Clownfish/String.h"
 #include "Clownfish/VTable.h"
 #include "Lucy/Search/Collector.h"
+#include "Lucy/Search/SearchBudget.h"
+
+// Consult the Collector's SearchBudget once per this many iterations of the
+// scoring loop, or once the Matcher has moved this many doc ids past the
+// last check -- whichever comes first.  Every hit costs one iteration.
+#define LUCY_MATCHER_BUDGET_INTERVAL 1024
+#define LUCY_MATCHER_BUDGET_SPAN     (64 * 1024)
 
 Matcher*
 Matcher_init(Matcher *self) {
@@ -40,15 +49,69 @@ Matcher_Advance_IMP(Matcher *self, int32_t target) {
     }
 }
 
+int32_t
+Matcher_Cost_IMP(Matcher *self) {
+    CFISH_UNUSED_VAR(self);
+    return INT32_MAX;
+}
+
+String*
+Matcher_Explain_IMP(Matcher *self) {
+    CharBuf *buf = CB_new(0);
+    Matcher_Describe(self, buf, 0);
+    String *retval = CB_Yield_String(buf);
+    DECREF(buf);
+    return retval;
+}
+
+void
+Matcher_Describe_IMP(Matcher *self, CharBuf *buf, int32_t depth) {
+    // Use the last component of the class name.
+    String *class_name = Matcher_Get_Class_Name(self);
+    const char *name = Str_Get_Ptr8(class_name);
+    size_t size = Str_Get_Size(class_name);
+    size_t start = size;
+    while (start > 0 && name[start - 1] != ':') { start--; }
+
+    for (int32_t i = 0; i < depth; i++) {
+        CB_Cat_Trusted_Utf8(buf, "  ", 2);
+    }
+    CB_Cat_Trusted_Utf8(buf, name + start, size - start);
+    int32_t cost = Matcher_Cost(self);
+    if (cost == INT32_MAX) {
+        CB_Cat_Trusted_Utf8(buf, " cost=?\n", 8);
+    }
+    else {
+        CB_catf(buf, " cost=%i32\n", cost);
+    }
+}
+
 void
 Matcher_Collect_IMP(Matcher *self, Collector *collector, Matcher *deletions) {
     int32_t doc_id        = 0;
     int32_t next_deletion = deletions ? 0 : INT32_MAX;
+    SearchBudget *budget  = Coll_Get_Budget(collector);
+    uint32_t iters        = 0;
+    uint32_t hits         = 0;
+    int64_t  check_at     = LUCY_MATCHER_BUDGET_SPAN;
 
     Coll_Set_Matcher(collector, self);
 
     // Execute scoring loop.
     while (1) {
+        // Counting hits alone isn't enough: a sparse Matcher may skip over
+        // a whole segment while collecting only a handful of docs.
+        if (budget
+            && (iters >= LUCY_MATCHER_BUDGET_INTERVAL || doc_id >= check_at)
+           ) {
+            SearchBudget_Visit(budget, hits);
+            if (!SearchBudget_Check(budget)) { break; }
+            iters    = 0;
+            hits     = 0;
+            check_at = (int64_t)doc_id + LUCY_MATCHER_BUDGET_SPAN;
+        }
+        iters++;
+
         if (doc_id > next_deletion) {
             next_deletion = Matcher_Advance(deletions, doc_id);
             if (next_deletion == 0) { next_deletion = INT32_MAX; }
@@ -80,8 +143,10 @@ Matcher_Collect_IMP(Matcher *self, Collector *collector, Matcher *deletions) {
 
         if (doc_id) {
             Coll_Collect(collector, doc_id);
+            hits++;
         }
         else {
+            if (budget) { SearchBudget_Visit(budget, hits); }
             break;
         }
     }
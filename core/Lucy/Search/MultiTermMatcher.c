@@ -0,0 +1,81 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_MULTITERMMATCHER
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Search/MultiTermMatcher.h"
+
+#include "Clownfish/CharBuf.h"
+
+MultiTermMatcher*
+MultiTermMatcher_new(Matcher *child, float score) {
+    MultiTermMatcher *self
+        = (MultiTermMatcher*)VTable_Make_Obj(MULTITERMMATCHER);
+    return MultiTermMatcher_init(self, child, score);
+}
+
+MultiTermMatcher*
+MultiTermMatcher_init(MultiTermMatcher *self, Matcher *child, float score) {
+    Matcher_init((Matcher*)self);
+    MultiTermMatcherIVARS *const ivars = MultiTermMatcher_IVARS(self);
+    ivars->child = (Matcher*)INCREF(child);
+    ivars->score = score;
+    return self;
+}
+
+void
+MultiTermMatcher_Destroy_IMP(MultiTermMatcher *self) {
+    MultiTermMatcherIVARS *const ivars = MultiTermMatcher_IVARS(self);
+    DECREF(ivars->child);
+    SUPER_DESTROY(self, MULTITERMMATCHER);
+}
+
+int32_t
+MultiTermMatcher_Next_IMP(MultiTermMatcher *self) {
+    return Matcher_Next(MultiTermMatcher_IVARS(self)->child);
+}
+
+int32_t
+MultiTermMatcher_Advance_IMP(MultiTermMatcher *self, int32_t target) {
+    return Matcher_Advance(MultiTermMatcher_IVARS(self)->child, target);
+}
+
+float
+MultiTermMatcher_Score_IMP(MultiTermMatcher *self) {
+    return MultiTermMatcher_IVARS(self)->score;
+}
+
+int32_t
+MultiTermMatcher_Get_Doc_ID_IMP(MultiTermMatcher *self) {
+    return Matcher_Get_Doc_ID(MultiTermMatcher_IVARS(self)->child);
+}
+
+int32_t
+MultiTermMatcher_Cost_IMP(MultiTermMatcher *self) {
+    return Matcher_Cost(MultiTermMatcher_IVARS(self)->child);
+}
+
+void
+MultiTermMatcher_Describe_IMP(MultiTermMatcher *self, CharBuf *buf,
+                              int32_t depth) {
+    MultiTermMatcher_Describe_t super_describe
+        = SUPER_METHOD_PTR(MULTITERMMATCHER, LUCY_MultiTermMatcher_Describe);
+    super_describe(self, buf, depth);
+    Matcher_Describe(MultiTermMatcher_IVARS(self)->child, buf, depth + 1);
+}
+
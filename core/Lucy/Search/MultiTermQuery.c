@@ -0,0 +1,413 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_MULTITERMQUERY
+#define C_LUCY_MULTITERMCOMPILER
+#define C_LUCY_TERMACCEPTOR
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Search/MultiTermQuery.h"
+#include "Lucy/Index/LexiconReader.h"
+#include "Lucy/Index/PostingList.h"
+#include "Lucy/Index/PostingListReader.h"
+#include "Lucy/Index/SegLexicon.h"
+#include "Lucy/Index/SegPostingList.h"
+#include "Lucy/Index/SegReader.h"
+#include "Lucy/Index/TermInfo.h"
+#include "Lucy/Object/BitVector.h"
+#include "Lucy/Search/BitVecMatcher.h"
+#include "Lucy/Search/MultiTermMatcher.h"
+#include "Lucy/Search/ORMatcher.h"
+#include "Lucy/Search/Searcher.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/OutStream.h"
+#include "Lucy/Util/Freezer.h"
+#include "Clownfish/Util/SortUtils.h"
+
+// Segments which expand to more terms than this have their matches gathered
+// into a BitVector rather than merged through an ORMatcher's heap.
+#define MAX_MERGED_TERMS 16
+
+// A term accepted during an expansion capped by max_expansions.
+typedef struct lucy_MTQCandidate {
+    int32_t   rank;
+    uint32_t  tick;
+    TermInfo *tinfo;
+} lucy_MTQCandidate;
+
+MultiTermQuery*
+MultiTermQuery_init(MultiTermQuery *self, String *field, String *term) {
+    Query_init((Query*)self, 1.0f);
+    MultiTermQueryIVARS *const ivars = MultiTermQuery_IVARS(self);
+    ivars->field          = Str_Clone(field);
+    ivars->term           = Str_Clone(term);
+    ivars->max_expansions = 0;
+    ABSTRACT_CLASS_CHECK(self, MULTITERMQUERY);
+    return self;
+}
+
+void
+MultiTermQuery_Destroy_IMP(MultiTermQuery *self) {
+    MultiTermQueryIVARS *const ivars = MultiTermQuery_IVARS(self);
+    DECREF(ivars->field);
+    DECREF(ivars->term);
+    SUPER_DESTROY(self, MULTITERMQUERY);
+}
+
+String*
+MultiTermQuery_Get_Field_IMP(MultiTermQuery *self) {
+    return MultiTermQuery_IVARS(self)->field;
+}
+
+String*
+MultiTermQuery_Get_Term_IMP(MultiTermQuery *self) {
+    return MultiTermQuery_IVARS(self)->term;
+}
+
+void
+MultiTermQuery_Set_Max_Expansions_IMP(MultiTermQuery *self,
+                                      int32_t max_expansions) {
+    if (max_expansions < 0) {
+        THROW(ERR, "Invalid value for max_expansions: %i32", max_expansions);
+    }
+    MultiTermQuery_IVARS(self)->max_expansions = max_expansions;
+}
+
+int32_t
+MultiTermQuery_Get_Max_Expansions_IMP(MultiTermQuery *self) {
+    return MultiTermQuery_IVARS(self)->max_expansions;
+}
+
+bool
+MultiTermQuery_Equals_IMP(MultiTermQuery *self, Obj *other) {
+    if ((MultiTermQuery*)other == self)                { return true; }
+    if (!Obj_Is_A(other, MULTITERMQUERY))              { return false; }
+    if (Obj_Get_VTable(other) != MultiTermQuery_Get_VTable(self)) {
+        return false;
+    }
+    MultiTermQueryIVARS *const ivars = MultiTermQuery_IVARS(self);
+    MultiTermQueryIVARS *const ovars
+        = MultiTermQuery_IVARS((MultiTermQuery*)other);
+    if (ivars->boost != ovars->boost)                  { return false; }
+    if (!Str_Equals(ivars->field, (Obj*)ovars->field)) { return false; }
+    if (!Str_Equals(ivars->term, (Obj*)ovars->term))   { return false; }
+    if (ivars->max_expansions != ovars->max_expansions) { return false; }
+    return true;
+}
+
+void
+MultiTermQuery_Serialize_IMP(MultiTermQuery *self, OutStream *outstream) {
+    MultiTermQueryIVARS *const ivars = MultiTermQuery_IVARS(self);
+    OutStream_Write_F32(outstream, ivars->boost);
+    Freezer_serialize_string(ivars->field, outstream);
+    Freezer_serialize_string(ivars->term, outstream);
+    OutStream_Write_C32(outstream, ivars->max_expansions);
+}
+
+MultiTermQuery*
+MultiTermQuery_Deserialize_IMP(MultiTermQuery *self, InStream *instream) {
+    float   boost = InStream_Read_F32(instream);
+    String *field = Freezer_read_string(instream);
+    String *term  = Freezer_read_string(instream);
+    MultiTermQuery_init(self, field, term);
+    MultiTermQuery_IVARS(self)->max_expansions
+        = (int32_t)InStream_Read_C32(instream);
+    MultiTermQuery_Set_Boost(self, boost);
+    DECREF(term);
+    DECREF(field);
+    return self;
+}
+
+Obj*
+MultiTermQuery_Dump_IMP(MultiTermQuery *self) {
+    MultiTermQueryIVARS *ivars = MultiTermQuery_IVARS(self);
+    MultiTermQuery_Dump_t super_dump
+        = SUPER_METHOD_PTR(MULTITERMQUERY, LUCY_MultiTermQuery_Dump);
+    Hash *dump = (Hash*)CERTIFY(super_dump(self), HASH);
+    Hash_Store_Utf8(dump, "field", 5, Freezer_dump((Obj*)ivars->field));
+    Hash_Store_Utf8(dump, "term", 4, Freezer_dump((Obj*)ivars->term));
+    Hash_Store_Utf8(dump, "max_expansions", 14,
+                    (Obj*)Str_newf("%i32", ivars->max_expansions));
+    return (Obj*)dump;
+}
+
+Obj*
+MultiTermQuery_Load_IMP(MultiTermQuery *self, Obj *dump) {
+    Hash *source = (Hash*)CERTIFY(dump, HASH);
+    MultiTermQuery_Load_t super_load
+        = SUPER_METHOD_PTR(MULTITERMQUERY, LUCY_MultiTermQuery_Load);
+    MultiTermQuery *loaded = (MultiTermQuery*)super_load(self, dump);
+    MultiTermQueryIVARS *loaded_ivars = MultiTermQuery_IVARS(loaded);
+    Obj *field = CERTIFY(Hash_Fetch_Utf8(source, "field", 5), OBJ);
+    loaded_ivars->field = (String*)CERTIFY(Freezer_load(field), STRING);
+    Obj *term = CERTIFY(Hash_Fetch_Utf8(source, "term", 4), OBJ);
+    loaded_ivars->term = (String*)CERTIFY(Freezer_load(term), STRING);
+    Obj *max_expansions
+        = CERTIFY(Hash_Fetch_Utf8(source, "max_expansions", 14), OBJ);
+    loaded_ivars->max_expansions = (int32_t)Obj_To_I64(max_expansions);
+    return (Obj*)loaded;
+}
+
+TermAcceptor*
+MultiTermQuery_Make_Acceptor_IMP(MultiTermQuery *self) {
+    return TermAcceptor_new(self);
+}
+
+MultiTermCompiler*
+MultiTermQuery_Make_Compiler_IMP(MultiTermQuery *self, Searcher *searcher,
+                                 float boost, bool subordinate) {
+    MultiTermCompiler *compiler = MultiTermCompiler_new(self, searcher, boost);
+    if (!subordinate) {
+        MultiTermCompiler_Normalize(compiler);
+    }
+    return compiler;
+}
+
+/**********************************************************************/
+
+TermAcceptor*
+TermAcceptor_new(MultiTermQuery *query) {
+    TermAcceptor *self = (TermAcceptor*)VTable_Make_Obj(TERMACCEPTOR);
+    return TermAcceptor_init(self, query);
+}
+
+TermAcceptor*
+TermAcceptor_init(TermAcceptor *self, MultiTermQuery *query) {
+    TermAcceptor_IVARS(self)->query = (MultiTermQuery*)INCREF(query);
+    return self;
+}
+
+void
+TermAcceptor_Destroy_IMP(TermAcceptor *self) {
+    DECREF(TermAcceptor_IVARS(self)->query);
+    SUPER_DESTROY(self, TERMACCEPTOR);
+}
+
+int32_t
+TermAcceptor_Rank_IMP(TermAcceptor *self, String *term) {
+    return MultiTermQuery_Accept_Term(TermAcceptor_IVARS(self)->query, term)
+           ? 0
+           : -1;
+}
+
+/**********************************************************************/
+
+MultiTermCompiler*
+MultiTermCompiler_new(MultiTermQuery *parent, Searcher *searcher,
+                      float boost) {
+    MultiTermCompiler *self
+        = (MultiTermCompiler*)VTable_Make_Obj(MULTITERMCOMPILER);
+    return MultiTermCompiler_init(self, parent, searcher, boost);
+}
+
+MultiTermCompiler*
+MultiTermCompiler_init(MultiTermCompiler *self, MultiTermQuery *parent,
+                       Searcher *searcher, float boost) {
+    return (MultiTermCompiler*)Compiler_init((Compiler*)self, (Query*)parent,
+                                             searcher, NULL, boost);
+}
+
+// Order candidates, given by index, from best to worst.
+static int
+S_compare_candidates(void *context, const void *va, const void *vb) {
+    const lucy_MTQCandidate *cands = (const lucy_MTQCandidate*)context;
+    const lucy_MTQCandidate *a = cands + *(const uint32_t*)va;
+    const lucy_MTQCandidate *b = cands + *(const uint32_t*)vb;
+    if (a->rank != b->rank) { return a->rank < b->rank ? -1 : 1; }
+    return a->tick < b->tick ? -1 : a->tick > b->tick ? 1 : 0;
+}
+
+// Keep the best `max` candidates, in their original order, releasing the
+// rest.  Returns the number kept.
+static uint32_t
+S_keep_best(lucy_MTQCandidate *cands, uint32_t num_cands, uint32_t max) {
+    if (num_cands <= max) { return num_cands; }
+    uint32_t *order = (uint32_t*)MALLOCATE(num_cands * sizeof(uint32_t));
+    for (uint32_t i = 0; i < num_cands; i++) { order[i] = i; }
+    Sort_quicksort(order, num_cands, sizeof(uint32_t), S_compare_candidates,
+                   cands);
+    for (uint32_t i = max; i < num_cands; i++) {
+        DECREF(cands[order[i]].tinfo);
+        cands[order[i]].tinfo = NULL;
+    }
+    uint32_t num_kept = 0;
+    for (uint32_t i = 0; i < num_cands; i++) {
+        if (cands[i].tinfo) { cands[num_kept++] = cands[i]; }
+    }
+    FREEMEM(order);
+    return num_kept;
+}
+
+// Walk the segment's lexicon from the literal prefix, collecting the
+// TermInfos of accepted terms.  Returns NULL if the field has no lexicon.
+//
+// When the expansion is capped, candidates are buffered along with their
+// rank and trimmed to the best `max_expansions` whenever the buffer holds
+// twice that many.  The walk ends early once `max_expansions` terms of rank
+// 0 have turned up, since nothing later can displace them.
+static VArray*
+S_expand(MultiTermQuery *query, TermAcceptor *acceptor,
+         LexiconReader *lex_reader) {
+    MultiTermQueryIVARS *const qvars = MultiTermQuery_IVARS(query);
+    String  *prefix  = MultiTermQuery_Literal_Prefix(query);
+    Lexicon *lexicon = LexReader_Lexicon(lex_reader, qvars->field,
+                                         Str_Get_Size(prefix)
+                                         ? (Obj*)prefix : NULL);
+    if (!lexicon) {
+        DECREF(prefix);
+        return NULL;
+    }
+
+    // A seek leaves the Lexicon on the first term ge the prefix; a reset
+    // leaves it before the first term.
+    const uint32_t max = qvars->max_expansions
+                         ? (uint32_t)qvars->max_expansions
+                         : UINT32_MAX;
+    const uint32_t trim_at = max <= UINT32_MAX / 2 ? max * 2 : UINT32_MAX;
+    lucy_MTQCandidate *cands = NULL;
+    uint32_t num_cands = 0;
+    uint32_t cands_cap = 0;
+    uint32_t num_best  = 0;
+    uint32_t tick      = 0;
+    bool has_term = Str_Get_Size(prefix)
+                    ? Lex_Get_Term(lexicon) != NULL
+                    : Lex_Next(lexicon);
+    for (; has_term && num_best < max;
+         has_term = Lex_Next(lexicon), tick++
+        ) {
+        String *term = (String*)Lex_Get_Term(lexicon);
+        if (!Obj_Is_A((Obj*)term, STRING))      { break; }
+        if (!Str_Starts_With(term, prefix))      { break; }
+        int32_t rank = TermAcceptor_Rank(acceptor, term);
+        if (rank < 0) { continue; }
+        TermInfo *tinfo = Obj_Is_A((Obj*)lexicon, SEGLEXICON)
+                          ? SegLex_Get_Term_Info((SegLexicon*)lexicon)
+                          : NULL;
+        if (!tinfo) { continue; }
+
+        if (num_cands == trim_at) {
+            num_cands = S_keep_best(cands, num_cands, max);
+        }
+        if (num_cands == cands_cap) {
+            cands_cap = cands_cap ? cands_cap * 2 : 16;
+            cands = (lucy_MTQCandidate*)REALLOCATE(
+                        cands, cands_cap * sizeof(lucy_MTQCandidate));
+        }
+        cands[num_cands].rank  = rank;
+        cands[num_cands].tick  = tick;
+        cands[num_cands].tinfo = TInfo_Clone(tinfo);
+        num_cands++;
+        if (rank == 0) { num_best++; }
+    }
+
+    num_cands = S_keep_best(cands, num_cands, max);
+    VArray *tinfos = VA_new(num_cands);
+    for (uint32_t i = 0; i < num_cands; i++) {
+        VA_Push(tinfos, (Obj*)cands[i].tinfo);
+    }
+    FREEMEM(cands);
+    DECREF(lexicon);
+    DECREF(prefix);
+    return tinfos;
+}
+
+static PostingList*
+S_posting_list(PostingListReader *plist_reader, String *field,
+               TermInfo *tinfo) {
+    PostingList *plist
+        = PListReader_Posting_List(plist_reader, field, NULL);
+    if (plist && !Obj_Is_A((Obj*)plist, SEGPOSTINGLIST)) {
+        THROW(ERR, "Unsupported PostingList class: %o",
+              Obj_Get_Class_Name((Obj*)plist));
+    }
+    if (plist) {
+        SegPList_Seek_Term_Info((SegPostingList*)plist, tinfo);
+    }
+    return plist;
+}
+
+Matcher*
+MultiTermCompiler_Make_Matcher_IMP(MultiTermCompiler *self, SegReader *reader,
+                                   bool need_score) {
+    MultiTermCompilerIVARS *const ivars = MultiTermCompiler_IVARS(self);
+    MultiTermQuery *parent = (MultiTermQuery*)ivars->parent;
+    String *field = MultiTermQuery_IVARS(parent)->field;
+    LexiconReader *lex_reader
+        = (LexiconReader*)SegReader_Fetch(reader,
+                                          VTable_Get_Name(LEXICONREADER));
+    PostingListReader *plist_reader
+        = (PostingListReader*)SegReader_Fetch(
+              reader, VTable_Get_Name(POSTINGLISTREADER));
+    UNUSED_VAR(need_score);
+    if (!lex_reader || !plist_reader) { return NULL; }
+
+    // Each expansion gets its own acceptor, so that any state it keeps
+    // while walking the lexicon stays out of the query.
+    TermAcceptor *acceptor = MultiTermQuery_Make_Acceptor(parent);
+    VArray *tinfos = S_expand(parent, acceptor, lex_reader);
+    DECREF(acceptor);
+    if (!tinfos) { return NULL; }
+    const uint32_t num_terms = VA_Get_Size(tinfos);
+    Matcher *child = NULL;
+
+    if (num_terms == 0) {
+        child = NULL;
+    }
+    else if (num_terms == 1) {
+        TermInfo *tinfo = (TermInfo*)VA_Fetch(tinfos, 0);
+        child = (Matcher*)S_posting_list(plist_reader, field, tinfo);
+    }
+    else if (num_terms <= MAX_MERGED_TERMS) {
+        VArray *plists = VA_new(num_terms);
+        for (uint32_t i = 0; i < num_terms; i++) {
+            TermInfo *tinfo = (TermInfo*)VA_Fetch(tinfos, i);
+            PostingList *plist = S_posting_list(plist_reader, field, tinfo);
+            if (plist) { VA_Push(plists, (Obj*)plist); }
+        }
+        child = VA_Get_Size(plists)
+                ? (Matcher*)ORMatcher_new(plists)
+                : NULL;
+        DECREF(plists);
+    }
+    else {
+        // Reuse a single PostingList, repositioning it for each term.
+        PostingList *plist = PListReader_Posting_List(plist_reader, field,
+                                                      NULL);
+        if (plist && Obj_Is_A((Obj*)plist, SEGPOSTINGLIST)) {
+            BitVector *bit_vec = BitVec_new(SegReader_Doc_Max(reader) + 1);
+            for (uint32_t i = 0; i < num_terms; i++) {
+                TermInfo *tinfo = (TermInfo*)VA_Fetch(tinfos, i);
+                SegPList_Seek_Term_Info((SegPostingList*)plist, tinfo);
+                int32_t doc_id;
+                while (0 != (doc_id = PList_Next(plist))) {
+                    BitVec_Set(bit_vec, (uint32_t)doc_id);
+                }
+            }
+            child = (Matcher*)BitVecMatcher_new(bit_vec);
+            DECREF(bit_vec);
+        }
+        DECREF(plist);
+    }
+    DECREF(tinfos);
+
+    if (!child) { return NULL; }
+    Matcher *matcher = (Matcher*)MultiTermMatcher_new(
+                           child, MultiTermCompiler_Get_Weight(self));
+    DECREF(child);
+    return matcher;
+}
+
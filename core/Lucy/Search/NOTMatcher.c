@@ -99,4 +99,13 @@ NOTMatcher_Score_IMP(NOTMatcher *self) {
     return 0.0f;
 }
 
+int32_t
+NOTMatcher_Cost_IMP(NOTMatcher *self) {
+    NOTMatcherIVARS *const ivars = NOTMatcher_IVARS(self);
+    int32_t negated = Matcher_Cost(ivars->negated_matcher);
+    // The negated cost is only an estimate -- overlapping clauses inflate
+    // it -- so never claim that nothing can match.
+    if (ivars->doc_max == 0) { return 0; }
+    return negated >= ivars->doc_max ? 1 : ivars->doc_max - negated;
+}
 
@@ -46,4 +46,9 @@ NoMatchMatcher_Advance_IMP(NoMatchMatcher* self, int32_t target) {
     return 0;
 }
 
+int32_t
+NoMatchMatcher_Cost_IMP(NoMatchMatcher* self) {
+    UNUSED_VAR(self);
+    return 0;
+}
 
@@ -23,6 +23,9 @@
 #include "Clownfish/CharBuf.h"
 #include "Lucy/Index/SegReader.h"
 #include "Lucy/Index/Similarity.h"
+#include "Lucy/Object/BitVector.h"
+#include "Lucy/Search/BitVecMatcher.h"
+#include "Lucy/Search/NoMatchMatcher.h"
 #include "Lucy/Search/ORMatcher.h"
 #include "Lucy/Search/Searcher.h"
 #include "Lucy/Store/InStream.h"
@@ -99,6 +102,90 @@ ORCompiler_init(ORCompiler *self, ORQuery *parent, Searcher *searcher,
     return self;
 }
 
+// A union of at least this many clauses whose combined cost covers at least
+// 1/DENSE_UNION_RATIO of the segment is materialized into a bitset.
+#define MIN_BITSET_CLAUSES 3
+#define DENSE_UNION_RATIO  8
+
+// Gather the compilers for a disjunction, splicing in the children of any
+// nested ORCompilers.
+static void
+S_flatten_or(ORCompiler *self, VArray *compilers) {
+    VArray *children = ORCompiler_IVARS(self)->children;
+    for (uint32_t i = 0, max = VA_Get_Size(children); i < max; i++) {
+        Compiler *child = (Compiler*)VA_Fetch(children, i);
+        if (Compiler_Get_VTable(child) == ORCOMPILER) {
+            S_flatten_or((ORCompiler*)child, compilers);
+        }
+        else {
+            VA_Push(compilers, INCREF(child));
+        }
+    }
+}
+
+// Iterate through every sub-matcher once, recording matches in a BitVector.
+static Matcher*
+S_materialize(VArray *submatchers, int32_t doc_max) {
+    BitVector *bit_vec = BitVec_new((uint32_t)doc_max + 1);
+    for (uint32_t i = 0, max = VA_Get_Size(submatchers); i < max; i++) {
+        Matcher *submatcher = (Matcher*)VA_Fetch(submatchers, i);
+        int32_t doc_id;
+        while (0 != (doc_id = Matcher_Next(submatcher))) {
+            BitVec_Set(bit_vec, (uint32_t)doc_id);
+        }
+    }
+    Matcher *retval = (Matcher*)BitVecMatcher_new(bit_vec);
+    DECREF(bit_vec);
+    return retval;
+}
+
+// Plan a disjunction whose matches need not be scored: nested unions are
+// flattened, clauses which cannot match in this segment are dropped, and
+// dense unions are converted into a bitset filter.
+static Matcher*
+S_make_match_only(ORCompiler *self, SegReader *reader) {
+    VArray *compilers = VA_new(0);
+    S_flatten_or(self, compilers);
+    uint32_t num_kids    = VA_Get_Size(compilers);
+    VArray  *submatchers = VA_new(num_kids);
+    int64_t  total_cost  = 0;
+
+    for (uint32_t i = 0; i < num_kids; i++) {
+        Compiler *child = (Compiler*)VA_Fetch(compilers, i);
+        Matcher *submatcher = Compiler_Make_Matcher(child, reader, false);
+        if (submatcher == NULL) { continue; }
+        // Cost() is only an estimate, so drop only clauses which provably
+        // cannot match.
+        if (Matcher_Get_VTable(submatcher) == NOMATCHMATCHER) {
+            DECREF(submatcher);
+            continue;
+        }
+        total_cost += Matcher_Cost(submatcher);
+        VA_Push(submatchers, (Obj*)submatcher);
+    }
+    DECREF(compilers);
+
+    Matcher *retval;
+    uint32_t num_submatchers = VA_Get_Size(submatchers);
+    int32_t  doc_max         = SegReader_Doc_Max(reader);
+    if (num_submatchers == 0) {
+        retval = NULL;
+    }
+    else if (num_submatchers == 1) {
+        retval = (Matcher*)INCREF(VA_Fetch(submatchers, 0));
+    }
+    else if (num_submatchers >= MIN_BITSET_CLAUSES
+             && total_cost >= doc_max / DENSE_UNION_RATIO
+            ) {
+        retval = S_materialize(submatchers, doc_max);
+    }
+    else {
+        retval = (Matcher*)ORMatcher_new(submatchers);
+    }
+    DECREF(submatchers);
+    return retval;
+}
+
 Matcher*
 ORCompiler_Make_Matcher_IMP(ORCompiler *self, SegReader *reader,
                             bool need_score) {
@@ -110,11 +197,15 @@ ORCompiler_Make_Matcher_IMP(ORCompiler *self, SegReader *reader,
         Compiler *only_child = (Compiler*)VA_Fetch(ivars->children, 0);
         return Compiler_Make_Matcher(only_child, reader, need_score);
     }
+    else if (!need_score) {
+        return S_make_match_only(self, reader);
+    }
     else {
         VArray *submatchers = VA_new(num_kids);
         uint32_t num_submatchers = 0;
 
-        // Accumulate sub-matchers.
+        // Accumulate sub-matchers.  Keep NULL placeholders, since the total
+        // number of clauses feeds into the coordination factor.
         for (uint32_t i = 0; i < num_kids; i++) {
             Compiler *child = (Compiler*)VA_Fetch(ivars->children, i);
             Matcher *submatcher
@@ -132,9 +223,7 @@ ORCompiler_Make_Matcher_IMP(ORCompiler *self, SegReader *reader,
         }
         else {
             Similarity *sim    = ORCompiler_Get_Similarity(self);
-            Matcher    *retval = need_score
-                                 ? (Matcher*)ORScorer_new(submatchers, sim)
-                                 : (Matcher*)ORMatcher_new(submatchers);
+            Matcher    *retval = (Matcher*)ORScorer_new(submatchers, sim);
             DECREF(submatchers);
             return retval;
         }
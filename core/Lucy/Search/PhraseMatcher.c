@@ -19,6 +19,10 @@
 #define C_LUCY_SCOREPOSTING
 #include "Lucy/Util/ToolSet.h"
 
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+
 #include "Lucy/Search/PhraseMatcher.h"
 #include "Lucy/Index/Posting/ScorePosting.h"
 #include "Lucy/Index/PostingList.h"
@@ -243,6 +247,91 @@ DONE:
     return anchors_found - anchors_start;
 }
 
+#if defined(__SSE2__)
+
+/* Block-wise variant of SI_winnow_anchors.  Four anchors (adjusted by the
+ * offset) are compared against four candidates at once by comparing against
+ * each rotation of the candidate block, accumulating a bitmask of anchors
+ * which found a partner.  Whichever block has the lower maximum is then
+ * moved forward; because the anchor block is moved on ties, duplicate
+ * positions are handled the same way as by the scalar loop.  Leftovers
+ * which don't fill a block are finished one at a time.
+ */
+static CFISH_INLINE uint32_t
+SI_winnow_anchors_sse2(uint32_t *anchors_start,
+                       const uint32_t *const anchors_end,
+                       const uint32_t *candidates,
+                       const uint32_t *const candidates_end,
+                       uint32_t offset) {
+    uint32_t *anchors       = anchors_start;
+    uint32_t *anchors_found = anchors_start;
+    const __m128i offsets   = _mm_set1_epi32((int)offset);
+    int       mask          = 0;
+
+    while (anchors_end - anchors >= 4 && candidates_end - candidates >= 4) {
+        const __m128i a = _mm_add_epi32(
+            _mm_loadu_si128((const __m128i*)anchors), offsets);
+        const __m128i c0 = _mm_loadu_si128((const __m128i*)candidates);
+        const __m128i c1 = _mm_shuffle_epi32(c0, _MM_SHUFFLE(0, 3, 2, 1));
+        const __m128i c2 = _mm_shuffle_epi32(c0, _MM_SHUFFLE(1, 0, 3, 2));
+        const __m128i c3 = _mm_shuffle_epi32(c0, _MM_SHUFFLE(2, 1, 0, 3));
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(a, c0), _mm_cmpeq_epi32(a, c1)),
+            _mm_or_si128(_mm_cmpeq_epi32(a, c2), _mm_cmpeq_epi32(a, c3)));
+        mask |= _mm_movemask_ps(_mm_castsi128_ps(hits));
+
+        if (anchors[3] + offset <= candidates[3]) {
+            // Keep the anchors which matched, then move on.
+            for (int i = 0; i < 4; i++) {
+                if (mask & (1 << i)) { *anchors_found++ = anchors[i]; }
+            }
+            anchors += 4;
+            mask = 0;
+        }
+        else {
+            candidates += 4;
+        }
+    }
+
+    // Finish up.  Anchors in the current block may already have matched.
+    for (int i = 0; anchors < anchors_end; anchors++, i++) {
+        const uint32_t target = *anchors + offset;
+        while (candidates < candidates_end && *candidates < target) {
+            candidates++;
+        }
+        if ((i < 4 && (mask & (1 << i)))
+            || (candidates < candidates_end && *candidates == target)
+           ) {
+            *anchors_found++ = *anchors;
+        }
+        else if (i >= 4 && candidates == candidates_end) {
+            break;
+        }
+    }
+
+    return anchors_found - anchors_start;
+}
+
+#endif // __SSE2__
+
+// Splice out anchors that aren't followed by a candidate <code>offset</code>
+// positions later.
+static CFISH_INLINE uint32_t
+SI_winnow(uint32_t *anchors_start, const uint32_t *const anchors_end,
+          const uint32_t *candidates, const uint32_t *const candidates_end,
+          uint32_t offset) {
+#if defined(__SSE2__)
+    if (anchors_end - anchors_start >= 4
+        && candidates_end - candidates >= 4
+       ) {
+        return SI_winnow_anchors_sse2(anchors_start, anchors_end,
+                                      candidates, candidates_end, offset);
+    }
+#endif
+    return SI_winnow_anchors(anchors_start, anchors_end, candidates,
+                             candidates_end, offset);
+}
+
 float
 PhraseMatcher_Calc_Phrase_Freq_IMP(PhraseMatcher *self) {
     PhraseMatcherIVARS *const ivars = PhraseMatcher_IVARS(self);
@@ -275,7 +364,7 @@ PhraseMatcher_Calc_Phrase_Freq_IMP(PhraseMatcher *self) {
     size_t    amount        = anchors_remaining * sizeof(uint32_t);
     uint32_t *anchors_start = (uint32_t*)BB_Grow(ivars->anchor_set, amount);
     uint32_t *anchors_end   = anchors_start + anchors_remaining;
-    memcpy(anchors_start, post_ivars->prox, amount);
+    memcpy(anchors_start, ScorePost_Get_Prox(posting), amount);
 
     // Match the positions of other terms against the anchor set.
     for (uint32_t i = 1, max = ivars->num_elements; i < max; i++) {
@@ -283,14 +372,14 @@ PhraseMatcher_Calc_Phrase_Freq_IMP(PhraseMatcher *self) {
         // set (which is a copy), these won't be overwritten.
         ScorePosting *next_post = (ScorePosting*)PList_Get_Posting(plists[i]);
         ScorePostingIVARS *const next_post_ivars = ScorePost_IVARS(next_post);
-        uint32_t *candidates_start = next_post_ivars->prox;
+        uint32_t *candidates_start = ScorePost_Get_Prox(next_post);
         uint32_t *candidates_end   = candidates_start + next_post_ivars->freq;
 
         // Splice out anchors that don't match the next term.  Bail out if
         // we've eliminated all possible anchors.
         anchors_remaining
-            = SI_winnow_anchors(anchors_start, anchors_end,
-                                candidates_start, candidates_end, i);
+            = SI_winnow(anchors_start, anchors_end,
+                        candidates_start, candidates_end, i);
         if (!anchors_remaining) { return 0.0f; }
 
         // Adjust end for number of anchors that remain.
@@ -316,4 +405,14 @@ PhraseMatcher_Score_IMP(PhraseMatcher *self) {
     return score;
 }
 
+int32_t
+PhraseMatcher_Cost_IMP(PhraseMatcher *self) {
+    PhraseMatcherIVARS *const ivars = PhraseMatcher_IVARS(self);
+    uint32_t cost = ivars->num_elements ? UINT32_MAX : 0;
+    for (uint32_t i = 0; i < ivars->num_elements; i++) {
+        uint32_t doc_freq = PList_Get_Doc_Freq(ivars->plists[i]);
+        if (doc_freq < cost) { cost = doc_freq; }
+    }
+    return cost > INT32_MAX ? INT32_MAX : (int32_t)cost;
+}
 
@@ -29,13 +29,16 @@
 #include "Lucy/Index/PostingListReader.h"
 #include "Lucy/Index/SegPostingList.h"
 #include "Lucy/Index/SegReader.h"
+#include "Lucy/Index/Segment.h"
 #include "Lucy/Index/Similarity.h"
 #include "Lucy/Index/TermVector.h"
+#include "Lucy/Plan/FullTextType.h"
 #include "Lucy/Plan/Schema.h"
 #include "Lucy/Search/PhraseMatcher.h"
 #include "Lucy/Search/Searcher.h"
 #include "Lucy/Search/Span.h"
 #include "Lucy/Search/TermQuery.h"
+#include "Lucy/Search/TermStateCache.h"
 #include "Lucy/Store/InStream.h"
 #include "Lucy/Store/OutStream.h"
 #include "Lucy/Util/Freezer.h"
@@ -215,12 +218,20 @@ PhraseCompiler_init(PhraseCompiler *self, PhraseQuery *parent,
     // Init.
     Compiler_init((Compiler*)self, (Query*)parent, searcher, sim, boost);
 
-    // Store IDF for the phrase.
+    // Store IDF for the phrase, keeping each term's per-segment lookups for
+    // Make_Matcher().
     ivars->idf = 0;
+    ivars->term_states = VA_new(VA_Get_Size(terms));
     for (uint32_t i = 0, max = VA_Get_Size(terms); i < max; i++) {
         Obj     *term     = VA_Fetch(terms, i);
         int32_t  doc_max  = Searcher_Doc_Max(searcher);
-        int32_t  doc_freq = Searcher_Doc_Freq(searcher, parent_ivars->field, term);
+        TermStateCache *states
+            = TermStateCache_gather(searcher, parent_ivars->field, term);
+        int32_t  doc_freq = states
+                            ? TermStateCache_Get_Doc_Freq(states)
+                            : Searcher_Doc_Freq(searcher, parent_ivars->field,
+                                                term);
+        VA_Store(ivars->term_states, i, (Obj*)states);
         ivars->idf += Sim_IDF(sim, doc_freq, doc_max);
     }
 
@@ -230,6 +241,13 @@ PhraseCompiler_init(PhraseCompiler *self, PhraseQuery *parent,
     return self;
 }
 
+void
+PhraseCompiler_Destroy_IMP(PhraseCompiler *self) {
+    PhraseCompilerIVARS *const ivars = PhraseCompiler_IVARS(self);
+    DECREF(ivars->term_states);
+    SUPER_DESTROY(self, PHRASECOMPILER);
+}
+
 void
 PhraseCompiler_Serialize_IMP(PhraseCompiler *self, OutStream *outstream) {
     PhraseCompilerIVARS *const ivars = PhraseCompiler_IVARS(self);
@@ -291,6 +309,64 @@ PhraseCompiler_Apply_Norm_Factor_IMP(PhraseCompiler *self, float factor) {
     ivars->normalized_weight = ivars->raw_weight * ivars->idf * factor;
 }
 
+// If the field has a shingle field in this segment, look up the posting
+// lists for the phrase's N-1 shingles, which occur at consecutive positions
+// wherever the phrase does, and return true.  <code>plists</code> is set to
+// NULL if any shingle is missing.  Return false if there is no shingle field
+// or the phrase is too short to use it.
+static bool
+S_shingle_plists(PhraseCompiler *self, SegReader *reader,
+                 PostingListReader *plist_reader, VArray **plists) {
+    PhraseCompilerIVARS *const ivars = PhraseCompiler_IVARS(self);
+    PhraseQueryIVARS *const parent_ivars
+        = PhraseQuery_IVARS((PhraseQuery*)ivars->parent);
+    VArray *const  terms     = parent_ivars->terms;
+    const uint32_t num_terms = VA_Get_Size(terms);
+    if (num_terms < 2) { return false; }
+
+    Schema    *schema = SegReader_Get_Schema(reader);
+    FieldType *type   = Schema_Fetch_Type(schema, parent_ivars->field);
+    if (!type
+        || !FType_Is_A(type, FULLTEXTTYPE)
+        || !FullTextType_Shingles((FullTextType*)type)
+       ) {
+        return false;
+    }
+    for (uint32_t i = 0; i < num_terms; i++) {
+        if (!Obj_Is_A(VA_Fetch(terms, i), STRING)) { return false; }
+    }
+    String *shingle_field = FullTextType_shingle_field(parent_ivars->field);
+    if (!Seg_Field_Num(SegReader_Get_Segment(reader), shingle_field)) {
+        DECREF(shingle_field);
+        return false;
+    }
+
+    *plists = VA_new(num_terms - 1);
+    for (uint32_t i = 0; i + 1 < num_terms; i++) {
+        String *first  = (String*)VA_Fetch(terms, i);
+        String *second = (String*)VA_Fetch(terms, i + 1);
+        String *shingle
+            = FullTextType_shingle_text(Str_Get_Ptr8(first),
+                                        Str_Get_Size(first),
+                                        Str_Get_Ptr8(second),
+                                        Str_Get_Size(second));
+        PostingList *plist
+            = PListReader_Posting_List(plist_reader, shingle_field,
+                                       (Obj*)shingle);
+        DECREF(shingle);
+        if (!plist || !PList_Get_Doc_Freq(plist)) {
+            DECREF(plist);
+            DECREF(*plists);
+            *plists = NULL;
+            break;
+        }
+        VA_Push(*plists, (Obj*)plist);
+    }
+
+    DECREF(shingle_field);
+    return true;
+}
+
 Matcher*
 PhraseCompiler_Make_Matcher_IMP(PhraseCompiler *self, SegReader *reader,
                                 bool need_score) {
@@ -319,12 +395,29 @@ PhraseCompiler_Make_Matcher_IMP(PhraseCompiler *self, SegReader *reader,
               reader, VTable_Get_Name(POSTINGLISTREADER));
     if (!plist_reader) { return NULL; }
 
+    // Phrases can be matched against the shingle field if there is one.
+    VArray *plists = NULL;
+    if (S_shingle_plists(self, reader, plist_reader, &plists)) {
+        if (!plists) { return NULL; }
+        Matcher *retval
+            = (Matcher*)PhraseMatcher_new(sim, plists, (Compiler*)self);
+        DECREF(plists);
+        return retval;
+    }
+
     // Look up each term.
-    VArray  *plists = VA_new(num_terms);
+    plists = VA_new(num_terms);
     for (uint32_t i = 0; i < num_terms; i++) {
         Obj *term = VA_Fetch(terms, i);
+        TermStateCache *states
+            = ivars->term_states
+              ? (TermStateCache*)VA_Fetch(ivars->term_states, i)
+              : NULL;
         PostingList *plist
-            = PListReader_Posting_List(plist_reader, parent_ivars->field, term);
+            = states
+              ? TermStateCache_Posting_List(states, reader)
+              : PListReader_Posting_List(plist_reader, parent_ivars->field,
+                                         term);
 
         // Bail if any one of the terms isn't in the index.
         if (!plist || !PList_Get_Doc_Freq(plist)) {
@@ -18,6 +18,7 @@
 #include "Lucy/Util/ToolSet.h"
 
 #include "Lucy/Search/PolyMatcher.h"
+#include "Clownfish/CharBuf.h"
 #include "Lucy/Index/Similarity.h"
 
 PolyMatcher*
@@ -51,4 +52,26 @@ PolyMatcher_Destroy_IMP(PolyMatcher *self) {
     SUPER_DESTROY(self, POLYMATCHER);
 }
 
+int32_t
+PolyMatcher_Cost_IMP(PolyMatcher *self) {
+    PolyMatcherIVARS *const ivars = PolyMatcher_IVARS(self);
+    int64_t cost = 0;
+    for (uint32_t i = 0; i < ivars->num_kids; i++) {
+        Matcher *child = (Matcher*)VA_Fetch(ivars->children, i);
+        if (child) { cost += Matcher_Cost(child); }
+    }
+    return cost > INT32_MAX ? INT32_MAX : (int32_t)cost;
+}
+
+void
+PolyMatcher_Describe_IMP(PolyMatcher *self, CharBuf *buf, int32_t depth) {
+    PolyMatcherIVARS *const ivars = PolyMatcher_IVARS(self);
+    PolyMatcher_Describe_t super_describe
+        = SUPER_METHOD_PTR(POLYMATCHER, LUCY_PolyMatcher_Describe);
+    super_describe(self, buf, depth);
+    for (uint32_t i = 0; i < ivars->num_kids; i++) {
+        Matcher *child = (Matcher*)VA_Fetch(ivars->children, i);
+        if (child) { Matcher_Describe(child, buf, depth + 1); }
+    }
+}
 
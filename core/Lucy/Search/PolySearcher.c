@@ -28,11 +28,18 @@
 #include "Lucy/Search/Query.h"
 #include "Lucy/Search/MatchDoc.h"
 #include "Lucy/Search/Matcher.h"
+#include "Lucy/Search/SearchBudget.h"
 #include "Lucy/Search/Searcher.h"
 #include "Lucy/Search/SortSpec.h"
 #include "Lucy/Search/TopDocs.h"
 #include "Lucy/Search/Compiler.h"
 
+PolySearcher*
+PolySearcher_new(Schema *schema, VArray *searchers) {
+    PolySearcher *self = (PolySearcher*)VTable_Make_Obj(POLYSEARCHER);
+    return PolySearcher_init(self, schema, searchers);
+}
+
 PolySearcher*
 PolySearcher_init(PolySearcher *self, Schema *schema, VArray *searchers) {
     const uint32_t num_searchers = VA_Get_Size(searchers);
@@ -89,6 +96,33 @@ PolySearcher_Fetch_Doc_IMP(PolySearcher *self, int32_t doc_id) {
     return hit_doc;
 }
 
+HitDoc*
+PolySearcher_Fetch_Doc_Fields_IMP(PolySearcher *self, int32_t doc_id,
+                                  VArray *fields) {
+    PolySearcherIVARS *const ivars = PolySearcher_IVARS(self);
+    uint32_t  tick     = PolyReader_sub_tick(ivars->starts, doc_id);
+    Searcher *searcher = (Searcher*)VA_Fetch(ivars->searchers, tick);
+    int32_t   offset   = I32Arr_Get(ivars->starts, tick);
+    if (!searcher) { THROW(ERR, "Invalid doc id: %i32", doc_id); }
+    HitDoc *hit_doc
+        = Searcher_Fetch_Doc_Fields(searcher, doc_id - offset, fields);
+    HitDoc_Set_Doc_ID(hit_doc, doc_id);
+    return hit_doc;
+}
+
+static VArray*
+S_fetch_sub_docs(Obj *searcher, I32Array *doc_ids, VArray *fields) {
+    return Searcher_Fetch_Docs((Searcher*)searcher, doc_ids, fields);
+}
+
+VArray*
+PolySearcher_Fetch_Docs_IMP(PolySearcher *self, I32Array *doc_ids,
+                            VArray *fields) {
+    PolySearcherIVARS *const ivars = PolySearcher_IVARS(self);
+    return PolyReader_fetch_docs(ivars->starts, ivars->searchers, doc_ids,
+                                 fields, S_fetch_sub_docs);
+}
+
 DocVector*
 PolySearcher_Fetch_Doc_Vec_IMP(PolySearcher *self, int32_t doc_id) {
     PolySearcherIVARS *const ivars = PolySearcher_IVARS(self);
@@ -126,7 +160,8 @@ S_modify_doc_ids(VArray *match_docs, int32_t base) {
 
 TopDocs*
 PolySearcher_Top_Docs_IMP(PolySearcher *self, Query *query,
-                          uint32_t num_wanted, SortSpec *sort_spec) {
+                          uint32_t num_wanted, SortSpec *sort_spec,
+                          SearchBudget *budget) {
     PolySearcherIVARS *const ivars = PolySearcher_IVARS(self);
     Schema   *schema      = PolySearcher_Get_Schema(self);
     VArray   *searchers   = ivars->searchers;
@@ -142,10 +177,12 @@ PolySearcher_Top_Docs_IMP(PolySearcher *self, Query *query,
                                                   false);
 
     for (uint32_t i = 0, max = VA_Get_Size(searchers); i < max; i++) {
+        if (budget && !SearchBudget_Check(budget)) { break; }
         Searcher   *searcher   = (Searcher*)VA_Fetch(searchers, i);
         int32_t     base       = I32Arr_Get(starts, i);
         TopDocs    *top_docs   = Searcher_Top_Docs(searcher, (Query*)compiler,
-                                                   num_wanted, sort_spec);
+                                                   num_wanted, sort_spec,
+                                                   budget);
         VArray     *sub_match_docs = TopDocs_Get_Match_Docs(top_docs);
 
         total_hits += TopDocs_Get_Total_Hits(top_docs);
@@ -161,6 +198,11 @@ PolySearcher_Top_Docs_IMP(PolySearcher *self, Query *query,
 
     VArray  *match_docs = HitQ_Pop_All(hit_q);
     TopDocs *retval     = TopDocs_new(match_docs, total_hits);
+    if (budget) {
+        TopDocs_Set_Partial(retval, SearchBudget_Expired(budget));
+        TopDocs_Set_Segments_Completed(
+            retval, SearchBudget_Get_Segments_Completed(budget));
+    }
 
     DECREF(match_docs);
     DECREF(compiler);
@@ -175,8 +217,10 @@ PolySearcher_Collect_IMP(PolySearcher *self, Query *query,
     PolySearcherIVARS *const ivars = PolySearcher_IVARS(self);
     VArray *const searchers = ivars->searchers;
     I32Array *starts = ivars->starts;
+    SearchBudget *budget = Coll_Get_Budget(collector);
 
     for (uint32_t i = 0, max = VA_Get_Size(searchers); i < max; i++) {
+        if (budget && !SearchBudget_Check(budget)) { break; }
         int32_t start = I32Arr_Get(starts, i);
         Searcher *searcher = (Searcher*)VA_Fetch(searchers, i);
         OffsetCollector *offset_coll = OffsetColl_new(collector, start);
@@ -0,0 +1,52 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_PREFIXQUERY
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Search/PrefixQuery.h"
+
+PrefixQuery*
+PrefixQuery_new(String *field, String *prefix) {
+    PrefixQuery *self = (PrefixQuery*)VTable_Make_Obj(PREFIXQUERY);
+    return PrefixQuery_init(self, field, prefix);
+}
+
+PrefixQuery*
+PrefixQuery_init(PrefixQuery *self, String *field, String *prefix) {
+    return (PrefixQuery*)MultiTermQuery_init((MultiTermQuery*)self, field,
+                                             prefix);
+}
+
+String*
+PrefixQuery_Literal_Prefix_IMP(PrefixQuery *self) {
+    return (String*)INCREF(PrefixQuery_IVARS(self)->term);
+}
+
+bool
+PrefixQuery_Accept_Term_IMP(PrefixQuery *self, String *term) {
+    UNUSED_VAR(self);
+    UNUSED_VAR(term);
+    return true;
+}
+
+String*
+PrefixQuery_To_String_IMP(PrefixQuery *self) {
+    PrefixQueryIVARS *const ivars = PrefixQuery_IVARS(self);
+    return Str_newf("%o:%o*", ivars->field, ivars->term);
+}
+
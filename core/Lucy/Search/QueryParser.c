@@ -132,7 +132,9 @@ QParser_init(QueryParser *self, Schema *schema, Analyzer *analyzer,
         for (uint32_t i = 0; i < num_fields; i++) {
             String *field = (String*)VA_Fetch(all_fields, i);
             FieldType *type = Schema_Fetch_Type(schema, field);
-            if (type && FType_Indexed(type)) {
+            if (type && FType_Indexed(type)
+                && !Schema_Hidden_Field(schema, field)
+               ) {
                 VA_Push(ivars->fields, INCREF(field));
             }
         }
@@ -94,4 +94,17 @@ RangeMatcher_Get_Doc_ID_IMP(RangeMatcher* self) {
     return RangeMatcher_IVARS(self)->doc_id;
 }
 
+int32_t
+RangeMatcher_Cost_IMP(RangeMatcher *self) {
+    RangeMatcherIVARS *const ivars = RangeMatcher_IVARS(self);
+    int32_t cardinality = SortCache_Get_Cardinality(ivars->sort_cache);
+    if (ivars->upper_bound < ivars->lower_bound || cardinality <= 0) {
+        return 0;
+    }
+    int64_t span = (int64_t)ivars->upper_bound - ivars->lower_bound + 1;
+    int64_t cost = (int64_t)ivars->doc_max * span / cardinality;
+    if (cost < 1)              { cost = 1; }
+    if (cost > ivars->doc_max) { cost = ivars->doc_max; }
+    return (int32_t)cost;
+}
 
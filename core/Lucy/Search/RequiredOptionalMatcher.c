@@ -117,4 +117,9 @@ ReqOptMatcher_Score_IMP(RequiredOptionalMatcher *self) {
     }
 }
 
+int32_t
+ReqOptMatcher_Cost_IMP(RequiredOptionalMatcher *self) {
+    RequiredOptionalMatcherIVARS *const ivars = ReqOptMatcher_IVARS(self);
+    return Matcher_Cost(ivars->req_matcher);
+}
 
@@ -130,6 +130,12 @@ ReqOptCompiler_Make_Matcher_IMP(RequiredOptionalCompiler *self,
     Compiler   *opt_compiler = (Compiler*)VA_Fetch(ivars->children, 1);
     Matcher *req_matcher
         = Compiler_Make_Matcher(req_compiler, reader, need_score);
+
+    // The optional clause only contributes to scores.
+    if (!need_score) {
+        return req_matcher;
+    }
+
     Matcher *opt_matcher
         = Compiler_Make_Matcher(opt_compiler, reader, need_score);
 
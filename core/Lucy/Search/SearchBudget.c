@@ -0,0 +1,121 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_SEARCHBUDGET
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Search/SearchBudget.h"
+#include "Lucy/Search/TopDocs.h"
+#include "Lucy/Util/Clock.h"
+
+SearchBudget*
+SearchBudget_new(uint32_t milliseconds, uint64_t max_docs) {
+    SearchBudget *self = (SearchBudget*)VTable_Make_Obj(SEARCHBUDGET);
+    return SearchBudget_init(self, milliseconds, max_docs);
+}
+
+SearchBudget*
+SearchBudget_init(SearchBudget *self, uint32_t milliseconds,
+                  uint64_t max_docs) {
+    SearchBudgetIVARS *const ivars = SearchBudget_IVARS(self);
+    ivars->time_budget    = milliseconds;
+    ivars->max_docs       = max_docs;
+    ivars->docs_visited   = 0;
+    ivars->segs_completed = 0;
+    ivars->expired        = false;
+    ivars->start_time     = Clock_microtime();
+    return self;
+}
+
+void
+SearchBudget_Visit_IMP(SearchBudget *self, uint32_t num_docs) {
+    SearchBudget_IVARS(self)->docs_visited += num_docs;
+}
+
+bool
+SearchBudget_Check_IMP(SearchBudget *self) {
+    SearchBudgetIVARS *const ivars = SearchBudget_IVARS(self);
+    if (ivars->expired) { return false; }
+    if (ivars->max_docs && ivars->docs_visited >= ivars->max_docs) {
+        ivars->expired = true;
+    }
+    else if (ivars->time_budget) {
+        uint64_t elapsed = Clock_microtime() - ivars->start_time;
+        if (elapsed >= (uint64_t)ivars->time_budget * 1000) {
+            ivars->expired = true;
+        }
+    }
+    return !ivars->expired;
+}
+
+bool
+SearchBudget_Expired_IMP(SearchBudget *self) {
+    return SearchBudget_IVARS(self)->expired;
+}
+
+void
+SearchBudget_Complete_Segment_IMP(SearchBudget *self) {
+    SearchBudget_IVARS(self)->segs_completed++;
+}
+
+uint32_t
+SearchBudget_Get_Segments_Completed_IMP(SearchBudget *self) {
+    return SearchBudget_IVARS(self)->segs_completed;
+}
+
+uint64_t
+SearchBudget_Get_Docs_Visited_IMP(SearchBudget *self) {
+    return SearchBudget_IVARS(self)->docs_visited;
+}
+
+uint32_t
+SearchBudget_Get_Time_Left_IMP(SearchBudget *self) {
+    SearchBudgetIVARS *const ivars = SearchBudget_IVARS(self);
+    if (!ivars->time_budget) { return 0; }
+    uint64_t elapsed = (Clock_microtime() - ivars->start_time) / 1000;
+    return elapsed < ivars->time_budget
+           ? ivars->time_budget - (uint32_t)elapsed
+           : 1;
+}
+
+uint64_t
+SearchBudget_Get_Docs_Left_IMP(SearchBudget *self) {
+    SearchBudgetIVARS *const ivars = SearchBudget_IVARS(self);
+    if (!ivars->max_docs) { return 0; }
+    return ivars->docs_visited < ivars->max_docs
+           ? ivars->max_docs - ivars->docs_visited
+           : 1;
+}
+
+void
+SearchBudget_Absorb_IMP(SearchBudget *self, TopDocs *top_docs) {
+    SearchBudgetIVARS *const ivars = SearchBudget_IVARS(self);
+    ivars->segs_completed += TopDocs_Get_Segments_Completed(top_docs);
+    if (TopDocs_Partial(top_docs)) { ivars->expired = true; }
+}
+
+uint32_t
+SearchBudget_Get_Time_Budget_IMP(SearchBudget *self) {
+    return SearchBudget_IVARS(self)->time_budget;
+}
+
+uint64_t
+SearchBudget_Get_Max_Docs_IMP(SearchBudget *self) {
+    return SearchBudget_IVARS(self)->max_docs;
+}
+
+
@@ -18,6 +18,7 @@
 #include "Lucy/Util/ToolSet.h"
 
 #include "Lucy/Search/Searcher.h"
+#include "Lucy/Document/HitDoc.h"
 
 #include "Lucy/Index/DocVector.h"
 #include "Lucy/Plan/Schema.h"
@@ -26,6 +27,7 @@
 #include "Lucy/Search/NoMatchQuery.h"
 #include "Lucy/Search/Query.h"
 #include "Lucy/Search/QueryParser.h"
+#include "Lucy/Search/SearchBudget.h"
 #include "Lucy/Search/SortSpec.h"
 #include "Lucy/Search/TopDocs.h"
 #include "Lucy/Search/Compiler.h"
@@ -49,20 +51,42 @@ Searcher_Destroy_IMP(Searcher *self) {
 
 Hits*
 Searcher_Hits_IMP(Searcher *self, Obj *query, uint32_t offset,
-                  uint32_t num_wanted, SortSpec *sort_spec) {
+                  uint32_t num_wanted, SortSpec *sort_spec,
+                  SearchBudget *budget, VArray *fields) {
     Query   *real_query = Searcher_Glean_Query(self, query);
     uint32_t doc_max    = Searcher_Doc_Max(self);
     uint32_t wanted     = offset + num_wanted > doc_max
                           ? doc_max
                           : offset + num_wanted;
     TopDocs *top_docs   = Searcher_Top_Docs(self, real_query, wanted,
-                                            sort_spec);
-    Hits    *hits       = Hits_new(self, top_docs, offset);
+                                            sort_spec, budget);
+    Hits    *hits       = Hits_new(self, top_docs, offset, fields);
     DECREF(top_docs);
     DECREF(real_query);
     return hits;
 }
 
+VArray*
+Searcher_Fetch_Docs_IMP(Searcher *self, I32Array *doc_ids, VArray *fields) {
+    const uint32_t num_docs = I32Arr_Get_Size(doc_ids);
+    VArray *hit_docs = VA_new(num_docs);
+    for (uint32_t i = 0; i < num_docs; i++) {
+        int32_t doc_id = I32Arr_Get(doc_ids, i);
+        HitDoc *hit_doc = fields
+                          ? Searcher_Fetch_Doc_Fields(self, doc_id, fields)
+                          : Searcher_Fetch_Doc(self, doc_id);
+        VA_Push(hit_docs, (Obj*)hit_doc);
+    }
+    return hit_docs;
+}
+
+HitDoc*
+Searcher_Fetch_Doc_Fields_IMP(Searcher *self, int32_t doc_id,
+                              VArray *fields) {
+    UNUSED_VAR(fields);
+    return Searcher_Fetch_Doc(self, doc_id);
+}
+
 Query*
 Searcher_Glean_Query_IMP(Searcher *self, Obj *query) {
     SearcherIVARS *const ivars = Searcher_IVARS(self);
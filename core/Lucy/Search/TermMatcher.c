@@ -90,6 +90,12 @@ TermMatcher_Advance_IMP(TermMatcher *self, int32_t target) {
     return 0;
 }
 
+int32_t
+TermMatcher_Cost_IMP(TermMatcher *self) {
+    PostingList *const plist = TermMatcher_IVARS(self)->plist;
+    return plist ? (int32_t)PList_Get_Doc_Freq(plist) : 0;
+}
+
 int32_t
 TermMatcher_Get_Doc_ID_IMP(TermMatcher* self) {
     TermMatcherIVARS *const ivars = TermMatcher_IVARS(self);
@@ -30,6 +30,7 @@
 #include "Lucy/Search/Searcher.h"
 #include "Lucy/Search/Span.h"
 #include "Lucy/Search/TermMatcher.h"
+#include "Lucy/Search/TermStateCache.h"
 #include "Lucy/Store/InStream.h"
 #include "Lucy/Store/OutStream.h"
 #include "Lucy/Util/Freezer.h"
@@ -165,10 +166,15 @@ TermCompiler_init(TermCompiler *self, Query *parent, Searcher *searcher,
     ivars->normalized_weight = 0.0f;
     ivars->query_norm_factor = 0.0f;
 
-    // Derive.
+    // Derive.  Keep the per-segment lookups so that Make_Matcher() doesn't
+    // have to repeat them.
+    ivars->term_states = TermStateCache_gather(searcher, parent_ivars->field,
+                                               parent_ivars->term);
     int32_t doc_max  = Searcher_Doc_Max(searcher);
-    int32_t doc_freq = Searcher_Doc_Freq(searcher, parent_ivars->field,
-                                         parent_ivars->term);
+    int32_t doc_freq = ivars->term_states
+                       ? TermStateCache_Get_Doc_Freq(ivars->term_states)
+                       : Searcher_Doc_Freq(searcher, parent_ivars->field,
+                                           parent_ivars->term);
     ivars->idf = Sim_IDF(sim, doc_freq, doc_max);
 
     /* The score of any document is approximately equal to:
@@ -187,6 +193,13 @@ TermCompiler_init(TermCompiler *self, Query *parent, Searcher *searcher,
     return self;
 }
 
+void
+TermCompiler_Destroy_IMP(TermCompiler *self) {
+    TermCompilerIVARS *const ivars = TermCompiler_IVARS(self);
+    DECREF(ivars->term_states);
+    SUPER_DESTROY(self, TERMCOMPILER);
+}
+
 bool
 TermCompiler_Equals_IMP(TermCompiler *self, Obj *other) {
     TermCompiler_Equals_t super_equals
@@ -261,14 +274,19 @@ TermCompiler_Make_Matcher_IMP(TermCompiler *self, SegReader *reader,
     TermCompilerIVARS *const ivars = TermCompiler_IVARS(self);
     TermQueryIVARS *const parent_ivars
         = TermQuery_IVARS((TermQuery*)ivars->parent);
-    PostingListReader *plist_reader
-        = (PostingListReader*)SegReader_Fetch(
-              reader, VTable_Get_Name(POSTINGLISTREADER));
-    PostingList *plist = plist_reader
-                         ? PListReader_Posting_List(plist_reader,
-                                                    parent_ivars->field,
-                                                    parent_ivars->term)
-                         : NULL;
+    PostingList *plist = NULL;
+    if (ivars->term_states) {
+        plist = TermStateCache_Posting_List(ivars->term_states, reader);
+    }
+    else {
+        PostingListReader *plist_reader
+            = (PostingListReader*)SegReader_Fetch(
+                  reader, VTable_Get_Name(POSTINGLISTREADER));
+        plist = plist_reader
+                ? PListReader_Posting_List(plist_reader, parent_ivars->field,
+                                           parent_ivars->term)
+                : NULL;
+    }
 
     if (plist == NULL || PList_Get_Doc_Freq(plist) == 0) {
         DECREF(plist);
@@ -0,0 +1,114 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_TERMSTATECACHE
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Search/TermStateCache.h"
+#include "Lucy/Index/IndexReader.h"
+#include "Lucy/Index/LexiconReader.h"
+#include "Lucy/Index/PostingListReader.h"
+#include "Lucy/Index/SegPostingList.h"
+#include "Lucy/Index/SegReader.h"
+#include "Lucy/Index/TermInfo.h"
+#include "Lucy/Search/IndexSearcher.h"
+
+TermStateCache*
+TermStateCache_gather(Searcher *searcher, String *field, Obj *term) {
+    if (!Obj_Is_A((Obj*)searcher, INDEXSEARCHER)) { return NULL; }
+    VTable *vtable = Searcher_Get_VTable(searcher);
+    if (METHOD_PTR(vtable, LUCY_IxSearcher_Doc_Freq)
+        != METHOD_PTR(INDEXSEARCHER, LUCY_IxSearcher_Doc_Freq)
+       ) {
+        return NULL;
+    }
+    IndexReader *reader = IxSearcher_Get_Reader((IndexSearcher*)searcher);
+    TermStateCache *self
+        = (TermStateCache*)VTable_Make_Obj(TERMSTATECACHE);
+    return TermStateCache_init(self, reader, field, term);
+}
+
+TermStateCache*
+TermStateCache_init(TermStateCache *self, IndexReader *reader,
+                    String *field, Obj *term) {
+    TermStateCacheIVARS *const ivars = TermStateCache_IVARS(self);
+    ivars->field       = (String*)INCREF(field);
+    ivars->term        = INCREF(term);
+    ivars->seg_readers = IxReader_Seg_Readers(reader);
+    ivars->tinfos      = VA_new(VA_Get_Size(ivars->seg_readers));
+    ivars->doc_freq    = 0;
+
+    String *lex_class = VTable_Get_Name(LEXICONREADER);
+    for (uint32_t i = 0, max = VA_Get_Size(ivars->seg_readers); i < max; i++) {
+        SegReader *seg_reader = (SegReader*)VA_Fetch(ivars->seg_readers, i);
+        LexiconReader *lex_reader
+            = (LexiconReader*)SegReader_Fetch(seg_reader, lex_class);
+        TermInfo *tinfo = lex_reader
+                          ? LexReader_Fetch_Term_Info(lex_reader, field, term)
+                          : NULL;
+        if (tinfo) {
+            ivars->doc_freq += TInfo_Get_Doc_Freq(tinfo);
+            VA_Store(ivars->tinfos, i, (Obj*)tinfo);
+        }
+    }
+
+    return self;
+}
+
+void
+TermStateCache_Destroy_IMP(TermStateCache *self) {
+    TermStateCacheIVARS *const ivars = TermStateCache_IVARS(self);
+    DECREF(ivars->field);
+    DECREF(ivars->term);
+    DECREF(ivars->seg_readers);
+    DECREF(ivars->tinfos);
+    SUPER_DESTROY(self, TERMSTATECACHE);
+}
+
+int32_t
+TermStateCache_Get_Doc_Freq_IMP(TermStateCache *self) {
+    return TermStateCache_IVARS(self)->doc_freq;
+}
+
+PostingList*
+TermStateCache_Posting_List_IMP(TermStateCache *self, SegReader *reader) {
+    TermStateCacheIVARS *const ivars = TermStateCache_IVARS(self);
+    PostingListReader *plist_reader
+        = (PostingListReader*)SegReader_Fetch(
+              reader, VTable_Get_Name(POSTINGLISTREADER));
+    if (!plist_reader) { return NULL; }
+
+    // Match by identity: the TermInfo is only valid for the exact segment
+    // snapshot it came from.
+    for (uint32_t i = 0, max = VA_Get_Size(ivars->seg_readers); i < max; i++) {
+        if (VA_Fetch(ivars->seg_readers, i) != (Obj*)reader) { continue; }
+        TermInfo *tinfo = (TermInfo*)VA_Fetch(ivars->tinfos, i);
+        if (!tinfo) { return NULL; }
+        PostingList *plist
+            = PListReader_Posting_List(plist_reader, ivars->field, NULL);
+        if (plist && Obj_Is_A((Obj*)plist, SEGPOSTINGLIST)) {
+            SegPList_Seek_Term_Info((SegPostingList*)plist, tinfo);
+        }
+        else if (plist) {
+            PList_Seek(plist, ivars->term);
+        }
+        return plist;
+    }
+
+    return PListReader_Posting_List(plist_reader, ivars->field, ivars->term);
+}
+
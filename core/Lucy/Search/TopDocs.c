@@ -36,7 +36,9 @@ TopDocs*
 TopDocs_init(TopDocs *self, VArray *match_docs, uint32_t total_hits) {
     TopDocsIVARS *const ivars = TopDocs_IVARS(self);
     ivars->match_docs = (VArray*)INCREF(match_docs);
-    ivars->total_hits = total_hits;
+    ivars->total_hits     = total_hits;
+    ivars->segs_completed = 0;
+    ivars->partial        = false;
     return self;
 }
 
@@ -52,13 +54,17 @@ TopDocs_Serialize_IMP(TopDocs *self, OutStream *outstream) {
     TopDocsIVARS *const ivars = TopDocs_IVARS(self);
     Freezer_serialize_varray(ivars->match_docs, outstream);
     OutStream_Write_C32(outstream, ivars->total_hits);
+    OutStream_Write_C32(outstream, ivars->segs_completed);
+    OutStream_Write_U8(outstream, ivars->partial ? 1 : 0);
 }
 
 TopDocs*
 TopDocs_Deserialize_IMP(TopDocs *self, InStream *instream) {
     TopDocsIVARS *const ivars = TopDocs_IVARS(self);
     ivars->match_docs = Freezer_read_varray(instream);
-    ivars->total_hits = InStream_Read_C32(instream);
+    ivars->total_hits     = InStream_Read_C32(instream);
+    ivars->segs_completed = InStream_Read_C32(instream);
+    ivars->partial        = InStream_Read_U8(instream) ? true : false;
     return self;
 }
 
@@ -83,4 +89,24 @@ TopDocs_Set_Total_Hits_IMP(TopDocs *self, uint32_t total_hits) {
     TopDocs_IVARS(self)->total_hits = total_hits;
 }
 
+bool
+TopDocs_Partial_IMP(TopDocs *self) {
+    return TopDocs_IVARS(self)->partial;
+}
+
+void
+TopDocs_Set_Partial_IMP(TopDocs *self, bool partial) {
+    TopDocs_IVARS(self)->partial = partial;
+}
+
+uint32_t
+TopDocs_Get_Segments_Completed_IMP(TopDocs *self) {
+    return TopDocs_IVARS(self)->segs_completed;
+}
+
+void
+TopDocs_Set_Segments_Completed_IMP(TopDocs *self, uint32_t segs_completed) {
+    TopDocs_IVARS(self)->segs_completed = segs_completed;
+}
+
 
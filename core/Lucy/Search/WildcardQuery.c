@@ -0,0 +1,93 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_WILDCARDQUERY
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Search/WildcardQuery.h"
+
+WildcardQuery*
+WildcardQuery_new(String *field, String *pattern) {
+    WildcardQuery *self = (WildcardQuery*)VTable_Make_Obj(WILDCARDQUERY);
+    return WildcardQuery_init(self, field, pattern);
+}
+
+WildcardQuery*
+WildcardQuery_init(WildcardQuery *self, String *field, String *pattern) {
+    return (WildcardQuery*)MultiTermQuery_init((MultiTermQuery*)self, field,
+                                               pattern);
+}
+
+String*
+WildcardQuery_Literal_Prefix_IMP(WildcardQuery *self) {
+    String *pattern = WildcardQuery_IVARS(self)->term;
+    const char *ptr  = Str_Get_Ptr8(pattern);
+    size_t      size = Str_Get_Size(pattern);
+    size_t      len  = 0;
+    while (len < size && ptr[len] != '*' && ptr[len] != '?') { len++; }
+    return Str_new_from_trusted_utf8(ptr, len);
+}
+
+// Glob match with backtracking to the most recent '*'.  Both wildcards are
+// ASCII, so literal text can be compared byte by byte; '?' and
+// backtracking step over whole UTF-8 sequences.
+static bool
+S_glob_match(const char *pat, const char *const pat_end,
+             const char *text, const char *const text_end) {
+    const char *star_pat  = NULL;
+    const char *star_text = NULL;
+    while (text < text_end) {
+        if (pat < pat_end && *pat == '*') {
+            star_pat  = ++pat;
+            star_text = text;
+        }
+        else if (pat < pat_end && *pat == '?') {
+            pat++;
+            text += StrHelp_UTF8_COUNT[*(const uint8_t*)text];
+        }
+        else if (pat < pat_end && *pat == *text) {
+            pat++;
+            text++;
+        }
+        else if (star_pat) {
+            star_text += StrHelp_UTF8_COUNT[*(const uint8_t*)star_text];
+            pat  = star_pat;
+            text = star_text;
+        }
+        else {
+            return false;
+        }
+    }
+    while (pat < pat_end && *pat == '*') { pat++; }
+    return pat == pat_end && text == text_end;
+}
+
+bool
+WildcardQuery_Accept_Term_IMP(WildcardQuery *self, String *term) {
+    String *pattern = WildcardQuery_IVARS(self)->term;
+    const char *pat  = Str_Get_Ptr8(pattern);
+    const char *text = Str_Get_Ptr8(term);
+    return S_glob_match(pat, pat + Str_Get_Size(pattern),
+                        text, text + Str_Get_Size(term));
+}
+
+String*
+WildcardQuery_To_String_IMP(WildcardQuery *self) {
+    WildcardQueryIVARS *const ivars = WildcardQuery_IVARS(self);
+    return Str_newf("%o:%o", ivars->field, ivars->term);
+}
+
@@ -22,6 +22,7 @@
 #include "Lucy/Store/CompoundFileWriter.h"
 #include "Lucy/Store/FileHandle.h"
 #include "Lucy/Store/InStream.h"
+#include "Lucy/Util/Checksum.h"
 #include "Lucy/Util/IndexFileNames.h"
 #include "Lucy/Util/Json.h"
 #include "Clownfish/Util/StringHelper.h"
@@ -41,6 +42,7 @@ CFReader_do_open(CompoundFileReader *self, Folder *folder) {
     Err *error = NULL;
 
     Folder_init((Folder*)self, Folder_Get_Path(folder));
+    ivars->advice = Hash_new(0);
 
     // Parse metadata file.
     if (!metadata || !Hash_Is_A(metadata, HASH)) {
@@ -49,7 +51,11 @@ CFReader_do_open(CompoundFileReader *self, Folder *folder) {
     }
     else {
         Obj *format = Hash_Fetch_Utf8(metadata, "format", 6);
+        Obj *alignment = Hash_Fetch_Utf8(metadata, "alignment", 9);
         ivars->format = format ? (int32_t)Obj_To_I64(format) : 0;
+        ivars->alignment = alignment
+                           ? (int32_t)Obj_To_I64(alignment)
+                           : ivars->format >= 2 ? 8 : 1;
         ivars->records = (Hash*)INCREF(Hash_Fetch_Utf8(metadata, "files", 5));
         if (ivars->format < 1) {
             error = Err_new(Str_newf("Corrupt %o file: Missing or invalid 'format'",
@@ -84,6 +90,31 @@ CFReader_do_open(CompoundFileReader *self, Folder *folder) {
     // Assign.
     ivars->real_folder = (Folder*)INCREF(folder);
 
+    // Pass recorded hints along, one sub-file at a time.  Each lands on the
+    // sub-file's own range of the shared filehandle, so access pattern
+    // hints don't compete with each other.  Those also become the standing
+    // advice for the sub-file.
+    if (ivars->format >= 3) {
+        String *name;
+        Obj    *record;
+        Hash_Iterate(ivars->records);
+        while (Hash_Next(ivars->records, (Obj**)&name, &record)) {
+            int32_t advice = CFReader_Get_Hint(self, name);
+            if (advice == FH_ADVICE_NORMAL) { continue; }
+            if (advice == FH_ADVICE_RANDOM
+                || advice == FH_ADVICE_SEQUENTIAL
+               ) {
+                Hash_Store(ivars->advice, (Obj*)name,
+                           (Obj*)Int32_new(advice));
+            }
+            InStream *instream = CFReader_Local_Open_In(self, name);
+            if (instream) {
+                InStream_Advise(instream, advice);
+                DECREF(instream);
+            }
+        }
+    }
+
     // Strip directory name from filepaths for old format.
     if (ivars->format == 1) {
         VArray *files = Hash_Keys(ivars->records);
@@ -115,6 +146,7 @@ CFReader_Destroy_IMP(CompoundFileReader *self) {
     DECREF(ivars->real_folder);
     DECREF(ivars->instream);
     DECREF(ivars->records);
+    DECREF(ivars->advice);
     SUPER_DESTROY(self, COMPOUNDFILEREADER);
 }
 
@@ -123,6 +155,152 @@ CFReader_Get_Real_Folder_IMP(CompoundFileReader *self) {
     return CFReader_IVARS(self)->real_folder;
 }
 
+int32_t
+CFReader_Get_Alignment_IMP(CompoundFileReader *self) {
+    return CFReader_IVARS(self)->alignment;
+}
+
+int32_t
+CFReader_Get_Hint_IMP(CompoundFileReader *self, String *name) {
+    CompoundFileReaderIVARS *const ivars = CFReader_IVARS(self);
+    Hash *entry = (Hash*)Hash_Fetch(ivars->records, (Obj*)name);
+    if (entry && Hash_Is_A(entry, HASH)) {
+        Obj *hint = Hash_Fetch_Utf8(entry, "hint", 4);
+        if (hint && Obj_Is_A(hint, STRING)) {
+            return CFWriter_word_to_hint((String*)hint);
+        }
+    }
+    return FH_ADVICE_NORMAL;
+}
+
+int32_t
+CFReader_Get_Advice_IMP(CompoundFileReader *self, String *name) {
+    Obj *advice = Hash_Fetch(CFReader_IVARS(self)->advice, (Obj*)name);
+    return advice ? (int32_t)Obj_To_I64(advice) : FH_ADVICE_NORMAL;
+}
+
+// Compute the CRC32C checksum of a virtual file, reading it in large chunks
+// so that a mapped cf.dat is consumed straight from the mapping.
+static uint32_t
+S_checksum(InStream *instream) {
+    const int64_t chunk_size = 1024 * 1024;
+    int64_t  bytes_left = InStream_Length(instream);
+    uint32_t crc        = 0;
+    while (bytes_left > 0) {
+        const size_t request = bytes_left < chunk_size
+                               ? (size_t)bytes_left
+                               : (size_t)chunk_size;
+        char *buf = InStream_Buf(instream, request);
+        crc = Checksum_crc32c(crc, buf, request);
+        InStream_Advance_Buf(instream, buf + request);
+        bytes_left -= (int64_t)request;
+    }
+    return crc;
+}
+
+// Open a virtual file without verifying it.  Return NULL and set Err_error
+// if its entry is malformed or its range runs past the end of cf.dat, as it
+// does when cf.dat has been truncated.
+static InStream*
+S_open_range(CompoundFileReader *self, String *name, Hash *entry) {
+    CompoundFileReaderIVARS *const ivars = CFReader_IVARS(self);
+    Obj *len    = Hash_Fetch_Utf8(entry, "length", 6);
+    Obj *offset = Hash_Fetch_Utf8(entry, "offset", 6);
+    if (!len || !offset) {
+        Err_set_error(Err_new(Str_newf("Malformed entry for '%o' in '%o'",
+                                       name, Folder_Get_Path(ivars->real_folder))));
+        return NULL;
+    }
+    const int64_t start = Obj_To_I64(offset);
+    const int64_t size  = Obj_To_I64(len);
+    if (start < 0 || size < 0
+        || start + size > InStream_Length(ivars->instream)
+       ) {
+        Err_set_error(Err_new(Str_newf("'%o' extends past the end of cf.dat "
+                                       "in '%o'", name,
+                                       Folder_Get_Path(ivars->real_folder))));
+        return NULL;
+    }
+    if (Str_Get_Size(ivars->path)) {
+        String *fullpath = Str_newf("%o/%o", ivars->path, name);
+        InStream *instream = InStream_Reopen(ivars->instream, fullpath,
+                                             start, size);
+        DECREF(fullpath);
+        return instream;
+    }
+    return InStream_Reopen(ivars->instream, name, start, size);
+}
+
+static bool
+S_verify(CompoundFileReader *self, String *name, bool streaming) {
+    CompoundFileReaderIVARS *const ivars = CFReader_IVARS(self);
+    Hash *entry = (Hash*)Hash_Fetch(ivars->records, (Obj*)name);
+    Obj  *checksum = entry ? Hash_Fetch_Utf8(entry, "checksum", 8) : NULL;
+    if (!checksum) { return true; }
+
+    InStream *instream = S_open_range(self, name, entry);
+    if (!instream) { return false; }
+
+    // Let readahead stream the file's own range, then put back its standing
+    // advice.  Other sub-files of the shared filehandle are unaffected.
+    if (streaming) { InStream_Advise(instream, FH_ADVICE_SEQUENTIAL); }
+    const uint32_t actual = S_checksum(instream);
+    if (streaming) {
+        InStream_Advise(instream, CFReader_Get_Advice(self, name));
+        if (CFReader_Get_Hint(self, name) == FH_ADVICE_WILLNEED) {
+            InStream_Advise(instream, FH_ADVICE_WILLNEED);
+        }
+    }
+    DECREF(instream);
+
+    if (actual != (uint32_t)Obj_To_I64(checksum)) {
+        Err_set_error(Err_new(Str_newf("Checksum mismatch for '%o' in '%o'",
+                                       name, Folder_Get_Path(ivars->real_folder))));
+        return false;
+    }
+    return true;
+}
+
+bool
+CFReader_Verify_File_IMP(CompoundFileReader *self, String *name) {
+    return S_verify(self, name, false);
+}
+
+static int
+S_compare_offsets(void *context, const void *va, const void *vb) {
+    Hash *records = (Hash*)context;
+    Hash *a = (Hash*)Hash_Fetch(records, *(Obj**)va);
+    Hash *b = (Hash*)Hash_Fetch(records, *(Obj**)vb);
+    int64_t offset_a = Obj_To_I64(Hash_Fetch_Utf8(a, "offset", 6));
+    int64_t offset_b = Obj_To_I64(Hash_Fetch_Utf8(b, "offset", 6));
+    return offset_a < offset_b ? -1 : offset_a > offset_b ? 1 : 0;
+}
+
+VArray*
+CFReader_Verify_IMP(CompoundFileReader *self) {
+    CompoundFileReaderIVARS *const ivars = CFReader_IVARS(self);
+    VArray *names  = Hash_Keys(ivars->records);
+    VArray *failed = VA_new(0);
+
+    // Visit files in the order they appear in cf.dat, streaming each one.
+    VA_Sort(names, S_compare_offsets, ivars->records);
+    for (uint32_t i = 0, max = VA_Get_Size(names); i < max; i++) {
+        String *name = (String*)VA_Fetch(names, i);
+        if (!S_verify(self, name, true)) {
+            VA_Push(failed, INCREF(name));
+        }
+    }
+
+    DECREF(names);
+    return failed;
+}
+
+void
+CFReader_Set_Verify_Threshold_IMP(CompoundFileReader *self,
+                                  int64_t threshold) {
+    CFReader_IVARS(self)->verify_threshold = threshold;
+}
+
 void
 CFReader_Set_Path_IMP(CompoundFileReader *self, String *path) {
     CompoundFileReaderIVARS *const ivars = CFReader_IVARS(self);
@@ -194,27 +372,47 @@ CFReader_Local_Open_In_IMP(CompoundFileReader *self, String *name) {
         return instream;
     }
     else {
-        Obj *len    = Hash_Fetch_Utf8(entry, "length", 6);
-        Obj *offset = Hash_Fetch_Utf8(entry, "offset", 6);
-        if (!len || !offset) {
-            Err_set_error(Err_new(Str_newf("Malformed entry for '%o' in '%o'",
-                                           name, Folder_Get_Path(ivars->real_folder))));
+        Obj *len = Hash_Fetch_Utf8(entry, "length", 6);
+        if (len
+            && Obj_To_I64(len) <= ivars->verify_threshold
+            && !CFReader_Verify_File(self, name)
+           ) {
+            ERR_ADD_FRAME(Err_get_error());
             return NULL;
         }
-        else if (Str_Get_Size(ivars->path)) {
-            String *fullpath = Str_newf("%o/%o", ivars->path, name);
-            InStream *instream = InStream_Reopen(ivars->instream, fullpath,
-                                                 Obj_To_I64(offset), Obj_To_I64(len));
-            DECREF(fullpath);
-            return instream;
-        }
-        else {
-            return InStream_Reopen(ivars->instream, name, Obj_To_I64(offset),
-                                   Obj_To_I64(len));
+        InStream *instream = S_open_range(self, name, entry);
+        if (!instream) {
+            ERR_ADD_FRAME(Err_get_error());
         }
+        return instream;
     }
 }
 
+bool
+CFReader_Local_Advise_IMP(CompoundFileReader *self, String *name,
+                          int32_t advice) {
+    CompoundFileReaderIVARS *const ivars = CFReader_IVARS(self);
+    Hash *entry = (Hash*)Hash_Fetch(ivars->records, (Obj*)name);
+    if (!entry) {
+        return Folder_Local_Advise(ivars->real_folder, name, advice);
+    }
+
+    InStream *instream = S_open_range(self, name, entry);
+    if (!instream) {
+        ERR_ADD_FRAME(Err_get_error());
+        return false;
+    }
+    if (advice == FH_ADVICE_RANDOM || advice == FH_ADVICE_SEQUENTIAL) {
+        Hash_Store(ivars->advice, (Obj*)name, (Obj*)Int32_new(advice));
+    }
+    else if (advice == FH_ADVICE_NORMAL) {
+        DECREF(Hash_Delete(ivars->advice, (Obj*)name));
+    }
+    InStream_Advise(instream, advice);
+    DECREF(instream);
+    return true;
+}
+
 bool
 CFReader_Local_Exists_IMP(CompoundFileReader *self, String *name) {
     CompoundFileReaderIVARS *const ivars = CFReader_IVARS(self);
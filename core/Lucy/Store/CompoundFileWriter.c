@@ -18,13 +18,15 @@
 #include "Lucy/Util/ToolSet.h"
 
 #include "Lucy/Store/CompoundFileWriter.h"
+#include "Lucy/Store/FileHandle.h"
 #include "Lucy/Store/Folder.h"
 #include "Lucy/Store/InStream.h"
 #include "Lucy/Store/OutStream.h"
 #include "Lucy/Util/IndexFileNames.h"
 #include "Lucy/Util/Json.h"
 
-int32_t CFWriter_current_file_format = 2;
+int32_t CFWriter_current_file_format = 3;
+int32_t CFWriter_default_alignment   = 64;
 
 // Helper which does the heavy lifting for CFWriter_consolidate.
 static void
@@ -45,7 +47,9 @@ CFWriter_new(Folder *folder) {
 CompoundFileWriter*
 CFWriter_init(CompoundFileWriter *self, Folder *folder) {
     CompoundFileWriterIVARS *const ivars = CFWriter_IVARS(self);
-    ivars->folder = (Folder*)INCREF(folder);
+    ivars->folder    = (Folder*)INCREF(folder);
+    ivars->hints     = Hash_new(0);
+    ivars->alignment = CFWriter_default_alignment;
     return self;
 }
 
@@ -53,6 +57,7 @@ void
 CFWriter_Destroy_IMP(CompoundFileWriter *self) {
     CompoundFileWriterIVARS *const ivars = CFWriter_IVARS(self);
     DECREF(ivars->folder);
+    DECREF(ivars->hints);
     SUPER_DESTROY(self, COMPOUNDFILEWRITER);
 }
 
@@ -70,6 +75,75 @@ CFWriter_Consolidate_IMP(CompoundFileWriter *self) {
     }
 }
 
+void
+CFWriter_Set_Alignment_IMP(CompoundFileWriter *self, int32_t alignment) {
+    if (alignment < 8 || alignment > 65536
+        || (alignment & (alignment - 1)) != 0
+       ) {
+        THROW(ERR, "Invalid compound file alignment: %i32", alignment);
+    }
+    CFWriter_IVARS(self)->alignment = alignment;
+}
+
+int32_t
+CFWriter_Get_Alignment_IMP(CompoundFileWriter *self) {
+    return CFWriter_IVARS(self)->alignment;
+}
+
+void
+CFWriter_Set_Hint_IMP(CompoundFileWriter *self, String *name,
+                      int32_t advice) {
+    CompoundFileWriterIVARS *const ivars = CFWriter_IVARS(self);
+    Hash_Store(ivars->hints, (Obj*)name, (Obj*)Str_newf("%i32", advice));
+}
+
+int32_t
+CFWriter_Get_Hint_IMP(CompoundFileWriter *self, String *name) {
+    CompoundFileWriterIVARS *const ivars = CFWriter_IVARS(self);
+    Obj *hint = Hash_Fetch(ivars->hints, (Obj*)name);
+    if (hint) {
+        return (int32_t)Obj_To_I64(hint);
+    }
+    else if (Str_Ends_With_Utf8(name, ".ix", 3)
+             || Str_Ends_With_Utf8(name, ".ixix", 5)
+             || Str_Ends_With_Utf8(name, ".fst", 4)
+             || Str_Ends_With_Utf8(name, ".bloom", 6)
+             || Str_Ends_With_Utf8(name, ".keys", 5)
+             || Str_Ends_With_Utf8(name, ".docs", 5)
+             || Str_Ends_With_Utf8(name, ".ord", 4)
+            ) {
+        return FH_ADVICE_WILLNEED;
+    }
+    return FH_ADVICE_NORMAL;
+}
+
+String*
+CFWriter_hint_to_word(int32_t advice) {
+    switch (advice) {
+        case FH_ADVICE_RANDOM:
+            return Str_new_from_trusted_utf8("random", 6);
+        case FH_ADVICE_SEQUENTIAL:
+            return Str_new_from_trusted_utf8("sequential", 10);
+        case FH_ADVICE_WILLNEED:
+            return Str_new_from_trusted_utf8("willneed", 8);
+        case FH_ADVICE_DONTNEED:
+            return Str_new_from_trusted_utf8("dontneed", 8);
+        default:
+            return Str_new_from_trusted_utf8("normal", 6);
+    }
+}
+
+int32_t
+CFWriter_word_to_hint(String *word) {
+    if (Str_Equals_Utf8(word, "random", 6))     { return FH_ADVICE_RANDOM; }
+    if (Str_Equals_Utf8(word, "sequential", 10)) {
+        return FH_ADVICE_SEQUENTIAL;
+    }
+    if (Str_Equals_Utf8(word, "willneed", 8))   { return FH_ADVICE_WILLNEED; }
+    if (Str_Equals_Utf8(word, "dontneed", 8))   { return FH_ADVICE_DONTNEED; }
+    return FH_ADVICE_NORMAL;
+}
+
 static void
 S_clean_up_old_temp_files(CompoundFileWriter *self,
                           CompoundFileWriterIVARS *ivars) {
@@ -92,7 +166,6 @@ S_clean_up_old_temp_files(CompoundFileWriter *self,
 
 static void
 S_do_consolidate(CompoundFileWriter *self, CompoundFileWriterIVARS *ivars) {
-    UNUSED_VAR(self);
     Folder    *folder       = ivars->folder;
     Hash      *metadata     = Hash_new(0);
     Hash      *sub_files    = Hash_new(0);
@@ -108,6 +181,8 @@ S_do_consolidate(CompoundFileWriter *self, CompoundFileWriterIVARS *ivars) {
     Hash_Store_Utf8(metadata, "files", 5, INCREF(sub_files));
     Hash_Store_Utf8(metadata, "format", 6,
                     (Obj*)Str_newf("%i32", CFWriter_current_file_format));
+    Hash_Store_Utf8(metadata, "alignment", 9,
+                    (Obj*)Str_newf("%i32", ivars->alignment));
 
     VA_Sort(files, NULL, NULL);
     for (uint32_t i = 0, max = VA_Get_Size(files); i < max; i++) {
@@ -115,27 +190,34 @@ S_do_consolidate(CompoundFileWriter *self, CompoundFileWriterIVARS *ivars) {
 
         if (!Str_Ends_With_Utf8(infilename, ".json", 5)) {
             InStream *instream   = Folder_Open_In(folder, infilename);
-            Hash     *file_data  = Hash_new(2);
+            Hash     *file_data  = Hash_new(4);
             int64_t   offset, len;
 
             if (!instream) { RETHROW(INCREF(Err_get_error())); }
 
-            // Absorb the file.
+            // Absorb the file, checksumming it on the way through.
             offset = OutStream_Tell(outstream);
+            OutStream_Reset_Checksum(outstream);
             OutStream_Absorb(outstream, instream);
             len = OutStream_Tell(outstream) - offset;
+            uint32_t checksum = OutStream_Get_Checksum(outstream);
 
             // Record offset and length.
             Hash_Store_Utf8(file_data, "offset", 6,
                             (Obj*)Str_newf("%i64", offset));
             Hash_Store_Utf8(file_data, "length", 6,
                             (Obj*)Str_newf("%i64", len));
+            Hash_Store_Utf8(file_data, "checksum", 8,
+                            (Obj*)Str_newf("%u32", checksum));
+            String *hint
+                = CFWriter_hint_to_word(CFWriter_Get_Hint(self, infilename));
+            Hash_Store_Utf8(file_data, "hint", 4, (Obj*)hint);
             Hash_Store(sub_files, (Obj*)infilename, (Obj*)file_data);
             VA_Push(merged, INCREF(infilename));
 
             // Add filler NULL bytes so that every sub-file begins on a file
-            // position multiple of 8.
-            OutStream_Align(outstream, 8);
+            // position which is a multiple of the alignment.
+            OutStream_Align(outstream, ivars->alignment);
 
             InStream_Close(instream);
             DECREF(instream);
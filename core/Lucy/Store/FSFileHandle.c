@@ -261,6 +261,12 @@ FSFH_Release_Window_IMP(FSFileHandle *self, FileWindow *window) {
     return true;
 }
 
+bool
+FSFH_Fully_Mapped_IMP(FSFileHandle *self) {
+    FSFileHandleIVARS *const ivars = FSFH_IVARS(self);
+    return (ivars->flags & FH_READ_ONLY) && ivars->buf != NULL;
+}
+
 bool
 FSFH_Read_IMP(FSFileHandle *self, char *dest, int64_t offset, size_t len) {
     FSFileHandleIVARS *const ivars = FSFH_IVARS(self);
@@ -321,6 +327,13 @@ FSFH_Release_Window_IMP(FSFileHandle *self, FileWindow *window) {
     return true;
 }
 
+bool
+FSFH_Fully_Mapped_IMP(FSFileHandle *self) {
+    // Only windows of the file are ever mapped.
+    UNUSED_VAR(self);
+    return false;
+}
+
 #endif // IS_64_BIT vs. 32-bit
 
 /********************************* UNIXEN *********************************/
@@ -404,6 +417,117 @@ SI_unmap(FSFileHandle *self, char *buf, int64_t len) {
     return true;
 }
 
+// Translate FileHandle access pattern hints to madvise() flags, returning -1
+// for hints the system doesn't support.
+static CFISH_INLINE int
+SI_madvise_flag(int32_t advice) {
+    switch (advice) {
+#ifdef MADV_NORMAL
+        case FH_ADVICE_NORMAL:     return MADV_NORMAL;
+        case FH_ADVICE_RANDOM:     return MADV_RANDOM;
+        case FH_ADVICE_SEQUENTIAL: return MADV_SEQUENTIAL;
+        case FH_ADVICE_WILLNEED:   return MADV_WILLNEED;
+        case FH_ADVICE_DONTNEED:   return MADV_DONTNEED;
+#endif
+        default:                   return -1;
+    }
+}
+
+bool
+FSFH_Advise_IMP(FSFileHandle *self, int64_t offset, int64_t len,
+                int32_t advice) {
+    FSFileHandleIVARS *const ivars = FSFH_IVARS(self);
+    if (offset < 0 || len < 0 || offset + len > ivars->len) {
+        Err_set_error(Err_new(Str_newf("Can't advise on range %i64 + %i64 in '%o' (len %i64)",
+                                       offset, len, ivars->path, ivars->len)));
+        return false;
+    }
+    if (!ivars->fd || !len) { return true; }
+
+    // Access pattern hints on part of the file -- e.g. one sub-file of a
+    // compound file -- must not change how the rest of it is read.
+    const bool whole_file = offset == 0 && len == ivars->len;
+    const bool pattern    = advice == FH_ADVICE_NORMAL
+                            || advice == FH_ADVICE_RANDOM
+                            || advice == FH_ADVICE_SEQUENTIAL;
+
+    // Failures are ignored, since these are only hints.
+#if IS_64_BIT
+    // The whole file is mapped, so apply the hint to the mapping.  madvise()
+    // requires a page-aligned start.  Page cache hints may harmlessly round
+    // out to whole pages, but a partial access pattern hint is confined to
+    // the pages lying wholly within the range.
+    int mflag = SI_madvise_flag(advice);
+    if (ivars->buf != NULL && mflag != -1) {
+        const int64_t page_size = ivars->page_size;
+        int64_t start = offset - offset % page_size;
+        int64_t end   = offset + len;
+        if (pattern && !whole_file) {
+            start = (offset + page_size - 1) / page_size * page_size;
+            end  -= end % page_size;
+        }
+        if (end > start) {
+            madvise(ivars->buf + start, (size_t)(end - start), mflag);
+        }
+    }
+#endif
+
+#ifdef POSIX_FADV_NORMAL
+    int fflag = -1;
+    switch (advice) {
+        case FH_ADVICE_NORMAL:     fflag = POSIX_FADV_NORMAL;     break;
+        case FH_ADVICE_RANDOM:     fflag = POSIX_FADV_RANDOM;     break;
+        case FH_ADVICE_SEQUENTIAL: fflag = POSIX_FADV_SEQUENTIAL; break;
+        case FH_ADVICE_WILLNEED:   fflag = POSIX_FADV_WILLNEED;   break;
+        case FH_ADVICE_DONTNEED:   fflag = POSIX_FADV_DONTNEED;   break;
+    }
+    // Some systems (e.g. Linux) apply access patterns to the whole
+    // descriptor regardless of the range given.
+    if (fflag != -1 && (whole_file || !pattern)) {
+        posix_fadvise(ivars->fd, (off_t)offset, (off_t)len, fflag);
+    }
+#endif
+
+    return true;
+}
+
+int64_t
+FSFH_Resident_Bytes_IMP(FSFileHandle *self, int64_t offset, int64_t len) {
+    FSFileHandleIVARS *const ivars = FSFH_IVARS(self);
+    if (offset < 0 || len < 0 || offset + len > ivars->len) {
+        Err_set_error(Err_new(Str_newf("Range %i64 + %i64 out of bounds in '%o' (len %i64)",
+                                       offset, len, ivars->path, ivars->len)));
+        return -1;
+    }
+    if (!len) { return 0; }
+
+#if IS_64_BIT
+    // mincore() reports on the pages backing the whole-file mapping, which
+    // for a shared file mapping reflects the page cache.
+    if (ivars->buf != NULL) {
+        const int64_t page_size = ivars->page_size;
+        const int64_t remainder = offset % page_size;
+        const int64_t start     = offset - remainder;
+        const size_t  span      = (size_t)(len + remainder);
+        const size_t  num_pages = (span + page_size - 1) / page_size;
+        unsigned char *vec      = (unsigned char*)MALLOCATE(num_pages);
+        int64_t resident        = -1;
+        if (mincore(ivars->buf + start, span, (void*)vec) == 0) {
+            resident = 0;
+            for (size_t i = 0; i < num_pages; i++) {
+                if (vec[i] & 1) { resident += page_size; }
+            }
+            // Clip the partial pages at either end of the range.
+            if (resident > len) { resident = len; }
+        }
+        FREEMEM(vec);
+        return resident;
+    }
+#endif
+
+    return -1;
+}
+
 #if !IS_64_BIT
 bool
 FSFH_Read_IMP(FSFileHandle *self, char *dest, int64_t offset, size_t len) {
@@ -561,6 +685,26 @@ SI_close_win_handles(FSFileHandle *self) {
     return true;
 }
 
+bool
+FSFH_Advise_IMP(FSFileHandle *self, int64_t offset, int64_t len,
+                int32_t advice) {
+    // No equivalent of madvise() is used on Windows.
+    UNUSED_VAR(self);
+    UNUSED_VAR(offset);
+    UNUSED_VAR(len);
+    UNUSED_VAR(advice);
+    return true;
+}
+
+int64_t
+FSFH_Resident_Bytes_IMP(FSFileHandle *self, int64_t offset, int64_t len) {
+    // Page cache residency is not queried on Windows.
+    UNUSED_VAR(self);
+    UNUSED_VAR(offset);
+    UNUSED_VAR(len);
+    return -1;
+}
+
 #if !IS_64_BIT
 bool
 FSFH_Read_IMP(FSFileHandle *self, char *dest, int64_t offset, size_t len) {
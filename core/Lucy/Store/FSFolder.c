@@ -27,11 +27,16 @@
   #include <sys/types.h>
 #endif
 
-// For rmdir, (hard) link.
+// For rmdir, (hard) link, fsync.
 #ifdef CHY_HAS_UNISTD_H
   #include <unistd.h>
 #endif
 
+// For syncfs.
+#ifdef __linux__
+  #include <sys/syscall.h>
+#endif
+
 // For mkdir, rmdir.
 #ifdef CHY_HAS_DIRECT_H
   #include <direct.h>
@@ -78,6 +83,24 @@ S_absolutify(String *path);
 static bool
 S_hard_link(char *from_path, char *to_path);
 
+// Record that a file or directory needs to be made durable by Sync().
+static void
+S_add_unsynced(FSFolder *self, String *fullpath, bool is_dir);
+
+// Return the directory portion of an absolute filepath.
+static String*
+S_parent_dir(String *fullpath);
+
+// Flush a file or directory to stable storage.  A path which no longer
+// exists is not an error.  On failure, set Err_error and return false.
+static bool
+S_sync_path(String *path, bool is_dir);
+
+// Flush the entire file system containing <code>path</code> in one call.
+// Return false if the platform doesn't support that.
+static bool
+S_sync_filesystem(String *path);
+
 FSFolder*
 FSFolder_new(String *path) {
     FSFolder *self = (FSFolder*)VTable_Make_Obj(FSFOLDER);
@@ -89,9 +112,19 @@ FSFolder_init(FSFolder *self, String *path) {
     String *abs_path = S_absolutify(path);
     Folder_init((Folder*)self, abs_path);
     DECREF(abs_path);
+    FSFolderIVARS *const ivars = FSFolder_IVARS(self);
+    ivars->unsynced       = Hash_new(0);
+    ivars->coalesce_syncs = false;
     return self;
 }
 
+void
+FSFolder_Destroy_IMP(FSFolder *self) {
+    FSFolderIVARS *const ivars = FSFolder_IVARS(self);
+    DECREF(ivars->unsynced);
+    SUPER_DESTROY(self, FSFOLDER);
+}
+
 void
 FSFolder_Initialize_IMP(FSFolder *self) {
     FSFolderIVARS *const ivars = FSFolder_IVARS(self);
@@ -108,12 +141,80 @@ FSFolder_Check_IMP(FSFolder *self) {
     return S_dir_ok(ivars->path);
 }
 
+void
+FSFolder_Set_Coalesce_Syncs_IMP(FSFolder *self, bool coalesce_syncs) {
+    FSFolder_IVARS(self)->coalesce_syncs = coalesce_syncs;
+}
+
+bool
+FSFolder_Get_Coalesce_Syncs_IMP(FSFolder *self) {
+    return FSFolder_IVARS(self)->coalesce_syncs;
+}
+
+Folder*
+FSFolder_Twin_IMP(FSFolder *self) {
+    FSFolderIVARS *const ivars = FSFolder_IVARS(self);
+    FSFolder *twin = FSFolder_new(ivars->path);
+    FSFolder_IVARS(twin)->coalesce_syncs = ivars->coalesce_syncs;
+    return (Folder*)twin;
+}
+
+bool
+FSFolder_Sync_IMP(FSFolder *self) {
+    FSFolderIVARS *const ivars = FSFolder_IVARS(self);
+    Hash *unsynced = ivars->unsynced;
+    if (!S_dir_ok(ivars->path)) {
+        // Anything written here has been lost along with the directory.
+        Err_set_error(Err_new(Str_newf("Can't sync '%o': no such directory",
+                                       ivars->path)));
+        return false;
+    }
+    if (!Hash_Get_Size(unsynced)) { return true; }
+
+    if (ivars->coalesce_syncs && S_sync_filesystem(ivars->path)) {
+        Hash_Clear(unsynced);
+        return true;
+    }
+
+    // Sync files before directories, so that no directory entry becomes
+    // durable before the data it refers to.
+    VArray *dirs    = VA_new(0);
+    bool    success = true;
+    String *path;
+    Obj    *is_dir;
+    Hash_Iterate(unsynced);
+    while (Hash_Next(unsynced, (Obj**)&path, &is_dir)) {
+        if (is_dir == (Obj*)CFISH_TRUE) {
+            VA_Push(dirs, INCREF(path));
+        }
+        else if (success && !S_sync_path(path, false)) {
+            success = false;
+        }
+    }
+    for (uint32_t i = 0, max = VA_Get_Size(dirs); i < max; i++) {
+        if (!success) { break; }
+        success = S_sync_path((String*)VA_Fetch(dirs, i), true);
+    }
+    DECREF(dirs);
+
+    if (success) { Hash_Clear(unsynced); }
+    return success;
+}
+
 FileHandle*
 FSFolder_Local_Open_FileHandle_IMP(FSFolder *self, String *name,
                                    uint32_t flags) {
     String       *fullpath = S_fullpath(self, name);
     FSFileHandle *fh = FSFH_open(fullpath, flags);
-    if (!fh) { ERR_ADD_FRAME(Err_get_error()); }
+    if (!fh) {
+        ERR_ADD_FRAME(Err_get_error());
+    }
+    else if (flags & FH_WRITE_ONLY) {
+        S_add_unsynced(self, fullpath, false);
+        if (flags & FH_CREATE) {
+            S_add_unsynced(self, FSFolder_IVARS(self)->path, true);
+        }
+    }
     DECREF(fullpath);
     return (FileHandle*)fh;
 }
@@ -122,7 +223,13 @@ bool
 FSFolder_Local_MkDir_IMP(FSFolder *self, String *name) {
     String *dir = S_fullpath(self, name);
     bool result = S_create_dir(dir);
-    if (!result) { ERR_ADD_FRAME(Err_get_error()); }
+    if (!result) {
+        ERR_ADD_FRAME(Err_get_error());
+    }
+    else {
+        S_add_unsynced(self, dir, true);
+        S_add_unsynced(self, FSFolder_IVARS(self)->path, true);
+    }
     DECREF(dir);
     return result;
 }
@@ -182,6 +289,20 @@ FSFolder_Rename_IMP(FSFolder *self, String* from, String *to) {
         Err_set_error(Err_new(Str_newf("rename from '%s' to '%s' failed: %s",
                                        from_path, to_path, strerror(errno))));
     }
+    else {
+        String *from_full = S_fullpath(self, from);
+        String *to_full   = S_fullpath(self, to);
+        String *from_dir  = S_parent_dir(from_full);
+        String *to_dir    = S_parent_dir(to_full);
+        DECREF(Hash_Delete(FSFolder_IVARS(self)->unsynced, (Obj*)from_full));
+        S_add_unsynced(self, to_full, false);
+        S_add_unsynced(self, from_dir, true);
+        S_add_unsynced(self, to_dir, true);
+        DECREF(to_dir);
+        DECREF(from_dir);
+        DECREF(to_full);
+        DECREF(from_full);
+    }
     FREEMEM(from_path);
     FREEMEM(to_path);
     return retval;
@@ -193,6 +314,13 @@ FSFolder_Hard_Link_IMP(FSFolder *self, String *from,
     char *from_path_ptr = S_fullpath_ptr(self, from);
     char *to_path_ptr   = S_fullpath_ptr(self, to);
     bool  retval        = S_hard_link(from_path_ptr, to_path_ptr);
+    if (retval) {
+        String *to_full = S_fullpath(self, to);
+        String *to_dir  = S_parent_dir(to_full);
+        S_add_unsynced(self, to_dir, true);
+        DECREF(to_dir);
+        DECREF(to_full);
+    }
     FREEMEM(from_path_ptr);
     FREEMEM(to_path_ptr);
     return retval;
@@ -209,6 +337,12 @@ FSFolder_Local_Delete_IMP(FSFolder *self, String *name) {
     bool result = !rmdir(path_ptr) || !remove(path_ptr);
 #endif
     DECREF(Hash_Delete(ivars->entries, (Obj*)name));
+    if (result) {
+        // Nothing left to sync.
+        String *fullpath = S_fullpath(self, name);
+        DECREF(Hash_Delete(ivars->unsynced, (Obj*)fullpath));
+        DECREF(fullpath);
+    }
     FREEMEM(path_ptr);
     return result;
 }
@@ -251,6 +385,11 @@ FSFolder_Local_Find_Folder_IMP(FSFolder *self, String *name) {
             DECREF(fullpath);
             THROW(ERR, "Failed to open FSFolder at '%o'", fullpath);
         }
+        // Track unsynced files in the subfolder along with our own.
+        FSFolderIVARS *const sub_ivars = FSFolder_IVARS((FSFolder*)subfolder);
+        DECREF(sub_ivars->unsynced);
+        sub_ivars->unsynced       = (Hash*)INCREF(ivars->unsynced);
+        sub_ivars->coalesce_syncs = ivars->coalesce_syncs;
         // Try to open a CompoundFileReader. On failure, just use the
         // existing folder.
         String *cfmeta_file = (String*)SSTR_WRAP_UTF8("cfmeta.json", 11);
@@ -337,6 +476,27 @@ S_is_local_entry(String *path) {
     return Str_Find_Utf8(path, "/", 1) == -1;
 }
 
+static void
+S_add_unsynced(FSFolder *self, String *fullpath, bool is_dir) {
+    Hash *unsynced = FSFolder_IVARS(self)->unsynced;
+    Obj  *flag     = (Obj*)(is_dir ? CFISH_TRUE : CFISH_FALSE);
+    Hash_Store(unsynced, (Obj*)fullpath, INCREF(flag));
+}
+
+static String*
+S_parent_dir(String *fullpath) {
+    StringIterator *iter = Str_Tail(fullpath);
+    int32_t code_point;
+    while (STRITER_DONE != (code_point = StrIter_Prev(iter))) {
+        if (code_point == DIR_SEP[0]) { break; }
+    }
+    StringIterator *top = Str_Top(fullpath);
+    String *parent = StrIter_substring(top, iter);
+    DECREF(top);
+    DECREF(iter);
+    return parent;
+}
+
 /***************************************************************************/
 
 #if (defined(CHY_HAS_WINDOWS_H) && !defined(__CYGWIN__))
@@ -391,6 +551,49 @@ S_hard_link(char *from8, char *to8) {
     }
 }
 
+static bool
+S_sync_path(String *path, bool is_dir) {
+    // NTFS journals directory updates itself, and directory handles can't
+    // be flushed.
+    if (is_dir) { return true; }
+
+    char   *path_ptr = Str_To_Utf8(path);
+    HANDLE  handle   = CreateFile(path_ptr, GENERIC_WRITE,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE
+                                  | FILE_SHARE_DELETE,
+                                  NULL, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, NULL);
+    bool retval = true;
+    if (handle == INVALID_HANDLE_VALUE) {
+        DWORD error = GetLastError();
+        if (error != ERROR_FILE_NOT_FOUND && error != ERROR_PATH_NOT_FOUND) {
+            char *win_error = Err_win_error();
+            Err_set_error(Err_new(Str_newf("Can't open '%o' to sync: %s",
+                                           path, win_error)));
+            FREEMEM(win_error);
+            retval = false;
+        }
+    }
+    else {
+        if (!FlushFileBuffers(handle)) {
+            char *win_error = Err_win_error();
+            Err_set_error(Err_new(Str_newf("Failed to sync '%o': %s",
+                                           path, win_error)));
+            FREEMEM(win_error);
+            retval = false;
+        }
+        CloseHandle(handle);
+    }
+    FREEMEM(path_ptr);
+    return retval;
+}
+
+static bool
+S_sync_filesystem(String *path) {
+    UNUSED_VAR(path);
+    return false;
+}
+
 #elif (defined(CHY_HAS_UNISTD_H))
 
 static bool
@@ -422,6 +625,49 @@ S_hard_link(char *from8, char *to8) {
     }
 }
 
+static bool
+S_sync_path(String *path, bool is_dir) {
+    char *path_ptr = Str_To_Utf8(path);
+    int   fd       = open(path_ptr, O_RDONLY);
+    bool  retval   = true;
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            Err_set_error(Err_new(Str_newf("Can't open '%o' to sync: %s",
+                                           path, strerror(errno))));
+            retval = false;
+        }
+    }
+    else {
+        // Some file systems don't support fsync() on directories.
+        if (fsync(fd) == -1 && !(is_dir && errno == EINVAL)) {
+            Err_set_error(Err_new(Str_newf("Failed to sync '%o': %s",
+                                           path, strerror(errno))));
+            retval = false;
+        }
+        close(fd);
+    }
+    FREEMEM(path_ptr);
+    return retval;
+}
+
+static bool
+S_sync_filesystem(String *path) {
+#ifdef SYS_syncfs
+    char *path_ptr = Str_To_Utf8(path);
+    int   fd       = open(path_ptr, O_RDONLY);
+    bool  retval   = false;
+    if (fd != -1) {
+        retval = syscall(SYS_syncfs, fd) == 0;
+        close(fd);
+    }
+    FREEMEM(path_ptr);
+    return retval;
+#else
+    UNUSED_VAR(path);
+    return false;
+#endif
+}
+
 #else
   #error "Need either windows.h or unistd.h"
 #endif /* CHY_HAS_UNISTD_H vs. CHY_HAS_WINDOWS_H */
@@ -18,6 +18,16 @@
 #include "Lucy/Util/ToolSet.h"
 
 #include "Lucy/Store/FileHandle.h"
+#include "Clownfish/Util/SortUtils.h"
+
+// Ranges closer together than this are merged into one readahead request,
+// since reading the gap costs less than issuing another request.
+#define PREFETCH_MERGE_GAP 4096
+
+typedef struct {
+    int64_t start;
+    int64_t end;
+} FHRange;
 
 int32_t FH_object_count = 0;
 
@@ -45,6 +55,12 @@ FH_Destroy_IMP(FileHandle *self) {
     FH_object_count--;
 }
 
+bool
+FH_Fully_Mapped_IMP(FileHandle *self) {
+    UNUSED_VAR(self);
+    return false;
+}
+
 bool
 FH_Grow_IMP(FileHandle *self, int64_t length) {
     UNUSED_VAR(self);
@@ -52,6 +68,80 @@ FH_Grow_IMP(FileHandle *self, int64_t length) {
     return true;
 }
 
+bool
+FH_Advise_IMP(FileHandle *self, int64_t offset, int64_t len,
+              int32_t advice) {
+    UNUSED_VAR(self);
+    UNUSED_VAR(offset);
+    UNUSED_VAR(len);
+    UNUSED_VAR(advice);
+    return true;
+}
+
+static int
+S_compare_ranges(void *context, const void *va, const void *vb) {
+    UNUSED_VAR(context);
+    const FHRange *a = *(FHRange**)va;
+    const FHRange *b = *(FHRange**)vb;
+    return a->start < b->start ? -1 : a->start > b->start ? 1 : 0;
+}
+
+bool
+FH_Prefetch_IMP(FileHandle *self, const int64_t *offsets,
+                const int64_t *lengths, uint32_t num_ranges) {
+    const int64_t file_len = FH_Length(self);
+    if (!num_ranges) { return true; }
+
+    FHRange  *ranges = (FHRange*)MALLOCATE(num_ranges * sizeof(FHRange));
+    FHRange **sorted = (FHRange**)MALLOCATE(num_ranges * sizeof(FHRange*));
+    for (uint32_t i = 0; i < num_ranges; i++) {
+        if (offsets[i] < 0 || lengths[i] < 0
+            || offsets[i] + lengths[i] > file_len
+           ) {
+            Err_set_error(Err_new(Str_newf("Can't prefetch range %i64 + %i64 in '%o' (len %i64)",
+                                           offsets[i], lengths[i],
+                                           FH_IVARS(self)->path, file_len)));
+            FREEMEM(sorted);
+            FREEMEM(ranges);
+            return false;
+        }
+        ranges[i].start = offsets[i];
+        ranges[i].end   = offsets[i] + lengths[i];
+        sorted[i]       = &ranges[i];
+    }
+    Sort_quicksort(sorted, num_ranges, sizeof(FHRange*), S_compare_ranges,
+                   NULL);
+
+    bool     success = true;
+    uint32_t i       = 0;
+    while (i < num_ranges) {
+        int64_t start = sorted[i]->start;
+        int64_t end   = sorted[i]->end;
+        for (i++; i < num_ranges; i++) {
+            if (sorted[i]->start > end + PREFETCH_MERGE_GAP) { break; }
+            if (sorted[i]->end > end) { end = sorted[i]->end; }
+        }
+        if (end > start
+            && !FH_Advise(self, start, end - start, FH_ADVICE_WILLNEED)
+           ) {
+            success = false;
+            break;
+        }
+    }
+
+    FREEMEM(sorted);
+    FREEMEM(ranges);
+    return success;
+}
+
+int64_t
+FH_Resident_Bytes_IMP(FileHandle *self, int64_t offset, int64_t len) {
+    UNUSED_VAR(self);
+    UNUSED_VAR(offset);
+    UNUSED_VAR(len);
+    return -1;
+}
+
 void
 FH_Set_Path_IMP(FileHandle *self, String *path) {
     FileHandleIVARS *const ivars = FH_IVARS(self);
@@ -26,6 +26,7 @@
 #include "Lucy/Store/FileHandle.h"
 #include "Lucy/Store/InStream.h"
 #include "Lucy/Store/OutStream.h"
+#include "Lucy/Store/RateLimiter.h"
 #include "Lucy/Util/IndexFileNames.h"
 
 Folder*
@@ -33,7 +34,8 @@ Folder_init(Folder *self, String *path) {
     FolderIVARS *const ivars = Folder_IVARS(self);
 
     // Init.
-    ivars->entries = Hash_new(16);
+    ivars->entries      = Hash_new(16);
+    ivars->rate_limiter = NULL;
 
     // Copy.
     if (path == NULL) {
@@ -58,9 +60,29 @@ Folder_Destroy_IMP(Folder *self) {
     FolderIVARS *const ivars = Folder_IVARS(self);
     DECREF(ivars->path);
     DECREF(ivars->entries);
+    DECREF(ivars->rate_limiter);
     SUPER_DESTROY(self, FOLDER);
 }
 
+void
+Folder_Set_Rate_Limiter_IMP(Folder *self, RateLimiter *rate_limiter) {
+    FolderIVARS *const ivars = Folder_IVARS(self);
+    RateLimiter *temp = ivars->rate_limiter;
+    ivars->rate_limiter = (RateLimiter*)INCREF(rate_limiter);
+    DECREF(temp);
+}
+
+RateLimiter*
+Folder_Get_Rate_Limiter_IMP(Folder *self) {
+    return Folder_IVARS(self)->rate_limiter;
+}
+
+Folder*
+Folder_Twin_IMP(Folder *self) {
+    UNUSED_VAR(self);
+    return NULL;
+}
+
 InStream*
 Folder_Open_In_IMP(Folder *self, String *path) {
     Folder *enclosing_folder = Folder_Enclosing_Folder(self, path);
@@ -72,6 +94,10 @@ Folder_Open_In_IMP(Folder *self, String *path) {
         if (!instream) {
             ERR_ADD_FRAME(Err_get_error());
         }
+        else if (Folder_IVARS(self)->rate_limiter) {
+            InStream_Set_Rate_Limiter(instream,
+                                      Folder_IVARS(self)->rate_limiter);
+        }
         DECREF(name);
     }
     else {
@@ -81,6 +107,60 @@ Folder_Open_In_IMP(Folder *self, String *path) {
     return instream;
 }
 
+bool
+Folder_Sync_IMP(Folder *self) {
+    UNUSED_VAR(self);
+    return true;
+}
+
+bool
+Folder_Advise_IMP(Folder *self, String *path, int32_t advice) {
+    Folder *enclosing_folder = Folder_Enclosing_Folder(self, path);
+    bool result = false;
+
+    if (enclosing_folder) {
+        String *name = IxFileNames_local_part(path);
+        result = Folder_Local_Advise(enclosing_folder, name, advice);
+        if (!result) {
+            ERR_ADD_FRAME(Err_get_error());
+        }
+        DECREF(name);
+    }
+    else {
+        Err_set_error(Err_new(Str_newf("Invalid path: '%o'", path)));
+    }
+
+    return result;
+}
+
+bool
+Folder_Local_Advise_IMP(Folder *self, String *name, int32_t advice) {
+    InStream *instream = Folder_Local_Open_In(self, name);
+    if (!instream) {
+        ERR_ADD_FRAME(Err_get_error());
+        return false;
+    }
+    InStream_Advise(instream, advice);
+    InStream_Close(instream);
+    DECREF(instream);
+    return true;
+}
+
+double
+Folder_Residency_IMP(Folder *self, String *path) {
+    InStream *instream = Folder_Open_In(self, path);
+    if (!instream) {
+        ERR_ADD_FRAME(Err_get_error());
+        return -1.0;
+    }
+    const int64_t len      = InStream_Length(instream);
+    const int64_t resident = InStream_Resident_Bytes(instream);
+    InStream_Close(instream);
+    DECREF(instream);
+    if (resident < 0) { return -1.0; }
+    return len ? (double)resident / (double)len : 1.0;
+}
+
 /* This method exists as a hook for CompoundFileReader to override; it is
  * necessary because calling CFReader_Local_Open_FileHandle() won't find
  * virtual files.  No other class should need to override it. */
@@ -112,6 +192,10 @@ Folder_Open_Out_IMP(Folder *self, String *path) {
         if (!outstream) {
             ERR_ADD_FRAME(Err_get_error());
         }
+        else if (Folder_IVARS(self)->rate_limiter) {
+            OutStream_Set_Rate_Limiter(outstream,
+                                       Folder_IVARS(self)->rate_limiter);
+        }
     }
     else {
         ERR_ADD_FRAME(Err_get_error());
@@ -405,7 +489,7 @@ Folder_Set_Path_IMP(Folder *self, String *path) {
 }
 
 void
-Folder_Consolidate_IMP(Folder *self, String *path) {
+Folder_Consolidate_IMP(Folder *self, String *path, int32_t alignment) {
     Folder *folder = Folder_Find_Folder(self, path);
     Folder *enclosing_folder = Folder_Enclosing_Folder(self, path);
     if (!folder) {
@@ -415,9 +499,17 @@ Folder_Consolidate_IMP(Folder *self, String *path) {
         THROW(ERR, "Can't consolidate %o twice", path);
     }
     else {
+        // Copying the files is subject to the same I/O budget as writing
+        // them in the first place.
+        RateLimiter *orig_limiter
+            = (RateLimiter*)INCREF(Folder_Get_Rate_Limiter(folder));
+        Folder_Set_Rate_Limiter(folder, Folder_IVARS(self)->rate_limiter);
         CompoundFileWriter *cf_writer = CFWriter_new(folder);
+        if (alignment) { CFWriter_Set_Alignment(cf_writer, alignment); }
         CFWriter_Consolidate(cf_writer);
         DECREF(cf_writer);
+        Folder_Set_Rate_Limiter(folder, orig_limiter);
+        DECREF(orig_limiter);
         if (Str_Get_Size(path)) {
             CompoundFileReader *cf_reader = CFReader_open(folder);
             if (!cf_reader) { RETHROW(INCREF(Err_get_error())); }
@@ -23,6 +23,12 @@
 #include "Lucy/Store/FileWindow.h"
 #include "Lucy/Store/RAMFile.h"
 #include "Lucy/Store/RAMFileHandle.h"
+#include "Lucy/Store/RateLimiter.h"
+
+// A whole-file mapping read under a RateLimiter is exposed this many bytes
+// at a time, so that the reads get charged and a budget set later is
+// noticed.
+#define LUCY_INSTREAM_METERED_SPAN (256 * 1024)
 
 // Inlined version of InStream_Tell.
 static CFISH_INLINE int64_t
@@ -46,6 +52,24 @@ S_fill(InStream *self, int64_t amount);
 static int64_t
 S_refill(InStream *self);
 
+// Map the whole file if the FileHandle allows it cheaply and no
+// RateLimiter is enforcing a budget.
+static void
+S_map_whole(InStream *self);
+
+// Return true if the InStream's RateLimiter is enforcing a budget.
+static CFISH_INLINE bool
+SI_throttled(InStreamIVARS *ivars);
+
+// Expose more of a whole-file mapping under a RateLimiter, at least
+// `amount` bytes from the current position, charging the limiter for it.
+static void
+S_extend_metered(InStream *self, int64_t amount);
+
+// Drop the whole-file window, keeping the file position.
+static void
+S_unmap_whole(InStream *self);
+
 InStream*
 InStream_open(Obj *file) {
     InStream *self = (InStream*)VTable_Make_Obj(INSTREAM);
@@ -61,6 +85,8 @@ InStream_do_open(InStream *self, Obj *file) {
     ivars->limit        = NULL;
     ivars->offset       = 0;
     ivars->window       = FileWindow_new();
+    ivars->rate_limiter = NULL;
+    ivars->direct       = false;
 
     // Obtain a FileHandle.
     if (Obj_Is_A(file, FILEHANDLE)) {
@@ -94,10 +120,74 @@ InStream_do_open(InStream *self, Obj *file) {
         DECREF(self);
         return NULL;
     }
+    S_map_whole(self);
 
     return self;
 }
 
+static CFISH_INLINE bool
+SI_throttled(InStreamIVARS *ivars) {
+    return ivars->rate_limiter
+           && RateLimiter_Get_Bytes_Per_Sec(ivars->rate_limiter) > 0;
+}
+
+static void
+S_map_whole(InStream *self) {
+    InStreamIVARS *const ivars = InStream_IVARS(self);
+    if (SI_throttled(ivars)
+        || !ivars->len
+        || !FH_Fully_Mapped(ivars->file_handle)
+       ) {
+        return;
+    }
+    const int64_t pos = SI_tell(self);
+    if (!FH_Window(ivars->file_handle, ivars->window, ivars->offset,
+                   ivars->len)
+       ) {
+        RETHROW(INCREF(Err_get_error()));
+    }
+    char *const top = FileWindow_Get_Buf(ivars->window);
+    ivars->buf    = top + pos;
+    ivars->limit  = top + ivars->len;
+    ivars->direct = true;
+    if (ivars->rate_limiter) {
+        ivars->limit = ivars->buf;
+        S_extend_metered(self, 0);
+    }
+}
+
+static void
+S_extend_metered(InStream *self, int64_t amount) {
+    InStreamIVARS *const ivars = InStream_IVARS(self);
+    char *const end = FileWindow_Get_Buf(ivars->window) + ivars->len;
+    char *const from = ivars->buf > ivars->limit ? ivars->buf : ivars->limit;
+    if (amount < LUCY_INSTREAM_METERED_SPAN) {
+        amount = LUCY_INSTREAM_METERED_SPAN;
+    }
+    ivars->limit = end - ivars->buf > amount ? ivars->buf + amount : end;
+    if (ivars->limit > from) {
+        RateLimiter_Pause(ivars->rate_limiter,
+                          PTR_TO_I64(ivars->limit) - PTR_TO_I64(from));
+    }
+}
+
+static void
+S_unmap_whole(InStream *self) {
+    InStreamIVARS *const ivars = InStream_IVARS(self);
+    if (!ivars->direct) { return; }
+    const int64_t pos = SI_tell(self);
+    FH_Release_Window(ivars->file_handle, ivars->window);
+    ivars->buf    = NULL;
+    ivars->limit  = NULL;
+    ivars->direct = false;
+    FileWindow_Set_Offset(ivars->window, ivars->offset + pos);
+}
+
+bool
+InStream_Direct_Mapped_IMP(InStream *self) {
+    return InStream_IVARS(self)->direct;
+}
+
 void
 InStream_Close_IMP(InStream *self) {
     InStreamIVARS *const ivars = InStream_IVARS(self);
@@ -107,6 +197,7 @@ InStream_Close_IMP(InStream *self) {
         // shared.
         DECREF(ivars->file_handle);
         ivars->file_handle = NULL;
+        ivars->direct      = false;
     }
 }
 
@@ -118,6 +209,7 @@ InStream_Destroy_IMP(InStream *self) {
     }
     DECREF(ivars->filename);
     DECREF(ivars->window);
+    DECREF(ivars->rate_limiter);
     SUPER_DESTROY(self, INSTREAM);
 }
 
@@ -141,9 +233,12 @@ InStream_Reopen_IMP(InStream *self, String *filename, int64_t offset,
         DECREF(ovars->filename);
         ovars->filename = Str_Clone(filename);
     }
+    S_unmap_whole(other);
     ovars->offset = offset;
     ovars->len    = len;
+    ovars->rate_limiter = (RateLimiter*)INCREF(ivars->rate_limiter);
     InStream_Seek(other, 0);
+    S_map_whole(other);
 
     return other;
 }
@@ -154,6 +249,7 @@ InStream_Clone_IMP(InStream *self) {
     VTable *vtable = InStream_Get_VTable(self);
     InStream *twin = (InStream*)VTable_Make_Obj(vtable);
     InStream_do_open(twin, (Obj*)ivars->file_handle);
+    InStream_Set_Rate_Limiter(twin, ivars->rate_limiter);
     InStream_Seek(twin, SI_tell(self));
     return twin;
 }
@@ -163,6 +259,64 @@ InStream_Get_Filename_IMP(InStream *self) {
     return InStream_IVARS(self)->filename;
 }
 
+void
+InStream_Set_Rate_Limiter_IMP(InStream *self, RateLimiter *rate_limiter) {
+    InStreamIVARS *const ivars = InStream_IVARS(self);
+    RateLimiter *temp = ivars->rate_limiter;
+    ivars->rate_limiter = (RateLimiter*)INCREF(rate_limiter);
+    DECREF(temp);
+
+    // Reads under a budget must go through S_fill() to be charged.  Without
+    // one, the mapping can stay, exposed a span at a time; see S_fill().
+    S_unmap_whole(self);
+    if (ivars->file_handle) { S_map_whole(self); }
+}
+
+RateLimiter*
+InStream_Get_Rate_Limiter_IMP(InStream *self) {
+    return InStream_IVARS(self)->rate_limiter;
+}
+
+void
+InStream_Advise_IMP(InStream *self, int32_t advice) {
+    InStreamIVARS *const ivars = InStream_IVARS(self);
+    if (ivars->file_handle) {
+        FH_Advise(ivars->file_handle, ivars->offset, ivars->len, advice);
+    }
+}
+
+int64_t
+InStream_Resident_Bytes_IMP(InStream *self) {
+    InStreamIVARS *const ivars = InStream_IVARS(self);
+    if (!ivars->file_handle) { return -1; }
+    return FH_Resident_Bytes(ivars->file_handle, ivars->offset, ivars->len);
+}
+
+void
+InStream_Prefetch_IMP(InStream *self, const int64_t *offsets,
+                      const int64_t *lengths, uint32_t num_ranges) {
+    InStreamIVARS *const ivars = InStream_IVARS(self);
+    if (!ivars->file_handle || !num_ranges) { return; }
+
+    // Translate to file positions, dropping anything outside the stream.
+    int64_t *file_offsets
+        = (int64_t*)MALLOCATE(num_ranges * 2 * sizeof(int64_t));
+    int64_t *file_lengths = file_offsets + num_ranges;
+    uint32_t num_valid    = 0;
+    for (uint32_t i = 0; i < num_ranges; i++) {
+        int64_t start = offsets[i];
+        int64_t end   = offsets[i] + lengths[i];
+        if (start < 0) { start = 0; }
+        if (end > ivars->len) { end = ivars->len; }
+        if (end <= start) { continue; }
+        file_offsets[num_valid] = ivars->offset + start;
+        file_lengths[num_valid] = end - start;
+        num_valid++;
+    }
+    FH_Prefetch(ivars->file_handle, file_offsets, file_lengths, num_valid);
+    FREEMEM(file_offsets);
+}
+
 static int64_t
 S_refill(InStream *self) {
     InStreamIVARS *const ivars = InStream_IVARS(self);
@@ -203,6 +357,31 @@ S_fill(InStream *self, int64_t amount) {
               ivars->filename, virtual_file_pos, ivars->len, amount);
     }
 
+    // The whole file is already in the window.  Under a RateLimiter, it's
+    // exposed a span at a time, checking whether a budget has been set in
+    // the meantime -- and if so, dropping the mapping.  Likewise, a lifted
+    // budget lets the mapping come back.
+    if (ivars->direct) {
+        if (!ivars->rate_limiter) { return; }
+        if (!SI_throttled(ivars)) {
+            S_extend_metered(self, amount);
+            return;
+        }
+        S_unmap_whole(self);
+    }
+    else if (ivars->rate_limiter && !SI_throttled(ivars)) {
+        S_map_whole(self);
+        if (ivars->direct) {
+            S_extend_metered(self, amount);
+            return;
+        }
+    }
+
+    // Charge the I/O budget, if any.
+    if (ivars->rate_limiter) {
+        RateLimiter_Pause(ivars->rate_limiter, amount);
+    }
+
     // Make the request.
     if (FH_Window(ivars->file_handle, window, real_file_pos, amount)) {
         char    *fw_buf    = FileWindow_Get_Buf(window);
@@ -372,6 +551,9 @@ SI_read_bytes(InStream *self, char* buf, size_t len) {
             // read.
             const int64_t sub_file_pos  = SI_tell(self);
             const int64_t real_file_pos = sub_file_pos + ivars->offset;
+            if (ivars->rate_limiter) {
+                RateLimiter_Pause(ivars->rate_limiter, (int64_t)len);
+            }
             bool success
                 = FH_Read(ivars->file_handle, buf, real_file_pos, len);
             if (!success) {
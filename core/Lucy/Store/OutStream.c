@@ -24,6 +24,8 @@
 #include "Lucy/Store/InStream.h"
 #include "Lucy/Store/RAMFile.h"
 #include "Lucy/Store/RAMFileHandle.h"
+#include "Lucy/Store/RateLimiter.h"
+#include "Lucy/Util/Checksum.h"
 
 // Inlined version of OutStream_Write_Bytes.
 static CFISH_INLINE void
@@ -49,9 +51,12 @@ OutStream_do_open(OutStream *self, Obj *file) {
     OutStreamIVARS *const ivars = OutStream_IVARS(self);
 
     // Init.
-    ivars->buf         = (char*)MALLOCATE(IO_STREAM_BUF_SIZE);
-    ivars->buf_start   = 0;
-    ivars->buf_pos     = 0;
+    ivars->buf          = (char*)MALLOCATE(IO_STREAM_BUF_SIZE);
+    ivars->buf_start    = 0;
+    ivars->buf_pos      = 0;
+    ivars->rate_limiter = NULL;
+    ivars->crc          = 0;
+    ivars->crc_pos      = 0;
 
     // Obtain a FileHandle.
     if (Obj_Is_A(file, FILEHANDLE)) {
@@ -94,6 +99,7 @@ OutStream_Destroy_IMP(OutStream *self) {
         DECREF(ivars->file_handle);
     }
     DECREF(ivars->path);
+    DECREF(ivars->rate_limiter);
     FREEMEM(ivars->buf);
     SUPER_DESTROY(self, OUTSTREAM);
 }
@@ -103,6 +109,19 @@ OutStream_Get_Path_IMP(OutStream *self) {
     return OutStream_IVARS(self)->path;
 }
 
+void
+OutStream_Set_Rate_Limiter_IMP(OutStream *self, RateLimiter *rate_limiter) {
+    OutStreamIVARS *const ivars = OutStream_IVARS(self);
+    RateLimiter *temp = ivars->rate_limiter;
+    ivars->rate_limiter = (RateLimiter*)INCREF(rate_limiter);
+    DECREF(temp);
+}
+
+RateLimiter*
+OutStream_Get_Rate_Limiter_IMP(OutStream *self) {
+    return OutStream_IVARS(self)->rate_limiter;
+}
+
 void
 OutStream_Absorb_IMP(OutStream *self, InStream *instream) {
     OutStreamIVARS *const ivars = OutStream_IVARS(self);
@@ -147,6 +166,22 @@ OutStream_Align_IMP(OutStream *self, int64_t modulus) {
     return OutStream_Tell(self);
 }
 
+uint32_t
+OutStream_Get_Checksum_IMP(OutStream *self) {
+    OutStreamIVARS *const ivars = OutStream_IVARS(self);
+    ivars->crc = Checksum_crc32c(ivars->crc, ivars->buf + ivars->crc_pos,
+                                 ivars->buf_pos - ivars->crc_pos);
+    ivars->crc_pos = ivars->buf_pos;
+    return ivars->crc;
+}
+
+void
+OutStream_Reset_Checksum_IMP(OutStream *self) {
+    OutStreamIVARS *const ivars = OutStream_IVARS(self);
+    ivars->crc     = 0;
+    ivars->crc_pos = ivars->buf_pos;
+}
+
 void
 OutStream_Flush_IMP(OutStream *self) {
     OutStreamIVARS *const ivars = OutStream_IVARS(self);
@@ -159,9 +194,15 @@ S_flush(OutStream *self, OutStreamIVARS *ivars) {
     if (ivars->file_handle == NULL) {
         THROW(ERR, "Can't write to a closed OutStream for %o", ivars->path);
     }
+    if (ivars->rate_limiter && ivars->buf_pos) {
+        RateLimiter_Pause(ivars->rate_limiter, (int64_t)ivars->buf_pos);
+    }
     if (!FH_Write(ivars->file_handle, ivars->buf, ivars->buf_pos)) {
         RETHROW(INCREF(Err_get_error()));
     }
+    ivars->crc = Checksum_crc32c(ivars->crc, ivars->buf + ivars->crc_pos,
+                                 ivars->buf_pos - ivars->crc_pos);
+    ivars->crc_pos = 0;
     ivars->buf_start += ivars->buf_pos;
     ivars->buf_pos = 0;
 }
@@ -182,9 +223,13 @@ SI_write_bytes(OutStream *self, OutStreamIVARS *ivars,
     // If this data is larger than the buffer size, flush and write.
     if (len >= IO_STREAM_BUF_SIZE) {
         S_flush(self, ivars);
+        if (ivars->rate_limiter) {
+            RateLimiter_Pause(ivars->rate_limiter, (int64_t)len);
+        }
         if (!FH_Write(ivars->file_handle, bytes, len)) {
             RETHROW(INCREF(Err_get_error()));
         }
+        ivars->crc = Checksum_crc32c(ivars->crc, bytes, len);
         ivars->buf_start += len;
     }
     // If there's not enough room in the buffer, flush then add.
@@ -176,6 +176,18 @@ RAMFH_Length_IMP(RAMFileHandle *self) {
     return RAMFH_IVARS(self)->len;
 }
 
+int64_t
+RAMFH_Resident_Bytes_IMP(RAMFileHandle *self, int64_t offset, int64_t len) {
+    RAMFileHandleIVARS *const ivars = RAMFH_IVARS(self);
+    if (offset < 0 || len < 0 || offset + len > ivars->len) {
+        Err_set_error(Err_new(Str_newf("Range %i64 + %i64 out of bounds in '%o' (len %i64)",
+                                       offset, len, ivars->path, ivars->len)));
+        return -1;
+    }
+    // RAM files are always resident.
+    return len;
+}
+
 bool
 RAMFH_Close_IMP(RAMFileHandle *self) {
     UNUSED_VAR(self);
@@ -53,6 +53,16 @@ RAMFolder_Check_IMP(RAMFolder *self) {
     return true;
 }
 
+Folder*
+RAMFolder_Twin_IMP(RAMFolder *self) {
+    RAMFolderIVARS *const ivars = RAMFolder_IVARS(self);
+    RAMFolder *twin = RAMFolder_new(ivars->path);
+    RAMFolderIVARS *const twin_ivars = RAMFolder_IVARS(twin);
+    DECREF(twin_ivars->entries);
+    twin_ivars->entries = (Hash*)INCREF(ivars->entries);
+    return (Folder*)twin;
+}
+
 bool
 RAMFolder_Local_MkDir_IMP(RAMFolder *self, String *name) {
     RAMFolderIVARS *const ivars = RAMFolder_IVARS(self);
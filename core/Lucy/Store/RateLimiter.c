@@ -0,0 +1,109 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_RATELIMITER
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Store/RateLimiter.h"
+#include "Lucy/Util/Clock.h"
+#include "Lucy/Util/Sleep.h"
+
+// Don't bother consulting the clock more often than once per this many
+// milliseconds' worth of budget.
+#define LUCY_RATELIMITER_CHECK_MILLIS 10
+
+// Start a fresh measurement window.
+static void
+S_reset_window(RateLimiter *self, RateLimiterIVARS *ivars);
+
+RateLimiter*
+RateLimiter_new(int64_t bytes_per_sec) {
+    RateLimiter *self = (RateLimiter*)VTable_Make_Obj(RATELIMITER);
+    return RateLimiter_init(self, bytes_per_sec);
+}
+
+RateLimiter*
+RateLimiter_init(RateLimiter *self, int64_t bytes_per_sec) {
+    RateLimiterIVARS *const ivars = RateLimiter_IVARS(self);
+    ivars->total_bytes = 0;
+    RateLimiter_Set_Bytes_Per_Sec(self, bytes_per_sec);
+    return self;
+}
+
+static void
+S_reset_window(RateLimiter *self, RateLimiterIVARS *ivars) {
+    UNUSED_VAR(self);
+    ivars->window_bytes = 0;
+    ivars->window_start = Clock_microtime();
+}
+
+void
+RateLimiter_Set_Bytes_Per_Sec_IMP(RateLimiter *self, int64_t bytes_per_sec) {
+    RateLimiterIVARS *const ivars = RateLimiter_IVARS(self);
+    if (bytes_per_sec < 0) {
+        THROW(ERR, "Invalid value for bytes_per_sec: %i64", bytes_per_sec);
+    }
+    ivars->bytes_per_sec  = bytes_per_sec;
+    ivars->check_interval
+        = bytes_per_sec * LUCY_RATELIMITER_CHECK_MILLIS / 1000;
+    S_reset_window(self, ivars);
+}
+
+int64_t
+RateLimiter_Get_Bytes_Per_Sec_IMP(RateLimiter *self) {
+    return RateLimiter_IVARS(self)->bytes_per_sec;
+}
+
+int64_t
+RateLimiter_Get_Total_Bytes_IMP(RateLimiter *self) {
+    return RateLimiter_IVARS(self)->total_bytes;
+}
+
+uint32_t
+RateLimiter_Pause_IMP(RateLimiter *self, int64_t bytes) {
+    RateLimiterIVARS *const ivars = RateLimiter_IVARS(self);
+    ivars->total_bytes += bytes;
+    if (!ivars->bytes_per_sec) { return 0; }
+
+    ivars->window_bytes += bytes;
+    if (ivars->window_bytes < ivars->check_interval) { return 0; }
+
+    // Compare the time the I/O in this window should have taken against the
+    // time it actually took.
+    const uint64_t now     = Clock_microtime();
+    const uint64_t elapsed = now > ivars->window_start
+                             ? now - ivars->window_start
+                             : 0;
+    const uint64_t target
+        = (uint64_t)((double)ivars->window_bytes * 1000000.0
+                     / (double)ivars->bytes_per_sec);
+    if (target <= elapsed) {
+        // We're within budget.  Start over so that idle time doesn't
+        // accumulate into a burst allowance.
+        S_reset_window(self, ivars);
+        return 0;
+    }
+
+    const uint64_t millis = (target - elapsed) / 1000;
+    if (millis) {
+        Sleep_millisleep(millis > UINT32_MAX ? UINT32_MAX : (uint32_t)millis);
+    }
+    S_reset_window(self, ivars);
+    return (uint32_t)millis;
+}
+
+
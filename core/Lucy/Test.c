@@ -32,6 +32,7 @@
 #include "Lucy/Test/Analysis/TestStandardTokenizer.h"
 #include "Lucy/Test/Highlight/TestHeatMap.h"
 #include "Lucy/Test/Highlight/TestHighlighter.h"
+#include "Lucy/Test/Index/TestBackgroundMerger.h"
 #include "Lucy/Test/Index/TestDocWriter.h"
 #include "Lucy/Test/Index/TestHighlightWriter.h"
 #include "Lucy/Test/Index/TestIndexManager.h"
@@ -41,6 +42,7 @@
 #include "Lucy/Test/Index/TestSegment.h"
 #include "Lucy/Test/Index/TestSnapshot.h"
 #include "Lucy/Test/Index/TestTermInfo.h"
+#include "Lucy/Test/Index/TestTieredMergePolicy.h"
 #include "Lucy/Test/Object/TestBitVector.h"
 #include "Lucy/Test/Object/TestI32Array.h"
 #include "Lucy/Test/Plan/TestBlobType.h"
@@ -50,14 +52,17 @@
 #include "Lucy/Test/Plan/TestNumericType.h"
 #include "Lucy/Test/Search/TestLeafQuery.h"
 #include "Lucy/Test/Search/TestMatchAllQuery.h"
+#include "Lucy/Test/Search/TestMultiTermQuery.h"
 #include "Lucy/Test/Search/TestNOTQuery.h"
 #include "Lucy/Test/Search/TestNoMatchQuery.h"
 #include "Lucy/Test/Search/TestPhraseQuery.h"
 #include "Lucy/Test/Search/TestPolyQuery.h"
 #include "Lucy/Test/Search/TestQueryParserLogic.h"
+#include "Lucy/Test/Search/TestQueryPlan.h"
 #include "Lucy/Test/Search/TestQueryParserSyntax.h"
 #include "Lucy/Test/Search/TestRangeQuery.h"
 #include "Lucy/Test/Search/TestReqOptQuery.h"
+#include "Lucy/Test/Search/TestSearchBudget.h"
 #include "Lucy/Test/Search/TestSeriesMatcher.h"
 #include "Lucy/Test/Search/TestSortSpec.h"
 #include "Lucy/Test/Search/TestSpan.h"
@@ -75,11 +80,16 @@
 #include "Lucy/Test/Store/TestRAMDirHandle.h"
 #include "Lucy/Test/Store/TestRAMFileHandle.h"
 #include "Lucy/Test/Store/TestRAMFolder.h"
+#include "Lucy/Test/Store/TestRateLimiter.h"
 #include "Lucy/Test/TestSchema.h"
+#include "Lucy/Test/Util/TestBloomFilter.h"
+#include "Lucy/Test/Util/TestChecksum.h"
 #include "Lucy/Test/Util/TestIndexFileNames.h"
 #include "Lucy/Test/Util/TestJson.h"
+#include "Lucy/Test/Util/TestLZBlock.h"
 #include "Lucy/Test/Util/TestMemoryPool.h"
 #include "Lucy/Test/Util/TestPriorityQueue.h"
+#include "Lucy/Test/Util/TestTransducer.h"
 
 TestSuite*
 Test_create_test_suite() {
@@ -90,6 +100,10 @@ Test_create_test_suite() {
     TestSuite_Add_Batch(suite, (TestBatch*)TestMemPool_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestIxFileNames_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestJson_new());
+    TestSuite_Add_Batch(suite, (TestBatch*)TestLZBlock_new());
+    TestSuite_Add_Batch(suite, (TestBatch*)TestChecksum_new());
+    TestSuite_Add_Batch(suite, (TestBatch*)TestTransducer_new());
+    TestSuite_Add_Batch(suite, (TestBatch*)TestBloomFilter_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestI32Arr_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestRAMFH_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestFSFH_new());
@@ -102,7 +116,10 @@ Test_create_test_suite() {
     TestSuite_Add_Batch(suite, (TestBatch*)TestFSFolder_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestRAMFolder_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestFolder_new());
+    TestSuite_Add_Batch(suite, (TestBatch*)TestRateLimiter_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestIxManager_new());
+    TestSuite_Add_Batch(suite, (TestBatch*)TestTieredMergePol_new());
+    TestSuite_Add_Batch(suite, (TestBatch*)TestBGMerger_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestCFWriter_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestCFReader_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestAnalyzer_new());
@@ -134,6 +151,7 @@ Test_create_test_suite() {
     TestSuite_Add_Batch(suite, (TestBatch*)TestPhraseQuery_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestSortSpec_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestRangeQuery_new());
+    TestSuite_Add_Batch(suite, (TestBatch*)TestMultiTermQuery_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestANDQuery_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestMatchAllQuery_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestNOTQuery_new());
@@ -142,6 +160,8 @@ Test_create_test_suite() {
     TestSuite_Add_Batch(suite, (TestBatch*)TestNoMatchQuery_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestSeriesMatcher_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestORQuery_new());
+    TestSuite_Add_Batch(suite, (TestBatch*)TestQueryPlan_new());
+    TestSuite_Add_Batch(suite, (TestBatch*)TestSearchBudget_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestQPLogic_new());
     TestSuite_Add_Batch(suite, (TestBatch*)TestQPSyntax_new());
 
@@ -256,7 +256,7 @@ test_Create_Excerpt(TestBatchRunner *runner, Searcher *searcher, Obj *query,
     DECREF(highlighter);
 
     query = (Obj*)SSTR_WRAP_UTF8("x \"x y z\" AND b", 15);
-    hits = Searcher_Hits(searcher, query, 0, 10, NULL);
+    hits = Searcher_Hits(searcher, query, 0, 10, NULL, NULL, NULL);
     highlighter = Highlighter_new(searcher, query, content, 200);
     hit = Hits_Next(hits);
     excerpt = Highlighter_Create_Excerpt(highlighter, hit);
@@ -271,7 +271,7 @@ test_Create_Excerpt(TestBatchRunner *runner, Searcher *searcher, Obj *query,
     DECREF(hits);
 
     query = (Obj*)SSTR_WRAP_UTF8("blind", 5);
-    hits = Searcher_Hits(searcher, query, 0, 10, NULL);
+    hits = Searcher_Hits(searcher, query, 0, 10, NULL, NULL, NULL);
     highlighter = Highlighter_new(searcher, query, content, 200);
     hit = Hits_Next(hits);
     excerpt = Highlighter_Create_Excerpt(highlighter, hit);
@@ -284,7 +284,7 @@ test_Create_Excerpt(TestBatchRunner *runner, Searcher *searcher, Obj *query,
     DECREF(hits);
 
     query = (Obj*)SSTR_WRAP_UTF8("why", 3);
-    hits = Searcher_Hits(searcher, query, 0, 10, NULL);
+    hits = Searcher_Hits(searcher, query, 0, 10, NULL, NULL, NULL);
     highlighter = Highlighter_new(searcher, query, content, 200);
     hit = Hits_Next(hits);
     excerpt = Highlighter_Create_Excerpt(highlighter, hit);
@@ -298,7 +298,7 @@ test_Create_Excerpt(TestBatchRunner *runner, Searcher *searcher, Obj *query,
 
     Obj *term = (Obj*)SSTR_WRAP_UTF8("x", 1);
     query = (Obj*)TermQuery_new(content, term);
-    hits = Searcher_Hits(searcher, query, 0, 10, NULL);
+    hits = Searcher_Hits(searcher, query, 0, 10, NULL, NULL, NULL);
     hit = Hits_Next(hits);
     highlighter = Highlighter_new(searcher, query, content, 200);
     excerpt = Highlighter_Create_Excerpt(highlighter, hit);
@@ -367,7 +367,7 @@ test_highlighting(TestBatchRunner *runner) {
 
     Searcher *searcher = (Searcher*)IxSearcher_new((Obj*)folder);
     Obj *query = (Obj*)SSTR_WRAP_UTF8("\"x y z\" AND " PHI, 14);
-    Hits *hits = Searcher_Hits(searcher, query, 0, 10, NULL);
+    Hits *hits = Searcher_Hits(searcher, query, 0, 10, NULL, NULL, NULL);
 
     test_Raw_Excerpt(runner, searcher, query);
     test_Highlight_Excerpt(runner, searcher, query);
@@ -419,7 +419,7 @@ test_hl_selection(TestBatchRunner *runner) {
     Searcher *searcher = (Searcher*)IxSearcher_new((Obj*)folder);
     Obj *query = (Obj*)SSTR_WRAP_UTF8("NNN MMM", 7);
     Highlighter *highlighter = Highlighter_new(searcher, query, content, 200);
-    Hits *hits = Searcher_Hits(searcher, query, 0, 10, NULL);
+    Hits *hits = Searcher_Hits(searcher, query, 0, 10, NULL, NULL, NULL);
     HitDoc *hit = Hits_Next(hits);
     String *excerpt = Highlighter_Create_Excerpt(highlighter, hit);
     String *mmm = (String*)SSTR_WRAP_UTF8("MMM", 3);
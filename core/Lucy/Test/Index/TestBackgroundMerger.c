@@ -0,0 +1,176 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define TESTLUCY_USE_SHORT_NAMES
+#include "Lucy/Util/ToolSet.h"
+
+#include "Clownfish/TestHarness/TestBatchRunner.h"
+#include "Lucy/Test.h"
+#include "Lucy/Test/Index/TestBackgroundMerger.h"
+#include "Lucy/Test/TestSchema.h"
+#include "Lucy/Document/Doc.h"
+#include "Lucy/Index/BackgroundMerger.h"
+#include "Lucy/Index/IndexManager.h"
+#include "Lucy/Index/Indexer.h"
+#include "Lucy/Index/PolyReader.h"
+#include "Lucy/Index/TieredMergePolicy.h"
+#include "Lucy/Store/RAMFolder.h"
+#include "Lucy/Util/Sleep.h"
+
+TestBackgroundMerger*
+TestBGMerger_new() {
+    return (TestBackgroundMerger*)VTable_Make_Obj(TESTBACKGROUNDMERGER);
+}
+
+// Add `num_segs` single-document segments, without merging.
+static void
+S_add_segments(Folder *folder, int num_segs) {
+    Schema            *schema = (Schema*)TestSchema_new(false);
+    String            *field  = (String*)SSTR_WRAP_UTF8("content", 7);
+    TieredMergePolicy *policy = TieredMergePol_new();
+
+    TieredMergePol_Set_Segs_Per_Tier(policy, 1000);
+
+    for (int i = 0; i < num_segs; i++) {
+        IndexManager *manager = IxManager_new(NULL, NULL);
+        IxManager_Set_Merge_Policy(manager, (MergePolicy*)policy);
+        Indexer *indexer = Indexer_new(schema, (Obj*)folder, manager, 0);
+        Doc *doc = Doc_new(NULL, 0);
+        String *value = Str_newf("doc %i32", (int32_t)i);
+        Doc_Store(doc, field, (Obj*)value);
+        Indexer_Add_Doc(indexer, doc, 1.0f);
+        Indexer_Commit(indexer);
+        DECREF(value);
+        DECREF(doc);
+        DECREF(indexer);
+        DECREF(manager);
+    }
+
+    DECREF(policy);
+    DECREF(schema);
+}
+
+static uint32_t
+S_num_segs(Folder *folder) {
+    PolyReader *reader = PolyReader_open((Obj*)folder, NULL, NULL);
+    uint32_t num_segs = VA_Get_Size(PolyReader_Get_Seg_Readers(reader));
+    DECREF(reader);
+    return num_segs;
+}
+
+static int32_t
+S_doc_count(Folder *folder) {
+    PolyReader *reader = PolyReader_open((Obj*)folder, NULL, NULL);
+    int32_t doc_count = PolyReader_Doc_Count(reader);
+    DECREF(reader);
+    return doc_count;
+}
+
+static void
+test_time_budget(TestBatchRunner *runner) {
+    RAMFolder *folder = RAMFolder_new(NULL);
+    S_add_segments((Folder*)folder, 5);
+
+    // Exhaust the time budget before merging starts, so that only one
+    // segment gets merged before the first checkpoint.
+    BackgroundMerger *bg_merger = BGMerger_new((Obj*)folder, NULL);
+    BGMerger_Optimize(bg_merger);
+    BGMerger_Set_Time_Budget(bg_merger, 1);
+    TEST_INT_EQ(runner, BGMerger_Get_Time_Budget(bg_merger), 1,
+                "Get_Time_Budget");
+    Sleep_millisleep(5);
+    TEST_TRUE(runner, BGMerger_ETA(bg_merger) == -1.0,
+              "no ETA before merging");
+    BGMerger_Prepare_Commit(bg_merger);
+    int64_t bytes_done  = BGMerger_Bytes_Done(bg_merger);
+    int64_t bytes_total = BGMerger_Bytes_Total(bg_merger);
+    TEST_TRUE(runner, bytes_done > 0 && bytes_done < bytes_total,
+              "partial progress (%i64 of %i64 bytes)", bytes_done,
+              bytes_total);
+    TEST_TRUE(runner, BGMerger_ETA(bg_merger) > 0.0, "ETA");
+    BGMerger_Commit(bg_merger);
+    DECREF(bg_merger);
+    TEST_INT_EQ(runner, S_num_segs((Folder*)folder), 5,
+                "segments left over by exhausted time budget remain");
+    TEST_INT_EQ(runner, S_doc_count((Folder*)folder), 5,
+                "no docs lost by checkpointed merge");
+
+    // The next session picks up where the last one left off.
+    bg_merger = BGMerger_new((Obj*)folder, NULL);
+    BGMerger_Optimize(bg_merger);
+    BGMerger_Set_IO_Budget(bg_merger, 1024 * 1024);
+    TEST_TRUE(runner, BGMerger_Get_IO_Budget(bg_merger) == 1024 * 1024,
+              "Get_IO_Budget");
+    TEST_TRUE(runner, RAMFolder_Get_Rate_Limiter(folder) == NULL,
+              "I/O budget leaves the caller's Folder alone");
+    BGMerger_Commit(bg_merger);
+    TEST_TRUE(runner, BGMerger_Bytes_Done(bg_merger)
+                      == BGMerger_Bytes_Total(bg_merger),
+              "all bytes done");
+    TEST_TRUE(runner, BGMerger_ETA(bg_merger) == 0.0, "ETA when done");
+    TEST_TRUE(runner, RAMFolder_Get_Rate_Limiter(folder) == NULL,
+              "Folder's RateLimiter untouched after Commit");
+    DECREF(bg_merger);
+    TEST_INT_EQ(runner, S_num_segs((Folder*)folder), 1, "resumed merge");
+    TEST_INT_EQ(runner, S_doc_count((Folder*)folder), 5,
+                "no docs lost by resumed merge");
+
+    DECREF(folder);
+}
+
+static void
+test_Abandon(TestBatchRunner *runner) {
+    RAMFolder *folder = RAMFolder_new(NULL);
+    S_add_segments((Folder*)folder, 3);
+
+    BackgroundMerger *bg_merger = BGMerger_new((Obj*)folder, NULL);
+    BGMerger_Optimize(bg_merger);
+    BGMerger_Prepare_Commit(bg_merger);
+    TEST_TRUE(runner,
+              RAMFolder_Exists(folder, (String*)SSTR_WRAP_UTF8("seg_4", 5)),
+              "Prepare_Commit writes new segment");
+    BGMerger_Abandon(bg_merger);
+    TEST_FALSE(runner,
+               RAMFolder_Exists(folder, (String*)SSTR_WRAP_UTF8("seg_4", 5)),
+               "Abandon deletes new segment");
+    TEST_FALSE(runner,
+               RAMFolder_Exists(folder,
+                                (String*)SSTR_WRAP_UTF8("merge.json", 10)),
+               "Abandon removes merge data");
+    DECREF(bg_merger);
+    TEST_INT_EQ(runner, S_num_segs((Folder*)folder), 3,
+                "Abandon leaves index untouched");
+
+    // The merge lock has been released, so another session can proceed.
+    bg_merger = BGMerger_new((Obj*)folder, NULL);
+    BGMerger_Optimize(bg_merger);
+    BGMerger_Commit(bg_merger);
+    DECREF(bg_merger);
+    TEST_INT_EQ(runner, S_num_segs((Folder*)folder), 1,
+                "merge succeeds after Abandon");
+
+    DECREF(folder);
+}
+
+void
+TestBGMerger_Run_IMP(TestBackgroundMerger *self, TestBatchRunner *runner) {
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 18);
+    test_time_budget(runner);
+    test_Abandon(runner);
+}
+
+
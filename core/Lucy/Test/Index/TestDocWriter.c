@@ -15,23 +15,595 @@
  */
 
 #define C_TESTLUCY_TESTDOCWRITER
+#define C_TESTLUCY_LEGACYDOCWRITER
+#define C_TESTLUCY_LEGACYDOCARCHITECTURE
+#define C_TESTLUCY_LEGACYDOCSCHEMA
 #define TESTLUCY_USE_SHORT_NAMES
 #include "Lucy/Util/ToolSet.h"
 
 #include "Clownfish/TestHarness/TestBatchRunner.h"
 #include "Lucy/Test.h"
 #include "Lucy/Test/Index/TestDocWriter.h"
+#include "Lucy/Test/Plan/TestArchitecture.h"
+#include "Lucy/Test/TestSchema.h"
+#include "Lucy/Document/Doc.h"
+#include "Lucy/Document/HitDoc.h"
+#include "Lucy/Index/DocReader.h"
 #include "Lucy/Index/DocWriter.h"
+#include "Lucy/Index/Indexer.h"
+#include "Lucy/Index/Inverter.h"
+#include "Lucy/Index/PolyReader.h"
+#include "Lucy/Index/SegReader.h"
+#include "Lucy/Index/Segment.h"
+#include "Lucy/Index/SegWriter.h"
+#include "Lucy/Index/Snapshot.h"
+#include "Lucy/Plan/FieldType.h"
+#include "Lucy/Plan/StringType.h"
+#include "Lucy/Search/Hits.h"
+#include "Lucy/Search/IndexSearcher.h"
+#include "Lucy/Search/TermQuery.h"
+#include "Lucy/Store/Folder.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/OutStream.h"
+#include "Lucy/Store/RAMFile.h"
+#include "Lucy/Store/RAMFolder.h"
+#include "Lucy/Util/Freezer.h"
+
+// Number of records in each format 3 chunk.
+#define LEGACY_CHUNK_DOCS 4
 
 TestDocWriter*
 TestDocWriter_new() {
     return (TestDocWriter*)VTable_Make_Obj(TESTDOCWRITER);
 }
 
+static void
+S_add_docs(Obj *index, Schema *schema, int32_t first, int32_t last) {
+    Indexer *indexer = Indexer_new(schema, index, NULL, 0);
+    String  *field   = (String*)SSTR_WRAP_UTF8("content", 7);
+    for (int32_t i = first; i <= last; i++) {
+        Doc    *doc   = Doc_new(NULL, 0);
+        String *value = Str_newf("the quick brown fox jumps over %i32", i);
+        Doc_Store(doc, field, (Obj*)value);
+        Indexer_Add_Doc(indexer, doc, 1.0f);
+        DECREF(value);
+        DECREF(doc);
+    }
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+}
+
+// Check that each doc id in turn holds the next of the expected values.
+static bool
+S_docs_match(Obj *index, const int32_t *expected, int32_t num_expected) {
+    IndexSearcher *searcher = IxSearcher_new(index);
+    String *field = (String*)SSTR_WRAP_UTF8("content", 7);
+    bool    match = IxSearcher_Doc_Max(searcher) == num_expected;
+    for (int32_t i = 0; match && i < num_expected; i++) {
+        HitDoc *hit_doc = IxSearcher_Fetch_Doc(searcher, i + 1);
+        Obj    *value   = HitDoc_Extract(hit_doc, field);
+        String *wanted  = Str_newf("the quick brown fox jumps over %i32",
+                                   expected[i]);
+        match = value && Obj_Equals(value, (Obj*)wanted);
+        DECREF(wanted);
+        DECREF(value);
+        DECREF(hit_doc);
+    }
+    DECREF(searcher);
+    return match;
+}
+
+// Return the raw chunks of a segment's documents.dat, in order.
+static VArray*
+S_raw_chunks(Obj *index, uint32_t seg_tick) {
+    PolyReader *reader      = PolyReader_open(index, NULL, NULL);
+    VArray     *seg_readers = PolyReader_Seg_Readers(reader);
+    SegReader  *seg_reader  = (SegReader*)VA_Fetch(seg_readers, seg_tick);
+    DefaultDocReader *doc_reader = (DefaultDocReader*)CERTIFY(
+        SegReader_Obtain(seg_reader, VTable_Get_Name(DOCREADER)),
+        DEFAULTDOCREADER);
+    uint32_t num_chunks = DefDocReader_Chunk_Count(doc_reader);
+    VArray  *chunks     = VA_new(num_chunks);
+    for (uint32_t tick = 0; tick < num_chunks; tick++) {
+        ByteBuf *chunk = BB_new(0);
+        DefDocReader_Read_Raw_Chunk(doc_reader, chunk, tick);
+        VA_Push(chunks, (Obj*)chunk);
+    }
+    DECREF(seg_readers);
+    DECREF(reader);
+    return chunks;
+}
+
+static void
+test_chunks_and_merge(TestBatchRunner *runner) {
+    // TestSchema uses tiny chunks, so each segment spans many of them.
+    Schema    *schema = (Schema*)TestSchema_new(false);
+    RAMFolder *folder = RAMFolder_new(NULL);
+    int32_t    expected[60];
+    int32_t    num_expected = 0;
+
+    S_add_docs((Obj*)folder, schema, 1, 40);
+    S_add_docs((Obj*)folder, schema, 41, 60);
+    for (int32_t i = 1; i <= 60; i++) { expected[num_expected++] = i; }
+    TEST_TRUE(runner, S_docs_match((Obj*)folder, expected, num_expected),
+              "Fetch docs spread across chunks");
+
+    // Deleting from the first segment forces its records to be recompressed
+    // during the merge, while the second segment's chunks are copied.
+    VArray  *copied  = S_raw_chunks((Obj*)folder, 1);
+    Indexer *indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    for (int32_t i = 5; i <= 9; i++) {
+        Indexer_Delete_By_Doc_ID(indexer, i);
+    }
+    Indexer_Optimize(indexer);
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+    num_expected = 0;
+    for (int32_t i = 1; i <= 60; i++) {
+        if (i < 5 || i > 9) { expected[num_expected++] = i; }
+    }
+    TEST_TRUE(runner, S_docs_match((Obj*)folder, expected, num_expected),
+              "Fetch docs after merging with deletions");
+
+    // The merged segment ends with the second segment's chunks, byte for
+    // byte.
+    VArray   *merged     = S_raw_chunks((Obj*)folder, 0);
+    uint32_t  num_copied = VA_Get_Size(copied);
+    uint32_t  num_merged = VA_Get_Size(merged);
+    bool      verbatim   = num_copied > 1 && num_merged > num_copied;
+    for (uint32_t i = 0; verbatim && i < num_copied; i++) {
+        Obj *chunk = VA_Fetch(merged, num_merged - num_copied + i);
+        verbatim = Obj_Equals(chunk, VA_Fetch(copied, i));
+    }
+    TEST_TRUE(runner, verbatim, "Merge copies intact chunks verbatim");
+    DECREF(merged);
+    DECREF(copied);
+
+    DECREF(folder);
+    DECREF(schema);
+}
+
+static void
+test_compression(TestBatchRunner *runner) {
+    Schema    *schema = (Schema*)TestSchema_new(true);
+    RAMFolder *folder = RAMFolder_new(NULL);
+    String    *path   = (String*)SSTR_WRAP_UTF8("seg_1/documents.dat", 19);
+
+    S_add_docs((Obj*)folder, schema, 1, 500);
+    InStream *instream = RAMFolder_Open_In(folder, path);
+    int64_t   length   = instream ? InStream_Length(instream) : -1;
+    TEST_TRUE(runner, length > 0 && length < 500 * 40 / 2,
+              "Stored docs are compressed");
+
+    int32_t expected[500];
+    for (int32_t i = 0; i < 500; i++) { expected[i] = i + 1; }
+    TEST_TRUE(runner, S_docs_match((Obj*)folder, expected, 500),
+              "Fetch compressed docs");
+
+    DECREF(instream);
+    DECREF(folder);
+    DECREF(schema);
+}
+
+static void
+test_Fetch_Doc_Fields(TestBatchRunner *runner) {
+    Schema     *schema  = (Schema*)TestSchema_new(false);
+    StringType *type    = StringType_new();
+    RAMFolder  *folder  = RAMFolder_new(NULL);
+    String     *title   = (String*)SSTR_WRAP_UTF8("title", 5);
+    String     *content = (String*)SSTR_WRAP_UTF8("content", 7);
+    String     *body    = Str_new_from_trusted_utf8("", 0);
+    Schema_Spec_Field(schema, title, (FieldType*)type);
+
+    // The content is far larger than TestSchema's tiny chunks, so it gets
+    // stored apart from the title.
+    for (int i = 0; i < 20; i++) {
+        String *sentence = Str_newf("sentence %i32 of the body. ", i);
+        String *longer   = Str_Cat(body, sentence);
+        DECREF(sentence);
+        DECREF(body);
+        body = longer;
+    }
+    Indexer *indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    for (int32_t i = 1; i <= 10; i++) {
+        Doc    *doc   = Doc_new(NULL, 0);
+        String *value = Str_newf("title %i32", i);
+        Doc_Store(doc, title, (Obj*)value);
+        Doc_Store(doc, content, (Obj*)body);
+        Indexer_Add_Doc(indexer, doc, 1.0f);
+        DECREF(value);
+        DECREF(doc);
+    }
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+
+    IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
+    VArray *fields = VA_new(1);
+    VA_Push(fields, INCREF(title));
+    HitDoc *hit_doc = IxSearcher_Fetch_Doc_Fields(searcher, 7, fields);
+    Obj    *value   = HitDoc_Extract(hit_doc, title);
+    Obj    *skipped = HitDoc_Extract(hit_doc, content);
+    TEST_TRUE(runner, value && Str_Equals_Utf8((String*)value, "title 7", 7),
+              "Fetch_Doc_Fields loads the requested field");
+    TEST_TRUE(runner, skipped == NULL,
+              "Fetch_Doc_Fields skips the others");
+    DECREF(value);
+    DECREF(skipped);
+    DECREF(hit_doc);
+
+    hit_doc = IxSearcher_Fetch_Doc(searcher, 7);
+    value   = HitDoc_Extract(hit_doc, content);
+    TEST_TRUE(runner, value && Str_Equals((String*)value, (Obj*)body),
+              "Fetch_Doc loads a large value stored out of line");
+    DECREF(value);
+    DECREF(hit_doc);
+
+    VA_Clear(fields);
+    VA_Push(fields, INCREF(content));
+    hit_doc = IxSearcher_Fetch_Doc_Fields(searcher, 3, fields);
+    value   = HitDoc_Extract(hit_doc, content);
+    skipped = HitDoc_Extract(hit_doc, title);
+    TEST_TRUE(runner, value && Str_Equals((String*)value, (Obj*)body)
+                      && skipped == NULL,
+              "Fetch_Doc_Fields loads only a large value");
+    DECREF(value);
+    DECREF(skipped);
+    DECREF(hit_doc);
+
+    VA_Clear(fields);
+    VA_Push(fields, INCREF(title));
+    int32_t   ids[]   = { 9, 2, 5 };
+    I32Array *doc_ids = I32Arr_new(ids, 3);
+    VArray   *hit_docs = IxSearcher_Fetch_Docs(searcher, doc_ids, fields);
+    bool      subset   = VA_Get_Size(hit_docs) == 3;
+    for (uint32_t i = 0; subset && i < 3; i++) {
+        hit_doc = (HitDoc*)VA_Fetch(hit_docs, i);
+        value   = HitDoc_Extract(hit_doc, title);
+        skipped = HitDoc_Extract(hit_doc, content);
+        String *expected = Str_newf("title %i32", ids[i]);
+        subset = value && Str_Equals(expected, value) && skipped == NULL;
+        DECREF(expected);
+        DECREF(value);
+        DECREF(skipped);
+    }
+    TEST_TRUE(runner, subset, "Fetch_Docs loads only the requested fields");
+    DECREF(hit_docs);
+    DECREF(doc_ids);
+
+    TermQuery *query = TermQuery_new(content, (Obj*)SSTR_WRAP_UTF8("body", 4));
+    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 10, NULL, NULL,
+                                 fields);
+    uint32_t num_hits = 0;
+    subset = true;
+    while (NULL != (hit_doc = Hits_Next(hits))) {
+        value   = HitDoc_Extract(hit_doc, title);
+        skipped = HitDoc_Extract(hit_doc, content);
+        if (!value || skipped) { subset = false; }
+        num_hits++;
+        DECREF(value);
+        DECREF(skipped);
+        DECREF(hit_doc);
+    }
+    TEST_TRUE(runner, subset && num_hits == 10,
+              "Hits load only the requested fields");
+    DECREF(hits);
+    DECREF(query);
+
+    DECREF(fields);
+    DECREF(searcher);
+    DECREF(body);
+    DECREF(folder);
+    DECREF(type);
+    DECREF(schema);
+}
+
+// Merge a segment written in a legacy format along with a current one,
+// deleting a doc so that some of its chunks could be copied and some not.
+static void
+test_legacy_format(TestBatchRunner *runner, int32_t format) {
+    Schema    *legacy_schema  = (Schema*)LegacyDocSchema_new(format);
+    Schema    *current_schema = (Schema*)LegacyDocSchema_new(0);
+    RAMFolder *folder         = RAMFolder_new(NULL);
+    int32_t    expected[40];
+    int32_t    num_expected   = 0;
+
+    S_add_docs((Obj*)folder, legacy_schema, 1, 30);
+    for (int32_t i = 1; i <= 30; i++) { expected[num_expected++] = i; }
+    TEST_TRUE(runner, S_docs_match((Obj*)folder, expected, num_expected),
+              "Fetch docs from a format %d segment", (int)format);
+
+    S_add_docs((Obj*)folder, current_schema, 31, 40);
+    Indexer *indexer = Indexer_new(current_schema, (Obj*)folder, NULL, 0);
+    Indexer_Delete_By_Doc_ID(indexer, 5);
+    Indexer_Optimize(indexer);
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+    num_expected = 0;
+    for (int32_t i = 1; i <= 40; i++) {
+        if (i != 5) { expected[num_expected++] = i; }
+    }
+    TEST_TRUE(runner, S_docs_match((Obj*)folder, expected, num_expected),
+              "Fetch docs after merging a format %d segment", (int)format);
+
+    DECREF(folder);
+    DECREF(current_schema);
+    DECREF(legacy_schema);
+}
+
 void
 TestDocWriter_Run_IMP(TestDocWriter *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 1);
-    PASS(runner, "placeholder");
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 15);
+    test_chunks_and_merge(runner);
+    test_compression(runner);
+    test_Fetch_Doc_Fields(runner);
+    test_legacy_format(runner, 2);
+    test_legacy_format(runner, 3);
+}
+
+/****************************** LegacyDocWriter ****************************/
+
+LegacyDocWriter*
+LegacyDocWriter_new(Schema *schema, Snapshot *snapshot, Segment *segment,
+                    PolyReader *polyreader, int32_t format) {
+    LegacyDocWriter *self
+        = (LegacyDocWriter*)VTable_Make_Obj(LEGACYDOCWRITER);
+    return LegacyDocWriter_init(self, schema, snapshot, segment, polyreader,
+                                format);
+}
+
+LegacyDocWriter*
+LegacyDocWriter_init(LegacyDocWriter *self, Schema *schema,
+                     Snapshot *snapshot, Segment *segment,
+                     PolyReader *polyreader, int32_t format) {
+    DocWriter_init((DocWriter*)self, schema, snapshot, segment, polyreader);
+    LegacyDocWriterIVARS *const ivars = LegacyDocWriter_IVARS(self);
+    if (format != 2 && format != 3) {
+        DECREF(self);
+        THROW(ERR, "Unsupported legacy doc format: %i32", format);
+    }
+    ivars->format     = format;
+    ivars->doc_max    = 0;
+    ivars->chunk_base = 1;
+    return self;
+}
+
+static void
+S_close_legacy_chunk(LegacyDocWriterIVARS *ivars) {
+    DECREF(ivars->lens_out);
+    DECREF(ivars->recs_out);
+    DECREF(ivars->lens_file);
+    DECREF(ivars->recs_file);
+    ivars->lens_out  = NULL;
+    ivars->recs_out  = NULL;
+    ivars->lens_file = NULL;
+    ivars->recs_file = NULL;
+}
+
+void
+LegacyDocWriter_Destroy_IMP(LegacyDocWriter *self) {
+    LegacyDocWriterIVARS *const ivars = LegacyDocWriter_IVARS(self);
+    S_close_legacy_chunk(ivars);
+    DECREF(ivars->legacy_ix);
+    DECREF(ivars->legacy_dat);
+    SUPER_DESTROY(self, LEGACYDOCWRITER);
+}
+
+static void
+S_open_legacy_streams(LegacyDocWriter *self) {
+    LegacyDocWriterIVARS *const ivars = LegacyDocWriter_IVARS(self);
+    Folder *folder   = LegacyDocWriter_Get_Folder(self);
+    String *seg_name = Seg_Get_Name(LegacyDocWriter_Get_Segment(self));
+    String *ix_file  = Str_newf("%o/documents.ix", seg_name);
+    String *dat_file = Str_newf("%o/documents.dat", seg_name);
+    ivars->legacy_ix  = Folder_Open_Out(folder, ix_file);
+    ivars->legacy_dat = Folder_Open_Out(folder, dat_file);
+    DECREF(ix_file);
+    DECREF(dat_file);
+    if (!ivars->legacy_ix || !ivars->legacy_dat) {
+        RETHROW(INCREF(Err_get_error()));
+    }
+
+    // Format 2 has an index entry for the non-doc #0.
+    if (ivars->format == 2) { OutStream_Write_I64(ivars->legacy_ix, 0); }
+}
+
+// Write the doc's stored fields with untagged values, as formats 2 and 3
+// did.
+static void
+S_write_legacy_record(OutStream *out, Inverter *inverter) {
+    uint32_t num_stored = 0;
+    Inverter_Iterate(inverter);
+    while (Inverter_Next(inverter)) {
+        if (FType_Stored(Inverter_Get_Type(inverter))) { num_stored++; }
+    }
+    OutStream_Write_C32(out, num_stored);
+
+    Inverter_Iterate(inverter);
+    while (Inverter_Next(inverter)) {
+        FieldType *type = Inverter_Get_Type(inverter);
+        if (!FType_Stored(type)) { continue; }
+        Obj *value = Inverter_Get_Value(inverter);
+        Freezer_serialize_string(Inverter_Get_Field_Name(inverter), out);
+        switch (FType_Primitive_ID(type) & FType_PRIMITIVE_ID_MASK) {
+            case FType_TEXT: {
+                    size_t size = Str_Get_Size((String*)value);
+                    OutStream_Write_C32(out, (uint32_t)size);
+                    OutStream_Write_Bytes(out, Str_Get_Ptr8((String*)value),
+                                          size);
+                    break;
+                }
+            case FType_BLOB: {
+                    size_t size = BB_Get_Size((ByteBuf*)value);
+                    OutStream_Write_C32(out, (uint32_t)size);
+                    OutStream_Write_Bytes(out, BB_Get_Buf((ByteBuf*)value),
+                                          size);
+                    break;
+                }
+            case FType_INT32:
+                OutStream_Write_C32(out,
+                    (uint32_t)Int32_Get_Value((Integer32*)value));
+                break;
+            case FType_INT64:
+                OutStream_Write_C64(out,
+                    (uint64_t)Int64_Get_Value((Integer64*)value));
+                break;
+            case FType_FLOAT32:
+                OutStream_Write_F32(out, Float32_Get_Value((Float32*)value));
+                break;
+            case FType_FLOAT64:
+                OutStream_Write_F64(out, Float64_Get_Value((Float64*)value));
+                break;
+            default:
+                THROW(ERR, "Unrecognized type: %o", type);
+        }
+    }
+}
+
+// Write out the pending format 3 chunk, uncompressed.
+static void
+S_flush_legacy_chunk(LegacyDocWriterIVARS *ivars) {
+    if (!ivars->recs_out) { return; }
+    OutStream_Close(ivars->lens_out);
+    OutStream_Close(ivars->recs_out);
+    ByteBuf *lens = RAMFile_Get_Contents(ivars->lens_file);
+    BB_Cat(lens, RAMFile_Get_Contents(ivars->recs_file));
+    uint32_t raw_len = (uint32_t)BB_Get_Size(lens);
+
+    OutStream_Write_I32(ivars->legacy_ix, ivars->chunk_base);
+    OutStream_Write_I64(ivars->legacy_ix, OutStream_Tell(ivars->legacy_dat));
+    OutStream_Write_U8(ivars->legacy_dat, (uint8_t)DocWriter_CODEC_NONE);
+    OutStream_Write_C32(ivars->legacy_dat, raw_len);
+    OutStream_Write_C32(ivars->legacy_dat, raw_len);
+    OutStream_Write_Bytes(ivars->legacy_dat, BB_Get_Buf(lens), raw_len);
+
+    S_close_legacy_chunk(ivars);
+    ivars->chunk_base = ivars->doc_max + 1;
+}
+
+void
+LegacyDocWriter_Add_Inverted_Doc_IMP(LegacyDocWriter *self,
+                                     Inverter *inverter, int32_t doc_id) {
+    LegacyDocWriterIVARS *const ivars = LegacyDocWriter_IVARS(self);
+    if (doc_id != ivars->doc_max + 1) {
+        THROW(ERR, "Expected doc id %i32 but got %i32", ivars->doc_max + 1,
+              doc_id);
+    }
+    if (!ivars->legacy_dat) { S_open_legacy_streams(self); }
+
+    if (ivars->format == 2) {
+        OutStream_Write_I64(ivars->legacy_ix,
+                            OutStream_Tell(ivars->legacy_dat));
+        S_write_legacy_record(ivars->legacy_dat, inverter);
+        ivars->doc_max++;
+        return;
+    }
+
+    if (!ivars->recs_out) {
+        ivars->lens_file = RAMFile_new(NULL, false);
+        ivars->recs_file = RAMFile_new(NULL, false);
+        ivars->lens_out  = OutStream_open((Obj*)ivars->lens_file);
+        ivars->recs_out  = OutStream_open((Obj*)ivars->recs_file);
+    }
+    int64_t start = OutStream_Tell(ivars->recs_out);
+    S_write_legacy_record(ivars->recs_out, inverter);
+    OutStream_Write_C32(ivars->lens_out,
+                        (uint32_t)(OutStream_Tell(ivars->recs_out) - start));
+    ivars->doc_max++;
+    if (ivars->doc_max - ivars->chunk_base + 1 == LEGACY_CHUNK_DOCS) {
+        S_flush_legacy_chunk(ivars);
+    }
+}
+
+void
+LegacyDocWriter_Add_Segment_IMP(LegacyDocWriter *self, SegReader *reader,
+                                I32Array *doc_map) {
+    UNUSED_VAR(self);
+    UNUSED_VAR(reader);
+    UNUSED_VAR(doc_map);
+    THROW(ERR, "Can't merge into a legacy doc format");
+}
+
+void
+LegacyDocWriter_Finish_IMP(LegacyDocWriter *self) {
+    LegacyDocWriterIVARS *const ivars = LegacyDocWriter_IVARS(self);
+    if (!ivars->legacy_dat) { return; }
+
+    // Both formats end with an entry marking the end of the data.
+    if (ivars->format == 2) {
+        OutStream_Write_I64(ivars->legacy_ix,
+                            OutStream_Tell(ivars->legacy_dat));
+    }
+    else {
+        S_flush_legacy_chunk(ivars);
+        OutStream_Write_I32(ivars->legacy_ix, ivars->doc_max + 1);
+        OutStream_Write_I64(ivars->legacy_ix,
+                            OutStream_Tell(ivars->legacy_dat));
+    }
+    OutStream_Close(ivars->legacy_ix);
+    OutStream_Close(ivars->legacy_dat);
+    Seg_Store_Metadata_Utf8(LegacyDocWriter_Get_Segment(self),
+                            "documents", 9,
+                            (Obj*)LegacyDocWriter_Metadata(self));
+}
+
+int32_t
+LegacyDocWriter_Format_IMP(LegacyDocWriter *self) {
+    return LegacyDocWriter_IVARS(self)->format;
+}
+
+/*************************** LegacyDocArchitecture *************************/
+
+LegacyDocArchitecture*
+LegacyDocArch_new(int32_t format) {
+    LegacyDocArchitecture *self
+        = (LegacyDocArchitecture*)VTable_Make_Obj(LEGACYDOCARCHITECTURE);
+    return LegacyDocArch_init(self, format);
+}
+
+LegacyDocArchitecture*
+LegacyDocArch_init(LegacyDocArchitecture *self, int32_t format) {
+    TestArch_init((TestArchitecture*)self);
+    LegacyDocArch_IVARS(self)->format = format;
+    return self;
+}
+
+void
+LegacyDocArch_Register_Doc_Writer_IMP(LegacyDocArchitecture *self,
+                                      SegWriter *writer) {
+    LegacyDocWriter *doc_writer
+        = LegacyDocWriter_new(SegWriter_Get_Schema(writer),
+                              SegWriter_Get_Snapshot(writer),
+                              SegWriter_Get_Segment(writer),
+                              SegWriter_Get_PolyReader(writer),
+                              LegacyDocArch_IVARS(self)->format);
+    SegWriter_Register(writer, VTable_Get_Name(DOCWRITER),
+                       (DataWriter*)doc_writer);
+    SegWriter_Add_Writer(writer, (DataWriter*)INCREF(doc_writer));
+}
+
+/****************************** LegacyDocSchema ****************************/
+
+LegacyDocSchema*
+LegacyDocSchema_new(int32_t format) {
+    LegacyDocSchema *self
+        = (LegacyDocSchema*)VTable_Make_Obj(LEGACYDOCSCHEMA);
+    return LegacyDocSchema_init(self, format);
+}
+
+LegacyDocSchema*
+LegacyDocSchema_init(LegacyDocSchema *self, int32_t format) {
+    // Architecture() is consulted during initialization.
+    LegacyDocSchema_IVARS(self)->format = format;
+    TestSchema_init((TestSchema*)self, false);
+    return self;
+}
+
+Architecture*
+LegacyDocSchema_Architecture_IMP(LegacyDocSchema *self) {
+    int32_t format = LegacyDocSchema_IVARS(self)->format;
+    return format
+           ? (Architecture*)LegacyDocArch_new(format)
+           : (Architecture*)TestArch_new();
 }
 
 
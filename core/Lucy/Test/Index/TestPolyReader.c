@@ -21,7 +21,22 @@
 #include "Clownfish/TestHarness/TestBatchRunner.h"
 #include "Lucy/Test.h"
 #include "Lucy/Test/Index/TestPolyReader.h"
+#include "Lucy/Test/TestSchema.h"
+#include "Lucy/Document/Doc.h"
+#include "Lucy/Document/HitDoc.h"
+#include "Lucy/Index/DocReader.h"
+#include "Lucy/Index/IndexManager.h"
+#include "Lucy/Index/Indexer.h"
 #include "Lucy/Index/PolyReader.h"
+#include "Lucy/Index/SegReader.h"
+#include "Lucy/Index/TieredMergePolicy.h"
+#include "Lucy/Plan/FullTextType.h"
+#include "Lucy/Plan/Schema.h"
+#include "Lucy/Plan/StringType.h"
+#include "Lucy/Search/Hits.h"
+#include "Lucy/Search/IndexSearcher.h"
+#include "Lucy/Search/TermQuery.h"
+#include "Lucy/Store/RAMFolder.h"
 
 TestPolyReader*
 TestPolyReader_new() {
@@ -45,9 +60,327 @@ test_sub_tick(TestBatchRunner *runner) {
     FREEMEM(ints);
 }
 
+static void
+S_add_doc(Indexer *indexer, String *field, int32_t num) {
+    Doc *doc = Doc_new(NULL, 0);
+    String *value = Str_newf("doc %i32", num);
+    Doc_Store(doc, field, (Obj*)value);
+    Indexer_Add_Doc(indexer, doc, 1.0f);
+    DECREF(value);
+    DECREF(doc);
+}
+
+static int32_t
+S_doc_count(Obj *index) {
+    PolyReader *reader = PolyReader_open(index, NULL, NULL);
+    int32_t doc_count = PolyReader_Doc_Count(reader);
+    DECREF(reader);
+    return doc_count;
+}
+
+static void
+test_open_Indexer(TestBatchRunner *runner) {
+    Schema    *schema = (Schema*)TestSchema_new(false);
+    String    *field  = (String*)SSTR_WRAP_UTF8("content", 7);
+    RAMFolder *folder = RAMFolder_new(NULL);
+
+    Indexer *indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    S_add_doc(indexer, field, 0);
+    S_add_doc(indexer, field, 1);
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+
+    indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    S_add_doc(indexer, field, 2);
+    TEST_INT_EQ(runner, S_doc_count((Obj*)indexer), 3,
+                "reader opened on Indexer sees uncommitted docs");
+    TEST_INT_EQ(runner, S_doc_count((Obj*)folder), 2,
+                "flushed docs aren't committed");
+
+    String *zero = Str_newf("0");
+    Indexer_Delete_By_Term(indexer, field, (Obj*)zero);
+    S_add_doc(indexer, field, 3);
+    IndexSearcher *searcher = IxSearcher_new((Obj*)indexer);
+    IndexReader   *nrt_reader = IxSearcher_Get_Reader(searcher);
+    TEST_INT_EQ(runner, IxReader_Doc_Count(nrt_reader), 3,
+                "pending deletions visible via Indexer");
+    String *three = Str_newf("3");
+    TermQuery *query = TermQuery_new(field, (Obj*)three);
+    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 10, NULL, NULL,
+                                 NULL);
+    TEST_INT_EQ(runner, Hits_Total_Hits(hits), 1,
+                "searching an Indexer finds uncommitted docs");
+    DECREF(hits);
+    DECREF(query);
+    DECREF(three);
+    DECREF(zero);
+
+    PolyReader *reader = PolyReader_open((Obj*)indexer, NULL, NULL);
+    TEST_TRUE(runner, reader == (PolyReader*)nrt_reader,
+              "reopening without changes reuses the previous reader");
+    DECREF(reader);
+    S_add_doc(indexer, field, 4);
+    reader = PolyReader_open((Obj*)indexer, NULL, NULL);
+    TEST_TRUE(runner, reader != (PolyReader*)nrt_reader
+                      && PolyReader_Doc_Count(reader) == 4,
+              "reopening after adding docs flushes");
+    DECREF(reader);
+
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+    TEST_INT_EQ(runner, IxReader_Doc_Count(nrt_reader), 3,
+                "NRT searcher survives Commit");
+    DECREF(searcher);
+
+    reader = PolyReader_open((Obj*)folder, NULL, NULL);
+    VArray *seg_readers = PolyReader_Get_Seg_Readers(reader);
+    bool all_have_docs = true;
+    for (uint32_t i = 0, max = VA_Get_Size(seg_readers); i < max; i++) {
+        SegReader *seg_reader = (SegReader*)VA_Fetch(seg_readers, i);
+        if (!SegReader_Doc_Max(seg_reader)) { all_have_docs = false; }
+    }
+    TEST_INT_EQ(runner, PolyReader_Doc_Count(reader), 4,
+                "flushed docs and deletions committed");
+    TEST_TRUE(runner, all_have_docs, "no empty segment after Commit");
+    DECREF(reader);
+
+    DECREF(folder);
+    DECREF(schema);
+}
+
+static void
+test_Warm_and_Residency(TestBatchRunner *runner) {
+    Schema    *schema = (Schema*)TestSchema_new(false);
+    String    *field  = (String*)SSTR_WRAP_UTF8("content", 7);
+    RAMFolder *folder = RAMFolder_new(NULL);
+
+    // Make the field sortable so that there's a sort cache to warm.
+    FullTextType_Set_Sortable((FullTextType*)Schema_Fetch_Type(schema, field),
+                              true);
+    Indexer *indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    S_add_doc(indexer, field, 0);
+    S_add_doc(indexer, field, 1);
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+
+    PolyReader *reader = PolyReader_open((Obj*)folder, NULL, NULL);
+    PolyReader_Warm(reader, IxReader_WARM_LEXICON | IxReader_WARM_SORT
+                            | IxReader_WARM_SKIP);
+    PolyReader_Warm(reader, IxReader_WARM_ALL);
+    Hash *report = PolyReader_Residency(reader);
+    String *key = Str_newf("seg_1/lexicon-1.ix");
+    Float64 *fraction = (Float64*)Hash_Fetch(report, (Obj*)key);
+    TEST_TRUE(runner, fraction != NULL && Float64_Get_Value(fraction) == 1.0,
+              "RAM lexicon index reported as fully resident");
+    bool all_resident = Hash_Get_Size(report) > 0;
+    Obj *path, *value;
+    Hash_Iterate(report);
+    while (Hash_Next(report, &path, &value)) {
+        if (Float64_Get_Value((Float64*)value) != 1.0) {
+            all_resident = false;
+        }
+    }
+    TEST_TRUE(runner, all_resident, "every RAM segment file is resident");
+    VArray *failed = PolyReader_Verify(reader);
+    TEST_INT_EQ(runner, VA_Get_Size(failed), 0,
+                "Verify finds no corrupt files");
+    DECREF(failed);
+    DECREF(key);
+    DECREF(report);
+    DECREF(reader);
+
+    DECREF(folder);
+    DECREF(schema);
+}
+
+static void
+test_Fetch_Docs(TestBatchRunner *runner) {
+    Schema    *schema = (Schema*)TestSchema_new(false);
+    String    *field  = (String*)SSTR_WRAP_UTF8("content", 7);
+    RAMFolder *folder = RAMFolder_new(NULL);
+
+    for (int32_t i = 0; i < 6; i += 2) {
+        Indexer *indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+        S_add_doc(indexer, field, i);
+        S_add_doc(indexer, field, i + 1);
+        Indexer_Commit(indexer);
+        DECREF(indexer);
+    }
+
+    IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
+    int32_t ids[] = { 5, 1, 4, 1, 2 };
+    I32Array *doc_ids = I32Arr_new(ids, 5);
+    VArray *hit_docs = IxSearcher_Fetch_Docs(searcher, doc_ids, NULL);
+    bool in_order = VA_Get_Size(hit_docs) == 5;
+    for (uint32_t i = 0; in_order && i < 5; i++) {
+        HitDoc *hit_doc = (HitDoc*)VA_Fetch(hit_docs, i);
+        HitDoc *single  = IxSearcher_Fetch_Doc(searcher, ids[i]);
+        Obj *value    = HitDoc_Extract(hit_doc, field);
+        Obj *expected = HitDoc_Extract(single, field);
+        if (HitDoc_Get_Doc_ID(hit_doc) != ids[i]
+            || !Obj_Equals(value, expected)
+           ) {
+            in_order = false;
+        }
+        DECREF(value);
+        DECREF(expected);
+        DECREF(single);
+    }
+    TEST_TRUE(runner, in_order,
+              "Fetch_Docs across segments returns docs in request order");
+    DECREF(hit_docs);
+    DECREF(doc_ids);
+
+    doc_ids  = I32Arr_new(ids, 0);
+    hit_docs = IxSearcher_Fetch_Docs(searcher, doc_ids, NULL);
+    TEST_INT_EQ(runner, VA_Get_Size(hit_docs), 0, "Fetch_Docs with no ids");
+    DECREF(hit_docs);
+    DECREF(doc_ids);
+
+    DECREF(searcher);
+    DECREF(folder);
+    DECREF(schema);
+}
+
+static void
+S_add_keyed_doc(Indexer *indexer, const char *key) {
+    Doc *doc = Doc_new(NULL, 0);
+    String *id    = Str_newf("id");
+    String *plain = Str_newf("plain");
+    String *value = Str_new_from_utf8(key, strlen(key));
+    Doc_Store(doc, id, (Obj*)value);
+    Doc_Store(doc, plain, (Obj*)value);
+    Indexer_Add_Doc(indexer, doc, 1.0f);
+    DECREF(value);
+    DECREF(plain);
+    DECREF(id);
+    DECREF(doc);
+}
+
+static Indexer*
+S_keyed_indexer(Schema *schema, RAMFolder *folder) {
+    TieredMergePolicy *policy  = TieredMergePol_new();
+    IndexManager      *manager = IxManager_new(NULL, NULL);
+    TieredMergePol_Set_Segs_Per_Tier(policy, 1000);
+    TieredMergePol_Set_Deletes_Threshold(policy, 1.0);
+    IxManager_Set_Merge_Policy(manager, (MergePolicy*)policy);
+    Indexer *indexer = Indexer_new(schema, (Obj*)folder, manager, 0);
+    DECREF(manager);
+    DECREF(policy);
+    return indexer;
+}
+
+// Look up a key in both the unique field and its plain copy, which lacks a
+// key map.  Return -1 if the two disagree.
+static int32_t
+S_lookup(IndexReader *reader, const char *key) {
+    String *id    = Str_newf("id");
+    String *plain = Str_newf("plain");
+    String *value = Str_new_from_utf8(key, strlen(key));
+    int32_t keyed    = IxReader_Lookup(reader, id, (Obj*)value);
+    int32_t unkeyed  = IxReader_Lookup(reader, plain, (Obj*)value);
+    DECREF(value);
+    DECREF(plain);
+    DECREF(id);
+    return keyed == unkeyed ? keyed : -1;
+}
+
+static void
+test_Lookup(TestBatchRunner *runner) {
+    Schema     *schema = Schema_new();
+    StringType *unique = StringType_new();
+    StringType *plain  = StringType_new();
+    RAMFolder  *folder = RAMFolder_new(NULL);
+    String     *id     = Str_newf("id");
+    String     *pfield = Str_newf("plain");
+
+    StringType_Set_Unique(unique, true);
+    Schema_Spec_Field(schema, id, (FieldType*)unique);
+    Schema_Spec_Field(schema, pfield, (FieldType*)plain);
+
+    // seg_1: docs 1-3.
+    Indexer *indexer = S_keyed_indexer(schema, folder);
+    S_add_keyed_doc(indexer, "a");
+    S_add_keyed_doc(indexer, "b");
+    S_add_keyed_doc(indexer, "c");
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+
+    // seg_2: docs 4-6.  Update "b", delete "c", add "d" twice and delete
+    // the newer copy.
+    String *b = Str_newf("b");
+    String *c = Str_newf("c");
+    indexer = S_keyed_indexer(schema, folder);
+    Indexer_Delete_By_Term(indexer, id, (Obj*)b);
+    Indexer_Delete_By_Term(indexer, id, (Obj*)c);
+    S_add_keyed_doc(indexer, "b");
+    S_add_keyed_doc(indexer, "d");
+    S_add_keyed_doc(indexer, "d");
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+    indexer = S_keyed_indexer(schema, folder);
+    Indexer_Delete_By_Doc_ID(indexer, 6);
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+
+    IndexReader *reader = IxReader_open((Obj*)folder, NULL, NULL);
+    Hash   *files    = IxReader_Residency(reader);
+    String *keys_key = Str_newf("seg_2/lexicon-1.keys");
+    String *docs_key = Str_newf("seg_2/lexicon-1.docs");
+    TEST_TRUE(runner,
+              Hash_Fetch(files, (Obj*)keys_key) != NULL
+              && Hash_Fetch(files, (Obj*)docs_key) != NULL,
+              "unique field gets a key map");
+    TEST_INT_EQ(runner, S_lookup(reader, "a"), 1, "Lookup in older segment");
+    TEST_INT_EQ(runner, S_lookup(reader, "b"), 4,
+                "Lookup finds the updated doc");
+    TEST_INT_EQ(runner, S_lookup(reader, "c"), 0,
+                "Lookup skips deleted doc");
+    TEST_INT_EQ(runner, S_lookup(reader, "d"), 5,
+                "Lookup falls back to older live doc with the same key");
+    TEST_INT_EQ(runner, S_lookup(reader, "e"), 0, "Lookup of missing key");
+    DECREF(reader);
+
+    // Deleting a key goes through the key map, but still catches every copy.
+    String *f = Str_newf("f");
+    indexer = S_keyed_indexer(schema, folder);
+    S_add_keyed_doc(indexer, "f");
+    S_add_keyed_doc(indexer, "f");
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+    indexer = S_keyed_indexer(schema, folder);
+    Indexer_Delete_By_Term(indexer, id, (Obj*)f);
+    Indexer_Delete_By_Term(indexer, id, (Obj*)c);
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+    reader = IxReader_open((Obj*)folder, NULL, NULL);
+    TEST_INT_EQ(runner, S_lookup(reader, "f"), 0,
+                "Delete_By_Term removes every doc with a duplicated key");
+    TEST_INT_EQ(runner, IxReader_Doc_Count(reader), 3,
+                "Delete_By_Term of absent key deletes nothing");
+
+    DECREF(docs_key);
+    DECREF(keys_key);
+    DECREF(files);
+    DECREF(reader);
+    DECREF(f);
+    DECREF(c);
+    DECREF(b);
+    DECREF(pfield);
+    DECREF(id);
+    DECREF(folder);
+    DECREF(plain);
+    DECREF(unique);
+    DECREF(schema);
+}
+
 void
 TestPolyReader_Run_IMP(TestPolyReader *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 1);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 23);
     test_sub_tick(runner);
+    test_open_Indexer(runner);
+    test_Warm_and_Residency(runner);
+    test_Fetch_Docs(runner);
+    test_Lookup(runner);
 }
 
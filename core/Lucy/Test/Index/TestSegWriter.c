@@ -21,17 +21,243 @@
 #include "Clownfish/TestHarness/TestBatchRunner.h"
 #include "Lucy/Test.h"
 #include "Lucy/Test/Index/TestSegWriter.h"
+#include "Lucy/Test/TestSchema.h"
+#include "Lucy/Document/Doc.h"
+#include "Lucy/Document/HitDoc.h"
+#include "Lucy/Index/Indexer.h"
+#include "Lucy/Index/PolyReader.h"
+#include "Lucy/Index/SegReader.h"
+#include "Lucy/Index/Segment.h"
 #include "Lucy/Index/SegWriter.h"
+#include "Lucy/Plan/NumericType.h"
+#include "Lucy/Plan/Schema.h"
+#include "Lucy/Plan/StringType.h"
+#include "Lucy/Search/Hits.h"
+#include "Lucy/Search/IndexSearcher.h"
+#include "Lucy/Search/TermQuery.h"
+#include "Lucy/Store/CompoundFileReader.h"
+#include "Lucy/Store/FileHandle.h"
+#include "Lucy/Store/RAMFolder.h"
 
 TestSegWriter*
 TestSegWriter_new() {
     return (TestSegWriter*)VTable_Make_Obj(TESTSEGWRITER);
 }
 
+typedef struct BatchContext {
+    Indexer    *indexer;
+    VArray     *fields;
+    const char *values[3];
+    size_t      sizes[3];
+} BatchContext;
+
+static void
+S_add_batch(void *context) {
+    BatchContext *batch = (BatchContext*)context;
+    Indexer_Add_Batch(batch->indexer, batch->fields, 1, batch->values,
+                      batch->sizes, 1.0f);
+}
+
+static uint32_t
+S_count_hits(IndexSearcher *searcher, const char *field, const char *term) {
+    String    *field_str = Str_newf(field);
+    String    *term_str  = Str_newf(term);
+    TermQuery *query     = TermQuery_new(field_str, (Obj*)term_str);
+    Hits      *hits      = IxSearcher_Hits(searcher, (Obj*)query, 0, 10,
+                                           NULL, NULL, NULL);
+    uint32_t   count     = Hits_Total_Hits(hits);
+    DECREF(hits);
+    DECREF(query);
+    DECREF(term_str);
+    DECREF(field_str);
+    return count;
+}
+
+static HitDoc*
+S_fetch_hit(IndexSearcher *searcher, const char *field, const char *term) {
+    String    *field_str = Str_newf(field);
+    String    *term_str  = Str_newf(term);
+    TermQuery *query     = TermQuery_new(field_str, (Obj*)term_str);
+    Hits      *hits      = IxSearcher_Hits(searcher, (Obj*)query, 0, 1, NULL,
+                                           NULL, NULL);
+    HitDoc    *hit_doc   = Hits_Next(hits);
+    DECREF(hits);
+    DECREF(query);
+    DECREF(term_str);
+    DECREF(field_str);
+    return hit_doc;
+}
+
+static void
+test_Add_Batch(TestBatchRunner *runner) {
+    Schema     *schema   = (Schema*)TestSchema_new(false);
+    StringType *str_type = StringType_new();
+    Int32Type  *int_type = Int32Type_new();
+    RAMFolder  *folder   = RAMFolder_new(NULL);
+    VArray     *fields   = VA_new(3);
+
+    // TestSchema supplies "content"; add a title and a number.
+    StringType_Set_Sortable(str_type, true);
+    Int32Type_Set_Indexed(int_type, false);
+    Int32Type_Set_Sortable(int_type, true);
+    VA_Push(fields, (Obj*)Str_newf("title"));
+    VA_Push(fields, (Obj*)Str_newf("content"));
+    VA_Push(fields, (Obj*)Str_newf("num"));
+    Schema_Spec_Field(schema, (String*)VA_Fetch(fields, 0),
+                      (FieldType*)str_type);
+    Schema_Spec_Field(schema, (String*)VA_Fetch(fields, 2),
+                      (FieldType*)int_type);
+
+    // Three records, one of which lacks a content field.
+    char buf[64];
+    strcpy(buf, "aalpha betabbeta gammac123");
+    const char *values[9] = {
+        buf,      buf + 1,  buf + 23,
+        buf + 11, buf + 12, buf + 24,
+        buf + 22, NULL,     buf + 25
+    };
+    size_t sizes[9] = {
+        1, 10, 1,
+        1, 10, 1,
+        1, 0,  1
+    };
+    Indexer *indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    Indexer_Add_Batch(indexer, fields, 3, values, sizes, 1.0f);
+
+    // Clobber the buffer and reuse it for another batch.
+    strcpy(buf, "ddelta4");
+    const char *more_values[3] = { buf, buf + 1, buf + 6 };
+    size_t more_sizes[3] = { 1, 5, 1 };
+    Indexer_Add_Batch(indexer, fields, 1, more_values, more_sizes, 1.0f);
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+
+    IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
+    TEST_INT_EQ(runner, IxSearcher_Doc_Max(searcher), 4,
+                "Add_Batch adds one doc per record");
+    TEST_INT_EQ(runner, S_count_hits(searcher, "content", "beta"), 2,
+                "analyzed values indexed");
+    TEST_INT_EQ(runner, S_count_hits(searcher, "title", "b"), 1,
+                "unanalyzed values indexed");
+    TEST_INT_EQ(runner, S_count_hits(searcher, "title", "a")
+                + S_count_hits(searcher, "title", "d"), 2,
+                "values copied before buffer reuse");
+
+    HitDoc *hit_doc = S_fetch_hit(searcher, "content", "gamma");
+    String *title
+        = (String*)HitDoc_Extract(hit_doc, (String*)VA_Fetch(fields, 0));
+    TEST_TRUE(runner, title && Str_Equals_Utf8(title, "b", 1),
+              "text values stored");
+    Obj *num = HitDoc_Extract(hit_doc, (String*)VA_Fetch(fields, 2));
+    TEST_INT_EQ(runner, num ? Obj_To_I64(num) : -1, 2,
+                "numeric values parsed");
+    DECREF(num);
+    DECREF(title);
+    DECREF(hit_doc);
+    DECREF(searcher);
+
+    // Bad input.
+    BatchContext batch;
+    batch.indexer   = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    batch.fields    = fields;
+    batch.values[0] = "\xff";
+    batch.values[1] = NULL;
+    batch.values[2] = NULL;
+    batch.sizes[0]  = 1;
+    batch.sizes[1]  = 0;
+    batch.sizes[2]  = 0;
+    Err *error = Err_trap(S_add_batch, &batch);
+    TEST_TRUE(runner, error != NULL, "Add_Batch rejects invalid UTF-8");
+    DECREF(error);
+    DECREF(batch.indexer);
+
+    const char *bad_nums[] = { "12x", "", " 7", "2147483648", "1e3" };
+    bool all_rejected = true;
+    batch.values[0] = NULL;
+    batch.sizes[0]  = 0;
+    for (int i = 0; i < 5; i++) {
+        batch.indexer   = Indexer_new(schema, (Obj*)folder, NULL, 0);
+        batch.values[2] = bad_nums[i];
+        batch.sizes[2]  = strlen(bad_nums[i]);
+        error = Err_trap(S_add_batch, &batch);
+        if (!error) { all_rejected = false; }
+        DECREF(error);
+        DECREF(batch.indexer);
+    }
+    TEST_TRUE(runner, all_rejected, "Add_Batch rejects invalid numbers");
+
+    batch.indexer   = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    batch.values[2] = "-2147483648";
+    batch.sizes[2]  = 11;
+    error = Err_trap(S_add_batch, &batch);
+    TEST_TRUE(runner, error == NULL, "Add_Batch accepts INT32_MIN");
+    DECREF(error);
+    DECREF(batch.indexer);
+
+    VArray *bogus = VA_new(1);
+    VA_Push(bogus, (Obj*)Str_newf("nope"));
+    batch.indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    batch.fields  = bogus;
+    error = Err_trap(S_add_batch, &batch);
+    TEST_TRUE(runner, error != NULL, "Add_Batch rejects unknown fields");
+    DECREF(error);
+    DECREF(batch.indexer);
+    DECREF(bogus);
+
+    DECREF(fields);
+    DECREF(folder);
+    DECREF(int_type);
+    DECREF(str_type);
+    DECREF(schema);
+}
+
+static void
+test_merge_advice(TestBatchRunner *runner) {
+    Schema    *schema  = (Schema*)TestSchema_new(false);
+    RAMFolder *folder  = RAMFolder_new(NULL);
+    String    *field   = Str_newf("content");
+    String    *dat     = Str_newf("documents.dat");
+    Indexer   *indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    Doc       *doc     = Doc_new(NULL, 0);
+    String    *value   = Str_newf("foo");
+    Doc_Store(doc, field, (Obj*)value);
+    Indexer_Add_Doc(indexer, doc, 1.0f);
+    Indexer_Commit(indexer);
+    DECREF(indexer);
+
+    PolyReader *reader      = PolyReader_open((Obj*)folder, NULL, NULL);
+    VArray     *seg_readers = PolyReader_Seg_Readers(reader);
+    SegReader  *seg_reader  = (SegReader*)VA_Fetch(seg_readers, 0);
+    String     *seg_name    = Seg_Get_Name(SegReader_Get_Segment(seg_reader));
+    CompoundFileReader *cf_reader = (CompoundFileReader*)Folder_Find_Folder(
+        SegReader_Get_Folder(seg_reader), seg_name);
+    TEST_INT_EQ(runner, CFReader_Get_Advice(cf_reader, dat), FH_ADVICE_RANDOM,
+                "DocReader leaves documents.dat advised random");
+
+    indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    I32Array *doc_map = I32Arr_new_blank(2);
+    I32Arr_Set(doc_map, 1, 1);
+    SegWriter_Add_Segment(Indexer_Get_Seg_Writer(indexer), seg_reader,
+                          doc_map);
+    TEST_INT_EQ(runner, CFReader_Get_Advice(cf_reader, dat), FH_ADVICE_RANDOM,
+                "Merging puts back the reader's advice");
+
+    DECREF(doc_map);
+    DECREF(indexer);
+    DECREF(seg_readers);
+    DECREF(reader);
+    DECREF(value);
+    DECREF(doc);
+    DECREF(dat);
+    DECREF(field);
+    DECREF(folder);
+    DECREF(schema);
+}
+
 void
 TestSegWriter_Run_IMP(TestSegWriter *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 1);
-    PASS(runner, "placeholder");
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 12);
+    test_Add_Batch(runner);
+    test_merge_advice(runner);
 }
 
-
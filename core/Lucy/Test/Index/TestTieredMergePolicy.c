@@ -0,0 +1,234 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define TESTLUCY_USE_SHORT_NAMES
+#include "Lucy/Util/ToolSet.h"
+
+#include "Clownfish/TestHarness/TestBatchRunner.h"
+#include "Lucy/Test.h"
+#include "Lucy/Test/Index/TestTieredMergePolicy.h"
+#include "Lucy/Test/TestSchema.h"
+#include "Lucy/Document/Doc.h"
+#include "Lucy/Index/IndexManager.h"
+#include "Lucy/Index/Indexer.h"
+#include "Lucy/Index/MergePolicy.h"
+#include "Lucy/Index/PolyReader.h"
+#include "Lucy/Index/TieredMergePolicy.h"
+#include "Lucy/Store/RAMFolder.h"
+
+#define KB INT64_C(1024)
+#define MB (INT64_C(1024) * 1024)
+
+TestTieredMergePolicy*
+TestTieredMergePol_new() {
+    return (TestTieredMergePolicy*)VTable_Make_Obj(TESTTIEREDMERGEPOLICY);
+}
+
+static TieredMergePolicy*
+S_make_policy() {
+    TieredMergePolicy *policy = TieredMergePol_new();
+    TieredMergePol_Set_Segs_Per_Tier(policy, 4);
+    TieredMergePol_Set_Max_Merge_At_Once(policy, 4);
+    TieredMergePol_Set_Floor_Size(policy, 1 * MB);
+    TieredMergePol_Set_Max_Merged_Size(policy, 100 * MB);
+    return policy;
+}
+
+static void
+S_add_cand(VArray *cands, int64_t size, int32_t doc_max, int32_t del_count) {
+    int64_t seg_num = VA_Get_Size(cands) + 1;
+    VA_Push(cands, (Obj*)MergeCand_new(seg_num, size, doc_max, del_count));
+}
+
+static bool
+S_picked(I32Array *ticks, int32_t tick) {
+    for (uint32_t i = 0, max = I32Arr_Get_Size(ticks); i < max; i++) {
+        if (I32Arr_Get(ticks, i) == tick) { return true; }
+    }
+    return false;
+}
+
+static void
+test_Merge_Candidate(TestBatchRunner *runner) {
+    MergeCandidate *cand = MergeCand_new(3, 1000, 100, 25);
+    TEST_TRUE(runner, MergeCand_Get_Seg_Num(cand) == 3, "Get_Seg_Num");
+    TEST_TRUE(runner, MergeCand_Get_Size(cand) == 1000, "Get_Size");
+    TEST_TRUE(runner, MergeCand_Del_Proportion(cand) == 0.25,
+              "Del_Proportion");
+    TEST_TRUE(runner, MergeCand_Live_Size(cand) == 750, "Live_Size");
+    DECREF(cand);
+}
+
+static void
+test_Tier(TestBatchRunner *runner) {
+    TieredMergePolicy *policy = S_make_policy();
+    TEST_INT_EQ(runner, TieredMergePol_Tier(policy, 1), 0,
+                "tiny segment in floor tier");
+    TEST_INT_EQ(runner, TieredMergePol_Tier(policy, 1 * MB), 0,
+                "floor-sized segment in floor tier");
+    TEST_INT_EQ(runner, TieredMergePol_Tier(policy, 2 * MB), 1,
+                "tier 1");
+    TEST_INT_EQ(runner, TieredMergePol_Tier(policy, 5 * MB), 2,
+                "tier 2");
+    TEST_INT_EQ(runner, TieredMergePol_Tier(policy, 17 * MB), 3,
+                "tier 3");
+    DECREF(policy);
+}
+
+static void
+test_tiers(TestBatchRunner *runner) {
+    TieredMergePolicy *policy = S_make_policy();
+    VArray *cands = VA_new(0);
+    I32Array *ticks;
+
+    // Three small segments don't fill a tier.
+    S_add_cand(cands, 50 * MB, 1000, 0);
+    S_add_cand(cands, 10 * KB, 10, 0);
+    S_add_cand(cands, 20 * KB, 10, 0);
+    S_add_cand(cands, 30 * KB, 10, 0);
+    ticks = TieredMergePol_Select(policy, cands);
+    TEST_INT_EQ(runner, I32Arr_Get_Size(ticks), 0,
+                "no merge while tiers aren't full");
+    DECREF(ticks);
+
+    // A fourth does.
+    S_add_cand(cands, 40 * KB, 10, 0);
+    ticks = TieredMergePol_Select(policy, cands);
+    TEST_INT_EQ(runner, I32Arr_Get_Size(ticks), 4,
+                "merge full tier of small segments");
+    TEST_FALSE(runner, S_picked(ticks, 0), "big segment left alone");
+    TEST_TRUE(runner, I32Arr_Get(ticks, 0) == 1
+              && I32Arr_Get(ticks, 3) == 4,
+              "ticks returned in segment order");
+    DECREF(ticks);
+
+    // Batches are bounded by max_merge_at_once.
+    for (int i = 0; i < 6; i++) { S_add_cand(cands, 5 * KB, 10, 0); }
+    ticks = TieredMergePol_Select(policy, cands);
+    TEST_INT_EQ(runner, I32Arr_Get_Size(ticks), 4, "bounded batch");
+    DECREF(ticks);
+
+    DECREF(cands);
+    DECREF(policy);
+}
+
+static void
+test_deletions(TestBatchRunner *runner) {
+    TieredMergePolicy *policy = S_make_policy();
+    VArray *cands = VA_new(0);
+    I32Array *ticks;
+
+    // Within a full tier, prefer segments with deletions.
+    S_add_cand(cands, 10 * KB, 100, 0);
+    S_add_cand(cands, 10 * KB, 100, 0);
+    S_add_cand(cands, 10 * KB, 100, 0);
+    S_add_cand(cands, 10 * KB, 100, 0);
+    S_add_cand(cands, 10 * KB, 100, 50);
+    ticks = TieredMergePol_Select(policy, cands);
+    TEST_TRUE(runner, S_picked(ticks, 4), "prefer deletions within tier");
+    DECREF(ticks);
+    DECREF(cands);
+
+    // Reclaim deletions even when no tier is full.
+    cands = VA_new(0);
+    S_add_cand(cands, 60 * MB, 1000, 500);
+    S_add_cand(cands, 60 * MB, 1000, 10);
+    ticks = TieredMergePol_Select(policy, cands);
+    TEST_INT_EQ(runner, I32Arr_Get_Size(ticks), 1, "reclaim lone segment");
+    TEST_TRUE(runner, S_picked(ticks, 0),
+              "reclaim big segment with many deletions");
+    DECREF(ticks);
+    DECREF(cands);
+
+    DECREF(policy);
+}
+
+static void
+test_max_merged_size(TestBatchRunner *runner) {
+    TieredMergePolicy *policy = S_make_policy();
+    VArray *cands = VA_new(0);
+    int64_t total = 0;
+
+    for (int i = 0; i < 4; i++) { S_add_cand(cands, 40 * MB, 100, 0); }
+    I32Array *ticks = TieredMergePol_Select(policy, cands);
+    for (uint32_t i = 0, max = I32Arr_Get_Size(ticks); i < max; i++) {
+        MergeCandidate *cand
+            = (MergeCandidate*)VA_Fetch(cands, I32Arr_Get(ticks, i));
+        total += MergeCand_Get_Size(cand);
+    }
+    TEST_TRUE(runner, I32Arr_Get_Size(ticks) == 2 && total <= 100 * MB,
+              "merged size capped");
+
+    DECREF(ticks);
+    DECREF(cands);
+    DECREF(policy);
+}
+
+static void
+test_Recycle(TestBatchRunner *runner) {
+    Schema            *schema   = (Schema*)TestSchema_new(false);
+    String            *field    = (String*)SSTR_WRAP_UTF8("content", 7);
+    RAMFolder         *folder   = RAMFolder_new(NULL);
+    TieredMergePolicy *policy   = S_make_policy();
+    uint32_t           max_segs = 0;
+
+    for (int i = 0; i < 20; i++) {
+        IndexManager *manager = IxManager_new(NULL, NULL);
+        IxManager_Set_Merge_Policy(manager, (MergePolicy*)policy);
+        Indexer *indexer = Indexer_new(schema, (Obj*)folder, manager, 0);
+        Doc *doc = Doc_new(NULL, 0);
+        String *value = Str_newf("doc %i32", (int32_t)i);
+        Doc_Store(doc, field, (Obj*)value);
+        Indexer_Add_Doc(indexer, doc, 1.0f);
+        Indexer_Commit(indexer);
+        DECREF(value);
+        DECREF(doc);
+        DECREF(indexer);
+        DECREF(manager);
+
+        PolyReader *reader = PolyReader_open((Obj*)folder, NULL, NULL);
+        VArray *seg_readers = PolyReader_Get_Seg_Readers(reader);
+        if (VA_Get_Size(seg_readers) > max_segs) {
+            max_segs = VA_Get_Size(seg_readers);
+        }
+        DECREF(reader);
+    }
+
+    TEST_TRUE(runner, max_segs <= 4,
+              "Recycle delegates to MergePolicy (max %u32 segs)", max_segs);
+    PolyReader *reader = PolyReader_open((Obj*)folder, NULL, NULL);
+    TEST_INT_EQ(runner, PolyReader_Doc_Count(reader), 20,
+                "all docs survive merging");
+    DECREF(reader);
+
+    DECREF(policy);
+    DECREF(folder);
+    DECREF(schema);
+}
+
+void
+TestTieredMergePol_Run_IMP(TestTieredMergePolicy *self,
+                           TestBatchRunner *runner) {
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 20);
+    test_Merge_Candidate(runner);
+    test_Tier(runner);
+    test_tiers(runner);
+    test_deletions(runner);
+    test_max_merged_size(runner);
+    test_Recycle(runner);
+}
+
@@ -47,4 +47,10 @@ TestArch_Skip_Interval_IMP(TestArchitecture *self) {
     return 3;
 }
 
+int32_t
+TestArch_Doc_Chunk_Size_IMP(TestArchitecture *self) {
+    UNUSED_VAR(self);
+    return 100;
+}
+
 
@@ -125,7 +125,8 @@ S_check(TestBatchRunner *runner, RAMFolder *folder, String *field,
         String *query_text, uint32_t expected_num_hits) {
     TermQuery *query = TermQuery_new(field, (Obj*)query_text);
     IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
-    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 10, NULL);
+    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 10, NULL, NULL,
+                                 NULL);
 
     TEST_TRUE(runner, Hits_Total_Hits(hits) == expected_num_hits,
               "%s correct num hits", Str_Get_Ptr8(field));
@@ -215,7 +216,8 @@ test_many_fields(TestBatchRunner *runner) {
 
         // See if our search results match as expected.
         IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
-        Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 100, NULL);
+        Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 100, NULL,
+                                     NULL, NULL);
         TEST_TRUE(runner, Hits_Total_Hits(hits) == 2,
                   "correct number of hits for %d fields", num_fields);
         HitDoc *top_hit = Hits_Next(hits);
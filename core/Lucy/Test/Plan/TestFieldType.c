@@ -43,6 +43,11 @@ S_alt_field_type() {
     return FType_init(self);
 }
 
+static void
+S_set_bad_bloom_bits(void *context) {
+    FType_Set_Bloom_Bits((FieldType*)context, 2);
+}
+
 static void
 test_Dump_Load_and_Equals(TestBatchRunner *runner) {
     FieldType   *type          = (FieldType*)DummyFieldType_new();
@@ -73,6 +78,20 @@ test_Dump_Load_and_Equals(TestBatchRunner *runner) {
     TEST_FALSE(runner, FType_Equals(type, (Obj*)stored),
                "Equals() false with stored => true");
 
+    FType_Set_Bloom_Bits(other, 10);
+    TEST_INT_EQ(runner, FType_Get_Bloom_Bits(other), 10, "Set_Bloom_Bits");
+    TEST_FALSE(runner, FType_Equals(type, (Obj*)other),
+               "Equals() false with different bloom_bits");
+    Err *error = Err_trap(S_set_bad_bloom_bits, type);
+    TEST_TRUE(runner, error != NULL, "Set_Bloom_Bits rejects 2 bits");
+    DECREF(error);
+
+    FType_Set_Bloom_Bits(other, 0);
+    FType_Set_Unique(other, true);
+    TEST_TRUE(runner, FType_Unique(other), "Set_Unique");
+    TEST_FALSE(runner, FType_Equals(type, (Obj*)other),
+               "Equals() false with unique => true");
+
     DECREF(stored);
     DECREF(indexed);
     DECREF(boost_differs);
@@ -102,7 +121,7 @@ test_Compare_Values(TestBatchRunner *runner) {
 
 void
 TestFType_Run_IMP(TestFieldType *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 9);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 14);
     test_Dump_Load_and_Equals(runner);
     test_Compare_Values(runner);
 }
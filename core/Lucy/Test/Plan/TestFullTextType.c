@@ -15,6 +15,8 @@
  */
 
 #define C_TESTLUCY_TESTFULLTEXTTYPE
+#define C_TESTLUCY_CUSTOMSIMTYPE
+#define C_TESTLUCY_CUSTOMSIM
 #define TESTLUCY_USE_SHORT_NAMES
 #include "Lucy/Util/ToolSet.h"
 
@@ -22,7 +24,9 @@
 #include "Lucy/Test.h"
 #include "Lucy/Test/Plan/TestFullTextType.h"
 #include "Lucy/Test/TestUtils.h"
+#include "Lucy/Index/Similarity.h"
 #include "Lucy/Plan/FullTextType.h"
+#include "Lucy/Plan/Schema.h"
 #include "Lucy/Analysis/Normalizer.h"
 #include "Lucy/Analysis/StandardTokenizer.h"
 #include "Lucy/Util/Freezer.h"
@@ -70,6 +74,30 @@ test_Dump_Load_and_Equals(TestBatchRunner *runner) {
     TEST_TRUE(runner, FullTextType_Equals(type, (Obj*)another_clone),
               "Dump_For_Schema => Load round trip");
 
+    FullTextType *bloom = FullTextType_new((Analyzer*)tokenizer);
+    FullTextType_Set_Bloom_Bits(bloom, 12);
+    Obj *bloom_dump  = (Obj*)FullTextType_Dump(bloom);
+    Obj *bloom_clone = Freezer_load(bloom_dump);
+    TEST_FALSE(runner, FullTextType_Equals(type, (Obj*)bloom),
+               "Equals() false with different bloom_bits");
+    TEST_TRUE(runner, FullTextType_Equals(bloom, bloom_clone),
+              "Dump => Load round trip preserves bloom_bits");
+    DECREF(bloom_clone);
+    DECREF(bloom_dump);
+    DECREF(bloom);
+
+    FullTextType *shingles = FullTextType_new((Analyzer*)tokenizer);
+    FullTextType_Set_Shingles(shingles, true);
+    Obj *shingles_dump  = (Obj*)FullTextType_Dump(shingles);
+    Obj *shingles_clone = Freezer_load(shingles_dump);
+    TEST_FALSE(runner, FullTextType_Equals(type, (Obj*)shingles),
+               "Equals() false with shingles => true");
+    TEST_TRUE(runner, FullTextType_Equals(shingles, shingles_clone),
+              "Dump => Load round trip preserves shingles");
+    DECREF(shingles_clone);
+    DECREF(shingles_dump);
+    DECREF(shingles);
+
     DECREF(another_clone);
     DECREF(dump);
     DECREF(clone);
@@ -105,11 +133,60 @@ test_Compare_Values(TestBatchRunner *runner) {
     DECREF(tokenizer);
 }
 
+static void
+test_shingle_type(TestBatchRunner *runner) {
+    StandardTokenizer *tokenizer = StandardTokenizer_new();
+    CustomSimType     *type      = CustomSimType_new((Analyzer*)tokenizer);
+    Schema            *schema    = Schema_new();
+    String            *field     = Str_newf("content");
+    String            *shingles  = FullTextType_shingle_field(field);
+    FullTextType_Set_Shingles((FullTextType*)type, true);
+    Schema_Spec_Field(schema, field, (FieldType*)type);
+
+    FieldType *shingle_type = Schema_Fetch_Type(schema, shingles);
+    TEST_TRUE(runner, shingle_type && FType_Is_A(shingle_type, CUSTOMSIMTYPE),
+              "Shingle type belongs to the parent's class");
+    Similarity *sim = Schema_Fetch_Sim(schema, field);
+    TEST_TRUE(runner, sim && Sim_Is_A(sim, CUSTOMSIM),
+              "Custom Similarity for the parent field");
+    TEST_TRUE(runner, Schema_Fetch_Sim(schema, shingles) == sim,
+              "Shingle field shares the parent's Similarity");
+
+    DECREF(shingles);
+    DECREF(field);
+    DECREF(schema);
+    DECREF(type);
+    DECREF(tokenizer);
+}
+
 void
 TestFullTextType_Run_IMP(TestFullTextType *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 10);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 17);
     test_Dump_Load_and_Equals(runner);
     test_Compare_Values(runner);
+    test_shingle_type(runner);
+}
+
+/****************************** CustomSimType ******************************/
+
+CustomSimType*
+CustomSimType_new(Analyzer *analyzer) {
+    CustomSimType *self = (CustomSimType*)VTable_Make_Obj(CUSTOMSIMTYPE);
+    return (CustomSimType*)FullTextType_init((FullTextType*)self, analyzer);
+}
+
+Similarity*
+CustomSimType_Make_Similarity_IMP(CustomSimType *self) {
+    UNUSED_VAR(self);
+    return (Similarity*)CustomSim_new();
+}
+
+/******************************** CustomSim ********************************/
+
+CustomSim*
+CustomSim_new() {
+    CustomSim *self = (CustomSim*)VTable_Make_Obj(CUSTOMSIM);
+    return (CustomSim*)Sim_init((Similarity*)self);
 }
 
 
@@ -0,0 +1,352 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_TESTLUCY_TESTMULTITERMQUERY
+#define TESTLUCY_USE_SHORT_NAMES
+#include "Lucy/Util/ToolSet.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "Clownfish/TestHarness/TestBatchRunner.h"
+#include "Lucy/Test.h"
+#include "Lucy/Test/Search/TestMultiTermQuery.h"
+#include "Lucy/Document/Doc.h"
+#include "Lucy/Index/Indexer.h"
+#include "Lucy/Plan/Schema.h"
+#include "Lucy/Plan/StringType.h"
+#include "Lucy/Document/HitDoc.h"
+#include "Lucy/Search/FuzzyQuery.h"
+#include "Lucy/Search/Hits.h"
+#include "Lucy/Search/IndexSearcher.h"
+#include "Lucy/Search/PrefixQuery.h"
+#include "Lucy/Search/WildcardQuery.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/OutStream.h"
+#include "Lucy/Store/RAMFile.h"
+#include "Lucy/Store/RAMFolder.h"
+#include "Lucy/Util/Freezer.h"
+
+#define NUM_NUMBERED 40
+
+static const char *words[] = {
+    "apple", "apply", "apricot", "aplomb", "banana", "band", "bandana",
+    "bane", "bond", "abandon", "\xC3\xA4pfel", "zebra", NULL
+};
+
+TestMultiTermQuery*
+TestMultiTermQuery_new() {
+    return (TestMultiTermQuery*)VTable_Make_Obj(TESTMULTITERMQUERY);
+}
+
+static MultiTermQuery*
+S_freeze_thaw(MultiTermQuery *query) {
+    RAMFile   *file      = RAMFile_new(NULL, false);
+    OutStream *outstream = OutStream_open((Obj*)file);
+    FREEZE(query, outstream);
+    OutStream_Close(outstream);
+    InStream  *instream  = InStream_open((Obj*)file);
+    MultiTermQuery *thawed = (MultiTermQuery*)THAW(instream);
+    DECREF(instream);
+    DECREF(outstream);
+    DECREF(file);
+    return thawed;
+}
+
+static void
+S_check_round_trips(TestBatchRunner *runner, MultiTermQuery *query,
+                    MultiTermQuery *other, const char *name) {
+    Obj *dump = (Obj*)MultiTermQuery_Dump(query);
+    MultiTermQuery *loaded = (MultiTermQuery*)MultiTermQuery_Load(other, dump);
+    MultiTermQuery *thawed = S_freeze_thaw(query);
+    TEST_FALSE(runner, MultiTermQuery_Equals(query, (Obj*)other),
+               "%s: Equals() false with different params", name);
+    TEST_TRUE(runner, MultiTermQuery_Equals(query, (Obj*)loaded),
+              "%s: Dump => Load round trip", name);
+    TEST_TRUE(runner, MultiTermQuery_Equals(query, (Obj*)thawed),
+              "%s: Serialize => Deserialize round trip", name);
+    DECREF(thawed);
+    DECREF(loaded);
+    DECREF(dump);
+}
+
+static void
+test_Dump_Load_and_Equals(TestBatchRunner *runner) {
+    String *field = Str_newf("content");
+    String *foo   = Str_newf("foo");
+    String *bar   = Str_newf("bar");
+
+    PrefixQuery *prefix = PrefixQuery_new(field, foo);
+    PrefixQuery *prefix_differs = PrefixQuery_new(field, bar);
+    S_check_round_trips(runner, (MultiTermQuery*)prefix,
+                        (MultiTermQuery*)prefix_differs, "PrefixQuery");
+
+    WildcardQuery *wildcard = WildcardQuery_new(field, foo);
+    WildcardQuery *wildcard_differs = WildcardQuery_new(field, foo);
+    WildcardQuery_Set_Max_Expansions(wildcard_differs, 3);
+    S_check_round_trips(runner, (MultiTermQuery*)wildcard,
+                        (MultiTermQuery*)wildcard_differs, "WildcardQuery");
+    TEST_FALSE(runner, WildcardQuery_Equals(wildcard, (Obj*)prefix),
+               "Equals() false with different class");
+
+    FuzzyQuery *fuzzy = FuzzyQuery_new(field, foo, 1, 1);
+    FuzzyQuery *fuzzy_differs = FuzzyQuery_new(field, foo, 2, 1);
+    S_check_round_trips(runner, (MultiTermQuery*)fuzzy,
+                        (MultiTermQuery*)fuzzy_differs, "FuzzyQuery");
+
+    DECREF(fuzzy_differs);
+    DECREF(fuzzy);
+    DECREF(wildcard_differs);
+    DECREF(wildcard);
+    DECREF(prefix_differs);
+    DECREF(prefix);
+    DECREF(bar);
+    DECREF(foo);
+    DECREF(field);
+}
+
+static RAMFolder*
+S_create_index() {
+    Schema     *schema = Schema_new();
+    StringType *type   = StringType_new();
+    String     *field  = Str_newf("content");
+    RAMFolder  *folder = RAMFolder_new(NULL);
+    Schema_Spec_Field(schema, field, (FieldType*)type);
+
+    Indexer *indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    for (int i = 0; words[i] != NULL; i++) {
+        Doc *doc = Doc_new(NULL, 0);
+        String *value = Str_new_from_utf8(words[i], strlen(words[i]));
+        Doc_Store(doc, field, (Obj*)value);
+        Indexer_Add_Doc(indexer, doc, 1.0f);
+        DECREF(value);
+        DECREF(doc);
+    }
+    for (int i = 0; i < NUM_NUMBERED; i++) {
+        Doc *doc = Doc_new(NULL, 0);
+        String *value = Str_newf("word%i32", (int32_t)(100 + i));
+        Doc_Store(doc, field, (Obj*)value);
+        Indexer_Add_Doc(indexer, doc, 1.0f);
+        DECREF(value);
+        DECREF(doc);
+    }
+    Indexer_Commit(indexer);
+
+    DECREF(indexer);
+    DECREF(field);
+    DECREF(type);
+    DECREF(schema);
+    return folder;
+}
+
+static uint32_t
+S_count(IndexSearcher *searcher, MultiTermQuery *query) {
+    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 100, NULL, NULL,
+                                 NULL);
+    uint32_t count = Hits_Total_Hits(hits);
+    DECREF(hits);
+    return count;
+}
+
+static uint32_t
+S_count_prefix(IndexSearcher *searcher, const char *prefix,
+               int32_t max_expansions) {
+    String *field = Str_newf("content");
+    String *term  = Str_new_from_utf8(prefix, strlen(prefix));
+    PrefixQuery *query = PrefixQuery_new(field, term);
+    PrefixQuery_Set_Max_Expansions(query, max_expansions);
+    uint32_t count = S_count(searcher, (MultiTermQuery*)query);
+    DECREF(query);
+    DECREF(term);
+    DECREF(field);
+    return count;
+}
+
+static uint32_t
+S_count_wildcard(IndexSearcher *searcher, const char *pattern) {
+    String *field = Str_newf("content");
+    String *term  = Str_new_from_utf8(pattern, strlen(pattern));
+    WildcardQuery *query = WildcardQuery_new(field, term);
+    uint32_t count = S_count(searcher, (MultiTermQuery*)query);
+    DECREF(query);
+    DECREF(term);
+    DECREF(field);
+    return count;
+}
+
+static void
+test_Prefix_and_Wildcard(TestBatchRunner *runner) {
+    RAMFolder     *folder   = S_create_index();
+    IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
+
+    TEST_INT_EQ(runner, S_count_prefix(searcher, "ap", 0), 4,
+                "PrefixQuery");
+    TEST_INT_EQ(runner, S_count_prefix(searcher, "band", 0), 2,
+                "PrefixQuery includes exact match");
+    TEST_INT_EQ(runner, S_count_prefix(searcher, "zz", 0), 0,
+                "PrefixQuery past the last term");
+    TEST_INT_EQ(runner, S_count_prefix(searcher, "word", 0), NUM_NUMBERED,
+                "PrefixQuery with many expansions");
+    TEST_INT_EQ(runner, S_count_prefix(searcher, "word", 10), 10,
+                "max_expansions caps the expansion");
+    TEST_INT_EQ(runner, S_count_prefix(searcher, "", 0), NUM_NUMBERED + 12,
+                "empty prefix matches everything");
+
+    TEST_INT_EQ(runner, S_count_wildcard(searcher, "ap*e"), 1, "ap*e");
+    TEST_INT_EQ(runner, S_count_wildcard(searcher, "ba?d"), 1, "ba?d");
+    TEST_INT_EQ(runner, S_count_wildcard(searcher, "*ana"), 2, "*ana");
+    TEST_INT_EQ(runner, S_count_wildcard(searcher, "b*n*"), 5, "b*n*");
+    TEST_INT_EQ(runner, S_count_wildcard(searcher, "?pfel"), 1,
+                "? matches a multibyte character");
+    TEST_INT_EQ(runner, S_count_wildcard(searcher, "word1?5"), 4, "word1?5");
+    TEST_INT_EQ(runner, S_count_wildcard(searcher, "band"), 1,
+                "pattern without wildcards");
+
+    DECREF(searcher);
+    DECREF(folder);
+}
+
+static int32_t
+S_levenshtein(const char *a, const char *b) {
+    size_t a_len = strlen(a);
+    size_t b_len = strlen(b);
+    int32_t *prev = (int32_t*)MALLOCATE((b_len + 1) * sizeof(int32_t));
+    int32_t *row  = (int32_t*)MALLOCATE((b_len + 1) * sizeof(int32_t));
+    for (size_t j = 0; j <= b_len; j++) { prev[j] = (int32_t)j; }
+    for (size_t i = 1; i <= a_len; i++) {
+        row[0] = (int32_t)i;
+        for (size_t j = 1; j <= b_len; j++) {
+            int32_t cost = prev[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+            if (prev[j] + 1 < cost)    { cost = prev[j] + 1; }
+            if (row[j - 1] + 1 < cost) { cost = row[j - 1] + 1; }
+            row[j] = cost;
+        }
+        int32_t *temp = prev;
+        prev = row;
+        row  = temp;
+    }
+    int32_t distance = prev[b_len];
+    FREEMEM(row);
+    FREEMEM(prev);
+    return distance;
+}
+
+static void
+test_Fuzzy(TestBatchRunner *runner) {
+    RAMFolder     *folder   = S_create_index();
+    IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
+    String        *field    = Str_newf("content");
+    const char    *targets[] = {
+        "bande", "aple", "word", "word1055", "bnad", "", "zebras", NULL
+    };
+
+    // Compare against brute force over every (ASCII) term.
+    bool all_agree = true;
+    for (int t = 0; targets[t] != NULL; t++) {
+        for (int32_t max_edits = 0; max_edits <= 2; max_edits++) {
+            uint32_t expected = 0;
+            char buf[20];
+            for (int i = 0; words[i] != NULL; i++) {
+                if (words[i][0] & 0x80) { continue; }
+                if (S_levenshtein(words[i], targets[t]) <= max_edits) {
+                    expected++;
+                }
+            }
+            for (int i = 0; i < NUM_NUMBERED; i++) {
+                sprintf(buf, "word%d", 100 + i);
+                if (S_levenshtein(buf, targets[t]) <= max_edits) {
+                    expected++;
+                }
+            }
+            String *term = Str_new_from_utf8(targets[t], strlen(targets[t]));
+            FuzzyQuery *query = FuzzyQuery_new(field, term, max_edits, 0);
+            FuzzyQuery_Set_Max_Expansions(query, 0);
+            if (S_count(searcher, (MultiTermQuery*)query) != expected) {
+                all_agree = false;
+            }
+            DECREF(query);
+            DECREF(term);
+        }
+    }
+    TEST_TRUE(runner, all_agree, "FuzzyQuery agrees with brute force");
+
+    String *term = Str_newf("xpple");
+    FuzzyQuery *query = FuzzyQuery_new(field, term, 1, 0);
+    TEST_INT_EQ(runner, S_count(searcher, (MultiTermQuery*)query), 1,
+                "FuzzyQuery substitution");
+    DECREF(query);
+    query = FuzzyQuery_new(field, term, 1, 1);
+    TEST_INT_EQ(runner, S_count(searcher, (MultiTermQuery*)query), 0,
+                "prefix_length requires exact leading characters");
+    DECREF(query);
+    DECREF(term);
+
+    term = Str_newf("\xC3\xB6pfel");
+    query = FuzzyQuery_new(field, term, 1, 0);
+    TEST_INT_EQ(runner, S_count(searcher, (MultiTermQuery*)query), 1,
+                "multibyte characters count as one edit");
+    DECREF(query);
+    DECREF(term);
+
+    // "band" and "bane" precede "bond" in the lexicon, but are further
+    // away.
+    term  = Str_newf("bond");
+    query = FuzzyQuery_new(field, term, 2, 0);
+    FuzzyQuery_Set_Max_Expansions(query, 1);
+    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 10, NULL, NULL,
+                                 NULL);
+    HitDoc *hit_doc = Hits_Next(hits);
+    String *content = hit_doc
+                      ? (String*)HitDoc_Extract(hit_doc, field)
+                      : NULL;
+    TEST_TRUE(runner, Hits_Total_Hits(hits) == 1
+                      && content && Str_Equals_Utf8(content, "bond", 4),
+              "max_expansions keeps the closest terms");
+    DECREF(content);
+    DECREF(hit_doc);
+    DECREF(hits);
+
+    // Acceptors for the same query keep their automaton state apart.
+    TermAcceptor *acceptor = FuzzyQuery_Make_Acceptor(query);
+    TermAcceptor *other    = FuzzyQuery_Make_Acceptor(query);
+    String *banana = Str_newf("banana");
+    String *band   = Str_newf("band");
+    TermAcceptor_Rank(acceptor, banana);
+    TEST_INT_EQ(runner, TermAcceptor_Rank(other, term), 0,
+                "Rank() of an exact match");
+    TEST_INT_EQ(runner, TermAcceptor_Rank(acceptor, band), 1,
+                "Rank() is the edit distance");
+    DECREF(band);
+    DECREF(banana);
+    DECREF(other);
+    DECREF(acceptor);
+    DECREF(query);
+    DECREF(term);
+
+    DECREF(field);
+    DECREF(searcher);
+    DECREF(folder);
+}
+
+void
+TestMultiTermQuery_Run_IMP(TestMultiTermQuery *self,
+                           TestBatchRunner *runner) {
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 30);
+    test_Dump_Load_and_Equals(runner);
+    test_Prefix_and_Wildcard(runner);
+    test_Fuzzy(runner);
+}
+
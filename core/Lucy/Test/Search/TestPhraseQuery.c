@@ -23,9 +23,26 @@
 #include "Lucy/Test.h"
 #include "Lucy/Test/TestUtils.h"
 #include "Lucy/Test/Search/TestPhraseQuery.h"
+#include "Lucy/Test/TestSchema.h"
+#include "Lucy/Analysis/StandardTokenizer.h"
+#include "Lucy/Document/Doc.h"
+#include "Lucy/Document/HitDoc.h"
+#include "Lucy/Index/Indexer.h"
+#include "Lucy/Index/IndexReader.h"
+#include "Lucy/Index/SegReader.h"
+#include "Lucy/Plan/FullTextType.h"
+#include "Lucy/Plan/Schema.h"
+#include "Lucy/Search/Compiler.h"
+#include "Lucy/Search/Hits.h"
+#include "Lucy/Search/IndexSearcher.h"
+#include "Lucy/Search/PhraseMatcher.h"
 #include "Lucy/Search/PhraseQuery.h"
+#include "Lucy/Store/RAMFolder.h"
 #include "Lucy/Util/Freezer.h"
 
+#define NUM_DOCS      60
+#define MAX_DOC_WORDS 300
+
 TestPhraseQuery*
 TestPhraseQuery_new() {
     return (TestPhraseQuery*)VTable_Make_Obj(TESTPHRASEQUERY);
@@ -44,10 +61,182 @@ test_Dump_And_Load(TestBatchRunner *runner) {
     DECREF(twin);
 }
 
+// Fill docs with words drawn from a tiny vocabulary, so that every term
+// occurs many times per doc and phrases overlap.
+static char
+S_word(uint32_t *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return "abc"[(*seed >> 16) % 3];
+}
+
+// Like TestSchema's "content" field, but with shingles.
+static Schema*
+S_shingle_schema() {
+    Schema            *schema    = Schema_new();
+    StandardTokenizer *tokenizer = StandardTokenizer_new();
+    FullTextType      *type      = FullTextType_new((Analyzer*)tokenizer);
+    String            *field     = Str_newf("content");
+    FullTextType_Set_Shingles(type, true);
+    Schema_Spec_Field(schema, field, (FieldType*)type);
+    DECREF(field);
+    DECREF(type);
+    DECREF(tokenizer);
+    return schema;
+}
+
+static RAMFolder*
+S_create_index(char words[NUM_DOCS][MAX_DOC_WORDS + 1], bool shingles) {
+    Schema    *schema  = shingles
+                         ? S_shingle_schema()
+                         : (Schema*)TestSchema_new(false);
+    RAMFolder *folder  = RAMFolder_new(NULL);
+    String    *field   = Str_newf("content");
+    Indexer   *indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+    uint32_t   seed    = 42;
+    char       text[MAX_DOC_WORDS * 2];
+
+    for (int i = 0; i < NUM_DOCS; i++) {
+        int num_words = 1 + (i * 37) % MAX_DOC_WORDS;
+        for (int j = 0; j < num_words; j++) {
+            words[i][j]     = S_word(&seed);
+            text[j * 2]     = words[i][j];
+            text[j * 2 + 1] = ' ';
+        }
+        words[i][num_words] = '\0';
+        Doc *doc = Doc_new(NULL, 0);
+        String *value = Str_new_from_utf8(text, num_words * 2 - 1);
+        Doc_Store(doc, field, (Obj*)value);
+        Indexer_Add_Doc(indexer, doc, 1.0f);
+        DECREF(value);
+        DECREF(doc);
+    }
+    Indexer_Commit(indexer);
+
+    DECREF(indexer);
+    DECREF(field);
+    DECREF(schema);
+    return folder;
+}
+
+// Count overlapping occurrences of <code>phrase</code> in <code>doc</code>.
+static uint32_t
+S_brute_force_freq(const char *doc, const char *phrase) {
+    uint32_t freq = 0;
+    size_t   len  = strlen(phrase);
+    for (const char *ptr = doc; strlen(ptr) >= len; ptr++) {
+        if (strncmp(ptr, phrase, len) == 0) { freq++; }
+    }
+    return freq;
+}
+
+static const char *phrases[] = {
+    "ab", "aa", "abc", "ccc", "baba", "cabcab", NULL
+};
+
+static PhraseQuery*
+S_make_phrase_query(const char *phrase) {
+    String *field = Str_newf("content");
+    VArray *terms = VA_new(0);
+    for (const char *ptr = phrase; *ptr; ptr++) {
+        VA_Push(terms, (Obj*)Str_new_from_utf8(ptr, 1));
+    }
+    PhraseQuery *query = PhraseQuery_new(field, terms);
+    DECREF(terms);
+    DECREF(field);
+    return query;
+}
+
+static void
+test_Calc_Phrase_Freq(TestBatchRunner *runner, bool shingles) {
+    static char words[NUM_DOCS][MAX_DOC_WORDS + 1];
+    RAMFolder     *folder   = S_create_index(words, shingles);
+    IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
+    IndexReader   *ix_reader   = IxSearcher_Get_Reader(searcher);
+    VArray        *seg_readers = IxReader_Seg_Readers(ix_reader);
+    SegReader     *reader      = (SegReader*)VA_Fetch(seg_readers, 0);
+
+    for (int p = 0; phrases[p] != NULL; p++) {
+        PhraseQuery *query = S_make_phrase_query(phrases[p]);
+        Compiler *compiler
+            = PhraseQuery_Make_Compiler(query, (Searcher*)searcher, 1.0f,
+                                        false);
+        PhraseMatcher *matcher
+            = (PhraseMatcher*)Compiler_Make_Matcher(compiler, reader, true);
+
+        bool     agree    = true;
+        int32_t  expected = 0;
+        int32_t  doc_id;
+        while (matcher && 0 != (doc_id = PhraseMatcher_Next(matcher))) {
+            uint32_t freq = (uint32_t)PhraseMatcher_Calc_Phrase_Freq(matcher);
+            if (freq != S_brute_force_freq(words[doc_id - 1], phrases[p])) {
+                agree = false;
+            }
+            expected--;
+        }
+        for (int i = 0; i < NUM_DOCS; i++) {
+            if (S_brute_force_freq(words[i], phrases[p])) { expected++; }
+        }
+        TEST_TRUE(runner, agree && expected == 0,
+                  "phrase \"%s\" matches brute force%s", phrases[p],
+                  shingles ? " using shingles" : "");
+
+        DECREF(matcher);
+        DECREF(compiler);
+        DECREF(query);
+    }
+
+    DECREF(seg_readers);
+    DECREF(searcher);
+    DECREF(folder);
+}
+
+static void
+test_shingle_scores(TestBatchRunner *runner) {
+    static char words[NUM_DOCS][MAX_DOC_WORDS + 1];
+    RAMFolder     *plain_folder    = S_create_index(words, false);
+    RAMFolder     *shingle_folder  = S_create_index(words, true);
+    IndexSearcher *plain    = IxSearcher_new((Obj*)plain_folder);
+    IndexSearcher *shingled = IxSearcher_new((Obj*)shingle_folder);
+
+    for (int p = 0; phrases[p] != NULL; p++) {
+        PhraseQuery *query = S_make_phrase_query(phrases[p]);
+        Hits *plain_hits
+            = IxSearcher_Hits(plain, (Obj*)query, 0, NUM_DOCS, NULL, NULL,
+                              NULL);
+        Hits *shingle_hits
+            = IxSearcher_Hits(shingled, (Obj*)query, 0, NUM_DOCS, NULL, NULL,
+                              NULL);
+        bool agree = Hits_Total_Hits(plain_hits)
+                     == Hits_Total_Hits(shingle_hits);
+        HitDoc *a, *b;
+        while (agree && NULL != (a = Hits_Next(plain_hits))) {
+            b = Hits_Next(shingle_hits);
+            agree = b != NULL
+                    && HitDoc_Get_Doc_ID(a) == HitDoc_Get_Doc_ID(b)
+                    && HitDoc_Get_Score(a) == HitDoc_Get_Score(b);
+            DECREF(a);
+            DECREF(b);
+        }
+        TEST_TRUE(runner, agree, "shingles give identical hits for \"%s\"",
+                  phrases[p]);
+        DECREF(shingle_hits);
+        DECREF(plain_hits);
+        DECREF(query);
+    }
+
+    DECREF(shingled);
+    DECREF(plain);
+    DECREF(shingle_folder);
+    DECREF(plain_folder);
+}
+
 void
 TestPhraseQuery_Run_IMP(TestPhraseQuery *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 1);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 19);
     test_Dump_And_Load(runner);
+    test_Calc_Phrase_Freq(runner, false);
+    test_Calc_Phrase_Freq(runner, true);
+    test_shingle_scores(runner);
 }
 
 
@@ -23,11 +23,14 @@
 #include "Lucy/Test.h"
 #include "Lucy/Test/TestUtils.h"
 #include "Lucy/Test/Search/TestPolyQuery.h"
+#include "Lucy/Index/Similarity.h"
+#include "Lucy/Search/ANDMatcher.h"
 #include "Lucy/Search/ANDQuery.h"
 #include "Lucy/Search/ORQuery.h"
 #include "Lucy/Search/PolyQuery.h"
 #include "Lucy/Search/LeafQuery.h"
 #include "Lucy/Util/Freezer.h"
+#include "LucyX/Search/MockMatcher.h"
 
 TestANDQuery*
 TestANDQuery_new() {
@@ -78,10 +81,83 @@ test_Dump_Load_and_Equals(TestBatchRunner *runner, uint32_t boolop) {
     DECREF(clone);
 }
 
+#define AND_DOC_MAX 1000
+
+// Build an ANDMatcher over MockMatchers yielding the multiples of each
+// interval up to AND_DOC_MAX.
+static ANDMatcher*
+S_make_and_matcher(const int32_t *intervals, uint32_t num_intervals) {
+    VArray     *children = VA_new(num_intervals);
+    Similarity *sim      = Sim_new();
+    for (uint32_t i = 0; i < num_intervals; i++) {
+        int32_t *ids   = (int32_t*)MALLOCATE(AND_DOC_MAX * sizeof(int32_t));
+        size_t   count = 0;
+        for (int32_t doc_id = intervals[i]; doc_id <= AND_DOC_MAX;
+             doc_id += intervals[i]
+            ) {
+            ids[count++] = doc_id;
+        }
+        I32Array *doc_ids = I32Arr_new_steal(ids, count);
+        VA_Push(children, (Obj*)MockMatcher_new(doc_ids, NULL));
+        DECREF(doc_ids);
+    }
+    ANDMatcher *matcher = ANDMatcher_new(children, sim);
+    DECREF(sim);
+    DECREF(children);
+    return matcher;
+}
+
+static bool
+S_matches_all(ANDMatcher *matcher, const int32_t *intervals,
+              uint32_t num_intervals, int32_t start) {
+    int32_t doc_id = start > 1
+                     ? ANDMatcher_Advance(matcher, start)
+                     : ANDMatcher_Next(matcher);
+    for (int32_t expected = start; expected <= AND_DOC_MAX; expected++) {
+        bool wanted = true;
+        for (uint32_t i = 0; i < num_intervals; i++) {
+            if (expected % intervals[i] != 0) { wanted = false; }
+        }
+        if (!wanted) { continue; }
+        if (doc_id != expected) { return false; }
+        doc_id = ANDMatcher_Next(matcher);
+    }
+    return doc_id == 0;
+}
+
+static void
+test_ANDMatcher(TestBatchRunner *runner) {
+    static const int32_t sets[][3] = {
+        { 2, 3, 7 }, { 50, 3, 1 }, { 1, 97, 1 }, { 13, 13, 5 },
+        { 999, 1, 3 }, { 7, 11, 13 }
+    };
+    bool all_ok = true;
+    for (uint32_t i = 0; i < sizeof(sets) / sizeof(sets[0]); i++) {
+        for (uint32_t num = 1; num <= 3; num++) {
+            ANDMatcher *matcher = S_make_and_matcher(sets[i], num);
+            if (!S_matches_all(matcher, sets[i], num, 1)) { all_ok = false; }
+            DECREF(matcher);
+            matcher = S_make_and_matcher(sets[i], num);
+            if (!S_matches_all(matcher, sets[i], num, 500)) { all_ok = false; }
+            DECREF(matcher);
+        }
+    }
+    TEST_TRUE(runner, all_ok, "ANDMatcher intersects correctly");
+
+    static const int32_t dense_first[] = { 1, 2, 250 };
+    ANDMatcher *matcher = S_make_and_matcher(dense_first, 3);
+    TEST_INT_EQ(runner, ANDMatcher_Cost(matcher), AND_DOC_MAX / 250,
+                "Cost() is that of the rarest child");
+    TEST_INT_EQ(runner, ANDMatcher_Next(matcher), 250,
+                "rarest child leads");
+    DECREF(matcher);
+}
+
 void
 TestANDQuery_Run_IMP(TestANDQuery *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 4);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 7);
     test_Dump_Load_and_Equals(runner, BOOLOP_AND);
+    test_ANDMatcher(runner);
 }
 
 void
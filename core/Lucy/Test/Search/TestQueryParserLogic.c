@@ -903,7 +903,8 @@ TestQPLogic_Run_IMP(TestQueryParserLogic *self, TestBatchRunner *runner) {
         TestQueryParserIVARS *test_case = TestQP_IVARS(test_case_obj);
         Query *tree     = QParser_Tree(or_parser, test_case->query_string);
         Query *parsed   = QParser_Parse(or_parser, test_case->query_string);
-        Hits  *hits     = IxSearcher_Hits(searcher, (Obj*)parsed, 0, 10, NULL);
+        Hits  *hits     = IxSearcher_Hits(searcher, (Obj*)parsed, 0, 10, NULL,
+                                          NULL, NULL);
 
         TEST_TRUE(runner, Query_Equals(tree, (Obj*)test_case->tree),
                   "tree() OR   %s", Str_Get_Ptr8(test_case->query_string));
@@ -922,7 +923,8 @@ TestQPLogic_Run_IMP(TestQueryParserLogic *self, TestBatchRunner *runner) {
         TestQueryParserIVARS *test_case = TestQP_IVARS(test_case_obj);
         Query *tree     = QParser_Tree(and_parser, test_case->query_string);
         Query *parsed   = QParser_Parse(and_parser, test_case->query_string);
-        Hits  *hits     = IxSearcher_Hits(searcher, (Obj*)parsed, 0, 10, NULL);
+        Hits  *hits     = IxSearcher_Hits(searcher, (Obj*)parsed, 0, 10, NULL,
+                                          NULL, NULL);
 
         TEST_TRUE(runner, Query_Equals(tree, (Obj*)test_case->tree),
                   "tree() AND   %s", Str_Get_Ptr8(test_case->query_string));
@@ -951,7 +953,8 @@ TestQPLogic_Run_IMP(TestQueryParserLogic *self, TestBatchRunner *runner) {
         TEST_TRUE(runner, Query_Equals(pruned, (Obj*)wanted),
                   "prune()   %s", Str_Get_Ptr8(qstring));
         expanded = QParser_Expand(or_parser, pruned);
-        hits = IxSearcher_Hits(searcher, (Obj*)expanded, 0, 10, NULL);
+        hits = IxSearcher_Hits(searcher, (Obj*)expanded, 0, 10, NULL, NULL,
+                               NULL);
         TEST_INT_EQ(runner, Hits_Total_Hits(hits), test_case->num_hits,
                     "hits:    %s", Str_Get_Ptr8(qstring));
 
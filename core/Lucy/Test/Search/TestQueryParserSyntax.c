@@ -402,7 +402,8 @@ test_query_parser_syntax(TestBatchRunner *runner) {
         Query *tree     = QParser_Tree(qparser, ivars->query_string);
         Query *expanded = QParser_Expand_Leaf(qparser, ivars->tree);
         Query *parsed   = QParser_Parse(qparser, ivars->query_string);
-        Hits  *hits     = IxSearcher_Hits(searcher, (Obj*)parsed, 0, 10, NULL);
+        Hits  *hits     = IxSearcher_Hits(searcher, (Obj*)parsed, 0, 10, NULL,
+                                          NULL, NULL);
 
         TEST_TRUE(runner, Query_Equals(tree, (Obj*)ivars->tree),
                   "tree()    %s", Str_Get_Ptr8(ivars->query_string));
@@ -423,7 +424,8 @@ test_query_parser_syntax(TestBatchRunner *runner) {
         TestQueryParserIVARS *ivars = TestQP_IVARS(test_case);
         Query *tree   = QParser_Tree(qparser, ivars->query_string);
         Query *parsed = QParser_Parse(qparser, ivars->query_string);
-        Hits  *hits   = IxSearcher_Hits(searcher, (Obj*)parsed, 0, 10, NULL);
+        Hits  *hits   = IxSearcher_Hits(searcher, (Obj*)parsed, 0, 10, NULL,
+                                        NULL, NULL);
 
         TEST_TRUE(runner, Query_Equals(tree, (Obj*)ivars->tree),
                   "tree()    %s", Str_Get_Ptr8(ivars->query_string));
@@ -0,0 +1,295 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_TESTLUCY_TESTQUERYPLAN
+#define TESTLUCY_USE_SHORT_NAMES
+#include "Lucy/Util/ToolSet.h"
+
+#include "Clownfish/TestHarness/TestBatchRunner.h"
+#include "Lucy/Test.h"
+#include "Lucy/Test/Search/TestQueryPlan.h"
+#include "Lucy/Test/TestSchema.h"
+#include "Lucy/Test/TestUtils.h"
+#include "Lucy/Document/Doc.h"
+#include "Lucy/Index/Indexer.h"
+#include "Lucy/Index/SegReader.h"
+#include "Lucy/Search/Compiler.h"
+#include "Lucy/Search/Hits.h"
+#include "Lucy/Search/IndexSearcher.h"
+#include "Lucy/Search/MatchAllQuery.h"
+#include "Lucy/Search/Matcher.h"
+#include "Lucy/Search/NOTQuery.h"
+#include "Lucy/Search/PolyQuery.h"
+#include "Lucy/Search/RequiredOptionalQuery.h"
+#include "Lucy/Search/TermQuery.h"
+#include "Lucy/Store/RAMFolder.h"
+
+#define NUM_DOCS 100
+
+TestQueryPlan*
+TestQueryPlan_new() {
+    return (TestQueryPlan*)VTable_Make_Obj(TESTQUERYPLAN);
+}
+
+// Every doc contains "all", either "even" or "odd", and a digit term "dN";
+// every 25th doc also contains "rare", and the first 60 contain "sixty".
+static RAMFolder*
+S_create_index() {
+    Schema    *schema = (Schema*)TestSchema_new(false);
+    RAMFolder *folder = RAMFolder_new(NULL);
+    String    *field  = Str_newf("content");
+    Indexer   *indexer = Indexer_new(schema, (Obj*)folder, NULL, 0);
+
+    for (int32_t i = 0; i < NUM_DOCS; i++) {
+        Doc *doc = Doc_new(NULL, 0);
+        String *value = Str_newf("all %s d%i32%s%s", i % 2 ? "odd" : "even",
+                                 i % 10, i % 25 ? "" : " rare",
+                                 i < 60 ? " sixty" : "");
+        Doc_Store(doc, field, (Obj*)value);
+        Indexer_Add_Doc(indexer, doc, 1.0f);
+        DECREF(value);
+        DECREF(doc);
+    }
+    Indexer_Commit(indexer);
+
+    DECREF(indexer);
+    DECREF(field);
+    DECREF(schema);
+    return folder;
+}
+
+static Query*
+S_term(const char *term) {
+    return (Query*)TestUtils_make_term_query("content", term);
+}
+
+static Compiler*
+S_compile(IndexSearcher *searcher, Query *query) {
+    return Query_Make_Compiler(query, (Searcher*)searcher,
+                               Query_Get_Boost(query), false);
+}
+
+static SegReader*
+S_seg_reader(IndexSearcher *searcher) {
+    IndexReader *reader = IxSearcher_Get_Reader(searcher);
+    VArray *seg_readers = IxReader_Seg_Readers(reader);
+    SegReader *seg_reader = (SegReader*)INCREF(VA_Fetch(seg_readers, 0));
+    DECREF(seg_readers);
+    return seg_reader;
+}
+
+// Verify the plan, and that the match-only plan and the scoring plan match
+// the same number of documents.
+static void
+S_check_plan(TestBatchRunner *runner, IndexSearcher *searcher,
+             Query *query, bool need_score, const char *expected,
+             const char *message) {
+    Compiler  *compiler = S_compile(searcher, query);
+    SegReader *reader   = S_seg_reader(searcher);
+    String    *plan     = Compiler_Explain_Plan(compiler, reader, need_score);
+    char      *plan_str = Str_To_Utf8(plan);
+    TEST_STR_EQ(runner, plan_str, expected, "%s", message);
+
+    uint32_t num_matched = 0;
+    Matcher *matcher = Compiler_Make_Matcher(compiler, reader, false);
+    if (matcher) {
+        while (Matcher_Next(matcher)) { num_matched++; }
+        DECREF(matcher);
+    }
+    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 10, NULL, NULL,
+                                 NULL);
+    TEST_INT_EQ(runner, num_matched, Hits_Total_Hits(hits),
+                "%s: match-only plan agrees with scoring plan", message);
+
+    DECREF(hits);
+    FREEMEM(plan_str);
+    DECREF(plan);
+    DECREF(reader);
+    DECREF(compiler);
+}
+
+static void
+test_Cost(TestBatchRunner *runner, IndexSearcher *searcher) {
+    SegReader *reader = S_seg_reader(searcher);
+    Query *queries[] = {
+        S_term("rare"),
+        S_term("even"),
+        (Query*)TestUtils_make_not_query(S_term("rare")),
+        (Query*)MatchAllQuery_new(),
+        NULL
+    };
+    int32_t expected[] = { 4, 50, 96, 100 };
+    const char *descriptions[] = { "rare term", "common term", "NOT",
+                                   "match-all" };
+    for (int i = 0; queries[i] != NULL; i++) {
+        Compiler *compiler = S_compile(searcher, queries[i]);
+        Matcher  *matcher  = Compiler_Make_Matcher(compiler, reader, true);
+        TEST_INT_EQ(runner, Matcher_Cost(matcher), expected[i],
+                    "Cost() of %s", descriptions[i]);
+        DECREF(matcher);
+        DECREF(compiler);
+        DECREF(queries[i]);
+    }
+    DECREF(reader);
+}
+
+static void
+test_plans(TestBatchRunner *runner, IndexSearcher *searcher) {
+    Query *query;
+
+    query = (Query*)TestUtils_make_poly_query(
+                BOOLOP_AND, S_term("all"),
+                TestUtils_make_poly_query(BOOLOP_AND, S_term("even"),
+                                          S_term("rare"), NULL),
+                NULL);
+    S_check_plan(runner, searcher, query, true,
+                 "ANDMatcher cost=4\n"
+                 "  ScorePostingMatcher cost=4\n"
+                 "  ScorePostingMatcher cost=50\n"
+                 "  ScorePostingMatcher cost=100\n",
+                 "nested AND flattened, rarest clause first");
+    DECREF(query);
+
+    query = (Query*)TestUtils_make_poly_query(
+                BOOLOP_AND, S_term("even"), S_term("nope"), NULL);
+    S_check_plan(runner, searcher, query, true, "(no match)\n",
+                 "AND with a clause absent from the segment is pruned");
+    DECREF(query);
+
+    query = (Query*)TestUtils_make_poly_query(
+                BOOLOP_AND, S_term("odd"), (Query*)MatchAllQuery_new(), NULL);
+    S_check_plan(runner, searcher, query, false,
+                 "ScorePostingMatcher cost=50\n",
+                 "match-all clause dropped from match-only AND");
+    DECREF(query);
+
+    query = (Query*)TestUtils_make_poly_query(
+                BOOLOP_OR, S_term("d1"),
+                TestUtils_make_poly_query(BOOLOP_OR, S_term("d2"),
+                                          S_term("d3"), NULL),
+                NULL);
+    S_check_plan(runner, searcher, query, false,
+                 "BitVecMatcher cost=30\n",
+                 "dense match-only OR flattened into a bitset");
+    S_check_plan(runner, searcher, query, true,
+                 "ORScorer cost=30\n"
+                 "  ScorePostingMatcher cost=10\n"
+                 "  ORScorer cost=20\n"
+                 "    ScorePostingMatcher cost=10\n"
+                 "    ScorePostingMatcher cost=10\n",
+                 "scoring OR keeps its structure");
+    DECREF(query);
+
+    query = (Query*)TestUtils_make_poly_query(
+                BOOLOP_OR, S_term("rare"), S_term("nope"), NULL);
+    S_check_plan(runner, searcher, query, false,
+                 "ScorePostingMatcher cost=4\n",
+                 "match-only OR drops clauses absent from the segment");
+    DECREF(query);
+
+    Query *req = S_term("rare");
+    Query *opt = S_term("even");
+    query = (Query*)ReqOptQuery_new(req, opt);
+    S_check_plan(runner, searcher, query, false,
+                 "ScorePostingMatcher cost=4\n",
+                 "optional clause skipped when not scoring");
+    S_check_plan(runner, searcher, query, true,
+                 "RequiredOptionalMatcher cost=4\n"
+                 "  ScorePostingMatcher cost=4\n"
+                 "  ScorePostingMatcher cost=50\n",
+                 "optional clause kept when scoring");
+    DECREF(query);
+    DECREF(opt);
+    DECREF(req);
+}
+
+static uint32_t
+S_count_match_only(IndexSearcher *searcher, Query *query) {
+    Compiler  *compiler    = S_compile(searcher, query);
+    SegReader *reader      = S_seg_reader(searcher);
+    Matcher   *matcher     = Compiler_Make_Matcher(compiler, reader, false);
+    uint32_t   num_matched = 0;
+    if (matcher) {
+        while (Matcher_Next(matcher)) { num_matched++; }
+        DECREF(matcher);
+    }
+    DECREF(reader);
+    DECREF(compiler);
+    return num_matched;
+}
+
+static uint32_t
+S_count_hits(IndexSearcher *searcher, Query *query) {
+    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 10, NULL, NULL,
+                                 NULL);
+    uint32_t total_hits = Hits_Total_Hits(hits);
+    DECREF(hits);
+    return total_hits;
+}
+
+// The clauses of the negated OR overlap, so its estimated cost exceeds
+// doc_max even though the NOT still matches the odd docs past the first 60.
+// The estimate must not get the NOT pruned.
+static void
+test_overlapping_NOT(TestBatchRunner *runner, IndexSearcher *searcher) {
+    Query *negated = (Query*)TestUtils_make_poly_query(
+                         BOOLOP_OR, S_term("even"), S_term("sixty"), NULL);
+    Query *not_query = (Query*)TestUtils_make_not_query(negated);
+
+    Compiler  *compiler = S_compile(searcher, not_query);
+    SegReader *reader   = S_seg_reader(searcher);
+    Matcher   *matcher  = Compiler_Make_Matcher(compiler, reader, true);
+    TEST_TRUE(runner, Matcher_Cost(matcher) > 0,
+              "NOT over an overestimated OR has non-zero Cost()");
+    DECREF(matcher);
+    DECREF(reader);
+    DECREF(compiler);
+
+    TEST_INT_EQ(runner, S_count_hits(searcher, not_query), 20,
+                "NOT over overlapping OR");
+
+    Query *and_query = (Query*)TestUtils_make_poly_query(
+                           BOOLOP_AND, S_term("all"),
+                           (Query*)INCREF(not_query), NULL);
+    TEST_INT_EQ(runner, S_count_hits(searcher, and_query), 20,
+                "AND is not pruned by an estimated zero cost");
+    TEST_INT_EQ(runner, S_count_match_only(searcher, and_query), 20,
+                "match-only AND is not pruned by an estimated zero cost");
+    DECREF(and_query);
+
+    Query *or_query = (Query*)TestUtils_make_poly_query(
+                          BOOLOP_OR, S_term("rare"), S_term("d5"),
+                          (Query*)INCREF(not_query), NULL);
+    TEST_INT_EQ(runner, S_count_match_only(searcher, or_query), 28,
+                "match-only OR keeps a clause with estimated zero cost");
+    DECREF(or_query);
+
+    DECREF(not_query);
+}
+
+void
+TestQueryPlan_Run_IMP(TestQueryPlan *self, TestBatchRunner *runner) {
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 25);
+    RAMFolder     *folder   = S_create_index();
+    IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
+    test_Cost(runner, searcher);
+    test_plans(runner, searcher);
+    test_overlapping_NOT(runner, searcher);
+    DECREF(searcher);
+    DECREF(folder);
+}
+
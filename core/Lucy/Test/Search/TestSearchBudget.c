@@ -0,0 +1,325 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_TESTLUCY_TESTSEARCHBUDGET
+#define TESTLUCY_USE_SHORT_NAMES
+#include "Lucy/Util/ToolSet.h"
+
+#include "Clownfish/TestHarness/TestBatchRunner.h"
+#include "Lucy/Test.h"
+#include "Lucy/Test/Search/TestSearchBudget.h"
+#include "Lucy/Test/TestSchema.h"
+#include "Lucy/Test/TestUtils.h"
+#include "Lucy/Document/Doc.h"
+#include "Lucy/Index/IndexManager.h"
+#include "Lucy/Index/Indexer.h"
+#include "Lucy/Index/TieredMergePolicy.h"
+#include "Lucy/Object/BitVector.h"
+#include "Lucy/Search/Collector.h"
+#include "Lucy/Search/Hits.h"
+#include "Lucy/Search/IndexSearcher.h"
+#include "Lucy/Search/PolySearcher.h"
+#include "Lucy/Search/SearchBudget.h"
+#include "Lucy/Search/TermQuery.h"
+#include "Lucy/Search/TopDocs.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/OutStream.h"
+#include "Lucy/Store/RAMFile.h"
+#include "Lucy/Store/RAMFolder.h"
+#include "Lucy/Util/Freezer.h"
+#include "Lucy/Util/Sleep.h"
+#include "LucyX/Search/MockMatcher.h"
+
+#define NUM_SEGS     3
+#define DOCS_PER_SEG 2000
+#define NUM_DOCS     (NUM_SEGS * DOCS_PER_SEG)
+
+TestSearchBudget*
+TestSearchBudget_new() {
+    return (TestSearchBudget*)VTable_Make_Obj(TESTSEARCHBUDGET);
+}
+
+// Every doc contains "all"; each batch of docs gets its own segment.
+static RAMFolder*
+S_create_index() {
+    Schema            *schema = (Schema*)TestSchema_new(false);
+    RAMFolder         *folder = RAMFolder_new(NULL);
+    String            *field  = Str_newf("content");
+    String            *value  = Str_newf("all");
+    TieredMergePolicy *policy = TieredMergePol_new();
+    TieredMergePol_Set_Segs_Per_Tier(policy, 1000);
+
+    for (int32_t i = 0; i < NUM_SEGS; i++) {
+        IndexManager *manager = IxManager_new(NULL, NULL);
+        IxManager_Set_Merge_Policy(manager, (MergePolicy*)policy);
+        Indexer *indexer = Indexer_new(schema, (Obj*)folder, manager, 0);
+        for (int32_t j = 0; j < DOCS_PER_SEG; j++) {
+            Doc *doc = Doc_new(NULL, 0);
+            Doc_Store(doc, field, (Obj*)value);
+            Indexer_Add_Doc(indexer, doc, 1.0f);
+            DECREF(doc);
+        }
+        Indexer_Commit(indexer);
+        DECREF(indexer);
+        DECREF(manager);
+    }
+
+    DECREF(policy);
+    DECREF(value);
+    DECREF(field);
+    DECREF(schema);
+    return folder;
+}
+
+static TopDocs*
+S_top_docs(Searcher *searcher, Query *query, SearchBudget *budget) {
+    return Searcher_Top_Docs(searcher, query, 10, NULL, budget);
+}
+
+static void
+test_unlimited(TestBatchRunner *runner, Searcher *searcher, Query *query) {
+    Hits *hits = Searcher_Hits(searcher, (Obj*)query, 0, 10, NULL, NULL, NULL);
+    TEST_FALSE(runner, Hits_Partial(hits), "no budget: not partial");
+    TEST_INT_EQ(runner, Hits_Total_Hits(hits), NUM_DOCS,
+                "no budget: all hits");
+    DECREF(hits);
+
+    SearchBudget *budget = SearchBudget_new(0, 0);
+    TopDocs *top_docs = S_top_docs(searcher, query, budget);
+    TEST_FALSE(runner, TopDocs_Partial(top_docs),
+               "unlimited budget: not partial");
+    TEST_INT_EQ(runner, TopDocs_Get_Total_Hits(top_docs), NUM_DOCS,
+                "unlimited budget: all hits");
+    TEST_INT_EQ(runner, TopDocs_Get_Segments_Completed(top_docs), NUM_SEGS,
+                "unlimited budget: every segment completed");
+    TEST_TRUE(runner, SearchBudget_Get_Docs_Visited(budget) == NUM_DOCS,
+              "unlimited budget: every doc counted");
+    DECREF(top_docs);
+    DECREF(budget);
+}
+
+static void
+test_max_docs(TestBatchRunner *runner, Searcher *searcher, Query *query) {
+    // Runs out 1024 docs into the second segment.
+    SearchBudget *budget = SearchBudget_new(0, DOCS_PER_SEG + 500);
+    TopDocs *top_docs = S_top_docs(searcher, query, budget);
+    TEST_TRUE(runner, TopDocs_Partial(top_docs), "max_docs: partial");
+    TEST_TRUE(runner, SearchBudget_Expired(budget), "max_docs: expired");
+    TEST_INT_EQ(runner, TopDocs_Get_Segments_Completed(top_docs), 1,
+                "max_docs: stopped mid-segment");
+    TEST_INT_EQ(runner, TopDocs_Get_Total_Hits(top_docs), DOCS_PER_SEG + 1024,
+                "max_docs: checked every 1024 docs");
+    TEST_INT_EQ(runner, VA_Get_Size(TopDocs_Get_Match_Docs(top_docs)), 10,
+                "max_docs: hits gathered so far are returned");
+    DECREF(top_docs);
+    DECREF(budget);
+
+    // Runs out exactly at a segment boundary.
+    budget = SearchBudget_new(0, DOCS_PER_SEG);
+    top_docs = S_top_docs(searcher, query, budget);
+    TEST_TRUE(runner, TopDocs_Partial(top_docs), "segment boundary: partial");
+    TEST_INT_EQ(runner, TopDocs_Get_Segments_Completed(top_docs), 1,
+                "segment boundary: first segment completed");
+    TEST_INT_EQ(runner, TopDocs_Get_Total_Hits(top_docs), DOCS_PER_SEG,
+                "segment boundary: no docs from later segments");
+    DECREF(top_docs);
+    DECREF(budget);
+
+    budget = SearchBudget_new(0, 1024);
+    Hits *hits = Searcher_Hits(searcher, (Obj*)query, 0, 10, NULL, budget,
+                               NULL);
+    TEST_TRUE(runner, Hits_Partial(hits), "Hits_Partial");
+    DECREF(hits);
+    DECREF(budget);
+}
+
+static void
+test_deadline(TestBatchRunner *runner, Searcher *searcher, Query *query) {
+    SearchBudget *budget = SearchBudget_new(1, 0);
+    Sleep_millisleep(5);
+    TopDocs *top_docs = S_top_docs(searcher, query, budget);
+    TEST_TRUE(runner, TopDocs_Partial(top_docs), "deadline: partial");
+    TEST_INT_EQ(runner, TopDocs_Get_Segments_Completed(top_docs), 0,
+                "deadline: no segments searched after the deadline");
+    TEST_INT_EQ(runner, TopDocs_Get_Total_Hits(top_docs), 0,
+                "deadline: no hits");
+    DECREF(top_docs);
+    DECREF(budget);
+
+    budget = SearchBudget_new(60 * 1000, 0);
+    top_docs = S_top_docs(searcher, query, budget);
+    TEST_FALSE(runner, TopDocs_Partial(top_docs),
+               "distant deadline: not partial");
+    DECREF(top_docs);
+    DECREF(budget);
+}
+
+static void
+test_Collect(TestBatchRunner *runner, Searcher *searcher, Query *query) {
+    BitVector    *bit_vec   = BitVec_new(NUM_DOCS + 1);
+    BitCollector *collector = BitColl_new(bit_vec);
+    SearchBudget *budget    = SearchBudget_new(0, 1024);
+    BitColl_Set_Budget(collector, budget);
+    TEST_TRUE(runner, BitColl_Get_Budget(collector) == budget, "Get_Budget");
+    Searcher_Collect(searcher, query, (Collector*)collector);
+    TEST_INT_EQ(runner, BitVec_Count(bit_vec), 1024,
+                "Collect stops once the budget runs out");
+    DECREF(budget);
+    DECREF(collector);
+    DECREF(bit_vec);
+}
+
+static void
+test_sparse(TestBatchRunner *runner) {
+    // Far fewer than 1024 hits, spread across a wide range of doc ids.
+    int32_t num_ids = 10;
+    int32_t *ids = (int32_t*)MALLOCATE(num_ids * sizeof(int32_t));
+    for (int32_t i = 0; i < num_ids; i++) {
+        ids[i] = 1 + i * 100000;
+    }
+    I32Array *doc_ids = I32Arr_new_steal(ids, num_ids);
+    MockMatcher  *matcher   = MockMatcher_new(doc_ids, NULL);
+    BitVector    *bit_vec   = BitVec_new(num_ids * 100000);
+    BitCollector *collector = BitColl_new(bit_vec);
+    SearchBudget *budget    = SearchBudget_new(1, 0);
+    BitColl_Set_Budget(collector, budget);
+    Sleep_millisleep(5);
+    MockMatcher_Collect(matcher, (Collector*)collector, NULL);
+    TEST_TRUE(runner, SearchBudget_Expired(budget),
+              "sparse matches: budget consulted");
+    TEST_TRUE(runner, BitVec_Count(bit_vec) < (uint32_t)num_ids,
+              "sparse matches: collection stops early");
+    DECREF(budget);
+    DECREF(collector);
+    DECREF(bit_vec);
+    DECREF(matcher);
+    DECREF(doc_ids);
+}
+
+static void
+test_PolySearcher(TestBatchRunner *runner, Searcher *searcher,
+                  Query *query) {
+    Schema *schema = Searcher_Get_Schema(searcher);
+    VArray *searchers = VA_new(2);
+    VA_Push(searchers, INCREF(searcher));
+    VA_Push(searchers, INCREF(searcher));
+    PolySearcher *poly_searcher = PolySearcher_new(schema, searchers);
+
+    // The budget is shared by the sub-searchers.
+    SearchBudget *budget = SearchBudget_new(0, NUM_DOCS + 1000);
+    TopDocs *top_docs = S_top_docs((Searcher*)poly_searcher, query, budget);
+    TEST_TRUE(runner, TopDocs_Partial(top_docs), "PolySearcher: partial");
+    TEST_INT_EQ(runner, TopDocs_Get_Segments_Completed(top_docs), NUM_SEGS,
+                "PolySearcher: segments completed across sub-searchers");
+    TEST_INT_EQ(runner, TopDocs_Get_Total_Hits(top_docs), NUM_DOCS + 1024,
+                "PolySearcher: hits from the second sub-searcher");
+    DECREF(top_docs);
+    DECREF(budget);
+
+    BitVector    *bit_vec   = BitVec_new(2 * NUM_DOCS + 1);
+    BitCollector *collector = BitColl_new(bit_vec);
+    budget = SearchBudget_new(0, 1024);
+    BitColl_Set_Budget(collector, budget);
+    PolySearcher_Collect(poly_searcher, query, (Collector*)collector);
+    TEST_INT_EQ(runner, BitVec_Count(bit_vec), 1024,
+                "PolySearcher_Collect honors the budget");
+    DECREF(budget);
+    DECREF(collector);
+    DECREF(bit_vec);
+
+    DECREF(poly_searcher);
+    DECREF(searchers);
+}
+
+static void
+test_remote(TestBatchRunner *runner, Searcher *searcher, Query *query) {
+    SearchBudget *budget = SearchBudget_new(0, 0);
+    TEST_INT_EQ(runner, SearchBudget_Get_Time_Left(budget), 0,
+                "Get_Time_Left: unlimited");
+    TEST_INT_EQ(runner, SearchBudget_Get_Docs_Left(budget), 0,
+                "Get_Docs_Left: unlimited");
+    DECREF(budget);
+
+    budget = SearchBudget_new(1, DOCS_PER_SEG + 500);
+    Sleep_millisleep(5);
+    TEST_INT_EQ(runner, SearchBudget_Get_Time_Left(budget), 1,
+                "Get_Time_Left never reports unlimited once time runs out");
+    TEST_INT_EQ(runner, SearchBudget_Get_Docs_Left(budget),
+                DOCS_PER_SEG + 500, "Get_Docs_Left");
+
+    // Search on a budget seeded from what's left, as a remote shard would.
+    SearchBudget *remote
+        = SearchBudget_new(0, SearchBudget_Get_Docs_Left(budget));
+    TopDocs *top_docs = S_top_docs(searcher, query, remote);
+    SearchBudget_Absorb(budget, top_docs);
+    TEST_TRUE(runner, SearchBudget_Expired(budget),
+              "Absorb expires the budget when the remote search was partial");
+    TEST_INT_EQ(runner, SearchBudget_Get_Segments_Completed(budget), 1,
+                "Absorb counts remote segments completed");
+    DECREF(top_docs);
+    DECREF(remote);
+    DECREF(budget);
+}
+
+static void
+test_serialization(TestBatchRunner *runner, Searcher *searcher,
+                   Query *query) {
+    SearchBudget *budget = SearchBudget_new(0, DOCS_PER_SEG + 500);
+    TopDocs *top_docs = S_top_docs(searcher, query, budget);
+
+    RAMFile *ram_file = RAMFile_new(NULL, false);
+    OutStream *outstream = OutStream_open((Obj*)ram_file);
+    FREEZE(top_docs, outstream);
+    OutStream_Close(outstream);
+    InStream *instream = InStream_open((Obj*)ram_file);
+    TopDocs *thawed = (TopDocs*)THAW(instream);
+
+    TEST_TRUE(runner, TopDocs_Partial(thawed), "partial survives thaw");
+    TEST_INT_EQ(runner, TopDocs_Get_Segments_Completed(thawed), 1,
+                "segments completed survives thaw");
+    TEST_INT_EQ(runner, TopDocs_Get_Total_Hits(thawed),
+                TopDocs_Get_Total_Hits(top_docs),
+                "total hits survives thaw");
+
+    DECREF(thawed);
+    DECREF(instream);
+    DECREF(outstream);
+    DECREF(ram_file);
+    DECREF(top_docs);
+    DECREF(budget);
+}
+
+void
+TestSearchBudget_Run_IMP(TestSearchBudget *self, TestBatchRunner *runner) {
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 36);
+    RAMFolder     *folder   = S_create_index();
+    IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
+    Query *query = (Query*)TestUtils_make_term_query("content", "all");
+    test_unlimited(runner, (Searcher*)searcher, query);
+    test_max_docs(runner, (Searcher*)searcher, query);
+    test_deadline(runner, (Searcher*)searcher, query);
+    test_Collect(runner, (Searcher*)searcher, query);
+    test_sparse(runner);
+    test_PolySearcher(runner, (Searcher*)searcher, query);
+    test_remote(runner, (Searcher*)searcher, query);
+    test_serialization(runner, (Searcher*)searcher, query);
+    DECREF(query);
+    DECREF(searcher);
+    DECREF(folder);
+}
+
+
@@ -348,7 +348,8 @@ S_test_sorted_search(IndexSearcher *searcher, String *query,
     VA_Push(rules, (Obj*)rule);
     SortSpec *spec = SortSpec_new(rules);
 
-    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, num_wanted, spec);
+    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, num_wanted, spec,
+                                 NULL, NULL);
 
     VArray *results = VA_new(10);
     HitDoc *hit_doc;
@@ -22,8 +22,23 @@
 #include "Clownfish/TestHarness/TestBatchRunner.h"
 #include "Lucy/Test.h"
 #include "Lucy/Test/Search/TestTermQuery.h"
+#include "Lucy/Test/TestSchema.h"
 #include "Lucy/Test/TestUtils.h"
+#include "Lucy/Document/Doc.h"
+#include "Lucy/Index/IndexManager.h"
+#include "Lucy/Index/Indexer.h"
+#include "Lucy/Index/PolyReader.h"
+#include "Lucy/Index/SegReader.h"
+#include "Lucy/Index/TieredMergePolicy.h"
+#include "Lucy/Plan/FullTextType.h"
+#include "Lucy/Plan/Schema.h"
+#include "Lucy/Search/Compiler.h"
+#include "Lucy/Search/Hits.h"
+#include "Lucy/Search/IndexSearcher.h"
+#include "Lucy/Search/Matcher.h"
 #include "Lucy/Search/TermQuery.h"
+#include "Lucy/Search/TermStateCache.h"
+#include "Lucy/Store/RAMFolder.h"
 
 TestTermQuery*
 TestTermQuery_new() {
@@ -57,10 +72,108 @@ test_Dump_Load_and_Equals(TestBatchRunner *runner) {
     DECREF(clone);
 }
 
+static void
+S_add_doc(Indexer *indexer, String *field, int32_t num) {
+    Doc *doc = Doc_new(NULL, 0);
+    String *value = Str_newf("doc %i32", num);
+    Doc_Store(doc, field, (Obj*)value);
+    Indexer_Add_Doc(indexer, doc, 1.0f);
+    DECREF(value);
+    DECREF(doc);
+}
+
+// Count the segments in which the compiled query produces a Matcher.
+static uint32_t
+S_count_matchers(Compiler *compiler, IndexReader *reader) {
+    VArray   *seg_readers = IxReader_Seg_Readers(reader);
+    uint32_t  count       = 0;
+    for (uint32_t i = 0, max = VA_Get_Size(seg_readers); i < max; i++) {
+        SegReader *seg_reader = (SegReader*)VA_Fetch(seg_readers, i);
+        Matcher *matcher = Compiler_Make_Matcher(compiler, seg_reader, false);
+        if (matcher) { count++; }
+        DECREF(matcher);
+    }
+    DECREF(seg_readers);
+    return count;
+}
+
+static void
+test_term_states(TestBatchRunner *runner) {
+    Schema            *schema = (Schema*)TestSchema_new(false);
+    String            *field  = (String*)SSTR_WRAP_UTF8("content", 7);
+    RAMFolder         *folder = RAMFolder_new(NULL);
+    TieredMergePolicy *policy = TieredMergePol_new();
+
+    // Keep each batch in its own segment.
+    TieredMergePol_Set_Segs_Per_Tier(policy, 1000);
+    FullTextType_Set_Bloom_Bits((FullTextType*)Schema_Fetch_Type(schema, field),
+                                10);
+    for (int32_t i = 0; i < 6; i += 2) {
+        IndexManager *manager = IxManager_new(NULL, NULL);
+        IxManager_Set_Merge_Policy(manager, (MergePolicy*)policy);
+        Indexer *indexer = Indexer_new(schema, (Obj*)folder, manager, 0);
+        S_add_doc(indexer, field, i);
+        S_add_doc(indexer, field, i + 1);
+        Indexer_Commit(indexer);
+        DECREF(indexer);
+        DECREF(manager);
+    }
+    DECREF(policy);
+
+    IndexSearcher *searcher = IxSearcher_new((Obj*)folder);
+    IndexReader   *reader   = IxSearcher_Get_Reader(searcher);
+    Hash          *files    = IxReader_Residency(reader);
+    TEST_TRUE(runner, Hash_Fetch_Utf8(files, "seg_1/lexicon-1.bloom", 21)
+                      != NULL,
+              "bloom_bits enables a per-segment Bloom filter");
+    DECREF(files);
+    String        *common   = Str_newf("doc");
+    String        *rare     = Str_newf("2");
+
+    TermStateCache *states
+        = TermStateCache_gather((Searcher*)searcher, field, (Obj*)common);
+    TEST_INT_EQ(runner, TermStateCache_Get_Doc_Freq(states),
+                IxSearcher_Doc_Freq(searcher, field, (Obj*)common),
+                "gathered doc freq matches Searcher_Doc_Freq");
+    DECREF(states);
+
+    TermQuery *query    = TermQuery_new(field, (Obj*)rare);
+    Compiler  *compiler = TermQuery_Make_Compiler(query, (Searcher*)searcher,
+                                                  1.0f, false);
+    TEST_INT_EQ(runner, S_count_matchers(compiler, reader), 1,
+                "no Matcher for segments which lack the term");
+
+    // Readers from another snapshot fall back to a fresh lookup.
+    PolyReader *other = PolyReader_open((Obj*)folder, NULL, NULL);
+    TEST_INT_EQ(runner, S_count_matchers(compiler, (IndexReader*)other), 1,
+                "Make_Matcher with a reader the Compiler didn't see");
+    DECREF(other);
+    DECREF(compiler);
+
+    Hits *hits = IxSearcher_Hits(searcher, (Obj*)query, 0, 10, NULL, NULL,
+                                 NULL);
+    TEST_INT_EQ(runner, Hits_Total_Hits(hits), 1, "rare term");
+    DECREF(hits);
+    DECREF(query);
+
+    query = TermQuery_new(field, (Obj*)common);
+    hits  = IxSearcher_Hits(searcher, (Obj*)query, 0, 10, NULL, NULL, NULL);
+    TEST_INT_EQ(runner, Hits_Total_Hits(hits), 6, "common term");
+    DECREF(hits);
+    DECREF(query);
+
+    DECREF(rare);
+    DECREF(common);
+    DECREF(searcher);
+    DECREF(folder);
+    DECREF(schema);
+}
+
 void
 TestTermQuery_Run_IMP(TestTermQuery *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 4);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 10);
     test_Dump_Load_and_Equals(runner);
+    test_term_states(runner);
 }
 
 
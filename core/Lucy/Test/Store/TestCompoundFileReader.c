@@ -79,7 +79,8 @@ S_folder_with_contents() {
     DECREF(foo_out);
     DECREF(bar_out);
     StackString *empty = SSTR_BLANK();
-    RAMFolder_Consolidate(folder, (String*)empty);
+    RAMFolder_Consolidate(folder, (String*)empty,
+                          CFWriter_default_alignment);
     return (Folder*)folder;
 }
 
@@ -358,9 +359,88 @@ test_Close(TestBatchRunner *runner) {
     DECREF(real_folder);
 }
 
+static void
+test_Verify(TestBatchRunner *runner) {
+    Folder *real_folder = S_folder_with_contents();
+    CompoundFileReader *cf_reader = CFReader_open(real_folder);
+    Folder_Advise((Folder*)cf_reader, foo, FH_ADVICE_RANDOM);
+    TEST_INT_EQ(runner, CFReader_Get_Advice(cf_reader, foo), FH_ADVICE_RANDOM,
+                "Advise records access pattern hint for virtual file");
+    VArray *failed = CFReader_Verify(cf_reader);
+    TEST_INT_EQ(runner, VA_Get_Size(failed), 0, "Verify intact files");
+    DECREF(failed);
+    TEST_INT_EQ(runner, CFReader_Get_Advice(cf_reader, foo), FH_ADVICE_RANDOM,
+                "Standing advice survives Verify");
+    DECREF(cf_reader);
+
+    // Flip a bit in "bar", the first sub-file.
+    ByteBuf *contents = Folder_Slurp_File(real_folder, cf_file);
+    BB_Get_Buf(contents)[0] ^= 1;
+    Folder_Delete(real_folder, cf_file);
+    OutStream *outstream = Folder_Open_Out(real_folder, cf_file);
+    OutStream_Write_Bytes(outstream, BB_Get_Buf(contents),
+                          BB_Get_Size(contents));
+    OutStream_Close(outstream);
+    DECREF(outstream);
+    DECREF(contents);
+
+    cf_reader = CFReader_open(real_folder);
+    failed = CFReader_Verify(cf_reader);
+    TEST_TRUE(runner, VA_Get_Size(failed) == 1
+                      && Str_Equals(bar, VA_Fetch(failed, 0)),
+              "Verify reports the corrupt file");
+    DECREF(failed);
+    Err_set_error(NULL);
+    TEST_FALSE(runner, CFReader_Verify_File(cf_reader, bar),
+               "Verify_File fails for corrupt file");
+    TEST_TRUE(runner, Err_get_error() != NULL,
+              "Verify_File sets Err_error");
+    TEST_TRUE(runner, CFReader_Verify_File(cf_reader, foo),
+              "Verify_File passes intact file");
+
+    InStream *instream = CFReader_Local_Open_In(cf_reader, bar);
+    TEST_TRUE(runner, instream != NULL,
+              "Corrupt file opens when verification on open is off");
+    DECREF(instream);
+    CFReader_Set_Verify_Threshold(cf_reader, 1024);
+    instream = CFReader_Local_Open_In(cf_reader, bar);
+    TEST_TRUE(runner, instream == NULL,
+              "Corrupt file fails to open when verified on open");
+    instream = CFReader_Local_Open_In(cf_reader, foo);
+    TEST_TRUE(runner, instream != NULL, "Intact file verified on open");
+    DECREF(instream);
+    DECREF(cf_reader);
+
+    // Truncate cf.dat in the middle of "bar".
+    contents = Folder_Slurp_File(real_folder, cf_file);
+    Folder_Delete(real_folder, cf_file);
+    outstream = Folder_Open_Out(real_folder, cf_file);
+    OutStream_Write_Bytes(outstream, BB_Get_Buf(contents), 2);
+    OutStream_Close(outstream);
+    DECREF(outstream);
+    DECREF(contents);
+
+    cf_reader = CFReader_open(real_folder);
+    failed = CFReader_Verify(cf_reader);
+    TEST_INT_EQ(runner, VA_Get_Size(failed), 2,
+                "Verify reports files past the end of truncated cf.dat");
+    DECREF(failed);
+    Err_set_error(NULL);
+    TEST_FALSE(runner, CFReader_Verify_File(cf_reader, foo),
+               "Verify_File fails for file past the end of cf.dat");
+    TEST_TRUE(runner, Err_get_error() != NULL,
+              "Verify_File sets Err_error for truncated cf.dat");
+    instream = CFReader_Local_Open_In(cf_reader, foo);
+    TEST_TRUE(runner, instream == NULL,
+              "File past the end of cf.dat fails to open");
+
+    DECREF(cf_reader);
+    DECREF(real_folder);
+}
+
 void
 TestCFReader_Run_IMP(TestCompoundFileReader *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 48);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 62);
     S_init_strings();
     test_open(runner);
     test_Local_MkDir_and_Find_Folder(runner);
@@ -369,6 +449,7 @@ TestCFReader_Run_IMP(TestCompoundFileReader *self, TestBatchRunner *runner) {
     test_Local_Open_FileHandle(runner);
     test_Local_Open_In(runner);
     test_Close(runner);
+    test_Verify(runner);
     S_destroy_strings();
 }
 
@@ -20,10 +20,13 @@
 #include "Clownfish/TestHarness/TestBatchRunner.h"
 #include "Lucy/Test.h"
 #include "Lucy/Test/Store/TestCompoundFileWriter.h"
+#include "Lucy/Store/CompoundFileReader.h"
 #include "Lucy/Store/CompoundFileWriter.h"
 #include "Lucy/Store/FileHandle.h"
+#include "Lucy/Store/InStream.h"
 #include "Lucy/Store/OutStream.h"
 #include "Lucy/Store/RAMFolder.h"
+#include "Lucy/Util/Checksum.h"
 #include "Lucy/Util/Json.h"
 
 static String *cfmeta_file = NULL;
@@ -127,15 +130,15 @@ test_offsets(TestBatchRunner *runner) {
         Hash *stats = (Hash*)CERTIFY(filestats, HASH);
         Obj *offset = CERTIFY(Hash_Fetch_Utf8(stats, "offset", 6), OBJ);
         int64_t offs = Obj_To_I64(offset);
-        if (offs % 8 != 0) {
+        if (offs % CFWriter_default_alignment != 0) {
             offsets_ok = false;
-            FAIL(runner, "Offset %" PRId64 " for %s not a multiple of 8",
-                 offset, Str_Get_Ptr8(file));
+            FAIL(runner, "Offset %" PRId64 " for %s not aligned",
+                 offs, Str_Get_Ptr8(file));
             break;
         }
     }
     if (offsets_ok) {
-        PASS(runner, "All offsets are multiples of 8");
+        PASS(runner, "All offsets are multiples of the default alignment");
     }
 
     DECREF(cf_metadata);
@@ -143,12 +146,98 @@ test_offsets(TestBatchRunner *runner) {
     DECREF(folder);
 }
 
+static void
+S_set_bad_alignment(void *context) {
+    CFWriter_Set_Alignment((CompoundFileWriter*)context, 100);
+}
+
+static void
+test_alignment_and_hints(TestBatchRunner *runner) {
+    Folder *folder = S_folder_with_contents();
+    String *lex_ix = (String*)SSTR_WRAP_UTF8("lexicon-1.ix", 12);
+    String *post   = (String*)SSTR_WRAP_UTF8("postings-1.dat", 14);
+    OutStream *outstream = Folder_Open_Out(folder, lex_ix);
+    OutStream_Write_Bytes(outstream, "lex", 3);
+    OutStream_Close(outstream);
+    DECREF(outstream);
+    outstream = Folder_Open_Out(folder, post);
+    OutStream_Write_Bytes(outstream, "post", 4);
+    OutStream_Close(outstream);
+    DECREF(outstream);
+
+    CompoundFileWriter *cf_writer = CFWriter_new(folder);
+    Err *error = Err_trap(S_set_bad_alignment, cf_writer);
+    TEST_TRUE(runner, error != NULL,
+              "Set_Alignment rejects a non-power-of-two");
+    DECREF(error);
+    CFWriter_Set_Alignment(cf_writer, 4096);
+    CFWriter_Set_Hint(cf_writer, foo, FH_ADVICE_WILLNEED);
+    CFWriter_Set_Hint(cf_writer, bar, FH_ADVICE_RANDOM);
+    TEST_INT_EQ(runner, CFWriter_Get_Hint(cf_writer, lex_ix),
+                FH_ADVICE_WILLNEED, "Index files default to willneed");
+    TEST_INT_EQ(runner, CFWriter_Get_Hint(cf_writer, post),
+                FH_ADVICE_NORMAL, "Postings default to normal");
+    CFWriter_Consolidate(cf_writer);
+    DECREF(cf_writer);
+
+    Hash *cf_metadata = (Hash*)CERTIFY(
+                            Json_slurp_json(folder, cfmeta_file), HASH);
+    Hash *files = (Hash*)CERTIFY(
+                      Hash_Fetch_Utf8(cf_metadata, "files", 5), HASH);
+    TEST_INT_EQ(runner,
+                Obj_To_I64(Hash_Fetch_Utf8(cf_metadata, "alignment", 9)),
+                4096, "alignment recorded in cfmeta");
+    bool offsets_ok = true;
+    String *file;
+    Obj    *filestats;
+    Hash_Iterate(files);
+    while (Hash_Next(files, (Obj**)&file, &filestats)) {
+        Obj *offset = Hash_Fetch_Utf8((Hash*)filestats, "offset", 6);
+        if (Obj_To_I64(offset) % 4096 != 0) { offsets_ok = false; }
+    }
+    TEST_TRUE(runner, offsets_ok, "All offsets are page-aligned");
+    Hash *foo_stats = (Hash*)Hash_Fetch(files, (Obj*)foo);
+    Obj  *foo_hint  = Hash_Fetch_Utf8(foo_stats, "hint", 4);
+    TEST_TRUE(runner, foo_hint && Obj_Equals(foo_hint,
+                  (Obj*)SSTR_WRAP_UTF8("willneed", 8)),
+              "Explicit hint recorded in cfmeta");
+    Obj *checksum = Hash_Fetch_Utf8(foo_stats, "checksum", 8);
+    TEST_TRUE(runner, checksum
+                      && (uint32_t)Obj_To_I64(checksum)
+                         == Checksum_crc32c(0, "foo", 3),
+              "Checksum recorded in cfmeta");
+    DECREF(cf_metadata);
+
+    CompoundFileReader *cf_reader = CFReader_open(folder);
+    TEST_INT_EQ(runner, CFReader_Get_Alignment(cf_reader), 4096,
+                "CompoundFileReader reports alignment");
+    TEST_INT_EQ(runner, CFReader_Get_Hint(cf_reader, lex_ix),
+                FH_ADVICE_WILLNEED, "CompoundFileReader reports hint");
+    TEST_INT_EQ(runner, CFReader_Get_Hint(cf_reader, post),
+                FH_ADVICE_NORMAL, "Files without a hint are normal");
+    TEST_INT_EQ(runner, CFReader_Get_Advice(cf_reader, bar),
+                FH_ADVICE_RANDOM, "Access pattern hint applied on open");
+    TEST_INT_EQ(runner, CFReader_Get_Advice(cf_reader, lex_ix),
+                FH_ADVICE_NORMAL, "Page cache hint isn't standing advice");
+    InStream *instream = CFReader_Local_Open_In(cf_reader, post);
+    char buf[4];
+    InStream_Read_Bytes(instream, buf, 4);
+    TEST_TRUE(runner, InStream_Length(instream) == 4
+                      && memcmp(buf, "post", 4) == 0,
+              "Aligned sub-file reads back intact");
+    DECREF(instream);
+    DECREF(cf_reader);
+
+    DECREF(folder);
+}
+
 void
 TestCFWriter_Run_IMP(TestCompoundFileWriter *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 7);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 20);
     S_init_strings();
     test_Consolidate(runner);
     test_offsets(runner);
+    test_alignment_and_hints(runner);
     S_destroy_strings();
 }
 
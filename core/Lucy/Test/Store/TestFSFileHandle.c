@@ -32,6 +32,8 @@
 #include "Lucy/Test/Store/TestFSFileHandle.h"
 #include "Lucy/Store/FSFileHandle.h"
 #include "Lucy/Store/FileWindow.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/RateLimiter.h"
 
 TestFSFileHandle*
 TestFSFH_new() {
@@ -248,13 +250,137 @@ test_Window(TestBatchRunner *runner) {
     remove(Str_Get_Ptr8(test_filename));
 }
 
+static void
+test_Advise(TestBatchRunner *runner) {
+    String *test_filename = (String*)SSTR_WRAP_UTF8("_fstest", 7);
+    FSFileHandle *fh;
+    char buf[4];
+
+    remove(Str_Get_Ptr8(test_filename));
+    fh = FSFH_open(test_filename,
+                   FH_CREATE | FH_WRITE_ONLY | FH_EXCLUSIVE);
+    for (uint32_t i = 0; i < 4096; i++) {
+        FSFH_Write(fh, "foo ", 4);
+    }
+    if (!FSFH_Close(fh)) { RETHROW(INCREF(Err_get_error())); }
+    DECREF(fh);
+    fh = FSFH_open(test_filename, FH_READ_ONLY);
+    if (!fh) { RETHROW(INCREF(Err_get_error())); }
+
+    TEST_TRUE(runner, FSFH_Advise(fh, 0, FSFH_Length(fh), FH_ADVICE_RANDOM),
+              "Advise() whole file");
+    TEST_TRUE(runner, FSFH_Advise(fh, 5000, 100, FH_ADVICE_WILLNEED),
+              "Advise() unaligned range");
+    Err_set_error(NULL);
+    TEST_FALSE(runner, FSFH_Advise(fh, 16000, 1000, FH_ADVICE_SEQUENTIAL),
+               "Advise() past EOF returns false");
+    TEST_TRUE(runner, Err_get_error() != NULL,
+              "Advise() past EOF sets error");
+    TEST_TRUE(runner, FSFH_Advise(fh, 0, FSFH_Length(fh), FH_ADVICE_DONTNEED)
+                      && FSFH_Read(fh, buf, 4092, 4)
+                      && strncmp(buf, "foo ", 4) == 0,
+              "Data still readable after DONTNEED");
+
+    int64_t resident = FSFH_Resident_Bytes(fh, 0, FSFH_Length(fh));
+    TEST_TRUE(runner, resident <= FSFH_Length(fh),
+              "Resident_Bytes() doesn't exceed the range");
+    Err_set_error(NULL);
+    TEST_INT_EQ(runner, FSFH_Resident_Bytes(fh, 16000, 1000), -1,
+                "Resident_Bytes() past EOF returns -1");
+
+    int64_t offsets[] = { 12000, 100, 0, 8000 };
+    int64_t lengths[] = { 4000,  500, 200, 10 };
+    TEST_TRUE(runner, FSFH_Prefetch(fh, offsets, lengths, 4),
+              "Prefetch() unsorted, overlapping ranges");
+    TEST_TRUE(runner, FSFH_Prefetch(fh, offsets, lengths, 0),
+              "Prefetch() no ranges");
+    lengths[0] = 5000;
+    Err_set_error(NULL);
+    TEST_FALSE(runner, FSFH_Prefetch(fh, offsets, lengths, 4),
+               "Prefetch() past EOF returns false");
+
+    DECREF(fh);
+    remove(Str_Get_Ptr8(test_filename));
+}
+
+static void
+S_read_past_eof(void *context) {
+    InStream_Read_U8((InStream*)context);
+}
+
+static void
+test_direct_InStream(TestBatchRunner *runner) {
+    String *test_filename = (String*)SSTR_WRAP_UTF8("_fstest", 7);
+    FSFileHandle *fh;
+    char buf[4];
+
+    remove(Str_Get_Ptr8(test_filename));
+    fh = FSFH_open(test_filename,
+                   FH_CREATE | FH_WRITE_ONLY | FH_EXCLUSIVE);
+    for (uint32_t i = 0; i < 4096; i++) {
+        char word[4] = { 'a' + (char)(i % 26), 'b', 'c', ' ' };
+        FSFH_Write(fh, word, 4);
+    }
+    if (!FSFH_Close(fh)) { RETHROW(INCREF(Err_get_error())); }
+    DECREF(fh);
+    fh = FSFH_open(test_filename, FH_READ_ONLY);
+    if (!fh) { RETHROW(INCREF(Err_get_error())); }
+
+    bool      mapped   = FSFH_Fully_Mapped(fh);
+    InStream *instream = InStream_open((Obj*)fh);
+    TEST_TRUE(runner, InStream_Direct_Mapped(instream) == mapped,
+              "InStream maps the whole file when the handle allows");
+    InStream_Seek(instream, 4000 * 4);
+    InStream_Read_Bytes(instream, buf, 4);
+    TEST_TRUE(runner, buf[0] == 'a' + 4000 % 26
+                      && InStream_Tell(instream) == 4001 * 4,
+              "Seek and read far into the file");
+
+    InStream *reopened = InStream_Reopen(instream, NULL, 400, 800);
+    TEST_TRUE(runner, InStream_Direct_Mapped(reopened) == mapped
+                      && InStream_Read_U8(reopened) == 'a' + 100 % 26,
+              "Reopen() maps only its own range");
+    InStream_Seek(reopened, 800);
+    Err *error = Err_trap(S_read_past_eof, reopened);
+    TEST_TRUE(runner, error != NULL, "Read past end of reopened range");
+    DECREF(error);
+
+    RateLimiter *rate_limiter = RateLimiter_new(0);
+    InStream_Seek(instream, 8);
+    InStream_Set_Rate_Limiter(instream, rate_limiter);
+    TEST_TRUE(runner, InStream_Direct_Mapped(instream) == mapped
+                      && InStream_Read_U8(instream) == 'c',
+              "A RateLimiter without a budget keeps the direct mapping");
+    RateLimiter_Set_Bytes_Per_Sec(rate_limiter, 1024 * 1024 * 1024);
+    InStream_Fill(instream, 4);
+    TEST_FALSE(runner, InStream_Direct_Mapped(instream),
+               "Setting a budget drops the direct mapping");
+    TEST_TRUE(runner, InStream_Tell(instream) == 9
+                      && InStream_Read_U8(instream) == 'b',
+              "File position kept when mapping is dropped");
+    RateLimiter_Set_Bytes_Per_Sec(rate_limiter, 0);
+    InStream_Fill(instream, 4);
+    TEST_TRUE(runner, InStream_Direct_Mapped(instream) == mapped
+                      && InStream_Tell(instream) == 10,
+              "Lifting the budget restores the mapping");
+    InStream_Set_Rate_Limiter(instream, NULL);
+
+    DECREF(rate_limiter);
+    DECREF(reopened);
+    DECREF(instream);
+    DECREF(fh);
+    remove(Str_Get_Ptr8(test_filename));
+}
+
 void
 TestFSFH_Run_IMP(TestFSFileHandle *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 46);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 64);
     test_open(runner);
     test_Read_Write(runner);
     test_Close(runner);
     test_Window(runner);
+    test_Advise(runner);
+    test_direct_InStream(runner);
 }
 
 
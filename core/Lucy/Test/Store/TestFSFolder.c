@@ -32,11 +32,15 @@
   #include <sys/stat.h>
 #endif
 
+// remove
+#include <stdio.h>
+
 #include "Clownfish/TestHarness/TestBatchRunner.h"
 #include "Lucy/Test.h"
 #include "Lucy/Test/Store/TestFSFolder.h"
 #include "Lucy/Test/Store/TestFolderCommon.h"
 #include "Lucy/Store/FSFolder.h"
+#include "Lucy/Store/InStream.h"
 #include "Lucy/Store/OutStream.h"
 
 /* The tests involving symlinks have to be run with administrator privileges
@@ -170,14 +174,90 @@ test_disallow_updir(TestBatchRunner *runner) {
     S_tear_down();
 }
 
+static void
+S_write_file(Folder *folder, String *path) {
+    OutStream *outstream = Folder_Open_Out(folder, path);
+    if (!outstream) { RETHROW(INCREF(Err_get_error())); }
+    OutStream_Write_Bytes(outstream, "foo", 3);
+    OutStream_Close(outstream);
+    DECREF(outstream);
+}
+
+static void
+test_Sync(TestBatchRunner *runner) {
+    FSFolder *folder = (FSFolder*)S_set_up();
+    String *foo       = (String*)SSTR_WRAP_UTF8("foo", 3);
+    String *boffo     = (String*)SSTR_WRAP_UTF8("foo/boffo", 9);
+    String *temp      = (String*)SSTR_WRAP_UTF8("foo/boffo.temp", 14);
+    String *banana    = (String*)SSTR_WRAP_UTF8("banana", 6);
+    String *kiwi      = (String*)SSTR_WRAP_UTF8("foo/kiwi", 8);
+    String *test_dir  = (String*)SSTR_WRAP_UTF8("_fstest", 7);
+
+    TEST_TRUE(runner, FSFolder_Sync(folder), "Sync() with nothing to do");
+
+    FSFolder_MkDir(folder, foo);
+    S_write_file((Folder*)folder, temp);
+    FSFolder_Rename(folder, temp, boffo);
+    TEST_TRUE(runner, FSFolder_Sync(folder),
+              "Sync() new file renamed within a subfolder");
+
+    S_write_file((Folder*)folder, banana);
+    FSFolder_Delete(folder, banana);
+    TEST_TRUE(runner, FSFolder_Sync(folder),
+              "Sync() skips files deleted in the meantime");
+
+    FSFolder_Set_Coalesce_Syncs(folder, true);
+    TEST_TRUE(runner, FSFolder_Get_Coalesce_Syncs(folder),
+              "Set_Coalesce_Syncs");
+    S_write_file((Folder*)folder, banana);
+    TEST_TRUE(runner, FSFolder_Sync(folder), "Sync() coalesced");
+    FSFolder_Set_Coalesce_Syncs(folder, false);
+
+    FSFolder *fresh    = FSFolder_new(test_dir);
+    InStream *instream = FSFolder_Open_In(fresh, boffo);
+    char      buf[3]   = { 0, 0, 0 };
+    if (instream) { InStream_Read_Bytes(instream, buf, 3); }
+    TEST_TRUE(runner, instream && InStream_Length(instream) == 3
+                      && memcmp(buf, "foo", 3) == 0,
+              "synced file readable through a fresh FSFolder");
+    DECREF(instream);
+    DECREF(fresh);
+
+    // Replace the directory holding an unsynced file with a plain file, so
+    // that the pending path can't be opened.
+    S_write_file((Folder*)folder, kiwi);
+    remove("_fstest/foo/kiwi");
+    remove("_fstest/foo/boffo");
+    rmdir("_fstest/foo");
+    S_write_file((Folder*)folder, foo);
+    Err_set_error(NULL);
+    TEST_FALSE(runner, FSFolder_Sync(folder),
+               "Sync() fails on a path which can't be opened");
+    TEST_TRUE(runner, Err_get_error() != NULL, "... and sets Err_error");
+    FSFolder_Delete(folder, foo);
+    TEST_TRUE(runner, FSFolder_Sync(folder),
+              "Sync() succeeds once the path is gone");
+
+    FSFolder_Delete(folder, banana);
+    S_write_file((Folder*)folder, banana);
+    remove("_fstest/banana");
+    S_tear_down();
+    Err_set_error(NULL);
+    TEST_FALSE(runner, FSFolder_Sync(folder),
+               "Sync() fails once the folder's directory is missing");
+    TEST_TRUE(runner, Err_get_error() != NULL, "... and sets Err_error");
+    DECREF(folder);
+}
+
 void
 TestFSFolder_Run_IMP(TestFSFolder *self, TestBatchRunner *runner) {
     TestBatchRunner_Plan(runner, (TestBatch*)self,
-                          TestFolderCommon_num_tests() + 9);
+                          TestFolderCommon_num_tests() + 20);
     test_Initialize_and_Check(runner);
     TestFolderCommon_run_tests(runner, S_set_up, S_tear_down);
     test_protect_symlinks(runner);
     test_disallow_updir(runner);
+    test_Sync(runner);
 }
 
 #ifdef ENABLE_SYMLINK_TESTS
@@ -214,13 +214,35 @@ test_Seek_and_Tell(TestBatchRunner *runner) {
     DECREF(fh);
 }
 
+static void
+test_Prefetch(TestBatchRunner *runner) {
+    RAMFile   *file      = RAMFile_new(NULL, false);
+    OutStream *outstream = OutStream_open((Obj*)file);
+    for (int32_t i = 0; i < 1000; i++) {
+        OutStream_Write_I32(outstream, i);
+    }
+    OutStream_Close(outstream);
+    InStream *instream = InStream_open((Obj*)file);
+    InStream_Seek(instream, 400);
+    int64_t offsets[] = { 3000, -10, 2000 };
+    int64_t lengths[] = { 2000, 100, 8 };
+    InStream_Prefetch(instream, offsets, lengths, 3);
+    TEST_TRUE(runner, InStream_Tell(instream) == 400
+                      && InStream_Read_I32(instream) == 100,
+              "Prefetch clips ranges and leaves the file pointer alone");
+    DECREF(instream);
+    DECREF(outstream);
+    DECREF(file);
+}
+
 void
 TestInStream_Run_IMP(TestInStream *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 37);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 38);
     test_refill(runner);
     test_Clone_and_Reopen(runner);
     test_Close(runner);
     test_Seek_and_Tell(runner);
+    test_Prefetch(runner);
 }
 
 
@@ -0,0 +1,133 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define TESTLUCY_USE_SHORT_NAMES
+#include "Lucy/Util/ToolSet.h"
+
+#include "Clownfish/TestHarness/TestBatchRunner.h"
+#include "Lucy/Test.h"
+#include "Lucy/Test/Store/TestRateLimiter.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/OutStream.h"
+#include "Lucy/Store/RAMFolder.h"
+#include "Lucy/Store/RateLimiter.h"
+#include "Lucy/Util/Clock.h"
+
+TestRateLimiter*
+TestRateLimiter_new() {
+    return (TestRateLimiter*)VTable_Make_Obj(TESTRATELIMITER);
+}
+
+static void
+S_set_negative_budget(void *context) {
+    RateLimiter_Set_Bytes_Per_Sec((RateLimiter*)context, -1);
+}
+
+static void
+test_accounting(TestBatchRunner *runner) {
+    RateLimiter *limiter = RateLimiter_new(0);
+    uint32_t slept = 0;
+    for (int i = 0; i < 100; i++) {
+        slept += RateLimiter_Pause(limiter, 1024 * 1024);
+    }
+    TEST_INT_EQ(runner, slept, 0, "unlimited budget never sleeps");
+    TEST_TRUE(runner, RateLimiter_Get_Total_Bytes(limiter) == 100 * 1024 * 1024,
+              "Get_Total_Bytes");
+
+    Err *error = Err_trap(S_set_negative_budget, limiter);
+    TEST_TRUE(runner, error != NULL, "negative budget throws");
+    DECREF(error);
+    DECREF(limiter);
+}
+
+static void
+test_throttling(TestBatchRunner *runner) {
+    // 100 KB/s, so 20 KB ought to take around 200 milliseconds.
+    RateLimiter *limiter = RateLimiter_new(100 * 1024);
+    uint64_t start = Clock_microtime();
+    for (int i = 0; i < 20; i++) {
+        RateLimiter_Pause(limiter, 1024);
+    }
+    uint64_t elapsed_millis = (Clock_microtime() - start) / 1000;
+    TEST_TRUE(runner, elapsed_millis >= 150,
+              "Pause enforces budget (%u64 ms)", elapsed_millis);
+
+    // Lift the budget at runtime.  Rather than timing the loop, which is at
+    // the mercy of the scheduler, check that Pause() reports never sleeping.
+    RateLimiter_Set_Bytes_Per_Sec(limiter, 0);
+    uint64_t slept_millis = 0;
+    for (int i = 0; i < 20; i++) {
+        slept_millis += RateLimiter_Pause(limiter, 1024);
+    }
+    TEST_TRUE(runner, slept_millis == 0,
+              "budget may be changed at runtime");
+    DECREF(limiter);
+}
+
+static void
+test_streams(TestBatchRunner *runner) {
+    RAMFolder   *folder  = RAMFolder_new(NULL);
+    RateLimiter *limiter = RateLimiter_new(0);
+    String      *path    = Str_newf("foo");
+    char         buf[3000];
+
+    memset(buf, 'x', sizeof(buf));
+    RAMFolder_Set_Rate_Limiter(folder, limiter);
+
+    OutStream *outstream = RAMFolder_Open_Out(folder, path);
+    TEST_TRUE(runner, OutStream_Get_Rate_Limiter(outstream) == limiter,
+              "Open_Out assigns Folder's RateLimiter");
+    for (int i = 0; i < 3; i++) {
+        OutStream_Write_Bytes(outstream, buf, 1000);
+    }
+    OutStream_Write_Bytes(outstream, buf, sizeof(buf));
+    OutStream_Close(outstream);
+    TEST_TRUE(runner, RateLimiter_Get_Total_Bytes(limiter) == 6000,
+              "OutStream writes are charged to the RateLimiter");
+
+    InStream *instream = RAMFolder_Open_In(folder, path);
+    InStream *clone    = InStream_Clone(instream);
+    TEST_TRUE(runner, InStream_Get_Rate_Limiter(clone) == limiter,
+              "clones inherit RateLimiter");
+    InStream_Read_Bytes(instream, buf, sizeof(buf));
+    InStream_Read_Bytes(clone, buf, 10);
+    TEST_TRUE(runner, RateLimiter_Get_Total_Bytes(limiter) >= 9010,
+              "InStream reads are charged to the RateLimiter");
+
+    RAMFolder_Set_Rate_Limiter(folder, NULL);
+    DECREF(outstream);
+    outstream = RAMFolder_Open_Out(folder, (String*)SSTR_WRAP_UTF8("bar", 3));
+    TEST_TRUE(runner, OutStream_Get_Rate_Limiter(outstream) == NULL,
+              "Set_Rate_Limiter(NULL) stops throttling new streams");
+
+    DECREF(outstream);
+    DECREF(clone);
+    DECREF(instream);
+    DECREF(path);
+    DECREF(limiter);
+    DECREF(folder);
+}
+
+void
+TestRateLimiter_Run_IMP(TestRateLimiter *self, TestBatchRunner *runner) {
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 10);
+    test_accounting(runner);
+    test_throttling(runner);
+    test_streams(runner);
+}
+
+
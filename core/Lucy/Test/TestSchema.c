@@ -102,11 +102,44 @@ test_Dump_and_Load(TestBatchRunner *runner) {
     DECREF(loaded);
 }
 
+static void
+test_shingles(TestBatchRunner *runner) {
+    Schema            *schema    = Schema_new();
+    StandardTokenizer *tokenizer = StandardTokenizer_new();
+    FullTextType      *type      = FullTextType_new((Analyzer*)tokenizer);
+    String            *title     = (String*)SSTR_WRAP_UTF8("title", 5);
+    String            *hidden    = FullTextType_shingle_field(title);
+    FullTextType_Set_Shingles(type, true);
+    Schema_Spec_Field(schema, title, (FieldType*)type);
+
+    TEST_INT_EQ(runner, Schema_Num_Fields(schema), 2,
+                "Spec'ing a field with shingles adds a hidden field");
+    TEST_TRUE(runner, Schema_Hidden_Field(schema, hidden), "Hidden_Field");
+    TEST_FALSE(runner, Schema_Hidden_Field(schema, title),
+               "Hidden_Field false for the parent field");
+
+    Hash *dump = Schema_Dump(schema);
+    Hash *fields = (Hash*)Hash_Fetch_Utf8(dump, "fields", 6);
+    TEST_INT_EQ(runner, Hash_Get_Size(fields), 1,
+                "Hidden fields aren't dumped");
+    Schema *loaded = (Schema*)Freezer_load((Obj*)dump);
+    TEST_TRUE(runner, Schema_Fetch_Type(loaded, hidden) != NULL,
+              "Hidden field recreated by Load");
+
+    DECREF(loaded);
+    DECREF(dump);
+    DECREF(hidden);
+    DECREF(type);
+    DECREF(tokenizer);
+    DECREF(schema);
+}
+
 void
 TestBatchSchema_Run_IMP(TestBatchSchema *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 4);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 9);
     test_Equals(runner);
     test_Dump_and_Load(runner);
+    test_shingles(runner);
 }
 
 
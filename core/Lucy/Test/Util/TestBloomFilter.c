@@ -0,0 +1,146 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define TESTLUCY_USE_SHORT_NAMES
+#include "Lucy/Util/ToolSet.h"
+#include <stdio.h>
+
+#include "Clownfish/TestHarness/TestBatchRunner.h"
+#include "Lucy/Test.h"
+#include "Lucy/Test/Util/TestBloomFilter.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/OutStream.h"
+#include "Lucy/Store/RAMFile.h"
+#include "Lucy/Util/BloomFilter.h"
+
+TestBloomFilter*
+TestBloomFilter_new() {
+    return (TestBloomFilter*)VTable_Make_Obj(TESTBLOOMFILTER);
+}
+
+static BloomFilter*
+S_build(int32_t bits_per_key, int32_t num_keys, RAMFile *file) {
+    BloomFilterWriter *writer = BloomWriter_new(bits_per_key);
+    char key[32];
+    for (int32_t i = 0; i < num_keys; i++) {
+        int len = sprintf(key, "key-%d", (int)i);
+        BloomWriter_Add(writer, key, (size_t)len);
+    }
+    OutStream *outstream = OutStream_open((Obj*)file);
+    BloomWriter_Finish(writer, outstream);
+    OutStream_Close(outstream);
+    DECREF(outstream);
+    DECREF(writer);
+
+    InStream *instream = InStream_open((Obj*)file);
+    BloomFilter *filter = BloomFilter_open(instream);
+    DECREF(instream);
+    return filter;
+}
+
+static void
+test_membership(TestBatchRunner *runner) {
+    const int32_t num_keys = 10000;
+    RAMFile     *file   = RAMFile_new(NULL, false);
+    BloomFilter *filter = S_build(10, num_keys, file);
+    char key[32];
+
+    TEST_TRUE(runner, filter != NULL, "open");
+    TEST_INT_EQ(runner, BB_Get_Size(RAMFile_Get_Contents(file)),
+                8 + 64 * ((num_keys * 10 + 511) / 512),
+                "sized by bits per key");
+
+    bool all_found = true;
+    for (int32_t i = 0; i < num_keys; i++) {
+        int len = sprintf(key, "key-%d", (int)i);
+        if (!BloomFilter_Might_Contain(filter, key, (size_t)len)) {
+            all_found = false;
+        }
+    }
+    TEST_TRUE(runner, all_found, "no false negatives");
+
+    int32_t false_positives = 0;
+    for (int32_t i = 0; i < num_keys; i++) {
+        int len = sprintf(key, "absent-%d", (int)i);
+        if (BloomFilter_Might_Contain(filter, key, (size_t)len)) {
+            false_positives++;
+        }
+    }
+    TEST_TRUE(runner, false_positives < num_keys / 50,
+              "false positive rate under 2%% with 10 bits per key (%d)",
+              (int)false_positives);
+
+    DECREF(filter);
+    DECREF(file);
+
+    file   = RAMFile_new(NULL, false);
+    filter = S_build(10, 0, file);
+    TEST_FALSE(runner, BloomFilter_Might_Contain(filter, "", 0),
+               "empty filter contains nothing");
+    DECREF(filter);
+    DECREF(file);
+}
+
+static void
+test_hash(TestBatchRunner *runner) {
+    TEST_TRUE(runner,
+              BloomFilter_hash("abcdefghij", 10)
+              == BloomFilter_hash("abcdefghij", 10),
+              "hash is deterministic");
+    TEST_TRUE(runner,
+              BloomFilter_hash("abcdefghij", 10)
+              != BloomFilter_hash("abcdefghik", 10),
+              "hash depends on trailing bytes");
+    TEST_TRUE(runner, BloomFilter_hash("a", 1) != BloomFilter_hash("a\0", 2),
+              "hash depends on length");
+}
+
+static void
+S_bad_bits_per_key(void *context) {
+    UNUSED_VAR(context);
+    BloomFilterWriter *writer = BloomWriter_new(2);
+    DECREF(writer);
+}
+
+static void
+test_errors(TestBatchRunner *runner) {
+    Err *error = Err_trap(S_bad_bits_per_key, NULL);
+    TEST_TRUE(runner, error != NULL, "bits_per_key out of range");
+    DECREF(error);
+
+    RAMFile *file = RAMFile_new(NULL, false);
+    OutStream *outstream = OutStream_open((Obj*)file);
+    OutStream_Write_U32(outstream, 2);
+    OutStream_Write_U32(outstream, 7);
+    OutStream_Write_Bytes(outstream, "short", 5);
+    OutStream_Close(outstream);
+    DECREF(outstream);
+    InStream *instream = InStream_open((Obj*)file);
+    BloomFilter *filter = BloomFilter_open(instream);
+    TEST_TRUE(runner, filter == NULL, "open() rejects truncated data");
+    DECREF(instream);
+    DECREF(file);
+}
+
+void
+TestBloomFilter_Run_IMP(TestBloomFilter *self, TestBatchRunner *runner) {
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 10);
+    test_membership(runner);
+    test_hash(runner);
+    test_errors(runner);
+}
+
@@ -0,0 +1,79 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define TESTLUCY_USE_SHORT_NAMES
+#include "Lucy/Util/ToolSet.h"
+
+#include "Clownfish/TestHarness/TestBatchRunner.h"
+#include "Lucy/Test.h"
+#include "Lucy/Test/Util/TestChecksum.h"
+#include "Lucy/Util/Checksum.h"
+
+TestChecksum*
+TestChecksum_new() {
+    return (TestChecksum*)VTable_Make_Obj(TESTCHECKSUM);
+}
+
+static void
+test_known_values(TestBatchRunner *runner) {
+    char buf[32];
+
+    TEST_TRUE(runner, Checksum_crc32c(0, "", 0) == 0, "empty input");
+    TEST_TRUE(runner, Checksum_crc32c(0, "123456789", 9) == 0xE3069283U,
+              "standard check value");
+    memset(buf, 0, sizeof(buf));
+    TEST_TRUE(runner, Checksum_crc32c(0, buf, sizeof(buf)) == 0x8A9136AAU,
+              "32 zero bytes");
+    memset(buf, 0xFF, sizeof(buf));
+    TEST_TRUE(runner, Checksum_crc32c(0, buf, sizeof(buf)) == 0x62A8AB43U,
+              "32 0xFF bytes");
+}
+
+static void
+test_update(TestBatchRunner *runner) {
+    size_t   size   = 10007;
+    char    *source = (char*)MALLOCATE(size);
+    for (size_t i = 0; i < size; i++) {
+        source[i] = (char)((i * 7919) >> 3);
+    }
+    uint32_t whole = Checksum_crc32c(0, source, size);
+
+    uint32_t bytewise = 0;
+    for (size_t i = 0; i < size; i++) {
+        bytewise = Checksum_crc32c(bytewise, source + i, 1);
+    }
+    TEST_TRUE(runner, bytewise == whole, "update() one byte at a time");
+
+    bool splits_match = true;
+    for (size_t split = 1; split < 24; split++) {
+        uint32_t crc = Checksum_crc32c(0, source, split);
+        crc = Checksum_crc32c(crc, source + split, size - split);
+        if (crc != whole) { splits_match = false; }
+    }
+    TEST_TRUE(runner, splits_match, "update() across unaligned splits");
+
+    source[size / 2] ^= 1;
+    TEST_TRUE(runner, Checksum_crc32c(0, source, size) != whole,
+              "single bit flip changes checksum");
+    FREEMEM(source);
+}
+
+void
+TestChecksum_Run_IMP(TestChecksum *self, TestBatchRunner *runner) {
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 7);
+    test_known_values(runner);
+    test_update(runner);
+}
@@ -0,0 +1,110 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define TESTLUCY_USE_SHORT_NAMES
+#include "Lucy/Util/ToolSet.h"
+
+#include "Clownfish/TestHarness/TestBatchRunner.h"
+#include "Lucy/Test.h"
+#include "Lucy/Test/Util/TestLZBlock.h"
+#include "Lucy/Util/LZBlock.h"
+
+TestLZBlock*
+TestLZBlock_new() {
+    return (TestLZBlock*)VTable_Make_Obj(TESTLZBLOCK);
+}
+
+// Compress and decompress, returning the compressed size or 0 on failure.
+static size_t
+S_round_trip(const char *source, size_t size) {
+    size_t  bound      = LZBlock_compress_bound(size);
+    char   *compressed = (char*)MALLOCATE(bound);
+    char   *restored   = (char*)MALLOCATE(size + 1);
+    size_t  comp_len   = LZBlock_compress(source, size, compressed);
+    bool    success    = comp_len <= bound
+                         && LZBlock_decompress(compressed, comp_len,
+                                               restored, size)
+                         && memcmp(source, restored, size) == 0;
+    FREEMEM(compressed);
+    FREEMEM(restored);
+    return success ? comp_len : 0;
+}
+
+static void
+test_round_trip(TestBatchRunner *runner) {
+    TEST_TRUE(runner, S_round_trip("", 0) > 0, "empty block");
+    TEST_TRUE(runner, S_round_trip("abc", 3) > 0, "short block");
+
+    size_t  size   = 100000;
+    char   *source = (char*)MALLOCATE(size);
+    for (size_t i = 0; i < size; i++) {
+        source[i] = "the quick brown fox "[i % 20];
+    }
+    size_t comp_len = S_round_trip(source, size);
+    TEST_TRUE(runner, comp_len > 0 && comp_len < size / 50,
+              "repetitive block compresses well");
+
+    // Runs of a single byte exercise overlapping matches.
+    memset(source, 'z', size);
+    memcpy(source + 5000, "interruption", 12);
+    comp_len = S_round_trip(source, size);
+    TEST_TRUE(runner, comp_len > 0 && comp_len < size / 50,
+              "overlapping matches");
+
+    uint64_t state = 12345;
+    for (size_t i = 0; i < size; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        source[i] = (char)(state >> 56);
+    }
+    comp_len = S_round_trip(source, size);
+    TEST_TRUE(runner, comp_len > 0
+                      && comp_len <= LZBlock_compress_bound(size),
+              "random block stays within compress_bound");
+
+    FREEMEM(source);
+}
+
+static void
+test_malformed(TestBatchRunner *runner) {
+    const char *text = "abcdabcdabcdabcdabcdabcdabcdabcd";
+    size_t      size = strlen(text);
+    char        compressed[64];
+    char        restored[64];
+    size_t      comp_len = LZBlock_compress(text, size, compressed);
+
+    TEST_FALSE(runner, LZBlock_decompress(compressed, comp_len, restored,
+                                          size - 1),
+               "reject wrong decompressed size");
+    TEST_FALSE(runner, LZBlock_decompress(compressed, comp_len - 1,
+                                          restored, size),
+               "reject truncated block");
+
+    // Back-reference which points before the start of the output.
+    char bogus[] = { 0x10, 'a', 0x09, 0x00 };
+    TEST_FALSE(runner, LZBlock_decompress(bogus, sizeof(bogus), restored,
+                                          5),
+               "reject out-of-range offset");
+}
+
+void
+TestLZBlock_Run_IMP(TestLZBlock *self, TestBatchRunner *runner) {
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 8);
+    test_round_trip(runner);
+    test_malformed(runner);
+}
+
+
@@ -29,9 +29,93 @@ TestMemPool_new() {
     return (TestMemoryPool*)VTable_Make_Obj(TESTMEMORYPOOL);
 }
 
+static void
+test_growth(TestBatchRunner *runner) {
+    MemoryPool *mem_pool = MemPool_new(1024);
+    MemoryPoolIVARS *const ivars = MemPool_IVARS(mem_pool);
+
+    for (int i = 0; i < 1000; i++) {
+        MemPool_Grab(mem_pool, 1000);
+    }
+    TEST_TRUE(runner, ivars->num_arenas < 20,
+              "Arena size grows with demand");
+    TEST_TRUE(runner, MemPool_Get_Reserved(mem_pool)
+                      >= MemPool_Get_Consumed(mem_pool),
+              "Get_Reserved covers Get_Consumed");
+
+    size_t reserved = MemPool_Get_Reserved(mem_pool);
+    size_t consumed = MemPool_Get_Consumed(mem_pool);
+    MemPool_Release_All(mem_pool);
+    MemPool_Grab(mem_pool, 10);
+    TEST_TRUE(runner, MemPool_Get_Reserved(mem_pool) == reserved,
+              "Release_All keeps arenas");
+    TEST_TRUE(runner, MemPool_Get_Peak(mem_pool) == consumed
+                      && MemPool_Get_Consumed(mem_pool) < consumed,
+              "Get_Peak");
+
+    size_t big = 0x300000;
+    char *ptr = (char*)MemPool_Grab(mem_pool, big);
+    memset(ptr, 'x', big);
+    TEST_TRUE(runner, ptr[0] == 'x' && ptr[big - 1] == 'x'
+                      && MemPool_Get_Reserved(mem_pool) >= reserved + big,
+              "Grab large arena");
+    TEST_TRUE(runner, ((size_t)ptr & (sizeof(void*) - 1)) == 0,
+              "Large arena is aligned");
+
+    DECREF(mem_pool);
+}
+
+static void
+test_alignment(TestBatchRunner *runner) {
+    MemoryPool *mem_pool = MemPool_new(1024);
+    MemoryPoolIVARS *const ivars = MemPool_IVARS(mem_pool);
+    const size_t huge_page = 0x200000; // MemoryPool's HUGE_PAGE_SIZE.
+    const size_t sizes[] = {
+        1, 3, 8, 13, 100, 1021, 4096, 0x250000, 7, 0x400001, 5, 0x3FFFFF
+    };
+    const size_t num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    bool grabs_aligned   = true;
+    bool resizes_aligned = true;
+
+    for (size_t i = 0; i < num_sizes; i++) {
+        char *ptr = (char*)MemPool_Grab(mem_pool, sizes[i]);
+        if ((size_t)ptr & (sizeof(void*) - 1)) { grabs_aligned = false; }
+        memset(ptr, 'x', sizes[i]);
+
+        // Shrink the allocation to an odd size; the next Grab must still be
+        // aligned.
+        MemPool_Resize(mem_pool, ptr, sizes[i] / 2 + 1);
+        char *next = (char*)MemPool_Grab(mem_pool, 1);
+        if ((size_t)next & (sizeof(void*) - 1)) { resizes_aligned = false; }
+    }
+    TEST_TRUE(runner, grabs_aligned, "Grab aligns a mix of sizes");
+    TEST_TRUE(runner, resizes_aligned, "Grab stays aligned after Resize");
+
+#ifdef CHY_HAS_SYS_MMAN_H
+    uint32_t num_mapped   = 0;
+    bool     huge_aligned = true;
+    for (uint32_t i = 0; i < ivars->num_arenas; i++) {
+        MemoryPoolArena *arena = &ivars->arenas[i];
+        if (!arena->mapped) { continue; }
+        num_mapped++;
+        if ((size_t)arena->buf % huge_page || arena->size % huge_page) {
+            huge_aligned = false;
+        }
+    }
+    TEST_TRUE(runner, num_mapped > 0 && huge_aligned,
+              "Large arenas are mapped on huge page boundaries");
+#else
+    UNUSED_VAR(ivars);
+    UNUSED_VAR(huge_page);
+    SKIP(runner, "Large arenas are only mapped where mmap is available");
+#endif
+
+    DECREF(mem_pool);
+}
+
 void
 TestMemPool_Run_IMP(TestMemoryPool *self, TestBatchRunner *runner) {
-    TestBatchRunner_Plan(runner, (TestBatch*)self, 4);
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 13);
 
     MemoryPool *mem_pool = MemPool_new(0);
     MemoryPool *other    = MemPool_new(0);
@@ -58,6 +142,9 @@ TestMemPool_Run_IMP(TestMemoryPool *self, TestBatchRunner *runner) {
 
     DECREF(mem_pool);
     DECREF(other);
+
+    test_growth(runner);
+    test_alignment(runner);
 }
 
 
@@ -0,0 +1,203 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define TESTLUCY_USE_SHORT_NAMES
+#include "Lucy/Util/ToolSet.h"
+
+#include "Clownfish/TestHarness/TestBatchRunner.h"
+#include "Lucy/Test.h"
+#include "Lucy/Test/Util/TestTransducer.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/OutStream.h"
+#include "Lucy/Store/RAMFile.h"
+#include "Lucy/Util/Transducer.h"
+
+TestTransducer*
+TestTransducer_new() {
+    return (TestTransducer*)VTable_Make_Obj(TESTTRANSDUCER);
+}
+
+// Append every string over "abc" up to `depth` bytes long which begins with
+// `prefix`, in ascending order.
+static void
+S_gen_keys(VArray *keys, char *prefix, size_t size, size_t depth) {
+    VA_Push(keys, (Obj*)BB_new_bytes(prefix, size));
+    if (size == depth) { return; }
+    for (char c = 'a'; c <= 'c'; c++) {
+        prefix[size] = c;
+        S_gen_keys(keys, prefix, size + 1, depth);
+    }
+}
+
+static int
+S_compare_bytes(const char *a, size_t a_size, const char *b, size_t b_size) {
+    size_t min = a_size < b_size ? a_size : b_size;
+    int comparison = memcmp(a, b, min);
+    if (comparison) { return comparison; }
+    return a_size < b_size ? -1 : a_size > b_size ? 1 : 0;
+}
+
+static Transducer*
+S_build(VArray *keys, RAMFile *file) {
+    TransducerBuilder *builder = FSTBuilder_new();
+    for (uint32_t i = 0, max = VA_Get_Size(keys); i < max; i++) {
+        ByteBuf *key = (ByteBuf*)VA_Fetch(keys, i);
+        FSTBuilder_Add(builder, BB_Get_Buf(key), BB_Get_Size(key));
+    }
+    OutStream *outstream = OutStream_open((Obj*)file);
+    FSTBuilder_Finish(builder, outstream);
+    OutStream_Close(outstream);
+    DECREF(outstream);
+    DECREF(builder);
+
+    InStream *instream = InStream_open((Obj*)file);
+    Transducer *fst = FST_open(instream);
+    DECREF(instream);
+    return fst;
+}
+
+static void
+test_lookups(TestBatchRunner *runner) {
+    VArray  *keys = VA_new(0);
+    RAMFile *file = RAMFile_new(NULL, false);
+    char     prefix[8];
+    S_gen_keys(keys, prefix, 0, 4);
+    const uint32_t num_keys = VA_Get_Size(keys);
+
+    Transducer *fst = S_build(keys, file);
+    TEST_TRUE(runner, fst != NULL, "open");
+    TEST_INT_EQ(runner, FST_Get_Num_Keys(fst), num_keys, "Get_Num_Keys");
+    TEST_TRUE(runner, BB_Get_Size(RAMFile_Get_Contents(file)) < 200,
+              "shared prefixes and suffixes keep the transducer small");
+
+    // Probe with every string up to 5 bytes over an alphabet which includes
+    // bytes on either side of the keys' alphabet.
+    bool  rank_ok  = true;
+    bool  exact_ok = true;
+    bool  floor_ok = true;
+    char  probe[8];
+    const char *alphabet = "`abcd";
+    for (size_t len = 0; len <= 5; len++) {
+        size_t combos = 1;
+        for (size_t i = 0; i < len; i++) { combos *= 5; }
+        for (size_t n = 0; n < combos; n++) {
+            size_t rest = n;
+            for (size_t i = 0; i < len; i++) {
+                probe[len - 1 - i] = alphabet[rest % 5];
+                rest /= 5;
+            }
+            int32_t expected = 0;
+            bool    found    = false;
+            for (uint32_t i = 0; i < num_keys; i++) {
+                ByteBuf *key = (ByteBuf*)VA_Fetch(keys, i);
+                int comparison
+                    = S_compare_bytes(BB_Get_Buf(key), BB_Get_Size(key),
+                                      probe, len);
+                if (comparison < 0)  { expected++; }
+                if (comparison == 0) { found = true; }
+            }
+            bool exact;
+            if (FST_Rank(fst, probe, len, &exact) != expected) {
+                rank_ok = false;
+            }
+            if (exact != found) { exact_ok = false; }
+            int32_t floor = found ? expected : expected - 1;
+            if (FST_Floor(fst, probe, len) != floor) { floor_ok = false; }
+        }
+    }
+    TEST_TRUE(runner, rank_ok, "Rank");
+    TEST_TRUE(runner, exact_ok, "Rank sets exact");
+    TEST_TRUE(runner, floor_ok, "Floor");
+
+    bool     fetch_ok = true;
+    ByteBuf *buf      = BB_new(0);
+    for (uint32_t i = 0; i < num_keys; i++) {
+        if (!FST_Fetch_Key(fst, (int32_t)i, buf)
+            || !BB_Equals(buf, VA_Fetch(keys, i))
+           ) {
+            fetch_ok = false;
+        }
+    }
+    TEST_TRUE(runner, fetch_ok, "Fetch_Key");
+    TEST_FALSE(runner, FST_Fetch_Key(fst, (int32_t)num_keys, buf),
+               "Fetch_Key out of range");
+    DECREF(buf);
+
+    int32_t first;
+    int32_t count = FST_Prefix_Range(fst, "ab", 2, &first);
+    TEST_INT_EQ(runner, count, 13, "Prefix_Range count");
+    TEST_INT_EQ(runner, first, FST_Rank(fst, "ab", 2, NULL),
+                "Prefix_Range first");
+    count = FST_Prefix_Range(fst, "abd", 3, &first);
+    TEST_INT_EQ(runner, count, 0, "Prefix_Range with no matches");
+    count = FST_Prefix_Range(fst, "", 0, &first);
+    TEST_TRUE(runner, count == (int32_t)num_keys && first == 0,
+              "Prefix_Range with empty prefix covers all keys");
+
+    DECREF(fst);
+    DECREF(file);
+    DECREF(keys);
+}
+
+static void
+test_builder(TestBatchRunner *runner) {
+    TransducerBuilder *builder = FSTBuilder_new();
+    TEST_TRUE(runner, FSTBuilder_Add(builder, "b", 1), "Add");
+    TEST_FALSE(runner, FSTBuilder_Add(builder, "b", 1), "reject duplicate");
+    TEST_FALSE(runner, FSTBuilder_Add(builder, "a", 1),
+               "reject out of order key");
+    TEST_TRUE(runner, FSTBuilder_Add(builder, "\xFF", 1), "high byte");
+    TEST_INT_EQ(runner, FSTBuilder_Get_Num_Keys(builder), 2,
+                "rejected keys aren't counted");
+
+    RAMFile *file = RAMFile_new(NULL, false);
+    OutStream *outstream = OutStream_open((Obj*)file);
+    FSTBuilder_Finish(builder, outstream);
+    OutStream_Close(outstream);
+    DECREF(outstream);
+    InStream *instream = InStream_open((Obj*)file);
+    Transducer *fst = FST_open(instream);
+    TEST_INT_EQ(runner, FST_Floor(fst, "c", 1), 0, "Floor between keys");
+    TEST_INT_EQ(runner, FST_Floor(fst, "a", 1), -1, "Floor before keys");
+    TEST_INT_EQ(runner, FST_Rank(fst, "\xFF\xFF", 2, NULL), 2,
+                "Rank after keys");
+    DECREF(fst);
+    DECREF(instream);
+    DECREF(file);
+    DECREF(builder);
+
+    // Truncated data.
+    file = RAMFile_new(NULL, false);
+    outstream = OutStream_open((Obj*)file);
+    OutStream_Write_U32(outstream, 0);
+    OutStream_Close(outstream);
+    DECREF(outstream);
+    instream = InStream_open((Obj*)file);
+    Err_set_error(NULL);
+    fst = FST_open(instream);
+    TEST_TRUE(runner, fst == NULL && Err_get_error() != NULL,
+              "open() rejects malformed data");
+    DECREF(instream);
+    DECREF(file);
+}
+
+void
+TestTransducer_Run_IMP(TestTransducer *self, TestBatchRunner *runner) {
+    TestBatchRunner_Plan(runner, (TestBatch*)self, 21);
+    test_lookups(runner);
+    test_builder(runner);
+}
@@ -0,0 +1,216 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define C_LUCY_BLOOMFILTER
+#define C_LUCY_BLOOMFILTERWRITER
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Util/BloomFilter.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/OutStream.h"
+
+#define BLOCK_BITS   512
+#define BLOCK_BYTES  (BLOCK_BITS / 8)
+#define HEADER_SIZE  8
+#define MAX_PROBES   16
+
+static CFISH_INLINE uint64_t
+SI_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= UINT64_C(0xFF51AFD7ED558CCD);
+    h ^= h >> 33;
+    h *= UINT64_C(0xC4CEB9FE1A85EC53);
+    h ^= h >> 33;
+    return h;
+}
+
+// Select a block using the high half of the hash.
+static CFISH_INLINE uint32_t
+SI_block_tick(uint64_t hash, uint32_t num_blocks) {
+    return (uint32_t)(((hash >> 32) * (uint64_t)num_blocks) >> 32);
+}
+
+// Derive the next bit to probe within a block.
+static CFISH_INLINE uint32_t
+SI_next_bit(uint64_t *state) {
+    *state = *state * UINT64_C(6364136223846793005)
+             + UINT64_C(1442695040888963407);
+    return (uint32_t)(*state >> 55);
+}
+
+uint64_t
+BloomFilter_hash(const void *key, size_t size) {
+    const uint8_t *ptr = (const uint8_t*)key;
+    const uint8_t *const end = ptr + size;
+    uint64_t h = UINT64_C(0x9E3779B97F4A7C15) ^ (uint64_t)size;
+
+    while (end - ptr >= 8) {
+        h = (h ^ SI_mix(NumUtil_decode_bigend_u64((void*)ptr)))
+            * UINT64_C(0x87C37B91114253D5);
+        ptr += 8;
+    }
+    uint64_t tail = 0;
+    while (ptr < end) {
+        tail = (tail << 8) | *ptr++;
+    }
+    h = (h ^ SI_mix(tail)) * UINT64_C(0x87C37B91114253D5);
+
+    return SI_mix(h);
+}
+
+BloomFilter*
+BloomFilter_open(InStream *instream) {
+    BloomFilter *self = (BloomFilter*)VTable_Make_Obj(BLOOMFILTER);
+    return BloomFilter_do_open(self, instream);
+}
+
+BloomFilter*
+BloomFilter_do_open(BloomFilter *self, InStream *instream) {
+    BloomFilterIVARS *const ivars = BloomFilter_IVARS(self);
+    const int64_t len = InStream_Length(instream);
+
+    if (len >= HEADER_SIZE) {
+        InStream_Seek(instream, 0);
+        const char *buf = InStream_Buf(instream, (size_t)len);
+        ivars->num_blocks = NumUtil_decode_bigend_u32((void*)buf);
+        ivars->num_probes = NumUtil_decode_bigend_u32((void*)(buf + 4));
+        ivars->blocks     = buf + HEADER_SIZE;
+    }
+    if (len < HEADER_SIZE
+        || ivars->num_blocks == 0
+        || ivars->num_probes == 0
+        || ivars->num_probes > MAX_PROBES
+        || (uint64_t)ivars->num_blocks * BLOCK_BYTES
+           != (uint64_t)(len - HEADER_SIZE)
+       ) {
+        Err_set_error(Err_new(Str_newf("Invalid Bloom filter in '%o'",
+                                       InStream_Get_Filename(instream))));
+        DECREF(self);
+        return NULL;
+    }
+
+    // Keep the whole file in a single window.
+    ivars->instream = (InStream*)INCREF(instream);
+    return self;
+}
+
+void
+BloomFilter_Destroy_IMP(BloomFilter *self) {
+    BloomFilterIVARS *const ivars = BloomFilter_IVARS(self);
+    DECREF(ivars->instream);
+    SUPER_DESTROY(self, BLOOMFILTER);
+}
+
+bool
+BloomFilter_Might_Contain_IMP(BloomFilter *self, const void *key,
+                              size_t size) {
+    BloomFilterIVARS *const ivars = BloomFilter_IVARS(self);
+    uint64_t hash = BloomFilter_hash(key, size);
+    const uint8_t *block
+        = (const uint8_t*)ivars->blocks
+          + (size_t)SI_block_tick(hash, ivars->num_blocks) * BLOCK_BYTES;
+    for (uint32_t i = 0; i < ivars->num_probes; i++) {
+        uint32_t bit = SI_next_bit(&hash);
+        if (!(block[bit >> 3] & (1 << (bit & 7)))) { return false; }
+    }
+    return true;
+}
+
+/****************************************************************************/
+
+BloomFilterWriter*
+BloomWriter_new(int32_t bits_per_key) {
+    BloomFilterWriter *self
+        = (BloomFilterWriter*)VTable_Make_Obj(BLOOMFILTERWRITER);
+    return BloomWriter_init(self, bits_per_key);
+}
+
+BloomFilterWriter*
+BloomWriter_init(BloomFilterWriter *self, int32_t bits_per_key) {
+    BloomFilterWriterIVARS *const ivars = BloomWriter_IVARS(self);
+    if (bits_per_key < 4 || bits_per_key > 32) {
+        DECREF(self);
+        THROW(ERR, "bits_per_key out of range: %i32", bits_per_key);
+    }
+    ivars->bits_per_key = bits_per_key;
+    ivars->cap          = 0;
+    ivars->num_hashes   = 0;
+    ivars->hashes       = NULL;
+    return self;
+}
+
+void
+BloomWriter_Destroy_IMP(BloomFilterWriter *self) {
+    BloomFilterWriterIVARS *const ivars = BloomWriter_IVARS(self);
+    FREEMEM(ivars->hashes);
+    SUPER_DESTROY(self, BLOOMFILTERWRITER);
+}
+
+void
+BloomWriter_Add_IMP(BloomFilterWriter *self, const void *key, size_t size) {
+    BloomFilterWriterIVARS *const ivars = BloomWriter_IVARS(self);
+    if (ivars->num_hashes == ivars->cap) {
+        ivars->cap = ivars->cap ? ivars->cap * 2 : 1024;
+        ivars->hashes = (uint64_t*)REALLOCATE(ivars->hashes,
+                                              ivars->cap * sizeof(uint64_t));
+    }
+    ivars->hashes[ivars->num_hashes++] = BloomFilter_hash(key, size);
+}
+
+size_t
+BloomWriter_Get_Num_Keys_IMP(BloomFilterWriter *self) {
+    return BloomWriter_IVARS(self)->num_hashes;
+}
+
+void
+BloomWriter_Finish_IMP(BloomFilterWriter *self, OutStream *outstream) {
+    BloomFilterWriterIVARS *const ivars = BloomWriter_IVARS(self);
+    const uint64_t num_bits = (uint64_t)ivars->num_hashes
+                              * (uint64_t)ivars->bits_per_key;
+    uint64_t num_blocks = (num_bits + BLOCK_BITS - 1) / BLOCK_BITS;
+    if (num_blocks == 0)         { num_blocks = 1; }
+    if (num_blocks > INT32_MAX / BLOCK_BYTES) {
+        num_blocks = INT32_MAX / BLOCK_BYTES;
+    }
+
+    // The optimal number of probes is bits_per_key * ln(2).  Blocking raises
+    // the false positive rate a little, so err towards fewer probes.
+    uint32_t num_probes = (uint32_t)(ivars->bits_per_key * 0.69);
+    if (num_probes < 1)          { num_probes = 1; }
+    if (num_probes > MAX_PROBES) { num_probes = MAX_PROBES; }
+
+    const size_t size = (size_t)num_blocks * BLOCK_BYTES;
+    uint8_t *blocks = (uint8_t*)CALLOCATE(size, 1);
+    for (size_t i = 0; i < ivars->num_hashes; i++) {
+        uint64_t hash = ivars->hashes[i];
+        uint8_t *block
+            = blocks + (size_t)SI_block_tick(hash, (uint32_t)num_blocks)
+                       * BLOCK_BYTES;
+        for (uint32_t j = 0; j < num_probes; j++) {
+            uint32_t bit = SI_next_bit(&hash);
+            block[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+        }
+    }
+
+    OutStream_Write_U32(outstream, (uint32_t)num_blocks);
+    OutStream_Write_U32(outstream, num_probes);
+    OutStream_Write_Bytes(outstream, blocks, size);
+    FREEMEM(blocks);
+
+    ivars->num_hashes = 0;
+}
+
@@ -0,0 +1,186 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define C_LUCY_LZBLOCK
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Util/LZBlock.h"
+
+#define HASH_LOG        12
+#define MIN_MATCH       4
+#define LAST_LITERALS   5   // The block must end with this many literals.
+#define MF_LIMIT        12  // No match may start closer to the end.
+#define MAX_DISTANCE    65535
+
+static CFISH_INLINE uint32_t
+SI_read32(const uint8_t *ptr) {
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(uint32_t));
+    return value;
+}
+
+static CFISH_INLINE uint32_t
+SI_hash(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+// Write a length which didn't fit into its four bits of the token.
+static CFISH_INLINE uint8_t*
+SI_write_extra_len(uint8_t *out, size_t len) {
+    while (len >= 255) {
+        *out++ = 255;
+        len -= 255;
+    }
+    *out++ = (uint8_t)len;
+    return out;
+}
+
+// Write one sequence.  A match length of 0 marks the final, literal-only
+// sequence.
+static uint8_t*
+S_write_sequence(uint8_t *out, const uint8_t *literals, size_t num_literals,
+                 size_t offset, size_t match_len) {
+    uint8_t *token = out++;
+    *token = (uint8_t)((num_literals < 15 ? num_literals : 15) << 4);
+    if (num_literals >= 15) {
+        out = SI_write_extra_len(out, num_literals - 15);
+    }
+    memcpy(out, literals, num_literals);
+    out += num_literals;
+
+    if (match_len) {
+        size_t extra = match_len - MIN_MATCH;
+        *out++ = (uint8_t)(offset & 0xFF);
+        *out++ = (uint8_t)(offset >> 8);
+        *token |= (uint8_t)(extra < 15 ? extra : 15);
+        if (extra >= 15) {
+            out = SI_write_extra_len(out, extra - 15);
+        }
+    }
+    return out;
+}
+
+size_t
+LZBlock_compress_bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t
+LZBlock_compress(const char *source, size_t size, char *dest) {
+    const uint8_t *const start  = (const uint8_t*)source;
+    const uint8_t *const end    = start + size;
+    const uint8_t       *anchor = start;
+    uint8_t             *out    = (uint8_t*)dest;
+
+    if (size > MF_LIMIT) {
+        const uint8_t *const match_limit = end - MF_LIMIT;
+        const uint8_t *const extend_limit = end - LAST_LITERALS;
+        uint32_t table[1 << HASH_LOG];
+        memset(table, 0, sizeof(table));
+
+        const uint8_t *ptr = start;
+        while (ptr <= match_limit) {
+            uint32_t       sequence  = SI_read32(ptr);
+            uint32_t       hash      = SI_hash(sequence);
+            const uint8_t *candidate = start + table[hash];
+            table[hash] = (uint32_t)(ptr - start);
+
+            if (candidate < ptr
+                && ptr - candidate <= MAX_DISTANCE
+                && SI_read32(candidate) == sequence
+               ) {
+                const uint8_t *match_end = ptr + MIN_MATCH;
+                const uint8_t *ref       = candidate + MIN_MATCH;
+                while (match_end < extend_limit && *match_end == *ref) {
+                    match_end++;
+                    ref++;
+                }
+                out = S_write_sequence(out, anchor, (size_t)(ptr - anchor),
+                                       (size_t)(ptr - candidate),
+                                       (size_t)(match_end - ptr));
+                ptr    = match_end;
+                anchor = ptr;
+            }
+            else {
+                ptr++;
+            }
+        }
+    }
+
+    out = S_write_sequence(out, anchor, (size_t)(end - anchor), 0, 0);
+    return (size_t)(out - (uint8_t*)dest);
+}
+
+// Read a length continued past its four bits of the token.  Return false if
+// the input runs out first.
+static CFISH_INLINE bool
+SI_read_extra_len(const uint8_t **ptr, const uint8_t *end, size_t *len) {
+    uint8_t byte;
+    do {
+        if (*ptr >= end) { return false; }
+        byte = *(*ptr)++;
+        *len += byte;
+    } while (byte == 255);
+    return true;
+}
+
+bool
+LZBlock_decompress(const char *source, size_t size, char *dest,
+                   size_t dest_size) {
+    const uint8_t       *ptr      = (const uint8_t*)source;
+    const uint8_t *const end      = ptr + size;
+    uint8_t             *out      = (uint8_t*)dest;
+    uint8_t *const       out_end  = out + dest_size;
+
+    while (ptr < end) {
+        uint8_t token = *ptr++;
+
+        // Copy literals.
+        size_t num_literals = token >> 4;
+        if (num_literals == 15
+            && !SI_read_extra_len(&ptr, end, &num_literals)
+           ) {
+            return false;
+        }
+        if (num_literals > (size_t)(end - ptr)
+            || num_literals > (size_t)(out_end - out)
+           ) {
+            return false;
+        }
+        memcpy(out, ptr, num_literals);
+        out += num_literals;
+        ptr += num_literals;
+        if (ptr == end) { break; } // Final sequence.
+
+        // Copy match, which may overlap the bytes it produces.
+        if (end - ptr < 2) { return false; }
+        size_t offset = (size_t)ptr[0] | ((size_t)ptr[1] << 8);
+        ptr += 2;
+        if (offset == 0 || offset > (size_t)(out - (uint8_t*)dest)) {
+            return false;
+        }
+        size_t match_len = token & 0x0F;
+        if (match_len == 15 && !SI_read_extra_len(&ptr, end, &match_len)) {
+            return false;
+        }
+        match_len += MIN_MATCH;
+        if (match_len > (size_t)(out_end - out)) { return false; }
+        const uint8_t *ref = out - offset;
+        while (match_len--) { *out++ = *ref++; }
+    }
+
+    return out == out_end;
+}
@@ -17,12 +17,28 @@
 #define C_LUCY_MEMORYPOOL
 #include "Lucy/Util/ToolSet.h"
 
+#ifdef CHY_HAS_SYS_MMAN_H
+  #include <sys/mman.h>
+  #if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+    #define MAP_ANONYMOUS MAP_ANON
+  #endif
+#endif
+
 #include "Lucy/Util/MemoryPool.h"
 
 static void
 S_init_arena(MemoryPool *self, MemoryPoolIVARS *ivars, size_t amount);
 
-#define DEFAULT_BUF_SIZE 0x100000 // 1 MiB
+// Obtain an arena of at least `size` bytes from the system.
+static void
+S_alloc_arena(MemoryPoolArena *arena, size_t size);
+
+static void
+S_free_arena(MemoryPoolArena *arena);
+
+#define DEFAULT_BUF_SIZE 0x100000   // 1 MiB
+#define MAX_BUF_SIZE     0x4000000  // 64 MiB
+#define HUGE_PAGE_SIZE   0x200000   // 2 MiB
 
 // Enlarge amount so pointers will always be aligned.
 #define INCREASE_TO_WORD_MULTIPLE(_amount) \
@@ -44,11 +60,17 @@ MemoryPool*
 MemPool_init(MemoryPool *self, uint32_t arena_size) {
     MemoryPoolIVARS *const ivars = MemPool_IVARS(self);
     ivars->arena_size = arena_size == 0 ? DEFAULT_BUF_SIZE : arena_size;
-    ivars->arenas     = VA_new(16);
+    ivars->arena_cap  = 16;
+    ivars->arenas     = (MemoryPoolArena*)CALLOCATE(ivars->arena_cap,
+                                                    sizeof(MemoryPoolArena));
+    ivars->num_arenas = 0;
     ivars->tick       = -1;
     ivars->buf        = NULL;
+    ivars->last_buf   = NULL;
     ivars->limit      = NULL;
     ivars->consumed   = 0;
+    ivars->peak       = 0;
+    ivars->reserved   = 0;
 
     return self;
 }
@@ -56,45 +78,111 @@ MemPool_init(MemoryPool *self, uint32_t arena_size) {
 void
 MemPool_Destroy_IMP(MemoryPool *self) {
     MemoryPoolIVARS *const ivars = MemPool_IVARS(self);
-    DECREF(ivars->arenas);
+    for (uint32_t i = 0; i < ivars->num_arenas; i++) {
+        S_free_arena(&ivars->arenas[i]);
+    }
+    FREEMEM(ivars->arenas);
     SUPER_DESTROY(self, MEMORYPOOL);
 }
 
+static void
+S_alloc_arena(MemoryPoolArena *arena, size_t size) {
+    arena->buf    = NULL;
+    arena->mapped = false;
+
+#if defined(CHY_HAS_SYS_MMAN_H) && defined(MAP_ANONYMOUS)
+    if (size >= HUGE_PAGE_SIZE) {
+        // Round up to a whole number of huge pages, then over-map by one so
+        // that the arena can be trimmed to a huge page boundary.
+        const size_t mask = HUGE_PAGE_SIZE - 1;
+        size_t  map_size = (size + mask) & ~mask;
+        size_t  span     = map_size + HUGE_PAGE_SIZE;
+        void   *region   = mmap(NULL, span, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region != MAP_FAILED) {
+            char   *start = (char*)region;
+            size_t  lead  = (HUGE_PAGE_SIZE - ((size_t)start & mask)) & mask;
+            if (lead) { munmap(start, lead); }
+            if (span - lead > map_size) {
+                munmap(start + lead + map_size, span - lead - map_size);
+            }
+            arena->buf    = start + lead;
+            arena->size   = map_size;
+            arena->mapped = true;
+  #ifdef MADV_HUGEPAGE
+            madvise(arena->buf, map_size, MADV_HUGEPAGE);
+  #endif
+            return;
+        }
+        // Fall back to the heap if the mapping failed.
+    }
+#endif
+
+    arena->buf  = (char*)MALLOCATE(size);
+    arena->size = size;
+}
+
+static void
+S_free_arena(MemoryPoolArena *arena) {
+#ifdef CHY_HAS_SYS_MMAN_H
+    if (arena->mapped) {
+        munmap(arena->buf, arena->size);
+        arena->buf = NULL;
+        return;
+    }
+#endif
+    FREEMEM(arena->buf);
+    arena->buf = NULL;
+}
+
 static void
 S_init_arena(MemoryPool *self, MemoryPoolIVARS *ivars, size_t amount) {
     UNUSED_VAR(self);
-    ByteBuf *bb;
+    MemoryPoolArena *arena;
 
     // Indicate which arena we're using at present.
     ivars->tick++;
 
-    if (ivars->tick < (int32_t)VA_Get_Size(ivars->arenas)) {
+    if (ivars->tick < (int32_t)ivars->num_arenas) {
         // In recycle mode, use previously acquired memory.
-        bb = (ByteBuf*)VA_Fetch(ivars->arenas, ivars->tick);
-        if (amount >= BB_Get_Size(bb)) {
-            BB_Grow(bb, amount);
-            BB_Set_Size(bb, amount);
+        arena = &ivars->arenas[ivars->tick];
+        if (amount >= arena->size) {
+            ivars->reserved -= arena->size;
+            S_free_arena(arena);
+            S_alloc_arena(arena, amount + 1);
+            ivars->reserved += arena->size;
         }
     }
     else {
-        // In add mode, get more mem from system.
-        size_t buf_size = (amount + 1) > ivars->arena_size
-                          ? (amount + 1)
-                          : ivars->arena_size;
-        char *ptr = (char*)MALLOCATE(buf_size);
-        bb = BB_new_steal_bytes(ptr, buf_size - 1, buf_size);
-        VA_Push(ivars->arenas, (Obj*)bb);
+        // In add mode, get more mem from system.  Grow arenas in proportion
+        // to what we already hold, so that the number of arenas stays
+        // logarithmic in the size of the pool.
+        size_t buf_size = ivars->arena_size;
+        if (ivars->reserved > buf_size) {
+            buf_size = ivars->reserved < MAX_BUF_SIZE
+                       ? ivars->reserved
+                       : MAX_BUF_SIZE;
+        }
+        if (amount + 1 > buf_size) { buf_size = amount + 1; }
+        if (ivars->num_arenas == ivars->arena_cap) {
+            ivars->arena_cap *= 2;
+            ivars->arenas = (MemoryPoolArena*)REALLOCATE(
+                                ivars->arenas,
+                                ivars->arena_cap * sizeof(MemoryPoolArena));
+        }
+        arena = &ivars->arenas[ivars->num_arenas++];
+        S_alloc_arena(arena, buf_size);
+        ivars->reserved += arena->size;
     }
 
     // Recalculate consumption to take into account blocked off space.
     ivars->consumed = 0;
     for (int32_t i = 0; i < ivars->tick; i++) {
-        ByteBuf *bb = (ByteBuf*)VA_Fetch(ivars->arenas, i);
-        ivars->consumed += BB_Get_Size(bb);
+        ivars->consumed += ivars->arenas[i].size;
     }
 
-    ivars->buf   = BB_Get_Buf(bb);
-    ivars->limit = ivars->buf + BB_Get_Size(bb);
+    ivars->buf   = arena->buf;
+    ivars->limit = ivars->buf + arena->size;
 }
 
 size_t
@@ -102,6 +190,16 @@ MemPool_Get_Consumed_IMP(MemoryPool *self) {
     return MemPool_IVARS(self)->consumed;
 }
 
+size_t
+MemPool_Get_Peak_IMP(MemoryPool *self) {
+    return MemPool_IVARS(self)->peak;
+}
+
+size_t
+MemPool_Get_Reserved_IMP(MemoryPool *self) {
+    return MemPool_IVARS(self)->reserved;
+}
+
 void*
 MemPool_Grab_IMP(MemoryPool *self, size_t amount) {
     MemoryPoolIVARS *const ivars = MemPool_IVARS(self);
@@ -119,6 +217,7 @@ MemPool_Grab_IMP(MemoryPool *self, size_t amount) {
 
     // Track bytes we've allocated from this pool.
     ivars->consumed += amount;
+    if (ivars->consumed > ivars->peak) { ivars->peak = ivars->consumed; }
 
     return ivars->last_buf;
 }
@@ -162,16 +261,35 @@ MemPool_Eat_IMP(MemoryPool *self, MemoryPool *other) {
         THROW(ERR, "Memory pool is not empty");
     }
 
-    // Move active arenas from other to self.
-    for (int32_t i = 0; i <= ovars->tick; i++) {
-        ByteBuf *arena = (ByteBuf*)VA_Shift(ovars->arenas);
-        // Maybe displace existing arena.
-        VA_Store(ivars->arenas, i, (Obj*)arena);
+    // Move active arenas from other to self, displacing any existing arenas
+    // in the same slots.
+    uint32_t num_moved = (uint32_t)(ovars->tick + 1);
+    if (num_moved > ivars->arena_cap) {
+        ivars->arena_cap = num_moved;
+        ivars->arenas = (MemoryPoolArena*)REALLOCATE(
+                            ivars->arenas,
+                            ivars->arena_cap * sizeof(MemoryPoolArena));
     }
+    for (uint32_t i = 0; i < num_moved; i++) {
+        if (i < ivars->num_arenas) {
+            ivars->reserved -= ivars->arenas[i].size;
+            S_free_arena(&ivars->arenas[i]);
+        }
+        ivars->arenas[i] = ovars->arenas[i];
+        ivars->reserved += ovars->arenas[i].size;
+        ovars->reserved -= ovars->arenas[i].size;
+    }
+    if (num_moved > ivars->num_arenas) { ivars->num_arenas = num_moved; }
+    ovars->num_arenas -= num_moved;
+    memmove(ovars->arenas, ovars->arenas + num_moved,
+            ovars->num_arenas * sizeof(MemoryPoolArena));
+
     ivars->tick     = ovars->tick;
     ivars->last_buf = ovars->last_buf;
     ivars->buf      = ovars->buf;
     ivars->limit    = ovars->limit;
+    ivars->consumed = ovars->consumed;
+    if (ivars->consumed > ivars->peak) { ivars->peak = ivars->consumed; }
 }
 
 
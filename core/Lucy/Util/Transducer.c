@@ -0,0 +1,410 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define C_LUCY_TRANSDUCER
+#define C_LUCY_TRANSDUCERBUILDER
+#include "Lucy/Util/ToolSet.h"
+
+#include "Lucy/Util/Transducer.h"
+#include "Lucy/Store/InStream.h"
+#include "Lucy/Store/OutStream.h"
+
+#define STATE_HEADER_SIZE 7  // U8 final, U16 num_arcs, U32 count
+#define ARC_SIZE          8  // U32 target, U32 preceding keys
+#define TRAILER_SIZE      8  // U32 root, U32 num_keys
+
+// A decoded view of a serialized state.
+typedef struct {
+    bool            final;
+    uint32_t        num_arcs;
+    uint32_t        count;
+    const uint8_t  *labels;
+    const char     *arcs;
+} FSTState;
+
+static CFISH_INLINE uint32_t
+SI_arc_target(const FSTState *state, uint32_t tick) {
+    return NumUtil_decode_bigend_u32((void*)(state->arcs + tick * ARC_SIZE));
+}
+
+static CFISH_INLINE uint32_t
+SI_arc_before(const FSTState *state, uint32_t tick) {
+    return NumUtil_decode_bigend_u32((void*)(state->arcs + tick * ARC_SIZE
+                                             + 4));
+}
+
+static void
+S_read_state(TransducerIVARS *ivars, uint32_t addr, FSTState *state) {
+    const char *ptr = ivars->data + addr;
+    if (addr > ivars->size - STATE_HEADER_SIZE) {
+        THROW(ERR, "Corrupt transducer in '%o': bad state address %u32",
+              InStream_Get_Filename(ivars->instream), addr);
+    }
+    state->final    = ptr[0] != 0;
+    state->num_arcs = NumUtil_decode_bigend_u16((void*)(ptr + 1));
+    state->count    = NumUtil_decode_bigend_u32((void*)(ptr + 3));
+    state->labels   = (const uint8_t*)ptr + STATE_HEADER_SIZE;
+    state->arcs     = ptr + STATE_HEADER_SIZE + state->num_arcs;
+    if ((uint64_t)addr + STATE_HEADER_SIZE
+        + (uint64_t)state->num_arcs * (1 + ARC_SIZE) > ivars->size
+       ) {
+        THROW(ERR, "Corrupt transducer in '%o': state %u32 overruns data",
+              InStream_Get_Filename(ivars->instream), addr);
+    }
+}
+
+// Return the tick of the first arc whose label is not less than `label`.
+static CFISH_INLINE uint32_t
+SI_find_arc(const FSTState *state, uint8_t label) {
+    uint32_t lo = 0;
+    uint32_t hi = state->num_arcs;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (state->labels[mid] < label) { lo = mid + 1; }
+        else                            { hi = mid; }
+    }
+    return lo;
+}
+
+Transducer*
+FST_open(InStream *instream) {
+    Transducer *self = (Transducer*)VTable_Make_Obj(TRANSDUCER);
+    return FST_do_open(self, instream);
+}
+
+Transducer*
+FST_do_open(Transducer *self, InStream *instream) {
+    TransducerIVARS *const ivars = FST_IVARS(self);
+    const int64_t len = InStream_Length(instream);
+    if (len < TRAILER_SIZE || len > INT32_MAX) {
+        Err_set_error(Err_new(Str_newf("Invalid transducer length in '%o': %i64",
+                                       InStream_Get_Filename(instream), len)));
+        DECREF(self);
+        return NULL;
+    }
+
+    // Keep the whole file in a single window.
+    ivars->instream = (InStream*)INCREF(instream);
+    InStream_Seek(instream, 0);
+    ivars->data = InStream_Buf(instream, (size_t)len);
+    ivars->size = (uint32_t)len - TRAILER_SIZE;
+    ivars->root = NumUtil_decode_bigend_u32((void*)(ivars->data + ivars->size));
+    ivars->num_keys = (int32_t)NumUtil_decode_bigend_u32(
+                          (void*)(ivars->data + ivars->size + 4));
+
+    if (ivars->size < STATE_HEADER_SIZE
+        || ivars->root > ivars->size - STATE_HEADER_SIZE
+        || ivars->num_keys < 0
+       ) {
+        Err_set_error(Err_new(Str_newf("Corrupt transducer in '%o'",
+                                       InStream_Get_Filename(instream))));
+        DECREF(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void
+FST_Destroy_IMP(Transducer *self) {
+    TransducerIVARS *const ivars = FST_IVARS(self);
+    DECREF(ivars->instream);
+    SUPER_DESTROY(self, TRANSDUCER);
+}
+
+int32_t
+FST_Get_Num_Keys_IMP(Transducer *self) {
+    return FST_IVARS(self)->num_keys;
+}
+
+int32_t
+FST_Rank_IMP(Transducer *self, const char *key, size_t size, bool *exact) {
+    TransducerIVARS *const ivars = FST_IVARS(self);
+    const uint8_t *bytes = (const uint8_t*)key;
+    uint32_t rank = 0;
+    FSTState state;
+
+    S_read_state(ivars, ivars->root, &state);
+    for (size_t i = 0; i < size; i++) {
+        const uint32_t tick = SI_find_arc(&state, bytes[i]);
+
+        // Everything reachable through earlier arcs -- plus this state's
+        // own key, which is a proper prefix -- sorts before the target.
+        rank += tick < state.num_arcs ? SI_arc_before(&state, tick)
+                                      : state.count;
+        if (tick == state.num_arcs || state.labels[tick] != bytes[i]) {
+            if (exact) { *exact = false; }
+            return (int32_t)rank;
+        }
+        S_read_state(ivars, SI_arc_target(&state, tick), &state);
+    }
+
+    if (exact) { *exact = state.final; }
+    return (int32_t)rank;
+}
+
+int32_t
+FST_Floor_IMP(Transducer *self, const char *key, size_t size) {
+    bool exact;
+    int32_t rank = FST_Rank_IMP(self, key, size, &exact);
+    return exact ? rank : rank - 1;
+}
+
+int32_t
+FST_Prefix_Range_IMP(Transducer *self, const char *prefix, size_t size,
+                     int32_t *first) {
+    TransducerIVARS *const ivars = FST_IVARS(self);
+    const uint8_t *bytes = (const uint8_t*)prefix;
+    uint32_t rank = 0;
+    FSTState state;
+
+    S_read_state(ivars, ivars->root, &state);
+    for (size_t i = 0; i < size; i++) {
+        const uint32_t tick = SI_find_arc(&state, bytes[i]);
+        rank += tick < state.num_arcs ? SI_arc_before(&state, tick)
+                                      : state.count;
+        if (tick == state.num_arcs || state.labels[tick] != bytes[i]) {
+            *first = (int32_t)rank;
+            return 0;
+        }
+        S_read_state(ivars, SI_arc_target(&state, tick), &state);
+    }
+
+    *first = (int32_t)rank;
+    return (int32_t)state.count;
+}
+
+bool
+FST_Fetch_Key_IMP(Transducer *self, int32_t ordinal, ByteBuf *dest) {
+    TransducerIVARS *const ivars = FST_IVARS(self);
+    uint32_t remaining = (uint32_t)ordinal;
+    FSTState state;
+
+    BB_Set_Size(dest, 0);
+    if (ordinal < 0 || ordinal >= ivars->num_keys) { return false; }
+
+    S_read_state(ivars, ivars->root, &state);
+    while (!(state.final && remaining == 0)) {
+        // Find the last arc which has no more than `remaining` keys before
+        // it.
+        uint32_t lo = 0;
+        uint32_t hi = state.num_arcs;
+        while (hi - lo > 1) {
+            const uint32_t mid = lo + (hi - lo) / 2;
+            if (SI_arc_before(&state, mid) <= remaining) { lo = mid; }
+            else                                          { hi = mid; }
+        }
+        if (state.num_arcs == 0) {
+            THROW(ERR, "Corrupt transducer in '%o'",
+                  InStream_Get_Filename(ivars->instream));
+        }
+        remaining -= SI_arc_before(&state, lo);
+        BB_Cat_Bytes(dest, state.labels + lo, 1);
+        S_read_state(ivars, SI_arc_target(&state, lo), &state);
+    }
+
+    return true;
+}
+
+/****************************************************************************/
+
+// An arc of a state still under construction.
+typedef struct {
+    uint8_t   label;
+    uint32_t  target;
+    uint32_t  count;
+} FSTBuilderArc;
+
+// A state on the path of the last key added, which later keys may still
+// extend.
+typedef struct {
+    bool            final;
+    uint32_t        num_arcs;
+    FSTBuilderArc   arcs[256];
+} FSTBuilderNode;
+
+TransducerBuilder*
+FSTBuilder_new() {
+    TransducerBuilder *self
+        = (TransducerBuilder*)VTable_Make_Obj(TRANSDUCERBUILDER);
+    return FSTBuilder_init(self);
+}
+
+TransducerBuilder*
+FSTBuilder_init(TransducerBuilder *self) {
+    TransducerBuilderIVARS *const ivars = FSTBuilder_IVARS(self);
+    ivars->nodes_cap = 16;
+    ivars->nodes     = CALLOCATE(ivars->nodes_cap, sizeof(FSTBuilderNode));
+    ivars->depth     = 0;
+    ivars->last_key  = BB_new(0);
+    ivars->data      = BB_new(0);
+    ivars->scratch   = BB_new(0);
+    ivars->registry  = Hash_new(0);
+    ivars->num_keys  = 0;
+    return self;
+}
+
+void
+FSTBuilder_Destroy_IMP(TransducerBuilder *self) {
+    TransducerBuilderIVARS *const ivars = FSTBuilder_IVARS(self);
+    FREEMEM(ivars->nodes);
+    DECREF(ivars->last_key);
+    DECREF(ivars->data);
+    DECREF(ivars->scratch);
+    DECREF(ivars->registry);
+    SUPER_DESTROY(self, TRANSDUCERBUILDER);
+}
+
+int32_t
+FSTBuilder_Get_Num_Keys_IMP(TransducerBuilder *self) {
+    return FSTBuilder_IVARS(self)->num_keys;
+}
+
+// Serialize a finished state, sharing an identical state already written if
+// there is one.  Return its address and set `count` to the number of keys
+// reachable from it.
+static uint32_t
+S_freeze(TransducerBuilderIVARS *ivars, FSTBuilderNode *node,
+         uint32_t *count) {
+    const size_t size = STATE_HEADER_SIZE + node->num_arcs * (1 + ARC_SIZE);
+    char *buf = BB_Grow(ivars->scratch, size);
+    char *ptr = buf;
+    uint32_t before = node->final ? 1 : 0;
+
+    *ptr++ = node->final ? 1 : 0;
+    NumUtil_encode_bigend_u16((uint16_t)node->num_arcs, &ptr);
+    ptr += 2;
+    ptr += 4; // Total count, filled in below.
+    for (uint32_t i = 0; i < node->num_arcs; i++) {
+        *ptr++ = (char)node->arcs[i].label;
+    }
+    for (uint32_t i = 0; i < node->num_arcs; i++) {
+        NumUtil_encode_bigend_u32(node->arcs[i].target, &ptr);
+        ptr += 4;
+        NumUtil_encode_bigend_u32(before, &ptr);
+        ptr += 4;
+        before += node->arcs[i].count;
+    }
+    ptr = buf + 3;
+    NumUtil_encode_bigend_u32(before, &ptr);
+    BB_Set_Size(ivars->scratch, size);
+    *count = before;
+
+    Integer32 *addr = (Integer32*)Hash_Fetch(ivars->registry,
+                                             (Obj*)ivars->scratch);
+    if (addr) { return (uint32_t)Int32_Get_Value(addr); }
+
+    const size_t new_addr = BB_Get_Size(ivars->data);
+    if (new_addr + size > INT32_MAX - TRAILER_SIZE) {
+        THROW(ERR, "Transducer too large");
+    }
+    BB_Cat_Bytes(ivars->data, buf, size);
+    Hash_Store(ivars->registry, (Obj*)ivars->scratch,
+               (Obj*)Int32_new((int32_t)new_addr));
+    return (uint32_t)new_addr;
+}
+
+// Freeze the states on the current path which are deeper than `depth`.
+static void
+S_freeze_tail(TransducerBuilderIVARS *ivars, uint32_t depth) {
+    FSTBuilderNode *nodes = (FSTBuilderNode*)ivars->nodes;
+    while (ivars->depth > depth) {
+        FSTBuilderNode *node   = nodes + ivars->depth;
+        FSTBuilderNode *parent = nodes + ivars->depth - 1;
+        FSTBuilderArc  *arc    = parent->arcs + parent->num_arcs - 1;
+        arc->target = S_freeze(ivars, node, &arc->count);
+        node->final    = false;
+        node->num_arcs = 0;
+        ivars->depth--;
+    }
+}
+
+bool
+FSTBuilder_Add_IMP(TransducerBuilder *self, const char *key, size_t size) {
+    TransducerBuilderIVARS *const ivars = FSTBuilder_IVARS(self);
+    const char *last      = BB_Get_Buf(ivars->last_key);
+    const size_t last_size = BB_Get_Size(ivars->last_key);
+    size_t common = 0;
+
+    // Keys must arrive in strictly ascending byte order.
+    while (common < size && common < last_size
+           && key[common] == last[common]
+          ) {
+        common++;
+    }
+    if (ivars->num_keys > 0) {
+        if (common == size) { return false; }
+        if (common < last_size
+            && (uint8_t)key[common] < (uint8_t)last[common]
+           ) {
+            return false;
+        }
+    }
+    if (size >= UINT32_MAX - 1) {
+        THROW(ERR, "Key too long: %u64", (uint64_t)size);
+    }
+
+    // States beyond the shared prefix can't gain any more arcs.
+    S_freeze_tail(ivars, (uint32_t)common);
+
+    // Extend the path with the rest of the new key.
+    if (size + 1 > ivars->nodes_cap) {
+        uint32_t new_cap = ivars->nodes_cap;
+        while (new_cap < size + 1) { new_cap *= 2; }
+        ivars->nodes = REALLOCATE(ivars->nodes,
+                                  new_cap * sizeof(FSTBuilderNode));
+        memset((FSTBuilderNode*)ivars->nodes + ivars->nodes_cap, 0,
+               (new_cap - ivars->nodes_cap) * sizeof(FSTBuilderNode));
+        ivars->nodes_cap = new_cap;
+    }
+    FSTBuilderNode *nodes = (FSTBuilderNode*)ivars->nodes;
+    for (size_t i = common; i < size; i++) {
+        FSTBuilderNode *node = nodes + i;
+        FSTBuilderArc  *arc  = node->arcs + node->num_arcs++;
+        arc->label  = (uint8_t)key[i];
+        arc->target = 0;
+        arc->count  = 0;
+    }
+    nodes[size].final = true;
+    ivars->depth = (uint32_t)size;
+
+    BB_Mimic_Bytes(ivars->last_key, key, size);
+    ivars->num_keys++;
+    return true;
+}
+
+void
+FSTBuilder_Finish_IMP(TransducerBuilder *self, OutStream *outstream) {
+    TransducerBuilderIVARS *const ivars = FSTBuilder_IVARS(self);
+    FSTBuilderNode *nodes = (FSTBuilderNode*)ivars->nodes;
+    uint32_t count;
+
+    S_freeze_tail(ivars, 0);
+    uint32_t root = S_freeze(ivars, nodes, &count);
+    nodes->final    = false;
+    nodes->num_arcs = 0;
+
+    OutStream_Write_Bytes(outstream, BB_Get_Buf(ivars->data),
+                          BB_Get_Size(ivars->data));
+    OutStream_Write_U32(outstream, root);
+    OutStream_Write_U32(outstream, (uint32_t)ivars->num_keys);
+
+    // Prevent further additions from producing a malformed result.
+    Hash_Clear(ivars->registry);
+    BB_Set_Size(ivars->data, 0);
+    BB_Set_Size(ivars->last_key, 0);
+    ivars->num_keys = 0;
+}
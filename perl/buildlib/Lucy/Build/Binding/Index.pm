@@ -46,7 +46,20 @@ sub bind_all {
 }
 
 sub bind_backgroundmerger {
-    my @exposed = qw( Commit Prepare_Commit Optimize );
+    my @exposed = qw(
+        Commit
+        Prepare_Commit
+        Optimize
+        Abandon
+        Set_IO_Budget
+        Get_IO_Budget
+        Set_Time_Budget
+        Get_Time_Budget
+        Checkpoint
+        Bytes_Total
+        Bytes_Done
+        ETA
+    );
 
     my $pod_spec = Clownfish::CFC::Binding::Perl::Pod->new;
     my $synopsis = <<'END_SYNOPSIS';
@@ -204,6 +217,8 @@ sub bind_indexmanager {
     my @exposed = qw(
         Make_Write_Lock
         Recycle
+        Set_Merge_Policy
+        Get_Merge_Policy
         Set_Folder
         Get_Folder
         Get_Host
@@ -338,6 +353,7 @@ sub bind_indexer {
         Optimize
         Commit
         Prepare_Commit
+        Flush
         Delete_By_Term
         Delete_By_Query
         Delete_By_Doc_ID
@@ -31,6 +31,7 @@ our %starts;
 our %doc_max;
 
 use IO::Socket::INET;
+use LucyX::Remote::SearchServer;
 
 sub new {
     my ( $either, %args ) = @_;
@@ -58,10 +59,15 @@ sub new {
     $shards{$$self} = \@shards;
 
     # Handshake with servers.
-    my %handshake_args = ( _action => 'handshake' );
+    my $version = $LucyX::Remote::SearchServer::PROTOCOL_VERSION;
+    my %handshake_args = (
+        _action          => 'handshake',
+        protocol_version => $version,
+    );
     my $responses = $self->_multi_rpc( \%handshake_args );
     for my $response (@$responses) {
-        confess unless $response;
+        confess("Server doesn't speak protocol version $version")
+            unless $response && $response == $version;
     }
 
     # Derive doc_max and relative start offsets.
@@ -282,6 +288,14 @@ sub top_docs {
         $hit_q = Lucy::Search::HitQueue->new( wanted => $num_wanted, );
     }
 
+    # A SearchBudget can't cross the wire, so send what's left of it for each
+    # shard to rebuild.
+    my $budget = delete $args{budget};
+    if ($budget) {
+        $args{budget_ms}   = $budget->get_time_left;
+        $args{budget_docs} = $budget->get_docs_left;
+    }
+
     # Gather remote responses and aggregate.
     $args{_action} = 'top_docs';
     my $responses  = $self->_multi_rpc( \%args );
@@ -296,14 +310,21 @@ sub top_docs {
             $hit_q->insert($match_doc);
         }
         $total_hits += $sub_top_docs->get_total_hits;
+        $budget->absorb($sub_top_docs) if $budget;
     }
 
-    # Return a TopDocs object with the best of the best.
+    # Return a TopDocs object with the best of the best, flagged as partial
+    # if any shard ran out of budget.
     my $best_match_docs = $hit_q->pop_all;
-    return Lucy::Search::TopDocs->new(
+    my $top_docs        = Lucy::Search::TopDocs->new(
         total_hits => $total_hits,
         match_docs => $best_match_docs,
     );
+    if ($budget) {
+        $top_docs->set_partial( $budget->expired );
+        $top_docs->set_segments_completed( $budget->get_segments_completed );
+    }
+    return $top_docs;
 }
 
 sub terminate {
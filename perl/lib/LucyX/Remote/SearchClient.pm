@@ -28,6 +28,7 @@ our %peer_address;
 our %sock;
 
 use IO::Socket::INET;
+use LucyX::Remote::SearchServer;
 
 sub new {
     my ( $either, %args ) = @_;
@@ -42,9 +43,15 @@ sub new {
     );
     confess("No socket: $!") unless $sock;
     $sock->autoflush(1);
-    my %handshake_args = ( _action => 'handshake' );
+    my $version = $LucyX::Remote::SearchServer::PROTOCOL_VERSION;
+    my %handshake_args = (
+        _action          => 'handshake',
+        protocol_version => $version,
+    );
     my $response = $self->_rpc( \%handshake_args );
-    confess("Failed to connect") unless $response;
+    confess("Failed to connect") unless defined $response;
+    confess("Server doesn't speak protocol version $version")
+        unless $response == $version;
 
     return $self;
 }
@@ -101,9 +108,19 @@ sub _rpc {
 }
 
 sub top_docs {
-    my $self = shift;
-    my %args = ( @_, _action => 'top_docs' );
-    return $self->_rpc( \%args );
+    my $self   = shift;
+    my %args   = ( @_, _action => 'top_docs' );
+    my $budget = delete $args{budget};
+
+    # A SearchBudget can't cross the wire, so send what's left of it for the
+    # server to rebuild, then fold the server's progress back in.
+    if ($budget) {
+        $args{budget_ms}   = $budget->get_time_left;
+        $args{budget_docs} = $budget->get_docs_left;
+    }
+    my $top_docs = $self->_rpc( \%args );
+    $budget->absorb($top_docs) if $budget;
+    return $top_docs;
 }
 
 sub terminate {
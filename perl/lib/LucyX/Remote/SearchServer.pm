@@ -27,6 +27,11 @@ use Scalar::Util qw( reftype );
 # Inside-out member vars.
 our %searcher;
 
+# Version of the wire protocol.  Bump it whenever the serialized form of
+# anything sent over the wire changes, so that mismatched clients and servers
+# refuse to talk.  Version 2 added TopDocs' partial flag and segment count.
+our $PROTOCOL_VERSION = 2;
+
 use IO::Socket::INET;
 use IO::Select;
 
@@ -136,7 +141,8 @@ sub serve_rpc {
 
 sub do_handshake {
     my ( $self, $args ) = @_;
-    my $retval = 1;
+    my $version = $args->{protocol_version} || 1;
+    my $retval  = $version == $PROTOCOL_VERSION ? $PROTOCOL_VERSION : 0;
     return { retval => $retval };
 }
 
@@ -151,6 +157,15 @@ sub do_doc_freq {
 
 sub do_top_docs {
     my ( $self, $args ) = @_;
+    # Rebuild the caller's SearchBudget from what was left of it.
+    my $budget_ms   = delete $args->{budget_ms};
+    my $budget_docs = delete $args->{budget_docs};
+    if ( $budget_ms || $budget_docs ) {
+        $args->{budget} = Lucy::Search::SearchBudget->new(
+            milliseconds => $budget_ms   || 0,
+            max_docs     => $budget_docs || 0,
+        );
+    }
     my $top_docs = $searcher{$$self}->top_docs(%$args);
     return { retval => $top_docs };
 }
@@ -98,7 +98,7 @@ my $test_client_sock = IO::Socket::INET->new(
     Proto    => 'tcp',
 );
 if ($test_client_sock) {
-    plan( tests => 10 );
+    plan( tests => 12 );
     undef $test_client_sock;
 }
 else {
@@ -185,6 +185,16 @@ while ( my $hit = $hits->next ) {
 is_deeply( \@got, [ reverse @reversed ],
     "Sort hits accross multiple shards" );
 
+my $budget   = Lucy::Search::SearchBudget->new( milliseconds => 60_000 );
+my $top_docs = $cluster_searcher->top_docs(
+    query => Lucy::Search::TermQuery->new( field => 'content', term => 'b' ),
+    num_wanted => 10,
+    budget     => $budget,
+);
+ok( !$top_docs->partial, "budget carried to shards without cutting search" );
+is( $top_docs->get_segments_completed, scalar @ports,
+    "segments completed merged across shards" );
+
 END {
     $solo_cluster_searcher->close if defined $solo_cluster_searcher;
     $cluster_searcher->close      if defined $cluster_searcher;
@@ -19,6 +19,7 @@
 #include "XSBind.h"
 
 #include "Lucy/Index/DocReader.h"
+#include "Clownfish/VArray.h"
 #include "Lucy/Document/HitDoc.h"
 #include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/BlobType.h"
@@ -27,29 +28,43 @@
 #include "Lucy/Plan/NumericType.h"
 #include "Lucy/Store/InStream.h"
 
-lucy_HitDoc*
-LUCY_DefDocReader_Fetch_Doc_IMP(lucy_DefaultDocReader *self, int32_t doc_id) {
+// Return true if <code>fields</code> is NULL or contains the field name.
+static bool
+S_wanted(cfish_VArray *fields, const char *name, size_t name_len) {
+    if (!fields) { return true; }
+    for (uint32_t i = 0, max = CFISH_VA_Get_Size(fields); i < max; i++) {
+        cfish_String *field = (cfish_String*)CFISH_VA_Fetch(fields, i);
+        if (field && CFISH_Str_Equals_Utf8(field, name, name_len)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static lucy_HitDoc*
+S_fetch_doc(lucy_DefaultDocReader *self, int32_t doc_id,
+            cfish_VArray *wanted_fields) {
     lucy_DefaultDocReaderIVARS *const ivars = lucy_DefDocReader_IVARS(self);
     lucy_Schema   *const schema = ivars->schema;
-    lucy_InStream *const dat_in = ivars->dat_in;
-    lucy_InStream *const ix_in  = ivars->ix_in;
+    lucy_InStream *const dat_in = LUCY_DefDocReader_Seek_Record(self, doc_id);
     HV *fields = newHV();
-    int64_t start;
     uint32_t num_fields;
+    uint32_t num_wanted = wanted_fields
+                          ? CFISH_VA_Get_Size(wanted_fields)
+                          : UINT32_MAX;
     SV *field_name_sv = newSV(1);
 
-    // Get data file pointer from index, read number of fields.
-    LUCY_InStream_Seek(ix_in, (int64_t)doc_id * 8);
-    start = LUCY_InStream_Read_U64(ix_in);
-    LUCY_InStream_Seek(dat_in, start);
+    // Read number of fields.
     num_fields = LUCY_InStream_Read_C32(dat_in);
 
-    // Decode stored data and build up the doc field by field.
-    while (num_fields--) {
+    // Decode stored data and build up the doc field by field, stopping once
+    // every requested field has been found.
+    while (num_fields-- && num_wanted) {
         STRLEN  field_name_len;
         char   *field_name_ptr;
         SV     *value_sv;
         lucy_FieldType *type;
+        lucy_InStream  *value_in;
 
         // Read field name.
         field_name_len = LUCY_InStream_Read_C32(dat_in);
@@ -65,12 +80,19 @@ LUCY_DefDocReader_Fetch_Doc_IMP(lucy_DefaultDocReader *self, int32_t doc_id) {
             = CFISH_SSTR_WRAP_UTF8(field_name_ptr, field_name_len);
         type = LUCY_Schema_Fetch_Type(schema, (cfish_String*)field_name_str);
 
+        // Skip over the value unless it was asked for.
+        bool wanted = S_wanted(wanted_fields, field_name_ptr, field_name_len);
+        value_in = LUCY_DefDocReader_Seek_Value(self, dat_in, type, wanted);
+        if (!value_in) { continue; }
+        if (wanted_fields) { num_wanted--; }
+
         // Read the field value.
         switch (LUCY_FType_Primitive_ID(type) & lucy_FType_PRIMITIVE_ID_MASK) {
             case lucy_FType_TEXT: {
-                    STRLEN value_len = LUCY_InStream_Read_C32(dat_in);
+                    STRLEN value_len = LUCY_InStream_Read_C32(value_in);
                     value_sv = newSV((value_len ? value_len : 1));
-                    LUCY_InStream_Read_Bytes(dat_in, SvPVX(value_sv), value_len);
+                    LUCY_InStream_Read_Bytes(value_in, SvPVX(value_sv),
+                                             value_len);
                     SvCUR_set(value_sv, value_len);
                     *SvEND(value_sv) = '\0';
                     SvPOK_on(value_sv);
@@ -78,30 +100,31 @@ LUCY_DefDocReader_Fetch_Doc_IMP(lucy_DefaultDocReader *self, int32_t doc_id) {
                     break;
                 }
             case lucy_FType_BLOB: {
-                    STRLEN value_len = LUCY_InStream_Read_C32(dat_in);
+                    STRLEN value_len = LUCY_InStream_Read_C32(value_in);
                     value_sv = newSV((value_len ? value_len : 1));
-                    LUCY_InStream_Read_Bytes(dat_in, SvPVX(value_sv), value_len);
+                    LUCY_InStream_Read_Bytes(value_in, SvPVX(value_sv),
+                                             value_len);
                     SvCUR_set(value_sv, value_len);
                     *SvEND(value_sv) = '\0';
                     SvPOK_on(value_sv);
                     break;
                 }
             case lucy_FType_FLOAT32:
-                value_sv = newSVnv(LUCY_InStream_Read_F32(dat_in));
+                value_sv = newSVnv(LUCY_InStream_Read_F32(value_in));
                 break;
             case lucy_FType_FLOAT64:
-                value_sv = newSVnv(LUCY_InStream_Read_F64(dat_in));
+                value_sv = newSVnv(LUCY_InStream_Read_F64(value_in));
                 break;
             case lucy_FType_INT32:
-                value_sv = newSViv((int32_t)LUCY_InStream_Read_C32(dat_in));
+                value_sv = newSViv((int32_t)LUCY_InStream_Read_C32(value_in));
                 break;
             case lucy_FType_INT64:
                 if (sizeof(IV) == 8) {
-                    int64_t val = (int64_t)LUCY_InStream_Read_C64(dat_in);
+                    int64_t val = (int64_t)LUCY_InStream_Read_C64(value_in);
                     value_sv = newSViv((IV)val);
                 }
                 else { // (lossy)
-                    int64_t val = (int64_t)LUCY_InStream_Read_C64(dat_in);
+                    int64_t val = (int64_t)LUCY_InStream_Read_C64(value_in);
                     value_sv = newSVnv((double)val);
                 }
                 break;
@@ -120,4 +143,15 @@ LUCY_DefDocReader_Fetch_Doc_IMP(lucy_DefaultDocReader *self, int32_t doc_id) {
     return retval;
 }
 
+lucy_HitDoc*
+LUCY_DefDocReader_Fetch_Doc_IMP(lucy_DefaultDocReader *self, int32_t doc_id) {
+    return S_fetch_doc(self, doc_id, NULL);
+}
+
+lucy_HitDoc*
+LUCY_DefDocReader_Fetch_Doc_Fields_IMP(lucy_DefaultDocReader *self,
+                                       int32_t doc_id, cfish_VArray *fields) {
+    return S_fetch_doc(self, doc_id, fields);
+}
+
 
@@ -19,19 +19,15 @@
 #include "XSBind.h"
 #include "Lucy/Index/Inverter.h"
 #include "Lucy/Document/Doc.h"
-#include "Lucy/Index/Segment.h"
 #include "Clownfish/ByteBuf.h"
 #include "Lucy/Plan/FieldType.h"
 #include "Lucy/Plan/BlobType.h"
 #include "Lucy/Plan/NumericType.h"
-#include "Lucy/Plan/Schema.h"
 #include "Lucy/Plan/TextType.h"
 #include "Clownfish/Util/StringHelper.h"
 
 static lucy_InverterEntry*
 S_fetch_entry(lucy_Inverter *self, HE *hash_entry) {
-    lucy_InverterIVARS *const ivars = lucy_Inverter_IVARS(self);
-    lucy_Schema *const schema = ivars->schema;
     char *key;
     STRLEN key_len;
     STRLEN he_key_len = HeKLEN(hash_entry);
@@ -51,30 +47,7 @@ S_fetch_entry(lucy_Inverter *self, HE *hash_entry) {
     }
 
     cfish_StackString *field = CFISH_SSTR_WRAP_UTF8(key, key_len);
-    int32_t field_num
-        = LUCY_Seg_Field_Num(ivars->segment, (cfish_String*)field);
-    if (!field_num) {
-        // This field seems not to be in the segment yet.  Try to find it in
-        // the Schema.
-        if (LUCY_Schema_Fetch_Type(schema, (cfish_String*)field)) {
-            // The field is in the Schema.  Get a field num from the Segment.
-            field_num = LUCY_Seg_Add_Field(ivars->segment,
-                                           (cfish_String*)field);
-        }
-        else {
-            // We've truly failed to find the field.  The user must
-            // not have spec'd it.
-            THROW(CFISH_ERR, "Unknown field name: '%s'", key);
-        }
-    }
-
-    lucy_InverterEntry *entry
-        = (lucy_InverterEntry*)CFISH_VA_Fetch(ivars->entry_pool, field_num);
-    if (!entry) {
-        entry = lucy_InvEntry_new(schema, (cfish_String*)field, field_num);
-        CFISH_VA_Store(ivars->entry_pool, field_num, (cfish_Obj*)entry);
-    }
-    return entry;
+    return LUCY_Inverter_Fetch_Entry(self, (cfish_String*)field);
 }
 
 void